@@ -10,6 +10,9 @@
 #ifndef MISAKI_API_H
 #define MISAKI_API_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +28,309 @@ extern "C" {
 #define MISAKI_API
 #endif
 
+/* ============================================================================
+ * 引擎（可重入）
+ * ========================================================================== */
+
+/**
+ * G2P 引擎：创建后只读，可以被多个线程同时使用
+ * （每次转换的临时数据都在调用内分配）
+ */
+typedef struct MisakiEngine MisakiEngine;
+
+/**
+ * 创建引擎（加载数据目录下的词典；缺少的语言不可用）
+ * 
+ * @param data_dir 数据目录路径（NULL 使用 "../extracted_data"）
+ * @return 引擎，失败返回 NULL（用 misaki_engine_free 释放）
+ */
+MISAKI_API MisakiEngine* misaki_engine_create(const char *data_dir);
+
+/**
+ * 释放引擎（调用前须确保没有线程还在使用）
+ * 
+ * @param engine 引擎
+ */
+MISAKI_API void misaki_engine_free(MisakiEngine *engine);
+
+/**
+ * 设置转换结果缓存的容量（默认 4096 条；0 表示关闭缓存）
+ * 
+ * 重复的文本（界面提示、预设台词等）直接返回缓存的结果；
+ * 应在开始转换前调用，不能与转换函数同时调用
+ * 
+ * @param engine 引擎
+ * @param capacity 容量（条目数）
+ * @return 0=成功, -1=失败
+ */
+MISAKI_API int misaki_engine_set_cache_capacity(MisakiEngine *engine, int capacity);
+
+/**
+ * 打开转换结果的持久化存储（放在内存缓存之后，重启后直接复用）
+ * 
+ * 同一台机器上的多个进程可以共用同一个文件；
+ * 应在开始转换前调用，不能与转换函数同时调用；关闭内存缓存时不使用存储
+ * 
+ * @param engine 引擎
+ * @param path 文件路径（不存在时创建；NULL 表示关闭已打开的存储）
+ * @return 0=成功, -1=失败（不支持的平台或无法打开）
+ */
+MISAKI_API int misaki_engine_open_store(MisakiEngine *engine, const char *path);
+
+/**
+ * 从文件加载预设表（tools/misaki_preset_compile 生成）
+ * 
+ * 转换前先查预设表：收录的文本直接返回预先转换好的音素，
+ * 不经过语言检测、分词和 G2P；应在开始转换前调用，不能与转换函数同时调用
+ * 
+ * @param engine 引擎
+ * @param path 文件路径（NULL 表示卸载已加载的预设表）
+ * @return 0=成功, -1=失败（文件不存在或格式错误）
+ */
+MISAKI_API int misaki_engine_load_presets(MisakiEngine *engine, const char *path);
+
+/**
+ * 使用编进程序的预设表数据（misaki_preset_compile -c 生成的数组）
+ * 
+ * 应在开始转换前调用，不能与转换函数同时调用
+ * 
+ * @param engine 引擎
+ * @param data 数据（不复制，须比引擎活得久；NULL 表示卸载）
+ * @param size 数据大小
+ * @return 0=成功, -1=失败（格式错误）
+ */
+MISAKI_API int misaki_engine_set_presets(MisakiEngine *engine, const void *data, size_t size);
+
+/**
+ * 文本转音素（自动检测语言，线程安全）
+ * 
+ * @param engine 引擎
+ * @param text 输入文本（UTF-8）
+ * @param output_buffer 输出缓冲区（调用者分配）
+ * @param buffer_size 缓冲区大小
+ * @return 0=成功, -1=失败
+ */
+MISAKI_API int misaki_engine_text_to_phonemes(
+    const MisakiEngine *engine,
+    const char *text,
+    char *output_buffer,
+    int buffer_size
+);
+
+/**
+ * 文本转音素（指定语言，线程安全）
+ * 
+ * @param engine 引擎
+ * @param text 输入文本（UTF-8）
+ * @param lang 语言代码（"ja"=日文, "zh"=中文, "en"=英文, "qya"=昆雅语）
+ * @param output_buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @return 0=成功, -1=失败
+ */
+MISAKI_API int misaki_engine_text_to_phonemes_lang(
+    const MisakiEngine *engine,
+    const char *text,
+    const char *lang,
+    char *output_buffer,
+    int buffer_size
+);
+
+/**
+ * 加载 Kokoro 词表（vocab.json：{"字符": ID, ...}；引擎默认使用内置的词表）
+ * 
+ * 应在开始转换前调用，不能与转换函数同时调用
+ * 
+ * @param engine 引擎
+ * @param path 文件路径（NULL 表示恢复内置的词表）
+ * @return 0=成功, -1=失败（文件不存在或格式错误，原来的词表不变）
+ */
+MISAKI_API int misaki_engine_load_vocab(MisakiEngine *engine, const char *path);
+
+/**
+ * 文本转 Kokoro 模型输入 ID（线程安全）
+ * 
+ * 转换得到的音素在库内直接查词表编码，不必把音素字符串交给应用再解析一遍；
+ * 超过模型长度上限时在标点（其次空格）处分段，每段为 [0, ID..., 0]，
+ * 可以直接作为一次推理的 input_ids。各段依次存放在 ids 中，
+ * 第 i 段的长度写在 chunk_lengths[i]
+ * 
+ * @param engine 引擎
+ * @param text 输入文本（UTF-8）
+ * @param lang 语言代码（同 misaki_engine_text_to_phonemes_lang；NULL=自动检测）
+ * @param max_tokens 每段最多的 ID 数（不含首尾的 0；<= 0 使用模型上限 510）
+ * @param ids 输出：ID（调用者分配）
+ * @param max_ids ids 的容量
+ * @param chunk_lengths 输出：每段的长度（调用者分配）
+ * @param max_chunks chunk_lengths 的容量
+ * @return 段数, -1=失败（转换失败或输出数组不够）
+ */
+MISAKI_API int misaki_engine_text_to_ids(
+    const MisakiEngine *engine,
+    const char *text,
+    const char *lang,
+    int max_tokens,
+    int64_t *ids,
+    int max_ids,
+    int *chunk_lengths,
+    int max_chunks
+);
+
+/**
+ * 音素字符串转 Kokoro 模型输入 ID（如流式转换回调里拿到的音素，线程安全）
+ * 
+ * 分段和输出格式同 misaki_engine_text_to_ids
+ * 
+ * @return 段数, -1=失败（参数错误或输出数组不够）
+ */
+MISAKI_API int misaki_engine_phonemes_to_ids(
+    const MisakiEngine *engine,
+    const char *phonemes,
+    int max_tokens,
+    int64_t *ids,
+    int max_ids,
+    int *chunk_lengths,
+    int max_chunks
+);
+
+/**
+ * 批量文本转音素（多线程，线程安全）
+ * 
+ * 一次调用转换多条文本，减少 FFI 调用次数；工作线程之间按工作窃取分配任务，
+ * 输出顺序与输入顺序一致，与线程数无关
+ * 
+ * 输出为一块连续内存：各条结果依次存放，每条以 '\0' 结尾，
+ * 第 i 条结果从 (*output + offsets[i]) 开始
+ * 
+ * @param engine 引擎
+ * @param texts 输入文本数组（UTF-8；某一项为 NULL 时该项视为失败）
+ * @param count 文本数
+ * @param lang 语言代码（同 misaki_engine_text_to_phonemes_lang；NULL=逐条自动检测）
+ * @param num_threads 线程数（<= 0 使用 CPU 核数）
+ * @param output 输出：结果缓冲区（用 misaki_free_buffer 释放）
+ * @param offsets 输出：每条结果的偏移（调用者分配 count 个；转换失败的项为 -1）
+ * @return 0=成功, -1=失败（参数错误或内存不足，此时 *output 为 NULL）
+ */
+MISAKI_API int misaki_engine_text_to_phonemes_batch(
+    const MisakiEngine *engine,
+    const char *const *texts,
+    int count,
+    const char *lang,
+    int num_threads,
+    char **output,
+    int *offsets
+);
+
+/**
+ * 流式转换的回调（在调用 misaki_engine_stream_convert 的线程上按句子顺序调用）
+ * 
+ * @param user 调用者数据
+ * @param index 句子序号（从 0 开始）
+ * @param sentence 句子在输入文本中的位置（已去掉首尾空白，不以 '\0' 结尾）
+ * @param sentence_length 句子的字节数
+ * @param phonemes 句子的音素（回调返回后失效；转换失败时为 NULL）
+ * @return 0=继续, 非 0=停止（不再转换和回调后面的句子）
+ */
+typedef int (*MisakiStreamCallback)(void *user, int index, const char *sentence,
+                                    int sentence_length, const char *phonemes);
+
+/**
+ * 流式文本转音素（按句子切分，每句转换完立即回调，线程安全）
+ * 
+ * 整段转换要等到最后一句完成才有输出；流式转换在第一句转换完时就回调，
+ * 调用者可以在回调里开始合成这一句。lookahead > 0 时另开一个后台线程
+ * 提前转换后面的句子：回调合成第 N 句的同时，第 N+1..N+lookahead 句已在转换
+ * 
+ * 每句单独做语言检测（lang 为 NULL 时）、分词和 G2P，同样先查预设表和缓存
+ * 
+ * @param engine 引擎
+ * @param text 输入文本（UTF-8）
+ * @param lang 语言代码（同 misaki_engine_text_to_phonemes_lang；NULL=逐句自动检测）
+ * @param lookahead 最多提前转换的句子数（0=不开后台线程，在调用线程上逐句转换）
+ * @param callback 回调
+ * @param user 调用者数据（原样传给回调）
+ * @return 回调过的句子数, -1=失败（参数错误或内存不足，此时没有回调）
+ */
+MISAKI_API int misaki_engine_stream_convert(
+    const MisakiEngine *engine,
+    const char *text,
+    const char *lang,
+    int lookahead,
+    MisakiStreamCallback callback,
+    void *user
+);
+
+/**
+ * 增量输入的流（文本一段一段到达时使用，如逐 token 生成的 LLM 回复）
+ * 
+ * 输入先缓冲起来，确定一个句子已经结束（后面的句子已经开始）时才转换并回调这个句子；
+ * 句子太长时在分句处（、，, 等）提前提交。音素只为提交的部分输出，
+ * 不会因为后面到达的文本而改变。同一个流不能被多个线程同时使用
+ */
+typedef struct MisakiStream MisakiStream;
+
+/**
+ * 创建增量输入的流
+ * 
+ * @param engine 引擎（须比流活得久）
+ * @param lang 语言代码（同 misaki_engine_text_to_phonemes_lang；NULL=逐句自动检测）
+ * @param callback 回调（在 feed / flush 的调用线程上按顺序调用；返回非 0 时流停止）
+ * @param user 调用者数据（原样传给回调）
+ * @return 流，失败返回 NULL（用 misaki_stream_free 释放）
+ */
+MISAKI_API MisakiStream* misaki_stream_create(
+    const MisakiEngine *engine,
+    const char *lang,
+    MisakiStreamCallback callback,
+    void *user
+);
+
+/**
+ * 设置分句提交的阈值：未结束的句子超过这么多字节时，在最后一个分句处提交；
+ * 超过 4 倍仍没有分句时整段提交（默认 96 字节；0 表示只在句末提交）
+ * 
+ * @param stream 流
+ * @param bytes 阈值（字节数）
+ */
+MISAKI_API void misaki_stream_set_clause_threshold(MisakiStream *stream, int bytes);
+
+/**
+ * 输入一段文本（可以在任意字节处切开，包括 UTF-8 字符中间）
+ * 
+ * @param stream 流
+ * @param chunk 文本片段（UTF-8）
+ * @return 这次回调的句子数, -1=失败（参数错误、内存不足或流已停止）
+ */
+MISAKI_API int misaki_stream_feed(MisakiStream *stream, const char *chunk);
+
+/**
+ * 输入结束：提交缓冲区里剩下的文本（之后可以继续 feed 下一段）
+ * 
+ * @param stream 流
+ * @return 这次回调的句子数, -1=失败（参数错误或流已停止）
+ */
+MISAKI_API int misaki_stream_flush(MisakiStream *stream);
+
+/**
+ * 释放流（不提交缓冲区里剩下的文本）
+ * 
+ * @param stream 流（可为 NULL）
+ */
+MISAKI_API void misaki_stream_free(MisakiStream *stream);
+
+/**
+ * 释放由 Misaki 分配的缓冲区（如批量转换的输出）
+ * 
+ * @param buffer 缓冲区（可为 NULL）
+ */
+MISAKI_API void misaki_free_buffer(char *buffer);
+
+/* ============================================================================
+ * 默认引擎（旧 API）
+ * 
+ * misaki_init / misaki_cleanup 不是线程安全的，应在启动、退出时各调用一次；
+ * 两者之间的转换函数可以在多个线程同时调用
+ * ========================================================================== */
+
 /**
  * 初始化 Misaki G2P 引擎
  * 
@@ -63,6 +369,53 @@ MISAKI_API int misaki_text_to_phonemes_lang(
     int buffer_size
 );
 
+/**
+ * 批量文本转音素（默认引擎，线程数为 CPU 核数）
+ * 
+ * 参数和输出格式同 misaki_engine_text_to_phonemes_batch
+ * 
+ * @return 0=成功, -1=失败
+ */
+MISAKI_API int misaki_text_to_phonemes_batch(
+    const char *const *texts,
+    int count,
+    const char *lang,
+    char **output,
+    int *offsets
+);
+
+/**
+ * 文本转 Kokoro 模型输入 ID（默认引擎，每段最多 510 个 ID）
+ * 
+ * 参数和输出格式同 misaki_engine_text_to_ids
+ * 
+ * @return 段数, -1=失败
+ */
+MISAKI_API int misaki_text_to_ids(
+    const char *text,
+    const char *lang,
+    int64_t *ids,
+    int max_ids,
+    int *chunk_lengths,
+    int max_chunks
+);
+
+/**
+ * 流式文本转音素（默认引擎，逐句自动检测语言，提前转换一句）
+ * 
+ * 回调和返回值同 misaki_engine_stream_convert
+ * 
+ * @param text 输入文本（UTF-8）
+ * @param callback 回调
+ * @param user 调用者数据
+ * @return 回调过的句子数, -1=失败
+ */
+MISAKI_API int misaki_stream_convert(
+    const char *text,
+    MisakiStreamCallback callback,
+    void *user
+);
+
 /**
  * 清理 Misaki G2P 引擎
  */
@@ -0,0 +1,136 @@
+/**
+ * misaki_arena.h
+ * 
+ * Misaki C Port - Arena Allocator
+ * 区域分配器（按块顺序分配，整体重置/释放）
+ * 
+ * 适用于生命周期一致的大量小对象（如 Lattice 节点）：
+ * 分配只是指针前移，释放只需一次 reset
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_ARENA_H
+#define MISAKI_ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * 数据结构
+ * ========================================================================== */
+
+/**
+ * 内存块（链表，最新的块在表头）
+ */
+typedef struct MisakiArenaChunk {
+    struct MisakiArenaChunk *next;  // 上一个块
+    size_t size;                    // 可用字节数
+    size_t used;                    // 已用字节数
+} MisakiArenaChunk;
+
+/**
+ * 区域分配器
+ */
+typedef struct MisakiArena {
+    MisakiArenaChunk *head;         // 当前块
+    size_t chunk_size;              // 默认块大小
+} MisakiArena;
+
+/* ============================================================================
+ * 区域分配器操作
+ * ========================================================================== */
+
+/**
+ * 创建区域分配器
+ * 
+ * @param chunk_size 默认块大小（字节，0 使用默认值 16KB）
+ * @return 分配器，失败返回 NULL
+ */
+MisakiArena* misaki_arena_create(size_t chunk_size);
+
+/**
+ * 释放区域分配器及其全部内存
+ * 
+ * @param arena 分配器
+ */
+void misaki_arena_free(MisakiArena *arena);
+
+/**
+ * 重置分配器（之前分配的内存全部失效，保留当前块供复用）
+ * 
+ * @param arena 分配器
+ */
+void misaki_arena_reset(MisakiArena *arena);
+
+/**
+ * 分配内存（按 max_align_t 对齐，内容已清零）
+ * 
+ * @param arena 分配器
+ * @param size 字节数
+ * @return 内存指针，失败返回 NULL
+ */
+void* misaki_arena_alloc(MisakiArena *arena, size_t size);
+
+/**
+ * 在分配器中复制字符串
+ * 
+ * @param arena 分配器
+ * @param str 源字符串
+ * @return 新字符串，str 为 NULL 或失败返回 NULL
+ */
+char* misaki_arena_strdup(MisakiArena *arena, const char *str);
+
+/**
+ * 已分配的总字节数（调试用）
+ * 
+ * @param arena 分配器
+ * @return 字节数
+ */
+size_t misaki_arena_used(const MisakiArena *arena);
+
+/* ============================================================================
+ * 字符串池（去重的只读字符串，存放在区域分配器中）
+ * ========================================================================== */
+
+/**
+ * 字符串池：相同内容的字符串只存一份，返回的指针在池释放前一直有效
+ */
+typedef struct MisakiStringPool {
+    MisakiArena *arena;             // 字符串存储
+    const char **slots;             // 开放寻址哈希表
+    size_t capacity;                // 槽数（2 的幂）
+    size_t count;                   // 字符串数
+} MisakiStringPool;
+
+/**
+ * 创建字符串池
+ * 
+ * @return 字符串池，失败返回 NULL
+ */
+MisakiStringPool* misaki_string_pool_create(void);
+
+/**
+ * 释放字符串池（之前返回的字符串全部失效）
+ * 
+ * @param pool 字符串池
+ */
+void misaki_string_pool_free(MisakiStringPool *pool);
+
+/**
+ * 驻留字符串（已有相同内容时返回已有的字符串）
+ * 
+ * @param pool 字符串池
+ * @param str 字符串
+ * @return 池中的字符串，str 为 NULL 或失败返回 NULL
+ */
+const char* misaki_string_pool_intern(MisakiStringPool *pool, const char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_ARENA_H */
@@ -4,6 +4,9 @@
  * Misaki C Port - LRU Cache
  * LRU 缓存实现（用于缓存分词结果、G2P 结果）
  * 
+ * 条目按键的 64 位哈希分到多个分片，各分片独立加锁，
+ * 所有操作都可以在多个线程同时调用
+ * 
  * License: MIT
  */
 
@@ -12,6 +15,9 @@
 
 #include "misaki_types.h"
 #include "misaki_tokenizer.h"
+#include "misaki_g2p.h"
+#include "misaki_sync.h"
+#include "misaki_store.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,39 +27,85 @@ extern "C" {
  * LRU Cache 数据结构
  * ========================================================================== */
 
+/**
+ * 缓存淘汰策略
+ */
+typedef enum {
+    CACHE_EVICT_LRU,           // 最近最少使用
+    CACHE_EVICT_LFU,           // 最不经常使用
+    CACHE_EVICT_FIFO,          // 先进先出
+} CacheEvictPolicy;
+
 /**
  * Cache Entry: 缓存条目
  */
 typedef struct CacheEntry {
     char *key;                 // 键（文本）
+    uint64_t hash;             // 键的 64 位哈希
     void *value;               // 值（TokenList 或其他）
     size_t value_size;         // 值大小（字节）
+    bool owned;                // 值由缓存分配（复制而来），释放时直接 free
     
     struct CacheEntry *prev;   // 双向链表：前驱
     struct CacheEntry *next;   // 双向链表：后继
+    struct CacheEntry *chain;  // 哈希桶内的下一个条目
     
+    uint64_t insert_time;      // 插入时间（毫秒，单调时钟）
     uint64_t access_time;      // 最后访问时间
     int access_count;          // 访问次数
 } CacheEntry;
 
 /**
- * LRU Cache: 最近最少使用缓存
+ * 正在计算的键（single-flight：同一个键同时未命中时只计算一次）
  */
-typedef struct LRUCache {
+typedef struct CacheFlight {
+    char *key;                 // 键
+    uint64_t hash;             // 键的哈希
+    void *value;               // 计算结果（副本，供等待者复制）
+    size_t value_size;         // 结果大小
+    bool done;                 // 计算已完成
+    int waiters;               // 等待者数（最后一个离开的释放）
+    struct CacheFlight *next;  // 同一分片的下一个
+} CacheFlight;
+
+/**
+ * 缓存分片：按键的哈希分到各分片，每个分片一把锁、一条 LRU 链表
+ */
+typedef struct CacheShard {
+    MisakiMutex lock;          // 保护本分片的全部字段
+    MisakiCond flight_done;    // 有计算完成时广播
+    
     CacheEntry **table;        // 哈希表
-    int table_size;            // 哈希表大小
+    int table_size;            // 哈希表大小（2 的幂）
     
     CacheEntry *head;          // 链表头（最近使用）
     CacheEntry *tail;          // 链表尾（最久未用）
+    CacheFlight *flights;      // 正在计算的键
     
     int count;                 // 当前条目数
     int capacity;              // 容量
-    size_t memory_limit;       // 内存限制（字节）
-    size_t memory_used;        // 已用内存
+    size_t memory_limit;       // 内存限制（字节，0 表示无限制）
+    size_t memory_used;        // 已用内存（键 + 值）
+    size_t key_bytes;          // 键占用的内存
     
     // 统计信息
     uint64_t hit_count;        // 命中次数
     uint64_t miss_count;       // 未命中次数
+} CacheShard;
+
+/**
+ * LRU Cache: 最近最少使用缓存（分片，线程安全）
+ */
+typedef struct LRUCache {
+    CacheShard *shards;        // 分片
+    int shard_count;           // 分片数（2 的幂）
+    
+    int capacity;              // 容量
+    size_t memory_limit;       // 内存限制（字节）
+    
+    CacheEvictPolicy policy;   // 淘汰策略
+    int ttl_seconds;           // 过期时间（秒，0 表示永不过期）
+    void (*value_free)(void*); // 淘汰、过期时释放非复制值的函数（可为 NULL）
 } LRUCache;
 
 /* ============================================================================
@@ -63,6 +115,8 @@ typedef struct LRUCache {
 /**
  * 创建 LRU Cache
  * 
+ * 容量和内存限制平均分给各分片（容量较小时只用一个分片，淘汰顺序是精确的 LRU）
+ * 
  * @param capacity 容量（条目数）
  * @param memory_limit 内存限制（字节，0 表示无限制）
  * @return Cache 对象，失败返回 NULL
@@ -80,12 +134,16 @@ void misaki_cache_free(LRUCache *cache, void (*value_free)(void*));
 /**
  * 插入/更新缓存
  * 
+ * 复制的值由缓存 free；直接存储的指针在淘汰、过期时交给
+ * misaki_cache_set_value_free 设置的函数，在删除、清空时交给调用者传入的 value_free
+ * （传入 NULL 时同样使用设置的函数）
+ * 
  * @param cache Cache 对象
  * @param key 键（会被复制）
  * @param value 值（会被复制或存储指针，取决于 copy）
  * @param value_size 值大小（字节）
  * @param copy 是否复制值（false 表示直接存储指针）
- * @return 成功返回 true
+ * @return 成功返回 true（值比单个分片的内存限制还大时返回 false）
  */
 bool misaki_cache_put(LRUCache *cache,
                       const char *key,
@@ -96,12 +154,49 @@ bool misaki_cache_put(LRUCache *cache,
 /**
  * 查询缓存
  * 
+ * 返回的是缓存内部的指针：其他线程可能随时把它淘汰，
+ * 多线程使用时请用 misaki_cache_get_copy
+ * 
  * @param cache Cache 对象
  * @param key 键
  * @return 值指针，未找到返回 NULL
  */
 void* misaki_cache_get(LRUCache *cache, const char *key);
 
+/**
+ * 查询缓存（返回值的副本，线程安全）
+ * 
+ * @param cache Cache 对象
+ * @param key 键
+ * @param value_size 输出：值大小（可为 NULL）
+ * @return 值的副本（调用者 free），未找到返回 NULL
+ */
+void* misaki_cache_get_copy(LRUCache *cache, const char *key, size_t *value_size);
+
+/**
+ * 计算回调：返回新分配的值（malloc），失败返回 NULL
+ */
+typedef void* (*CacheComputeFn)(void *ctx, size_t *value_size);
+
+/**
+ * 查询缓存，未命中时计算并插入（single-flight）
+ * 
+ * 多个线程同时查询同一个未命中的键时，只有一个线程调用 compute，
+ * 其余线程等待并得到同一结果的副本；计算失败不缓存
+ * 
+ * @param cache Cache 对象
+ * @param key 键
+ * @param compute 计算回调（不持有任何分片锁时调用）
+ * @param ctx 回调数据
+ * @param value_size 输出：值大小（可为 NULL）
+ * @return 值的副本（调用者 free），计算失败返回 NULL
+ */
+void* misaki_cache_get_or_compute(LRUCache *cache,
+                                  const char *key,
+                                  CacheComputeFn compute,
+                                  void *ctx,
+                                  size_t *value_size);
+
 /**
  * 删除缓存条目
  * 
@@ -143,7 +238,7 @@ typedef struct TokenizerCache {
 } TokenizerCache;
 
 /**
- * 创建分词结果缓存
+ * 创建分词结果缓存（键为文本）
  * 
  * @param capacity 容量
  * @return Cache 对象
@@ -180,10 +275,11 @@ MisakiTokenList* misaki_tokenizer_cache_get(TokenizerCache *cache,
                                              const char *text);
 
 /**
- * G2P 结果缓存
+ * G2P 结果缓存（键为文本、语言、G2P 选项三者的组合）
  */
 typedef struct G2PCache {
     LRUCache *cache;
+    MisakiStore *store;        // 持久化存储（可为 NULL；不归缓存所有）
 } G2PCache;
 
 /**
@@ -201,16 +297,31 @@ G2PCache* misaki_g2p_cache_create(int capacity);
  */
 void misaki_g2p_cache_free(G2PCache *cache);
 
+/**
+ * 设置后备的持久化存储
+ * 
+ * 内存中未命中时先查存储，计算出的新结果同时追加到存储；
+ * 应在开始使用缓存前调用，存储须比缓存活得久
+ * 
+ * @param cache Cache 对象
+ * @param store 存储（NULL 表示不用）
+ */
+void misaki_g2p_cache_set_store(G2PCache *cache, MisakiStore *store);
+
 /**
  * 插入 G2P 结果
  * 
  * @param cache Cache 对象
  * @param text 文本
+ * @param lang 语言代码（如 "ja"；自动检测时用 "auto"）
+ * @param options G2P 选项（NULL 表示默认选项）
  * @param phonemes 音素字符串（会被复制）
  * @return 成功返回 true
  */
 bool misaki_g2p_cache_put(G2PCache *cache,
                           const char *text,
+                          const char *lang,
+                          const G2POptions *options,
                           const char *phonemes);
 
 /**
@@ -218,9 +329,37 @@ bool misaki_g2p_cache_put(G2PCache *cache,
  * 
  * @param cache Cache 对象
  * @param text 文本
+ * @param lang 语言代码
+ * @param options G2P 选项（NULL 表示默认选项）
  * @return 音素字符串（新副本），未找到返回 NULL
  */
-char* misaki_g2p_cache_get(G2PCache *cache, const char *text);
+char* misaki_g2p_cache_get(G2PCache *cache,
+                           const char *text,
+                           const char *lang,
+                           const G2POptions *options);
+
+/**
+ * G2P 计算回调：返回新分配的音素字符串，失败返回 NULL
+ */
+typedef char* (*G2PComputeFn)(void *ctx);
+
+/**
+ * 查询 G2P 结果，未命中时计算并插入（同一个键并发未命中时只计算一次）
+ * 
+ * @param cache Cache 对象
+ * @param text 文本
+ * @param lang 语言代码
+ * @param options G2P 选项（NULL 表示默认选项）
+ * @param compute 计算回调
+ * @param ctx 回调数据
+ * @return 音素字符串（新副本，调用者 free），计算失败返回 NULL
+ */
+char* misaki_g2p_cache_get_or_compute(G2PCache *cache,
+                                      const char *text,
+                                      const char *lang,
+                                      const G2POptions *options,
+                                      G2PComputeFn compute,
+                                      void *ctx);
 
 /* ============================================================================
  * 缓存统计
@@ -270,16 +409,7 @@ void misaki_cache_reset_stats(LRUCache *cache);
  * ========================================================================== */
 
 /**
- * 缓存淘汰策略
- */
-typedef enum {
-    CACHE_EVICT_LRU,           // 最近最少使用
-    CACHE_EVICT_LFU,           // 最不经常使用
-    CACHE_EVICT_FIFO,          // 先进先出
-} CacheEvictPolicy;
-
-/**
- * 设置淘汰策略
+ * 设置淘汰策略（应在开始使用缓存前设置）
  * 
  * @param cache Cache 对象
  * @param policy 淘汰策略
@@ -287,7 +417,7 @@ typedef enum {
 void misaki_cache_set_evict_policy(LRUCache *cache, CacheEvictPolicy policy);
 
 /**
- * 设置过期时间
+ * 设置过期时间（应在开始使用缓存前设置）
  * 
  * @param cache Cache 对象
  * @param ttl_seconds 过期时间（秒，0 表示永不过期）
@@ -303,6 +433,14 @@ void misaki_cache_set_ttl(LRUCache *cache, int ttl_seconds);
  */
 int misaki_cache_expire(LRUCache *cache, void (*value_free)(void*));
 
+/**
+ * 设置释放非复制值的函数（默认不释放；应在开始使用缓存前设置）
+ * 
+ * @param cache Cache 对象
+ * @param value_free 值释放函数（可为 NULL）
+ */
+void misaki_cache_set_value_free(LRUCache *cache, void (*value_free)(void*));
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,78 @@
+/**
+ * misaki_char_class.h
+ * 
+ * Misaki C Port - Character Class Table
+ * 字符类别表（MeCab char.def 风格），用于未登录词处理
+ * 
+ * 每个码点属于一个类别；每个类别有三个参数：
+ *   invoke - 即使词典有匹配也生成未登录词节点
+ *   group  - 把同类别的连续字符合并成一个节点
+ *   length - 额外生成 1..length 个字符的节点
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_CHAR_CLASS_H
+#define MISAKI_CHAR_CLASS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * 字符类别
+ * ========================================================================== */
+
+typedef enum {
+    MISAKI_CHAR_DEFAULT = 0,   // 其他
+    MISAKI_CHAR_SPACE,         // 空白
+    MISAKI_CHAR_KANJI,         // 汉字
+    MISAKI_CHAR_SYMBOL,        // 符号、标点
+    MISAKI_CHAR_NUMERIC,       // 数字
+    MISAKI_CHAR_ALPHA,         // 拉丁字母
+    MISAKI_CHAR_HIRAGANA,      // 平假名
+    MISAKI_CHAR_KATAKANA,      // 片假名（含长音符）
+    MISAKI_CHAR_KANJINUMERIC,  // 汉字数字（一二三…百千万）
+    MISAKI_CHAR_GREEK,         // 希腊字母
+    MISAKI_CHAR_CYRILLIC,      // 西里尔字母
+    MISAKI_CHAR_CLASS_COUNT
+} MisakiCharClass;
+
+/**
+ * 类别的未登录词参数
+ */
+typedef struct {
+    const char *name;          // 类别名（同 char.def）
+    bool invoke;               // 词典有匹配时也生成未登录词节点
+    bool group;                // 合并同类别连续字符
+    int length;                // 额外生成 1..length 个字符的节点（0 表示不生成）
+} MisakiCharCategory;
+
+/* ============================================================================
+ * 查询
+ * ========================================================================== */
+
+/**
+ * 获取码点的字符类别
+ * 
+ * @param codepoint Unicode 码点
+ * @return 字符类别
+ */
+MisakiCharClass misaki_char_class(uint32_t codepoint);
+
+/**
+ * 获取类别的未登录词参数
+ * 
+ * @param char_class 字符类别
+ * @return 类别参数（无效类别返回 DEFAULT 的参数）
+ */
+const MisakiCharCategory* misaki_char_category(MisakiCharClass char_class);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_CHAR_CLASS_H */
@@ -14,6 +14,7 @@
 #include "misaki_string.h"
 #include "misaki_dict.h"
 #include "misaki_tokenizer.h"
+#include "misaki_memo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -89,6 +90,14 @@ MisakiTokenList* misaki_en_g2p(const EnDict *dict,
  */
 char* misaki_en_g2p_oov(const char *word);
 
+/**
+ * 英文单词记忆表统计（记忆表属于词典，随词典释放）
+ * 
+ * @param dict 英文词典
+ * @param stats 输出：统计信息
+ */
+void misaki_en_memo_stats(const EnDict *dict, MisakiMemoStats *stats);
+
 /* ============================================================================
  * 中文 G2P (Pinyin → IPA)
  * ========================================================================== */
@@ -139,6 +148,14 @@ void misaki_zh_tone_sandhi(MisakiTokenList *tokens,
  */
 void misaki_zh_erhua(MisakiTokenList *tokens);
 
+/**
+ * 中文拼音→IPA 记忆表统计（记忆表属于词典，随词典释放）
+ * 
+ * @param dict 中文词典
+ * @param stats 输出：统计信息
+ */
+void misaki_zh_memo_stats(const ZhDict *dict, MisakiMemoStats *stats);
+
 /* ============================================================================
  * 日文 G2P (Kana → IPA)
  * ========================================================================== */
@@ -153,6 +170,13 @@ void misaki_zh_erhua(MisakiTokenList *tokens);
  */
 char* misaki_ja_kana_to_ipa(const char *kana);
 
+/**
+ * 日文读音→IPA 记忆表统计（进程内共享）
+ * 
+ * @param stats 输出：统计信息
+ */
+void misaki_ja_memo_stats(MisakiMemoStats *stats);
+
 /**
  * 日文 G2P 转换（完整流程：分词 + G2P）
  * 
@@ -176,6 +200,18 @@ MisakiTokenList* misaki_ja_g2p(const Trie *dict_trie,
  */
 void misaki_ja_long_vowel(MisakiTokenList *tokens);
 
+/**
+ * 为词典中所有带读音的词预先计算 IPA（含长音处理）
+ * 
+ * 结果去重后存放在 Trie 的字符串池中，分词时随匹配带到 Token，
+ * 已登录词的 G2P 只需取指针；未登录的假名仍在运行时转换。
+ * 在加载词典之后、分词之前调用一次（重复调用只处理新词）
+ * 
+ * @param trie 日文词典 Trie 树
+ * @return 预计算的词数，失败返回 -1
+ */
+int misaki_ja_precompute_ipa(Trie *trie);
+
 /* ============================================================================
  * 韩文 G2P (Hangul → IPA)
  * ========================================================================== */
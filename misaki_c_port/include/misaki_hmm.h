@@ -38,6 +38,27 @@ typedef enum {
  * HMM 模型数据结构
  * ========================================================================== */
 
+/**
+ * 发射概率行：一个字符在 B/M/E/S 四个状态下的 log 概率
+ * 
+ * 四个 float 共 16 字节，一次读取即可拿到全部状态的发射概率，
+ * 且同一行不会跨越缓存行
+ */
+typedef struct {
+    float prob[HMM_STATE_COUNT];
+} HmmEmitRow;
+
+// 发射概率表分页参数（按码点高位分页，每页 256 个字符）
+#define HMM_EMIT_PAGE_BITS 8
+#define HMM_EMIT_PAGE_SIZE (1 << HMM_EMIT_PAGE_BITS)
+#define HMM_EMIT_PAGE_COUNT (0x110000 >> HMM_EMIT_PAGE_BITS)
+
+// 发射概率下界（float 无法表示 -3.14e100，使用同量级意义的下界）
+#define HMM_EMIT_MIN_PROB (-3.14e30f)
+
+// misaki_hmm_viterbi 最多解码的字符数（更长的文本用 misaki_hmm_viterbi_spans）
+#define HMM_VITERBI_MAX_CHARS 256
+
 /**
  * HMM 模型
  * 
@@ -46,7 +67,7 @@ typedef enum {
  * 2. 转移概率 (prob_trans): 从一个状态转移到另一个状态的概率
  * 3. 发射概率 (prob_emit): 某个状态产生某个字符的概率
  */
-typedef struct {
+typedef struct HmmModel {
     // 初始概率: P(state) at start
     double prob_start[HMM_STATE_COUNT];
     
@@ -54,9 +75,17 @@ typedef struct {
     // 4x4 矩阵
     double prob_trans[HMM_STATE_COUNT][HMM_STATE_COUNT];
     
-    // 发射概率: 使用哈希表存储 (字符 -> 概率)
-    // 每个状态对应一个 Trie 树，存储字符的发射概率
-    Trie *prob_emit[HMM_STATE_COUNT];
+    // 发射概率: 码点索引的两级表
+    // emit_pages[cp >> 8][cp & 0xFF] 即该字符的四状态发射概率
+    // 没有任何字符的页统一指向 emit_default（全部为 HMM_EMIT_MIN_PROB）
+    HmmEmitRow *emit_pages[HMM_EMIT_PAGE_COUNT];
+    HmmEmitRow *emit_default;
+    int emit_page_count;  // 实际分配的页数
+    
+    // float 版本的初始/转移概率（加载时预计算，供向量化 Viterbi 使用）
+    // prev_trans[k].prob[s] = P(s | 第 k 个合法前驱)，前驱顺序见 misaki_hmm.c
+    HmmEmitRow start_f;
+    HmmEmitRow prev_trans[2];
     
     // 统计信息
     int total_chars;  // 发射概率中的总字符数
@@ -120,15 +149,99 @@ MisakiTokenList* misaki_hmm_cut(const HmmModel *model, const char *text);
 /**
  * HMM Viterbi 解码（内部实现）
  * 
+ * 只解码前 HMM_VITERBI_MAX_CHARS 个字符；没有长度限制的解码用
+ * misaki_hmm_viterbi_spans
+ * 
  * @param model HMM 模型
  * @param text UTF-8 文本
- * @param states 输出：最优状态序列（需要预分配，长度至少为字符数）
- * @return 字符数量
+ * @param states 输出：最优状态序列（需要预分配，长度至少为
+ *               min(字符数, HMM_VITERBI_MAX_CHARS)）
+ * @return 解码的字符数量
  */
 int misaki_hmm_viterbi(const HmmModel *model, 
                        const char *text,
                        HmmState *states);
 
+/* ============================================================================
+ * 无长度限制的批量 Viterbi 解码
+ * ========================================================================== */
+
+/**
+ * 待解码片段（文本中的字节区间）
+ */
+typedef struct {
+    int start;   // 起始位置（字节偏移）
+    int length;  // 长度（字节数）
+} HmmSpan;
+
+/**
+ * 解码工作区
+ * 
+ * 保存 Viterbi 的回溯信息和解码结果，可在多次调用之间复用，
+ * 缓冲区按需增长，不限制文本长度
+ */
+typedef struct HmmWorkspace {
+    uint8_t *choice;      // 每个字符的前驱选择位（bit s 表示状态 s 取第二个前驱）
+    HmmState *states;     // 解码结果（所有片段按顺序拼接）
+    int *span_chars;      // 每个片段的字符数
+    int capacity;         // choice/states 容量（字符数）
+    int span_capacity;    // span_chars 容量
+    int count;            // 最近一次解码的字符总数
+} HmmWorkspace;
+
+/**
+ * 创建解码工作区
+ * 
+ * @return 工作区对象，失败返回 NULL
+ */
+HmmWorkspace* misaki_hmm_workspace_create(void);
+
+/**
+ * 释放解码工作区
+ * 
+ * @param ws 工作区对象
+ */
+void misaki_hmm_workspace_free(HmmWorkspace *ws);
+
+/**
+ * 批量 Viterbi 解码（float 运算，四状态 max-plus 向量化）
+ * 
+ * 每个片段独立解码（各自满足起止状态约束），结果按片段顺序
+ * 拼接写入 ws->states，每个片段的字符数写入 ws->span_chars
+ * 
+ * @param model HMM 模型
+ * @param text UTF-8 文本
+ * @param spans 片段数组
+ * @param span_count 片段数量
+ * @param ws 工作区
+ * @return 解码的字符总数，失败返回 -1
+ */
+int misaki_hmm_viterbi_spans(const HmmModel *model,
+                             const char *text,
+                             const HmmSpan *spans,
+                             int span_count,
+                             HmmWorkspace *ws);
+
+/**
+ * 批量 HMM 切分：解码所有片段并把切分结果追加到 Token 列表
+ * 
+ * Token 的 start 为相对 text 的字节偏移
+ * 
+ * @param model HMM 模型
+ * @param text UTF-8 文本
+ * @param spans 片段数组
+ * @param span_count 片段数量
+ * @param ws 工作区
+ * @param out 输出 Token 列表（追加）
+ * @return 追加的 Token 数量，失败返回 -1
+ */
+int misaki_hmm_cut_spans(const HmmModel *model,
+                         const char *text,
+                         const HmmSpan *spans,
+                         int span_count,
+                         HmmWorkspace *ws,
+                         MisakiTokenList *out);
+
 /* ============================================================================
  * 辅助函数
  * ========================================================================== */
@@ -145,6 +258,22 @@ MisakiTokenList* misaki_hmm_states_to_tokens(const char *text,
                                              const HmmState *states,
                                              int state_count);
 
+/**
+ * 获取字符的发射概率行（四个状态）
+ * 
+ * @param model HMM 模型
+ * @param codepoint 字符 Unicode 码点
+ * @return 发射概率行（不在表中的字符返回全部为下界的默认行）
+ */
+static inline const HmmEmitRow* misaki_hmm_emit_row(const HmmModel *model,
+                                                    uint32_t codepoint) {
+    if (codepoint >= 0x110000) {
+        return model->emit_default;
+    }
+    return &model->emit_pages[codepoint >> HMM_EMIT_PAGE_BITS]
+                             [codepoint & (HMM_EMIT_PAGE_SIZE - 1)];
+}
+
 /**
  * 获取发射概率
  * 
@@ -9,14 +9,16 @@
 #ifndef MISAKI_KANA_MAP_H
 #define MISAKI_KANA_MAP_H
 
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * 查找假名的 IPA 映射
+ * 查找假名的 IPA 映射（拗音时匹配两个字符）
  * 
- * @param kana 假名字符串（UTF-8）
+ * @param kana 假名字符串（UTF-8，平假名或片假名）
  * @param out_ipa 输出：IPA 音素（如果找到）
  * @return 匹配的字节数，0表示未找到
  */
@@ -42,6 +44,21 @@ int misaki_kana_special(const char *kana, const char *next_kana, const char **ou
  */
 int misaki_kana_string_to_ipa(const char *kana_str, char *out_buffer, int buffer_size);
 
+/**
+ * 将整个假名字符串转换为 IPA（可选同时做长音处理）
+ * 
+ * 单遍扫描：拗音、促音、拨音同化都只向前看一个字符；
+ * long_vowel 为 true 时在同一遍里应用 ei → eː（同 misaki_ja_long_vowel）
+ * 
+ * @param kana_str 假名字符串（UTF-8）
+ * @param out_buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param long_vowel 是否做长音处理
+ * @return IPA 音素长度，-1表示错误
+ */
+int misaki_kana_string_to_ipa_ex(const char *kana_str, char *out_buffer, int buffer_size,
+                                 bool long_vowel);
+
 #ifdef __cplusplus
 }
 #endif
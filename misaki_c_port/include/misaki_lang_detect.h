@@ -182,6 +182,41 @@ bool misaki_is_pure_latin(const char *text);
  */
 bool misaki_has_japanese_features(const char *text);
 
+/* ============================================================================
+ * 文字段切分（混合语言文本）
+ * ========================================================================== */
+
+/**
+ * 一个文字段：输入文本中连续的、同一种文字的部分
+ */
+typedef struct {
+    size_t offset;          // 在输入文本中的字节偏移
+    size_t length;          // 字节数
+    MisakiLanguage lang;    // 对应的语言（LANG_UNKNOWN：没有对应后端的文字）
+    bool neutral;           // 只有数字、标点的段（拉丁字母段旁边的全角标点）
+} MisakiScriptRun;
+
+/**
+ * 按文字把混合语言文本切成文字段（只按码点类别判断，一遍扫描）
+ * 
+ * 拉丁字母 → 英文；假名、汉字连在一起 → 日文或中文；韩文 → 韩语；
+ * 其他字母文字 → LANG_UNKNOWN。数字、标点、空白不决定文字，归到相邻的段：
+ * 默认归前一段，拉丁字母段和其后的汉字/假名段之间的归后一段；
+ * 文字段首尾的空白不算在段里。拉丁字母段首尾的全角标点（「」、。等）没有
+ * 归到汉字/假名段时单独成段（neutral），语言取最近的汉字/假名段的语言，
+ * 没有汉字/假名段时为 LANG_UNKNOWN。有文字段时，除了空白每个字符都在某一段里
+ * 
+ * 汉字/假名段的语言：cjk_lang 为 LANG_UNKNOWN 时，整个文本里有假名为日文、
+ * 否则为中文（如 "我用iPhone打电话" → 中文 "我用"、英文 "iPhone"、中文 "打电话"）；
+ * 否则都为 cjk_lang
+ * 
+ * @param text UTF-8 文本
+ * @param cjk_lang 汉字/假名段的语言（LANG_UNKNOWN 表示按有无假名判断）
+ * @param runs 输出：文字段数组（调用者 free；没有文字段时为 NULL）
+ * @return 文字段数（只有数字、标点、空白时为 0）, -1=失败
+ */
+int misaki_segment_scripts(const char *text, MisakiLanguage cjk_lang, MisakiScriptRun **runs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,126 @@
+/**
+ * misaki_memo.h
+ * 
+ * Misaki C Port - Token Memo Table
+ * 词级音素记忆表（有界、无锁，CLOCK 淘汰）
+ * 
+ * 键为「词面 + 上下文标志」，值为音素字符串，都直接存放在定长槽里：
+ * 读取不加锁（seqlock：读到正在写的槽就当作未命中），
+ * 写入只在抢到槽时进行，抢不到就放弃（不会阻塞其他线程）
+ * 
+ * 键、值太长（合计超过一个槽）的不记忆，每次照常计算
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_MEMO_H
+#define MISAKI_MEMO_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * 数据结构
+ * ========================================================================== */
+
+// 每个槽存放数据的 64 位字数（标志 + 键 + '\0' + 值 + '\0'，共 112 字节）
+#define MISAKI_MEMO_SLOT_WORDS 14
+
+// 组相联：同一个键只会放在连续的这么多个槽之一
+#define MISAKI_MEMO_WAYS 8
+
+// 值的最大长度（含 '\0'），调用者的输出缓冲区不小于它即可
+#define MISAKI_MEMO_VALUE_MAX (MISAKI_MEMO_SLOT_WORDS * 8 - 4)
+
+/**
+ * 记忆槽（128 字节）
+ */
+typedef struct {
+    _Atomic uint32_t seq;                                // 版本号（奇数表示正在写入）
+    _Atomic uint32_t referenced;                         // CLOCK 访问位
+    _Atomic uint64_t tag;                                // 键的哈希（0 表示空槽）
+    _Atomic uint64_t words[MISAKI_MEMO_SLOT_WORDS];      // 标志、键、值
+} MisakiMemoSlot;
+
+/**
+ * 记忆表
+ */
+typedef struct MisakiMemo {
+    MisakiMemoSlot *slots;          // 槽数组
+    uint32_t mask;                  // 槽数 - 1（槽数为 2 的幂）
+    _Atomic uint32_t hand;          // CLOCK 指针（选择淘汰起点）
+    _Atomic uint64_t hit_count;     // 命中次数
+    _Atomic uint64_t miss_count;    // 未命中次数
+} MisakiMemo;
+
+/**
+ * 记忆表统计
+ */
+typedef struct {
+    uint64_t hit_count;             // 命中次数
+    uint64_t miss_count;            // 未命中次数
+    int capacity;                   // 槽数
+} MisakiMemoStats;
+
+/* ============================================================================
+ * 记忆表操作
+ * ========================================================================== */
+
+/**
+ * 创建记忆表
+ * 
+ * @param capacity 槽数（向上取 2 的幂，至少 MISAKI_MEMO_WAYS）
+ * @return 记忆表，失败返回 NULL
+ */
+MisakiMemo* misaki_memo_create(int capacity);
+
+/**
+ * 释放记忆表（调用前须确保没有线程还在使用）
+ * 
+ * @param memo 记忆表
+ */
+void misaki_memo_free(MisakiMemo *memo);
+
+/**
+ * 查询
+ * 
+ * @param memo 记忆表（NULL 时总是未命中，不计数）
+ * @param key 词面
+ * @param flags 上下文标志（同一词面在不同上下文下结果不同时区分）
+ * @param value 输出缓冲区
+ * @param value_size 缓冲区大小
+ * @return 命中返回 true（值已写入 value）
+ */
+bool misaki_memo_get(MisakiMemo *memo, const char *key, uint32_t flags,
+                     char *value, size_t value_size);
+
+/**
+ * 记忆（槽被其他线程占用或键、值过长时放弃）
+ * 
+ * @param memo 记忆表
+ * @param key 词面
+ * @param flags 上下文标志
+ * @param value 音素字符串
+ * @return 写入返回 true
+ */
+bool misaki_memo_put(MisakiMemo *memo, const char *key, uint32_t flags, const char *value);
+
+/**
+ * 获取统计信息
+ * 
+ * @param memo 记忆表（NULL 时全为 0）
+ * @param stats 输出：统计信息
+ */
+void misaki_memo_stats(const MisakiMemo *memo, MisakiMemoStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_MEMO_H */
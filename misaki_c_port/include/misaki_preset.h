@@ -0,0 +1,115 @@
+/**
+ * misaki_preset.h
+ * 
+ * Misaki C Port - Preset Phrase Table
+ * 预编译的 文本→音素 表（完美哈希，常数时间查询）
+ * 
+ * 界面提示、预设台词等固定的文本事先用 tools/misaki_preset_compile 转换好，
+ * 编译成一块只读数据（可以写成文件，也可以生成 C 数组直接编进程序）；
+ * 引擎转换前先查这张表，命中时不经过语言检测、分词和 G2P
+ * 
+ * 完美哈希用「哈希 + 位移」：键先按种子 0 的哈希分桶，
+ * 每个桶找一个种子，使桶内的键都落到空槽里；
+ * 查询只需算两次哈希、比较一次键
+ * 
+ * 数据格式（整数为本机字节序）：
+ *   文件头 32 字节：魔数 "MSKPRSET"、版本、条目数、桶数、槽数、字符串池大小
+ *   种子：桶数 × u32
+ *   槽：槽数 × [语言 u32][键偏移 u32][键长 u32][值偏移 u32]（键长为 0 表示空槽）
+ *   字符串池：键、值（都以 '\0' 结尾）
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_PRESET_H
+#define MISAKI_PRESET_H
+
+#include "misaki_types.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 预设表（不透明类型，只读，多个线程可以同时查询）
+ */
+typedef struct MisakiPresetTable MisakiPresetTable;
+
+/* ============================================================================
+ * 编译
+ * ========================================================================== */
+
+/**
+ * 把 (语言, 文本, 音素) 列表编译成预设表数据
+ * 
+ * 同一语言下重复的文本只保留第一条
+ * 
+ * @param langs 语言（LANG_UNKNOWN 表示自动检测的请求）
+ * @param texts 文本（不能为空串）
+ * @param phonemes 音素
+ * @param count 条目数
+ * @param out_data 输出：数据（调用者 free）
+ * @param out_size 输出：数据大小
+ * @return 0=成功, -1=失败
+ */
+int misaki_preset_table_build(const MisakiLanguage *langs,
+                              const char *const *texts,
+                              const char *const *phonemes,
+                              int count,
+                              unsigned char **out_data,
+                              size_t *out_size);
+
+/* ============================================================================
+ * 加载与查询
+ * ========================================================================== */
+
+/**
+ * 从文件加载预设表
+ * 
+ * @param path 文件路径
+ * @return 预设表，失败返回 NULL（文件不存在或格式错误）
+ */
+MisakiPresetTable* misaki_preset_table_load(const char *path);
+
+/**
+ * 使用内存中的预设表数据（如编进程序的数组；不复制，数据须比预设表活得久）
+ * 
+ * @param data 数据
+ * @param size 数据大小
+ * @return 预设表，失败返回 NULL（格式错误）
+ */
+MisakiPresetTable* misaki_preset_table_from_memory(const void *data, size_t size);
+
+/**
+ * 释放预设表
+ * 
+ * @param table 预设表
+ */
+void misaki_preset_table_free(MisakiPresetTable *table);
+
+/**
+ * 查询
+ * 
+ * @param table 预设表
+ * @param lang 请求的语言（LANG_UNKNOWN 表示自动检测）
+ * @param text 文本
+ * @return 音素（指向表内数据，不要释放），未收录返回 NULL
+ */
+const char* misaki_preset_table_lookup(const MisakiPresetTable *table,
+                                       MisakiLanguage lang,
+                                       const char *text);
+
+/**
+ * 条目数
+ * 
+ * @param table 预设表
+ * @return 条目数（NULL 时为 0）
+ */
+int misaki_preset_table_count(const MisakiPresetTable *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_PRESET_H */
@@ -0,0 +1,119 @@
+/**
+ * misaki_store.h
+ * 
+ * Misaki C Port - Persistent Result Store
+ * 持久化的 键→音素 存储（追加写日志 + 内存哈希索引，mmap 读取）
+ * 
+ * 文件格式：64 字节文件头，之后是依次追加的记录
+ *   [键长 u32][值长 u32][CRC32 u32][保留 u32][键][值]，按 8 字节对齐
+ * 同一个键出现多次时以最后一条为准，旧记录在压缩时丢弃
+ * 
+ * 多进程：
+ *   - 同一台机器上的多个进程可以同时打开同一个文件
+ *   - 追加、修复、压缩时持有文件的排他锁（flock），追读新记录时持有共享锁
+ *   - 每条记录带 CRC：写到一半崩溃留下的残缺记录读取时被忽略，下次追加前截掉
+ *   - 压缩写入新文件后 rename 替换，其他进程发现文件被替换后重新打开
+ * 
+ * 不保证掉电时最近的记录不丢（需要时调用 misaki_store_sync），
+ * 但不会读到残缺的值；词典更新后应换用新的文件
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_STORE_H
+#define MISAKI_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 存储（不透明类型，内部加锁，多个线程可以共用）
+ */
+typedef struct MisakiStore MisakiStore;
+
+/**
+ * 存储统计
+ */
+typedef struct {
+    int count;                  // 键数
+    size_t file_size;           // 已索引的日志长度（字节）
+    size_t live_bytes;          // 有效记录的字节数
+    size_t dead_bytes;          // 被覆盖的旧记录的字节数（压缩可回收）
+    uint64_t hit_count;         // 命中次数
+    uint64_t miss_count;        // 未命中次数
+    uint64_t append_count;      // 本进程追加的记录数
+} MisakiStoreStats;
+
+/* ============================================================================
+ * 存储操作
+ * ========================================================================== */
+
+/**
+ * 打开存储（扫描已有记录建立索引）
+ * 
+ * @param path 文件路径
+ * @param read_only 只读（文件不存在时失败）；否则不存在时创建
+ * @return 存储，失败返回 NULL（文件不是存储格式、无法创建，或平台不支持）
+ */
+MisakiStore* misaki_store_open(const char *path, bool read_only);
+
+/**
+ * 关闭存储
+ * 
+ * @param store 存储
+ */
+void misaki_store_close(MisakiStore *store);
+
+/**
+ * 查询（索引中没有时先追读其他进程新追加的记录）
+ * 
+ * @param store 存储
+ * @param key 键
+ * @return 值（新副本，调用者 free），未找到返回 NULL
+ */
+char* misaki_store_get(MisakiStore *store, const char *key);
+
+/**
+ * 追加（值与已有记录相同时不重复写入）
+ * 
+ * @param store 存储
+ * @param key 键
+ * @param value 值
+ * @return 成功返回 true（只读存储返回 false）
+ */
+bool misaki_store_put(MisakiStore *store, const char *key, const char *value);
+
+/**
+ * 压缩：只保留每个键的最后一条记录，写入新文件后替换
+ * 
+ * @param store 存储
+ * @return 0=成功, -1=失败（原文件不变）
+ */
+int misaki_store_compact(MisakiStore *store);
+
+/**
+ * 把已追加的记录刷到磁盘（fsync）
+ * 
+ * @param store 存储
+ * @return 0=成功, -1=失败
+ */
+int misaki_store_sync(MisakiStore *store);
+
+/**
+ * 获取统计信息
+ * 
+ * @param store 存储（NULL 时全为 0）
+ * @param stats 输出：统计信息
+ */
+void misaki_store_get_stats(MisakiStore *store, MisakiStoreStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_STORE_H */
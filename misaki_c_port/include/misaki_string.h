@@ -328,6 +328,29 @@ bool misaki_isdigit(char c);
  */
 bool misaki_isalpha(char c);
 
+/**
+ * 第一个句子的字节长度（用于按句切分文本）
+ * 
+ * 句子在 。！？!?；;… 或换行处结束，连续的句末标点、其后的右引号/右括号
+ * 和空白都算在这个句子里；"." 只有后面是空白、结尾或右引号时才算句末
+ * （不切开 3.14、example.com 之类）
+ * 
+ * @param text UTF-8 字符串
+ * @return 字节数（没有句末标点时为整个字符串的长度；text 为 NULL 时为 0）
+ */
+size_t misaki_sentence_length(const char *text);
+
+/**
+ * 第一个分句的字节长度（句子太长时在分句处切开）
+ * 
+ * 分句在 、，：, : 处结束，其后的空白算在这个分句里；
+ * "," ":" 只有后面是空白时才算（不切开 1,000、12:30 之类）
+ * 
+ * @param text UTF-8 字符串（通常是一个句子）
+ * @return 字节数（没有分句标点时为整个字符串的长度；text 为 NULL 时为 0）
+ */
+size_t misaki_clause_length(const char *text);
+
 #ifdef __cplusplus
 }
 #endif
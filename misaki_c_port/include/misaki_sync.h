@@ -0,0 +1,130 @@
+/**
+ * misaki_sync.h
+ *
+ * Misaki C Port - Synchronization Helpers
+ * 线程同步工具（C11 原子操作）
+ *
+ * 自旋锁只用于很短的临界区（驻留新字符串、合并计数、替换只读表）：
+ * 查询路径上不加锁，只做原子读；需要等待其他线程时用互斥锁和条件变量
+ *
+ * License: MIT
+ */
+
+#ifndef MISAKI_SYNC_H
+#define MISAKI_SYNC_H
+
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * 自旋锁
+ * ========================================================================== */
+
+typedef atomic_flag MisakiSpinLock;
+
+#define MISAKI_SPIN_LOCK_INIT ATOMIC_FLAG_INIT
+
+static inline void misaki_spin_lock(MisakiSpinLock *lock) {
+    while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+        // 临界区很短，忙等即可
+    }
+}
+
+static inline void misaki_spin_unlock(MisakiSpinLock *lock) {
+    atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+/* ============================================================================
+ * 互斥锁、条件变量
+ * ========================================================================== */
+
+#ifdef _WIN32
+
+typedef SRWLOCK MisakiMutex;
+typedef CONDITION_VARIABLE MisakiCond;
+
+static inline void misaki_mutex_init(MisakiMutex *mutex) {
+    InitializeSRWLock(mutex);
+}
+
+static inline void misaki_mutex_destroy(MisakiMutex *mutex) {
+    (void)mutex;
+}
+
+static inline void misaki_mutex_lock(MisakiMutex *mutex) {
+    AcquireSRWLockExclusive(mutex);
+}
+
+static inline void misaki_mutex_unlock(MisakiMutex *mutex) {
+    ReleaseSRWLockExclusive(mutex);
+}
+
+static inline void misaki_cond_init(MisakiCond *cond) {
+    InitializeConditionVariable(cond);
+}
+
+static inline void misaki_cond_destroy(MisakiCond *cond) {
+    (void)cond;
+}
+
+static inline void misaki_cond_wait(MisakiCond *cond, MisakiMutex *mutex) {
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+static inline void misaki_cond_broadcast(MisakiCond *cond) {
+    WakeAllConditionVariable(cond);
+}
+
+#else
+
+typedef pthread_mutex_t MisakiMutex;
+typedef pthread_cond_t MisakiCond;
+
+static inline void misaki_mutex_init(MisakiMutex *mutex) {
+    pthread_mutex_init(mutex, NULL);
+}
+
+static inline void misaki_mutex_destroy(MisakiMutex *mutex) {
+    pthread_mutex_destroy(mutex);
+}
+
+static inline void misaki_mutex_lock(MisakiMutex *mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+static inline void misaki_mutex_unlock(MisakiMutex *mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+static inline void misaki_cond_init(MisakiCond *cond) {
+    pthread_cond_init(cond, NULL);
+}
+
+static inline void misaki_cond_destroy(MisakiCond *cond) {
+    pthread_cond_destroy(cond);
+}
+
+static inline void misaki_cond_wait(MisakiCond *cond, MisakiMutex *mutex) {
+    pthread_cond_wait(cond, mutex);
+}
+
+static inline void misaki_cond_broadcast(MisakiCond *cond) {
+    pthread_cond_broadcast(cond);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_SYNC_H */
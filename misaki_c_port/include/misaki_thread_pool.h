@@ -0,0 +1,131 @@
+/**
+ * misaki_thread_pool.h
+ * 
+ * Misaki C Port - Parallel Loop
+ * 并行循环（工作窃取）
+ * 
+ * 下标区间先平均分给各工作线程；线程做完自己的区间后，
+ * 从剩余最多的线程的区间尾部窃取一半，直到全部完成
+ * 
+ * 线程池的工作线程常驻，多次并行循环复用同一组线程（批量转换由引擎持有）
+ * 
+ * 另有单个后台线程的启动/等待（流式转换的预取线程等）
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_THREAD_POOL_H
+#define MISAKI_THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 并行任务回调
+ * 
+ * @param ctx 调用者数据
+ * @param worker 工作线程编号（0..num_threads-1，可用于索引每线程的工作区）
+ * @param index 任务下标
+ */
+typedef void (*MisakiParallelFn)(void *ctx, int worker, int index);
+
+/**
+ * 在线的 CPU 核数
+ * 
+ * @return 核数（至少为 1）
+ */
+int misaki_cpu_count(void);
+
+/**
+ * 实际使用的工作线程数
+ * 
+ * @param count 任务数
+ * @param num_threads 期望的线程数（<= 0 使用 CPU 核数）
+ * @return 线程数（1..count，count <= 0 时为 1）
+ */
+int misaki_parallel_threads(int count, int num_threads);
+
+/**
+ * 并行执行 fn(ctx, worker, index)，index = 0..count-1，每个下标恰好执行一次
+ * 
+ * 调用线程作为 0 号工作线程参与执行，返回时所有任务都已完成；
+ * 执行顺序不确定，需要确定的输出时由调用者按下标存放结果
+ * 
+ * @param count 任务数
+ * @param num_threads 线程数（同 misaki_parallel_threads）
+ * @param fn 回调
+ * @param ctx 调用者数据
+ * @return 0=成功, -1=失败（参数错误或无法分配；此时没有任务被执行）
+ */
+int misaki_parallel_for(int count, int num_threads, MisakiParallelFn fn, void *ctx);
+
+/**
+ * 线程池（不透明类型）
+ */
+typedef struct MisakiThreadPool MisakiThreadPool;
+
+/**
+ * 创建线程池（工作线程在第一次执行并行循环时才启动）
+ * 
+ * @param num_threads 线程数，含调用线程（<= 0 使用 CPU 核数）
+ * @return 线程池，失败返回 NULL
+ */
+MisakiThreadPool* misaki_thread_pool_create(int num_threads);
+
+/**
+ * 停止工作线程并释放线程池（不能与 misaki_thread_pool_for 同时调用）
+ * 
+ * @param pool 线程池（可为 NULL）
+ */
+void misaki_thread_pool_free(MisakiThreadPool *pool);
+
+/**
+ * 用线程池的常驻线程执行并行循环（语义同 misaki_parallel_for）
+ * 
+ * 同一时间只执行一个循环：线程池正被其他调用占用、线程数超过线程池大小
+ * 或 pool 为 NULL 时退回 misaki_parallel_for（为本次调用临时创建线程）
+ * 
+ * @param pool 线程池
+ * @param count 任务数
+ * @param num_threads 线程数（同 misaki_parallel_threads）
+ * @param fn 回调
+ * @param ctx 调用者数据
+ * @return 0=成功, -1=失败（参数错误或无法分配；此时没有任务被执行）
+ */
+int misaki_thread_pool_for(MisakiThreadPool *pool, int count, int num_threads,
+                           MisakiParallelFn fn, void *ctx);
+
+/**
+ * 后台线程入口
+ * 
+ * @param ctx 调用者数据
+ */
+typedef void (*MisakiThreadFn)(void *ctx);
+
+/**
+ * 后台线程（不透明类型）
+ */
+typedef struct MisakiThread MisakiThread;
+
+/**
+ * 启动一个后台线程执行 fn(ctx)
+ * 
+ * @param fn 入口
+ * @param ctx 调用者数据
+ * @return 线程，失败返回 NULL（须用 misaki_thread_join 等待并释放）
+ */
+MisakiThread* misaki_thread_start(MisakiThreadFn fn, void *ctx);
+
+/**
+ * 等待线程结束并释放
+ * 
+ * @param thread 线程（可为 NULL）
+ */
+void misaki_thread_join(MisakiThread *thread);
+    
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_THREAD_POOL_H */
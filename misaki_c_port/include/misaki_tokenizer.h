@@ -52,14 +52,26 @@ void misaki_token_free(MisakiToken *token);
 MisakiToken* misaki_token_clone(const MisakiToken *token);
 
 /**
- * 设置 Token 的音素
+ * 设置 Token 的音素（复制）
+ * 
+ * 短于 MISAKI_TOKEN_INLINE_PHONEMES 的串存放在 Token 内，不分配内存。
+ * 修改 phonemes 请使用本函数或 misaki_token_take_phonemes，不要直接 free
  * 
  * @param token Token 对象
- * @param phonemes 音素序列
+ * @param phonemes 音素序列（可为 NULL）
  * @return 成功返回 true
  */
 bool misaki_token_set_phonemes(MisakiToken *token, const char *phonemes);
 
+/**
+ * 设置 Token 的音素（接管所有权）
+ * 
+ * @param token Token 对象
+ * @param phonemes 堆上分配的音素序列（之后由 Token 负责释放）
+ * @return 成功返回 true
+ */
+bool misaki_token_take_phonemes(MisakiToken *token, char *phonemes);
+
 /**
  * 设置 Token 的分数
  * 
@@ -86,6 +98,38 @@ MisakiTokenList* misaki_token_list_create(void);
  */
 void misaki_token_list_free(MisakiTokenList *list);
 
+/**
+ * 创建视图模式的 Token 列表
+ * 
+ * Token 的表层文本是 source 中的视图，词性为驻留 ID，
+ * 只有音素（如果设置）会单独分配内存
+ * 
+ * @param source 被引用的输入文本（必须比列表活得久）
+ * @return Token 列表对象，失败返回 NULL
+ */
+MisakiTokenList* misaki_token_list_create_view(const char *source);
+
+/**
+ * 按表层文本视图添加 Token
+ * 
+ * 视图模式下直接保存视图和标签 ID（不分配内存）；
+ * 普通模式下复制为 text/tag（每个字段只复制一次）
+ * 
+ * @param list Token 列表对象
+ * @param surface 表层文本视图
+ * @param tag 词性标签（可为 NULL）
+ * @param start 起始位置
+ * @param length 长度
+ * @param score 分数
+ * @return 新添加的 Token，失败返回 NULL
+ */
+MisakiToken* misaki_token_list_add_view(MisakiTokenList *list,
+                                        MisakiStringView surface,
+                                        const char *tag,
+                                        int start,
+                                        int length,
+                                        double score);
+
 /**
  * 添加 Token 到列表
  * 
@@ -95,6 +139,45 @@ void misaki_token_list_free(MisakiTokenList *list);
  */
 bool misaki_token_list_add(MisakiTokenList *list, const MisakiToken *token);
 
+/**
+ * 添加 Token 到列表（接管所有权，不复制）
+ * 
+ * token 的 text/tag/phonemes/whitespace 移入列表，成功后 *token 被清零，
+ * token 本身可以在栈上
+ * 
+ * @param list Token 列表对象
+ * @param token Token 对象（成功后被清零）
+ * @return 成功返回 true（失败时 token 保持不变）
+ */
+bool misaki_token_list_push_owned(MisakiTokenList *list, MisakiToken *token);
+
+/**
+ * 把 src 的全部 Token 移动到 dst 末尾（不复制字符串）
+ * 
+ * 成功后 src 变为空列表（仍需调用者释放）
+ * 
+ * @param dst 目标列表
+ * @param src 源列表
+ * @return 成功返回 true
+ */
+bool misaki_token_list_append_list(MisakiTokenList *dst, MisakiTokenList *src);
+
+/**
+ * 原地替换：删除 [index, index + remove_count)，并在该位置移入 insert 的全部 Token
+ * 
+ * 成功后 insert 变为空列表（仍需调用者释放）
+ * 
+ * @param list Token 列表对象
+ * @param index 起始索引
+ * @param remove_count 删除数量（超出末尾时截断）
+ * @param insert 要插入的列表（可为 NULL，表示只删除）
+ * @return 成功返回 true
+ */
+bool misaki_token_list_splice(MisakiTokenList *list,
+                              int index,
+                              int remove_count,
+                              MisakiTokenList *insert);
+
 /**
  * 获取列表中的 Token
  * 
@@ -119,6 +202,52 @@ int misaki_token_list_size(const MisakiTokenList *list);
  */
 void misaki_token_list_clear(MisakiTokenList *list);
 
+/**
+ * 获取 Token 的表层文本视图（两种模式通用）
+ * 
+ * @param token Token 对象
+ * @return 表层文本视图
+ */
+MisakiStringView misaki_token_surface(const MisakiToken *token);
+
+/**
+ * 获取 Token 的词性标签（两种模式通用）
+ * 
+ * @param token Token 对象
+ * @return 词性标签，没有返回 NULL
+ */
+const char* misaki_token_tag(const MisakiToken *token);
+
+/* ============================================================================
+ * 词性标签驻留
+ * 
+ * 标签表是进程级的，只增不减。词典加载时出现的标签都已预置，
+ * 分词期间查找已有标签是只读的
+ * ========================================================================== */
+
+/**
+ * 驻留词性标签
+ * 
+ * @param tag 词性标签
+ * @return 标签 ID，tag 为 NULL/空或表已满返回 MISAKI_TAG_NONE
+ */
+MisakiTagId misaki_tag_intern(const char *tag);
+
+/**
+ * 获取标签 ID 对应的名称
+ * 
+ * @param id 标签 ID
+ * @return 标签名称，无效 ID 返回 NULL
+ */
+const char* misaki_tag_name(MisakiTagId id);
+
+/**
+ * 当前已驻留的标签数量（有效 ID 为 1 到 count - 1）
+ * 
+ * @return 标签数量（含 MISAKI_TAG_NONE）
+ */
+int misaki_tag_count(void);
+
 /* ============================================================================
  * DAG（有向无环图）操作
  * 用于 jieba 分词算法
@@ -214,6 +343,15 @@ void misaki_zh_tokenizer_free(void *tokenizer);
  */
 MisakiTokenList* misaki_zh_tokenize(void *tokenizer, const char *text);
 
+/**
+ * 中文分词（视图模式，Token 表层文本引用 text，不分配字符串）
+ * 
+ * @param tokenizer 分词器对象
+ * @param text 文本（UTF-8，必须比返回的列表活得久）
+ * @return 视图模式的 Token 列表，失败返回 NULL
+ */
+MisakiTokenList* misaki_zh_tokenize_view(void *tokenizer, const char *text);
+
 /**
  * 中文分词（全模式，返回所有可能的词）
  * 
@@ -244,8 +382,14 @@ typedef struct {
     Trie *dict_trie;           // 词典 Trie 树（必需）
     const char *unidic_path;   // UniDic 词典路径（可选）
     bool use_simple_model;     // 使用简化模型（默认 true）
+    const char *cost_matrix_path; // 连接成本矩阵文件（可选，NULL 使用内置词性规则）
+    int beam_width;            // 束宽：每个位置保留的前驱数（0 = 精确搜索）
+    float beam_threshold;      // 成本阈值：与最优的最大差距（0 = 不限）
+    int max_matches;           // 每个位置保留的词典匹配数（0 = 不限）
 } JaTokenizerConfig;
 
+typedef struct ViterbiPruneStats ViterbiPruneStats;
+
 /**
  * 创建日文分词器
  * 
@@ -270,6 +414,41 @@ void misaki_ja_tokenizer_free(void *tokenizer);
  */
 MisakiTokenList* misaki_ja_tokenize(void *tokenizer, const char *text);
 
+/**
+ * 日文分词（视图模式，Token 表层文本引用 text，不分配字符串）
+ * 
+ * @param tokenizer 分词器对象
+ * @param text 文本（UTF-8，必须比返回的列表活得久）
+ * @return 视图模式的 Token 列表，失败返回 NULL
+ */
+MisakiTokenList* misaki_ja_tokenize_view(void *tokenizer, const char *text);
+
+/**
+ * 日文分词（N-Best：总成本最低的前 n 种分词结果）
+ * 
+ * 一次前向传播后用后向 A* 取出候选，代价约为一次分词
+ * （不使用束剪枝；构建 Lattice 时的匹配数限制仍然有效）
+ * 
+ * @param tokenizer 分词器对象
+ * @param text 文本（UTF-8）
+ * @param n 最多返回的结果数
+ * @param results 输出：Token 列表数组（至少 n 个，按总成本从小到大，
+ *                每个列表由调用方用 misaki_token_list_free 释放）
+ * @return 实际结果数量
+ */
+int misaki_ja_tokenize_nbest(void *tokenizer, const char *text, int n,
+                             MisakiTokenList **results);
+
+/**
+ * 获取日文分词器的剪枝计数（自创建以来累计）
+ * 
+ * 每次调用结束时才合并到分词器，正在进行的分词不计入
+ * 
+ * @param tokenizer 分词器对象（NULL 时计数全为 0）
+ * @param stats 输出：剪枝计数的副本
+ */
+void misaki_ja_tokenizer_get_prune_stats(void *tokenizer, ViterbiPruneStats *stats);
+
 /* ============================================================================
  * 英文分词器（简单空格分割 + 标点处理）
  * ========================================================================== */
@@ -351,7 +530,7 @@ void misaki_token_list_stats(const MisakiTokenList *list,
                              int *total_tokens,
                              double *avg_token_length,
                              int *max_token_length);
-
+    
 #ifdef __cplusplus
 }
 #endif
@@ -10,6 +10,8 @@
 #ifndef MISAKI_TRANSITION_RULES_H
 #define MISAKI_TRANSITION_RULES_H
 
+#include "misaki_viterbi.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,6 +28,28 @@ extern "C" {
  */
 double misaki_get_transition_cost(const char *left_tag, const char *right_tag);
 
+/**
+ * 把转移规则预计算为成本矩阵
+ * 
+ * 对当前已驻留的全部词性标签（misaki_tag_intern）两两求
+ * misaki_get_transition_cost，结果按 MisakiTagId 下标存放，
+ * Viterbi 内循环只需查表，不再做字符串匹配
+ * 
+ * @return 成本矩阵（misaki_tag_count() × misaki_tag_count()），失败返回 NULL
+ */
+CostMatrix* misaki_transition_matrix_build(void);
+
+/**
+ * 预计算转移规则矩阵，并用已有矩阵覆盖其范围内的成本
+ * 
+ * 用于从文件加载的矩阵：文件覆盖的 ID 取文件中的值（按词性名加载的文件
+ * 只覆盖 defined 标记的词性），其他词性取内置规则
+ * 
+ * @param overrides 覆盖用的成本矩阵（可为 NULL）
+ * @return 成本矩阵（至少覆盖当前全部词性），失败返回 NULL
+ */
+CostMatrix* misaki_transition_matrix_build_with(const CostMatrix *overrides);
+
 /**
  * 检查是否为动词相关词性
  */
@@ -132,6 +132,9 @@ typedef struct {
     int length;              // 词汇长度（字节数）
     double frequency;        // 词频
     const char *tag;         // 词性标签
+    MisakiTagId tag_id;      // 驻留的词性标签 ID
+    const char *pron;        // 读音（片假名，日文词典；可为 NULL）
+    const char *ipa;         // 预先计算的 IPA（misaki_ja_precompute_ipa；可为 NULL）
 } TrieMatch;
 
 /**
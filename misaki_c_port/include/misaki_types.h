@@ -81,6 +81,7 @@ typedef struct {
     EnDictEntry *entries;  // 词典条目数组
     int count;             // 条目数量
     int capacity;          // 数组容量
+    struct MisakiMemo *memo;  // 单词→音素记忆表（可为 NULL）
 } EnDict;
 
 /**
@@ -104,6 +105,7 @@ typedef struct {
     ZhDictEntry *entries;  // 词典条目数组
     int count;             // 条目数量（约 42K 汉字）
     int capacity;          // 数组容量
+    struct MisakiMemo *memo;  // 词→音素记忆表（可为 NULL）
 } ZhDict;
 
 /**
@@ -160,29 +162,54 @@ typedef enum {
     TOKEN_UNKNOWN        // 未知类型
 } MisakiTokenType;
 
+/**
+ * 词性标签 ID（全局驻留，0 表示无标签）
+ */
+typedef uint16_t MisakiTagId;
+
+#define MISAKI_TAG_NONE 0
+
+/**
+ * Token 内联音素缓冲区大小（含 '\0'）
+ * 
+ * 短音素串直接存放在 Token 内（phonemes 指向 phonemes_inline），不单独分配
+ */
+#define MISAKI_TOKEN_INLINE_PHONEMES 32
+
 /**
  * Token: 分词后的词单元
  * 
  * 用于所有语言的分词结果
  */
 typedef struct {
-    char *text;          // 原始文本（UTF-8）
+    char *text;          // 原始文本（UTF-8，视图模式下为 NULL）
     MisakiTokenType type; // Token类型
-    char *tag;           // 词性标签（POS tag，如 "n" = 名词）
-    char *phonemes;      // 音素序列（IPA 或拼音）
+    char *tag;           // 词性标签（POS tag，如 "n" = 名词；视图模式下为 NULL）
+    char *phonemes;      // 音素序列（IPA 或拼音；短串指向 phonemes_inline）
     char *whitespace;    // 后续空白字符
     int start;           // 起始位置（字节偏移）
     int length;          // 长度（字节数）
     double score;        // 置信度分数（用于路径选择）
+    MisakiStringView surface; // 表层文本（视图模式下指向输入文本，否则指向 text）
+    MisakiTagId tag_id;  // 驻留的词性标签 ID
+    const char *reading; // 词典读音（引用词典中的字符串，不复制；可为 NULL）
+    const char *ipa;     // 词典中预先计算的 IPA（同上，不复制；可为 NULL）
+    char phonemes_inline[MISAKI_TOKEN_INLINE_PHONEMES]; // 短音素内联存储
 } MisakiToken;
 
 /**
  * Token 列表
+ * 
+ * 视图模式（view_mode）下 Token 不拥有 text/tag：
+ * 表层文本是指向 source 的 MisakiStringView，词性是驻留 ID，
+ * 分词过程不再为每个 Token 分配内存。source 必须比列表活得久。
  */
 typedef struct {
     MisakiToken *tokens;   // Token 数组
     int count;             // Token 数量
     int capacity;          // 数组容量
+    const char *source;    // 视图模式引用的输入文本（不拥有）
+    bool view_mode;        // 是否为视图模式
 } MisakiTokenList;
 
 /* ============================================================================
@@ -197,8 +224,10 @@ typedef struct TrieNode {
     uint32_t codepoint;        // Unicode 码点（字符）
     char *word;                // 完整词（如果是词尾）
     char *pron;                // 读音（片假名，日文专用）
+    const char *ipa;           // 预先计算的 IPA（在 Trie 的字符串池中，可为 NULL）
     double frequency;          // 词频（用于路径选择）
     char *tag;                 // 词性标签
+    MisakiTagId tag_id;        // 驻留的词性标签 ID（插入时确定）
     struct TrieNode **children; // 子节点数组
     int children_count;        // 子节点数量
     int children_capacity;     // 子节点容量
@@ -211,6 +240,7 @@ typedef struct TrieNode {
 typedef struct {
     TrieNode *root;            // 根节点
     int word_count;            // 词汇总数
+    struct MisakiStringPool *strings; // 共享字符串池（预计算的 IPA，可为 NULL）
 } Trie;
 
 /* ============================================================================
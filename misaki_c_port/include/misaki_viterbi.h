@@ -11,6 +11,7 @@
 #define MISAKI_VITERBI_H
 
 #include "misaki_types.h"
+#include "misaki_arena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,24 +23,32 @@ extern "C" {
 
 /**
  * Lattice Node: 词格节点
+ * 
+ * 节点及其字符串都分配在 Lattice 的 arena 中，不单独释放。
+ * 偏移节点（misaki_lattice_add_span）不保存 surface，表层文本由
+ * start/length 指向原文，只在提取结果时构造
  */
 typedef struct LatticeNode {
-    int pos;                   // 在文本中的位置
-    char *surface;             // 表层形式（原始文本）
+    int pos;                   // 在文本中的位置（字符）
+    char *surface;             // 表层形式（偏移节点为 NULL）
     char *feature;             // 特征字符串（词性等）
     char *reading;             // 读音（假名/拼音）
     char *phonemes;            // 音素序列
     
     double node_cost;          // 节点成本
-    double edge_cost;          // 边成本（到前驱的成本）
+    double edge_cost;          // 边成本（搜索后为最优前驱到本节点的边的成本）
     double total_cost;         // 累积成本
     
     struct LatticeNode *prev;  // 前驱节点（回溯用）
     struct LatticeNode **next; // 后继节点数组
+    double *next_costs;        // 到各后继的边成本（与 next 一一对应）
     int next_count;            // 后继数量
+    int next_capacity;         // 后继数组容量
     
-    int start;                 // 起始位置（字节偏移）
+    int start;                 // 起始位置（字节偏移；没有原文的 Lattice 上的普通节点为 -1）
     int length;                // 长度（字节数）
+    int char_length;           // 跨越的字符数（下一个节点的位置 = pos + char_length）
+    MisakiTagId tag_id;        // 驻留的词性标签 ID
 } LatticeNode;
 
 /**
@@ -49,10 +58,16 @@ typedef struct Lattice {
     LatticeNode ***nodes;      // 节点数组（每个位置是一个动态数组）
     int *node_counts;          // 每个位置的节点数
     int *node_capacities;      // 每个位置的数组容量
+    LatticeNode ***end_nodes;  // 在每个位置结束的节点（pos + length）
+    int *end_counts;           // 每个位置结束的节点数
+    int *end_capacities;       // 每个位置结束数组的容量
     int text_length;           // 文本长度（字符数）
     
     LatticeNode *bos;          // 起始节点 (Begin of Sentence)
     LatticeNode *eos;          // 结束节点 (End of Sentence)
+    
+    const char *text;          // 原文（偏移节点引用，可为 NULL）
+    MisakiArena *arena;        // 节点/数组/字符串的分配区
 } Lattice;
 
 /* ============================================================================
@@ -67,6 +82,23 @@ typedef struct Lattice {
  */
 Lattice* misaki_lattice_create(int text_length);
 
+/**
+ * 为文本创建 Lattice（可以使用偏移节点）
+ * 
+ * @param text 原文（UTF-8，必须比 Lattice 活得久）
+ * @return Lattice 对象，失败返回 NULL
+ */
+Lattice* misaki_lattice_create_for_text(const char *text);
+
+/**
+ * 重置 Lattice 以处理新文本（一次 arena 重置，之前的节点全部失效）
+ * 
+ * @param lattice Lattice 对象
+ * @param text 新文本（UTF-8）
+ * @return 成功返回 true
+ */
+bool misaki_lattice_reset(Lattice *lattice, const char *text);
+
 /**
  * 释放 Lattice
  * 
@@ -92,9 +124,41 @@ LatticeNode* misaki_lattice_add_node(Lattice *lattice,
                                       const char *reading,
                                       double node_cost);
 
+/**
+ * 添加偏移节点（不复制字符串）
+ * 
+ * @param lattice Lattice 对象（需绑定原文）
+ * @param pos 位置（字符）
+ * @param byte_start 在原文中的字节偏移
+ * @param byte_length 字节长度
+ * @param char_length 字符数
+ * @param tag_id 词性标签 ID
+ * @param node_cost 节点成本
+ * @return 创建的节点，失败返回 NULL
+ */
+LatticeNode* misaki_lattice_add_span(Lattice *lattice,
+                                      int pos,
+                                      int byte_start,
+                                      int byte_length,
+                                      int char_length,
+                                      MisakiTagId tag_id,
+                                      double node_cost);
+
+/**
+ * 获取节点的表层文本
+ * 
+ * @param lattice Lattice 对象
+ * @param node 节点
+ * @return 表层文本视图（偏移节点指向原文）
+ */
+MisakiStringView misaki_lattice_node_surface(const Lattice *lattice,
+                                             const LatticeNode *node);
+
 /**
  * 添加边（连接两个节点）
  * 
+ * 成本按边保存：同一节点的多条入边各自计成本
+ * 
  * @param from 起始节点
  * @param to 结束节点
  * @param edge_cost 边成本
@@ -132,6 +196,34 @@ int misaki_lattice_get_nodes_at(const Lattice *lattice,
  */
 bool misaki_viterbi_search(Lattice *lattice);
 
+/**
+ * 连接成本回调
+ * 
+ * @param left 左侧节点（可能是 BOS）
+ * @param right 右侧节点（可能是 EOS）
+ * @param user_data 用户数据
+ * @return 连接成本
+ */
+typedef double (*LatticeConnectCost)(const LatticeNode *left,
+                                     const LatticeNode *right,
+                                     void *user_data);
+
+/**
+ * Viterbi 算法（无边版本，MeCab 风格）
+ * 
+ * 不需要 misaki_lattice_add_edge：按位置从左到右，对每个节点扫描
+ * 在其起始位置结束的所有节点，现场计算连接成本。
+ * 复杂度为 节点数 × 局部入度，每条连接有独立的成本
+ * 
+ * @param lattice Lattice 对象
+ * @param connect 连接成本回调（NULL 表示连接成本为 0）
+ * @param user_data 传给回调的用户数据
+ * @return 找到到达 EOS 的路径返回 true
+ */
+bool misaki_viterbi_search_connect(Lattice *lattice,
+                                   LatticeConnectCost connect,
+                                   void *user_data);
+
 /**
  * 回溯最优路径
  * 
@@ -152,26 +244,83 @@ int misaki_viterbi_backtrack(const Lattice *lattice,
  */
 MisakiTokenList* misaki_viterbi_extract_tokens(const Lattice *lattice);
 
+/**
+ * 把最优路径追加到 Token 列表
+ * 
+ * 视图模式下表层文本取自 list->source + node->start（节点的 start 须为字节偏移）
+ * 
+ * @param lattice Lattice 对象（已执行 viterbi_search）
+ * @param list Token 列表
+ * @return 追加的 Token 数量，失败返回 -1
+ */
+int misaki_viterbi_append_tokens(const Lattice *lattice, MisakiTokenList *list);
+
 /* ============================================================================
  * 成本计算
  * ========================================================================== */
 
 /**
  * 成本矩阵（用于计算边成本）
+ * 
+ * 稠密 int16 矩阵，按 左 ID × 右 ID 行优先存放，查表只需一次下标运算。
+ * 日文分词器中 ID 为 MisakiTagId（0 = 无词性，用于 BOS/EOS）
  */
 typedef struct CostMatrix {
-    double **trans_cost;       // 转移成本矩阵
-    int pos_count;             // 词性数量
+    int16_t *costs;            // 转移成本（left_size × right_size）
+    int left_size;             // 左侧 ID 数量
+    int right_size;            // 右侧 ID 数量
+    uint8_t *defined;          // 按词性名加载时文件中出现的 ID（NULL 表示范围内都有值）
 } CostMatrix;
 
+/**
+ * 创建成本矩阵（所有成本为 0）
+ * 
+ * @param left_size 左侧 ID 数量
+ * @param right_size 右侧 ID 数量
+ * @return 成本矩阵，失败返回 NULL
+ */
+CostMatrix* misaki_cost_matrix_create(int left_size, int right_size);
+
 /**
  * 加载成本矩阵
  * 
+ * 文件格式（同 MeCab matrix.def）：
+ *   第一行：左侧数量 右侧数量
+ *   之后每行：左 ID 右 ID 成本
+ * 未出现的组合成本为 0，'#' 开头的行为注释
+ * 
+ * 第一行之后可以有词性表（每行 "@ ID 词性名"，在成本之前）：
+ * MisakiTagId 是进程内按驻留顺序分配的，有词性表时文件中的 ID 按名字
+ * 换成当前进程的 ID（misaki_tag_intern），矩阵大小随之调整，
+ * defined 记录文件中出现的词性；没有词性表时 ID 原样使用
+ * 
  * @param file_path 成本文件路径
  * @return 成本矩阵，失败返回 NULL
  */
 CostMatrix* misaki_cost_matrix_load(const char *file_path);
 
+/**
+ * 保存成本矩阵（格式同 misaki_cost_matrix_load，只写非 0 项）
+ * 
+ * 范围内已驻留的词性写进词性表，文件可以在其他进程中加载
+ * 
+ * @param matrix 成本矩阵
+ * @param file_path 文件路径
+ * @return 成功返回 true
+ */
+bool misaki_cost_matrix_save(const CostMatrix *matrix, const char *file_path);
+
+/**
+ * 设置成本
+ * 
+ * @param matrix 成本矩阵
+ * @param from_pos 左侧 ID
+ * @param to_pos 右侧 ID
+ * @param cost 成本
+ * @return 越界返回 false
+ */
+bool misaki_cost_matrix_set(CostMatrix *matrix, int from_pos, int to_pos, int16_t cost);
+
 /**
  * 释放成本矩阵
  * 
@@ -191,6 +340,194 @@ double misaki_cost_matrix_get(const CostMatrix *matrix,
                                int from_pos,
                                int to_pos);
 
+/**
+ * 判断 ID 对是否在矩阵范围内
+ * 
+ * @param matrix 成本矩阵
+ * @param from_pos 左侧 ID
+ * @param to_pos 右侧 ID
+ * @return 在范围内返回 true
+ */
+static inline bool misaki_cost_matrix_covers(const CostMatrix *matrix,
+                                             int from_pos,
+                                             int to_pos) {
+    return matrix && from_pos >= 0 && from_pos < matrix->left_size &&
+           to_pos >= 0 && to_pos < matrix->right_size;
+}
+
+/* ============================================================================
+ * 紧凑 Lattice（SoA 布局）
+ * ========================================================================== */
+
+/**
+ * 紧凑 Lattice：每个字段一个连续数组（结构体数组 → 数组结构体）
+ * 
+ * LatticeNode 是 80+ 字节的 double/指针混合结构，前向传播在分散的缓存行间跳转；
+ * 这里节点只是下标，成本用 float（同 MeCab 的整数/单精度成本思路），
+ * 前向传播是对连续内存的紧凑循环，连接成本直接查 CostMatrix，没有回调。
+ * 
+ * 节点必须按起始位置非递减的顺序添加（前驱的下标总是更小）
+ */
+typedef struct CompactLattice {
+    int count;                 // 节点数
+    int capacity;              // 各数组容量
+    
+    int32_t *start;            // 起始位置（字符）
+    int32_t *length;           // 跨越的字符数
+    int32_t *byte_start;       // 起始位置（字节偏移）
+    int32_t *byte_length;      // 长度（字节数）
+    float *word_cost;          // 节点成本
+    MisakiTagId *tag_id;       // 词性 ID（连接成本矩阵下标）
+    const char **reading;      // 读音（引用词典中的字符串，可为 NULL）
+    const char **ipa;          // 预先计算的 IPA（同上，可为 NULL）
+    float *best_cost;          // 累积成本（前向传播结果）
+    int32_t *back;             // 最优前驱下标（-1 表示 BOS）
+    
+    int32_t *end_offsets;      // 在位置 p 结束的节点：end_index[end_offsets[p] .. end_offsets[p + 1])
+    int32_t *end_index;        // 按结束位置分桶的节点下标
+    float *end_cost;           // 与 end_index 对齐的累积成本（前向传播时填充）
+    MisakiTagId *end_tag;      // 与 end_index 对齐的词性 ID
+    int position_capacity;     // end_offsets 容量
+    float *sort_scratch;       // 剪枝用的临时数组
+    int32_t *prune_scratch;    // 剪枝用的临时数组
+    
+    int text_length;           // 文本长度（字符数）
+    const char *text;          // 原文（节点以偏移引用）
+    float eos_cost;            // 到达 EOS 的最优成本
+    int32_t eos_back;          // EOS 的最优前驱（-1 表示不可达）
+} CompactLattice;
+
+/**
+ * 为文本创建紧凑 Lattice
+ * 
+ * @param text 原文（UTF-8，必须比 Lattice 活得久）
+ * @return Lattice 对象，失败返回 NULL
+ */
+CompactLattice* misaki_compact_lattice_create(const char *text);
+
+/**
+ * 重置紧凑 Lattice 以处理新文本（保留已分配的数组）
+ * 
+ * @param lattice Lattice 对象
+ * @param text 新文本（UTF-8）
+ * @return 成功返回 true
+ */
+bool misaki_compact_lattice_reset(CompactLattice *lattice, const char *text);
+
+/**
+ * 释放紧凑 Lattice
+ * 
+ * @param lattice Lattice 对象
+ */
+void misaki_compact_lattice_free(CompactLattice *lattice);
+
+/**
+ * 添加节点
+ * 
+ * @param lattice Lattice 对象
+ * @param start 起始位置（字符，不能小于上一个节点的起始位置）
+ * @param length 跨越的字符数
+ * @param byte_start 起始位置（字节偏移）
+ * @param byte_length 长度（字节数）
+ * @param tag_id 词性 ID
+ * @param word_cost 节点成本
+ * @return 节点下标，失败返回 -1
+ */
+int misaki_compact_lattice_add(CompactLattice *lattice,
+                               int start,
+                               int length,
+                               int byte_start,
+                               int byte_length,
+                               MisakiTagId tag_id,
+                               float word_cost);
+
+/**
+ * 设置节点的读音和 IPA（提取 Token 时带到 MisakiToken.reading/ipa，G2P 不必再查词典）
+ * 
+ * @param lattice Lattice 对象
+ * @param node 节点下标
+ * @param reading 读音（不复制，须比 Token 活得久，通常是词典中的字符串）
+ * @param ipa 预先计算的 IPA（同上，可为 NULL）
+ * @return 成功返回 true
+ */
+bool misaki_compact_lattice_set_reading(CompactLattice *lattice, int node,
+                                        const char *reading, const char *ipa);
+
+/**
+ * 前向传播（Viterbi）
+ * 
+ * 连接成本为 matrix[左词性][右词性]（BOS/EOS 的词性为 0），
+ * 超出矩阵范围的 ID 成本为 0
+ * 
+ * @param lattice Lattice 对象
+ * @param matrix 连接成本矩阵（可为 NULL，表示连接成本全为 0）
+ * @return 找到到达 EOS 的路径返回 true
+ */
+bool misaki_compact_viterbi_search(CompactLattice *lattice, const CostMatrix *matrix);
+
+/**
+ * 束搜索参数（全为 0 时为精确搜索）
+ */
+typedef struct ViterbiBeam {
+    int beam_width;            // 每个位置最多保留的前驱数（0 = 不限）
+    float cost_threshold;      // 与该位置最优成本的最大差距（0 = 不限）
+} ViterbiBeam;
+
+/**
+ * 剪枝计数（累加，调用方负责清零）
+ */
+typedef struct ViterbiPruneStats {
+    uint64_t beam_hits;        // 发生剪枝的位置数
+    uint64_t pruned_paths;     // 被剪掉的前驱数
+    uint64_t pruned_matches;   // 构建 Lattice 时丢弃的词典匹配数
+    uint64_t exact_fallbacks;  // 剪枝后无解、退回精确搜索的次数
+} ViterbiPruneStats;
+
+/**
+ * 前向传播（束剪枝）
+ * 
+ * 每个结束位置的前驱在其累积成本全部确定后剪枝：只保留成本最低的
+ * beam_width 个，以及与最优成本差距不超过 cost_threshold 的。
+ * 每个位置至少保留最优前驱，所以剪枝不会让 Lattice 断开；
+ * 代价是结果可能不是全局最优
+ * 
+ * @param lattice Lattice 对象
+ * @param matrix 连接成本矩阵（可为 NULL）
+ * @param beam 束搜索参数（NULL 表示精确搜索）
+ * @param stats 输出：剪枝计数（可为 NULL）
+ * @return 找到到达 EOS 的路径返回 true
+ */
+bool misaki_compact_viterbi_search_beam(CompactLattice *lattice,
+                                        const CostMatrix *matrix,
+                                        const ViterbiBeam *beam,
+                                        ViterbiPruneStats *stats);
+
+/**
+ * 回溯最优路径
+ * 
+ * @param lattice Lattice 对象（已执行 misaki_compact_viterbi_search）
+ * @param path 输出：节点下标数组（从左到右）
+ * @param max_length 最大长度
+ * @return 实际路径长度（路径比 max_length 长时返回 -1）
+ */
+int misaki_compact_viterbi_backtrack(const CompactLattice *lattice,
+                                     int *path,
+                                     int max_length);
+
+/**
+ * 把最优路径追加到 Token 列表
+ * 
+ * Token 的 start/length 为字符位置，score 为累积成本，reading/ipa 为节点的读音；
+ * 视图模式下表层文本
+ * 取自 list->source + byte_start
+ * 
+ * @param lattice Lattice 对象（已执行 misaki_compact_viterbi_search）
+ * @param list Token 列表
+ * @return 追加的 Token 数量，失败返回 -1
+ */
+int misaki_compact_viterbi_append_tokens(const CompactLattice *lattice,
+                                         MisakiTokenList *list);
+
 /* ============================================================================
  * N-Best 路径（可选）
  * ========================================================================== */
@@ -199,23 +536,76 @@ double misaki_cost_matrix_get(const CostMatrix *matrix,
  * N-Best 结果
  */
 typedef struct NBestResult {
-    LatticeNode **path;        // 路径节点数组
-    int path_length;           // 路径长度
+    LatticeNode **path;        // 路径节点数组（通用 Lattice）
+    int *nodes;                // 路径节点下标（紧凑 Lattice）
+    int path_length;           // 路径长度（不含 BOS/EOS）
     double total_cost;         // 总成本
 } NBestResult;
 
 /**
- * 求 N-Best 路径（Top N 个最优路径）
+ * 求 N-Best 路径（Top N 个最优路径，按总成本从小到大）
  * 
- * @param lattice Lattice 对象
+ * 前向传播（misaki_viterbi_search）之后从 EOS 做后向 A*：
+ * 每个节点的前向累积成本就是其左侧的精确最优成本，用作启发值，
+ * 所以不需要重新解码，代价约为一次前向传播加上 N 条路径的长度。
+ * 节点的前驱为在其起始位置结束的、有边指向它的节点
+ * 
+ * @param lattice Lattice 对象（已执行 misaki_viterbi_search）
  * @param n N 值
- * @param results 输出：N-Best 结果数组
+ * @param results 输出：N-Best 结果数组（至少 n 个，用 misaki_nbest_free 释放）
  * @return 实际结果数量
  */
 int misaki_viterbi_nbest(const Lattice *lattice,
                          int n,
                          NBestResult *results);
 
+/**
+ * 求 N-Best 路径（无边版本）
+ * 
+ * @param lattice Lattice 对象（已用同样的 connect 执行 misaki_viterbi_search_connect）
+ * @param connect 连接成本回调（NULL 表示连接成本为 0；返回 DBL_MAX 表示不可连接）
+ * @param user_data 传给回调的用户数据
+ * @param n N 值
+ * @param results 输出：N-Best 结果数组
+ * @return 实际结果数量
+ */
+int misaki_viterbi_nbest_connect(const Lattice *lattice,
+                                 LatticeConnectCost connect,
+                                 void *user_data,
+                                 int n,
+                                 NBestResult *results);
+
+/**
+ * 求 N-Best 路径（紧凑 Lattice，结果写入 results[i].nodes）
+ * 
+ * 须在精确搜索（misaki_compact_viterbi_search）之后调用：
+ * 束剪枝后的前向成本不是精确下界，结果的顺序没有保证
+ * 
+ * @param lattice Lattice 对象（已执行 misaki_compact_viterbi_search）
+ * @param matrix 前向传播时使用的连接成本矩阵（可为 NULL）
+ * @param n N 值
+ * @param results 输出：N-Best 结果数组
+ * @return 实际结果数量
+ */
+int misaki_compact_viterbi_nbest(const CompactLattice *lattice,
+                                 const CostMatrix *matrix,
+                                 int n,
+                                 NBestResult *results);
+
+/**
+ * 把一条紧凑 N-Best 路径追加到 Token 列表（score 为沿该路径的累积成本）
+ * 
+ * @param lattice Lattice 对象
+ * @param matrix 连接成本矩阵（可为 NULL）
+ * @param result misaki_compact_viterbi_nbest 的一个结果
+ * @param list Token 列表
+ * @return 追加的 Token 数量，失败返回 -1
+ */
+int misaki_compact_nbest_append_tokens(const CompactLattice *lattice,
+                                       const CostMatrix *matrix,
+                                       const NBestResult *result,
+                                       MisakiTokenList *list);
+
 /**
  * 释放 N-Best 结果
  * 
@@ -256,7 +646,7 @@ void misaki_lattice_stats(const Lattice *lattice,
                           int *total_nodes,
                           int *total_edges,
                           double *avg_nodes_per_pos);
-
+    
 #ifdef __cplusplus
 }
 #endif
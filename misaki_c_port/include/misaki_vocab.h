@@ -0,0 +1,110 @@
+/**
+ * misaki_vocab.h
+ * 
+ * Misaki C Port - Kokoro Vocabulary Encoder
+ * 音素 → Kokoro 模型输入 ID（input_ids）
+ * 
+ * 音素字符串逐个码点查表得到 ID（词表外的字符跳过），
+ * 按模型的长度上限（510 个 ID，加上首尾的 0 共 512）切成若干段，
+ * 直接写进调用者的数组，省去应用层再解析一遍音素字符串
+ * 
+ * 词表编译成两级表：码点高 8 位选页，低 8 位在页内取 ID，查询是两次数组访问
+ * 
+ * License: MIT
+ */
+
+#ifndef MISAKI_VOCAB_H
+#define MISAKI_VOCAB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Kokoro 每段最多的 ID 数（不含首尾的 0）
+#define MISAKI_VOCAB_MAX_TOKENS 510
+
+/**
+ * 编译好的词表（不透明类型，只读，多个线程可以同时使用）
+ */
+typedef struct MisakiVocab MisakiVocab;
+
+/* ============================================================================
+ * 创建与释放
+ * ========================================================================== */
+
+/**
+ * 内置的 Kokoro 词表（与 models/vocab.json 相同）
+ * 
+ * @return 词表，失败返回 NULL（用 misaki_vocab_free 释放）
+ */
+MisakiVocab* misaki_vocab_create_default(void);
+
+/**
+ * 从 (码点, ID) 列表创建词表
+ * 
+ * @param codepoints 码点（只支持基本多文种平面 U+0000..U+FFFF）
+ * @param ids ID（1..32767；0 保留给段首尾）
+ * @param count 条目数
+ * @return 词表，失败返回 NULL（参数超出范围或内存不足）
+ */
+MisakiVocab* misaki_vocab_create(const uint32_t *codepoints, const int *ids, int count);
+
+/**
+ * 从 vocab.json 加载词表（{"字符": ID, ...}，每个键是一个字符）
+ * 
+ * @param path 文件路径
+ * @return 词表，失败返回 NULL（文件不存在或格式错误）
+ */
+MisakiVocab* misaki_vocab_load(const char *path);
+
+/**
+ * 释放词表
+ * 
+ * @param vocab 词表（可为 NULL）
+ */
+void misaki_vocab_free(MisakiVocab *vocab);
+
+/* ============================================================================
+ * 查询与编码
+ * ========================================================================== */
+
+/**
+ * 查询一个码点的 ID
+ * 
+ * @param vocab 词表
+ * @param codepoint 码点
+ * @return ID，词表外返回 -1
+ */
+int misaki_vocab_lookup(const MisakiVocab *vocab, uint32_t codepoint);
+
+/**
+ * 音素字符串编码为 ID，按长度上限分段
+ * 
+ * 每段写成 [0, ID..., 0]，各段依次存放在 ids 中，第 i 段的长度（含首尾的 0）
+ * 写在 chunk_lengths[i]。超过上限时在段内最后一个标点（;:,.!?—…）之后切开，
+ * 没有标点时在最后一个空格处，都没有时才在上限处硬切；段首尾的空格去掉
+ * 
+ * 输出需要 (词表内的码点数 + 2 × 段数) 个 ID；每段至少有一个 ID，
+ * 所以 ids 容量为音素字节数 × 3、chunk_lengths 容量为音素字节数时总是够用
+ * 
+ * @param vocab 词表
+ * @param phonemes 音素字符串（UTF-8）
+ * @param max_tokens 每段最多的 ID 数（不含首尾的 0；<= 0 使用 MISAKI_VOCAB_MAX_TOKENS）
+ * @param ids 输出：ID（调用者分配）
+ * @param max_ids ids 的容量
+ * @param chunk_lengths 输出：每段的长度（调用者分配）
+ * @param max_chunks chunk_lengths 的容量
+ * @return 段数（音素中没有词表内的字符时为 0）, -1=失败（参数错误或输出数组不够）
+ */
+int misaki_vocab_encode(const MisakiVocab *vocab, const char *phonemes, int max_tokens,
+                        int64_t *ids, int max_ids, int *chunk_lengths, int max_chunks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISAKI_VOCAB_H */
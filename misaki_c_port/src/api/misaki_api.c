@@ -15,15 +15,31 @@
 #include "misaki_lang_detect.h"
 #include "misaki_g2p_qya.h"      // 昆雅语 G2P
 #include "misaki_tokenizer_qya.h" // 昆雅语分词器
+#include "misaki_thread_pool.h"
+#include "misaki_cache.h"
+#include "misaki_store.h"
+#include "misaki_preset.h"
+#include "misaki_vocab.h"
+#include "misaki_string.h"
+#include "misaki_sync.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
 
 #define VERSION "0.3.0"
 
-// 全局状态（单例）
-static struct {
-    bool initialized;
+// 引擎默认的 G2P 结果缓存容量（条目数）
+#define MISAKI_ENGINE_CACHE_CAPACITY 4096
+
+/**
+ * 引擎：加载后只读的模型（词典、Trie、HMM、分词器配置）
+ * 
+ * 转换时的临时数据（Lattice、Token 列表、缓冲区）都在每次调用内分配，
+ * 同一个引擎可以被多个线程同时使用
+ */
+struct MisakiEngine {
     EnDict *en_dict;
     ZhDict *zh_dict;
     ZhPhraseDict *zh_phrase_dict;
@@ -33,14 +49,24 @@ static struct {
     Trie *zh_trie;
     Trie *ja_trie;
     LangDetector *lang_detector;
-} g_misaki = {0};
+    G2PCache *g2p_cache;        // 转换结果缓存（NULL 表示不缓存，内部加锁）
+    MisakiStore *store;         // 缓存后备的持久化存储（可为 NULL）
+    MisakiPresetTable *presets; // 预设表（转换前先查，可为 NULL）
+    MisakiThreadPool *pool;     // 批量转换的工作线程（常驻，多次批量转换复用）
+    MisakiVocab *vocab;         // 音素 → 模型输入 ID 的词表（默认为内置的 Kokoro 词表）
+};
 
-/**
- * 初始化 Misaki G2P 引擎
- */
-MISAKI_API int misaki_init(const char *data_dir) {
-    if (g_misaki.initialized) {
-        return 0;  // 已初始化
+// 旧 API（misaki_init / misaki_text_to_phonemes）使用的默认引擎
+static MisakiEngine *g_engine = NULL;
+
+/* ============================================================================
+ * 引擎生命周期
+ * ========================================================================== */
+
+MISAKI_API MisakiEngine* misaki_engine_create(const char *data_dir) {
+    MisakiEngine *engine = (MisakiEngine *)calloc(1, sizeof(MisakiEngine));
+    if (!engine) {
+        return NULL;
     }
     
     if (!data_dir) {
@@ -50,47 +76,49 @@ MISAKI_API int misaki_init(const char *data_dir) {
     // 1. 加载英文词典
     char path[512];
     snprintf(path, sizeof(path), "%s/en/us_dict.txt", data_dir);
-    g_misaki.en_dict = misaki_en_dict_load(path);
+    engine->en_dict = misaki_en_dict_load(path);
     
     // 2. 加载中文词典
     snprintf(path, sizeof(path), "%s/zh/pinyin_dict.txt", data_dir);
-    g_misaki.zh_dict = misaki_zh_dict_load(path);
+    engine->zh_dict = misaki_zh_dict_load(path);
     
     snprintf(path, sizeof(path), "%s/zh/phrase_pinyin.txt", data_dir);
-    g_misaki.zh_phrase_dict = misaki_zh_phrase_dict_load(path);
+    engine->zh_phrase_dict = misaki_zh_phrase_dict_load(path);
     
     snprintf(path, sizeof(path), "%s/zh/hmm_prob_emit.txt", data_dir);
-    g_misaki.zh_hmm_model = misaki_hmm_load(path);
+    engine->zh_hmm_model = misaki_hmm_load(path);
     
     // 加载中文词汇
     snprintf(path, sizeof(path), "%s/zh/dict_merged.txt", data_dir);
-    g_misaki.zh_trie = misaki_trie_create();
-    misaki_trie_load_from_file(g_misaki.zh_trie, path, "word freq");
+    engine->zh_trie = misaki_trie_create();
+    misaki_trie_load_from_file(engine->zh_trie, path, "word freq");
     
     // 创建中文分词器
-    if (g_misaki.zh_dict && g_misaki.zh_trie) {
+    if (engine->zh_dict && engine->zh_trie) {
         ZhTokenizerConfig config = {
-            .dict_trie = g_misaki.zh_trie,
+            .dict_trie = engine->zh_trie,
             .enable_hmm = true,
-            .hmm_model = g_misaki.zh_hmm_model,
+            .hmm_model = engine->zh_hmm_model,
             .enable_userdict = false,
             .user_trie = NULL
         };
-        g_misaki.zh_tokenizer = misaki_zh_tokenizer_create(&config);
+        engine->zh_tokenizer = misaki_zh_tokenizer_create(&config);
     }
     
     // 3. 加载日文词典
     snprintf(path, sizeof(path), "%s/ja/ja_pron_dict.tsv", data_dir);
-    g_misaki.ja_trie = misaki_trie_create();
-    int ja_count = misaki_trie_load_ja_pron_dict(g_misaki.ja_trie, path);
+    engine->ja_trie = misaki_trie_create();
+    int ja_count = misaki_trie_load_ja_pron_dict(engine->ja_trie, path);
     
     if (ja_count > 0) {
+        misaki_ja_precompute_ipa(engine->ja_trie);
+        
         JaTokenizerConfig ja_config = {
-            .dict_trie = g_misaki.ja_trie,
+            .dict_trie = engine->ja_trie,
             .use_simple_model = true,
             .unidic_path = NULL
         };
-        g_misaki.ja_tokenizer = misaki_ja_tokenizer_create(&ja_config);
+        engine->ja_tokenizer = misaki_ja_tokenizer_create(&ja_config);
     }
     
     // 4. 初始化语言检测器
@@ -98,225 +126,1111 @@ MISAKI_API int misaki_init(const char *data_dir) {
         .enable_ngram = true,
         .enable_tokenization = false,
         .confidence_threshold = 0.5f,
-        .zh_tokenizer = g_misaki.zh_tokenizer,
-        .ja_tokenizer = g_misaki.ja_tokenizer
+        .zh_tokenizer = engine->zh_tokenizer,
+        .ja_tokenizer = engine->ja_tokenizer
     };
-    g_misaki.lang_detector = misaki_lang_detector_create(&detector_config);
+    engine->lang_detector = misaki_lang_detector_create(&detector_config);
     
     // 5. 初始化昆雅语 G2P（无需词典）
     misaki_g2p_qya_init();
     misaki_tokenizer_qya_init();
     
-    g_misaki.initialized = true;
-    return 0;
+    // 6. 转换结果缓存
+    engine->g2p_cache = misaki_g2p_cache_create(MISAKI_ENGINE_CACHE_CAPACITY);
+    
+    // 7. Kokoro 词表
+    engine->vocab = misaki_vocab_create_default();
+    
+    // 8. 批量转换的线程池（工作线程在第一次批量转换时才启动；创建失败时每次临时创建线程）
+    engine->pool = misaki_thread_pool_create(0);
+    
+    return engine;
 }
 
-/**
- * 文本转音素（自动检测语言）
- */
-MISAKI_API int misaki_text_to_phonemes(
-    const char *text,
-    char *output_buffer,
-    int buffer_size
-) {
-    if (!g_misaki.initialized) {
+MISAKI_API void misaki_engine_free(MisakiEngine *engine) {
+    if (!engine) {
+        return;
+    }
+    
+    if (engine->en_dict) {
+        misaki_en_dict_free(engine->en_dict);
+    }
+    if (engine->zh_dict) {
+        misaki_zh_dict_free(engine->zh_dict);
+    }
+    if (engine->zh_phrase_dict) {
+        misaki_zh_phrase_dict_free(engine->zh_phrase_dict);
+    }
+    if (engine->zh_hmm_model) {
+        misaki_hmm_free(engine->zh_hmm_model);
+    }
+    if (engine->zh_tokenizer) {
+        misaki_zh_tokenizer_free(engine->zh_tokenizer);
+    }
+    if (engine->ja_tokenizer) {
+        misaki_ja_tokenizer_free(engine->ja_tokenizer);
+    }
+    if (engine->zh_trie) {
+        misaki_trie_free(engine->zh_trie);
+    }
+    if (engine->ja_trie) {
+        misaki_trie_free(engine->ja_trie);
+    }
+    if (engine->lang_detector) {
+        misaki_lang_detector_free(engine->lang_detector);
+    }
+    misaki_thread_pool_free(engine->pool);
+    misaki_g2p_cache_free(engine->g2p_cache);
+    misaki_store_close(engine->store);
+    misaki_preset_table_free(engine->presets);
+    misaki_vocab_free(engine->vocab);
+    
+    free(engine);
+}
+
+MISAKI_API int misaki_engine_set_cache_capacity(MisakiEngine *engine, int capacity) {
+    if (!engine || capacity < 0) {
         return -1;
     }
     
-    if (!text || !output_buffer || buffer_size <= 0) {
+    misaki_g2p_cache_free(engine->g2p_cache);
+    engine->g2p_cache = NULL;
+    if (capacity == 0) {
+        return 0;
+    }
+    
+    engine->g2p_cache = misaki_g2p_cache_create(capacity);
+    misaki_g2p_cache_set_store(engine->g2p_cache, engine->store);
+    return engine->g2p_cache ? 0 : -1;
+}
+
+MISAKI_API int misaki_engine_open_store(MisakiEngine *engine, const char *path) {
+    if (!engine) {
         return -1;
     }
     
-    // 检测语言
-    MisakiLanguage lang = LANG_UNKNOWN;
-    if (g_misaki.lang_detector) {
-        LangDetectResult result = misaki_lang_detect_full(g_misaki.lang_detector, text);
-        lang = result.language;
-        fprintf(stderr, "[DEBUG] 检测语言: %s (置信度: %.2f%%)\n", 
-                misaki_language_name(lang), result.confidence * 100);
-    } else {
-        lang = misaki_lang_detect_quick(text);
-        fprintf(stderr, "[DEBUG] 快速检测语言: %s\n", misaki_language_name(lang));
+    misaki_g2p_cache_set_store(engine->g2p_cache, NULL);
+    misaki_store_close(engine->store);
+    engine->store = NULL;
+    if (!path) {
+        return 0;
     }
     
-    // 根据语言调用 G2P
-    MisakiTokenList *tokens = NULL;
+    engine->store = misaki_store_open(path, false);
+    misaki_g2p_cache_set_store(engine->g2p_cache, engine->store);
+    return engine->store ? 0 : -1;
+}
+
+MISAKI_API int misaki_engine_load_presets(MisakiEngine *engine, const char *path) {
+    if (!engine) {
+        return -1;
+    }
+    
+    MisakiPresetTable *presets = path ? misaki_preset_table_load(path) : NULL;
+    if (path && !presets) {
+        return -1;
+    }
+    
+    misaki_preset_table_free(engine->presets);
+    engine->presets = presets;
+    return 0;
+}
+
+MISAKI_API int misaki_engine_set_presets(MisakiEngine *engine, const void *data, size_t size) {
+    if (!engine) {
+        return -1;
+    }
+    
+    MisakiPresetTable *presets = data ? misaki_preset_table_from_memory(data, size) : NULL;
+    if (data && !presets) {
+        return -1;
+    }
+    
+    misaki_preset_table_free(engine->presets);
+    engine->presets = presets;
+    return 0;
+}
+
+/* ============================================================================
+ * 引擎转换
+ * ========================================================================== */
+
+/**
+ * 按语言分词并转换（英文、中文、日文）
+ */
+static MisakiTokenList* engine_g2p(const MisakiEngine *engine, MisakiLanguage lang,
+                                   const char *text) {
     G2POptions options = misaki_g2p_default_options();
     
     switch (lang) {
         case LANG_ENGLISH:
-            if (g_misaki.en_dict) {
-                tokens = misaki_en_g2p(g_misaki.en_dict, text, &options);
+            if (engine->en_dict) {
+                return misaki_en_g2p(engine->en_dict, text, &options);
             }
             break;
-            
+        
         case LANG_CHINESE:
-            if (g_misaki.zh_dict && g_misaki.zh_tokenizer) {
-                tokens = misaki_zh_g2p(g_misaki.zh_dict, g_misaki.zh_phrase_dict, 
-                                      g_misaki.zh_tokenizer, text, &options);
+            if (engine->zh_dict && engine->zh_tokenizer) {
+                return misaki_zh_g2p(engine->zh_dict, engine->zh_phrase_dict,
+                                     engine->zh_tokenizer, text, &options);
             }
             break;
-            
+        
         case LANG_JAPANESE:
-            if (g_misaki.ja_tokenizer && g_misaki.ja_trie) {
-                tokens = misaki_ja_g2p(g_misaki.ja_trie, g_misaki.ja_tokenizer, text, &options);
+            if (engine->ja_tokenizer && engine->ja_trie) {
+                return misaki_ja_g2p(engine->ja_trie, engine->ja_tokenizer, text, &options);
             }
             break;
-            
+        
         default:
-            return -1;
+            break;
     }
     
+    return NULL;
+}
+
+/**
+ * 解析语言代码
+ */
+static MisakiLanguage engine_parse_lang(const char *lang) {
+    if (strcmp(lang, "ja") == 0 || strcmp(lang, "jp") == 0) {
+        return LANG_JAPANESE;
+    } else if (strcmp(lang, "zh") == 0 || strcmp(lang, "cn") == 0) {
+        return LANG_CHINESE;
+    } else if (strcmp(lang, "en") == 0) {
+        return LANG_ENGLISH;
+    } else if (strcmp(lang, "qya") == 0 || strcmp(lang, "quenya") == 0) {
+        return LANG_QUENYA;
+    }
+    return LANG_UNKNOWN;
+}
+
+/**
+ * 检测语言
+ */
+static MisakiLanguage engine_detect_lang(const MisakiEngine *engine, const char *text) {
+    MisakiLanguage lang = LANG_UNKNOWN;
+    if (engine->lang_detector) {
+        lang = misaki_lang_detect_full(engine->lang_detector, text).language;
+    } else {
+        lang = misaki_lang_detect_quick(text);
+    }
+    return lang;
+}
+
+/**
+ * 文本转音素字符串（不经过缓存；调用者 free），失败返回 NULL
+ */
+static char* engine_convert(const MisakiEngine *engine, MisakiLanguage lang, const char *text) {
+    // 昆雅语特殊处理：直接调用 G2P，不需要词典
+    if (lang == LANG_QUENYA) {
+        char* phonemes_str = NULL;
+        if (misaki_g2p_qya_convert(text, &phonemes_str) == 0 && phonemes_str) {
+            return phonemes_str;
+        }
+        free(phonemes_str);
+        return NULL;
+    }
+    
+    MisakiTokenList *tokens = engine_g2p(engine, lang, text);
     if (!tokens) {
-        return -1;
+        return NULL;
     }
     
-    // 合并音素
     char *merged = misaki_merge_phonemes(tokens, " ");
-    if (merged) {
-        strncpy(output_buffer, merged, buffer_size - 1);
-        output_buffer[buffer_size - 1] = '\0';
-        free(merged);
-        misaki_token_list_free(tokens);
-        return 0;
+    misaki_token_list_free(tokens);
+    return merged;
+}
+
+static char* engine_phonemes(const MisakiEngine *engine, MisakiLanguage lang, const char *text);
+
+/**
+ * 混合文字的文本按文字段分别转换，结果用空格连接（调用者 free）
+ * 
+ * 只有一种文字、或某一段的后端不可用（如没有英文词典）时返回 NULL，
+ * 由调用者整段转换；没有后端的文字（韩文等）跳过，
+ * 没有对应语言的标点段原样保留
+ * 
+ * @param cjk_lang 汉字/假名段的语言（LANG_UNKNOWN 表示按有无假名判断）
+ */
+static char* engine_convert_mixed(const MisakiEngine *engine, MisakiLanguage cjk_lang,
+                                  const char *text) {
+    MisakiScriptRun *runs = NULL;
+    int count = misaki_segment_scripts(text, cjk_lang, &runs);
+    int script_count = 0;
+    for (int i = 0; i < count; i++) {
+        script_count += !runs[i].neutral;
+    }
+    if (script_count < 2) {
+        free(runs);
+        return NULL;
     }
     
-    misaki_token_list_free(tokens);
-    return -1;
+    MisakiString *merged = misaki_string_new();
+    bool ok = merged != NULL;
+    for (int i = 0; i < count && ok; i++) {
+        MisakiLanguage lang = runs[i].lang;
+        bool pass_through = runs[i].neutral && lang == LANG_UNKNOWN;
+        if (!pass_through && lang != LANG_ENGLISH && lang != LANG_CHINESE && lang != LANG_JAPANESE) {
+            continue;
+        }
+        
+        char *run = (char *)malloc(runs[i].length + 1);
+        if (!run) {
+            ok = false;
+            break;
+        }
+        memcpy(run, text + runs[i].offset, runs[i].length);
+        run[runs[i].length] = '\0';
+        
+        // 每段单独查预设表和缓存（品牌名等重复出现的段直接命中）
+        char *phonemes = pass_through ? run : engine_phonemes(engine, lang, run);
+        if (!pass_through) {
+            free(run);
+        }
+        ok = phonemes != NULL;
+        if (ok && phonemes[0] != '\0') {
+            ok = (merged->length == 0 || misaki_string_append_char(merged, ' ')) &&
+                 misaki_string_append_cstr(merged, phonemes);
+        }
+        free(phonemes);
+    }
+    free(runs);
+    
+    char *result = NULL;
+    if (ok) {
+        result = misaki_strdup(misaki_string_cstr(merged));
+    }
+    misaki_string_free(merged);
+    return result;
+}
+
+typedef struct {
+    const MisakiEngine *engine;
+    MisakiLanguage lang;        // LANG_UNKNOWN 表示自动检测
+    const char *text;
+} EngineRequest;
+
+static char* engine_request_compute(void *ctx) {
+    const EngineRequest *request = (const EngineRequest *)ctx;
+    MisakiLanguage lang = request->lang;
+    if (lang == LANG_UNKNOWN) {
+        lang = engine_detect_lang(request->engine, request->text);
+    }
+    return engine_convert(request->engine, lang, request->text);
 }
 
 /**
- * 文本转音素（指定语言）
+ * 文本转音素字符串（先查预设表、再分文字段，最后查缓存；同一文本并发未命中时只转换一次）
  */
-MISAKI_API int misaki_text_to_phonemes_lang(
+static char* engine_phonemes(const MisakiEngine *engine, MisakiLanguage lang, const char *text) {
+    const char *preset = misaki_preset_table_lookup(engine->presets, lang, text);
+    if (preset) {
+        return misaki_strdup(preset);
+    }
+    
+    // 混合文字（如 "我用iPhone打电话"）：各段交给对应的后端；
+    // 指定中文/日文时汉字/假名段用指定的语言。拼接的结果不进缓存：
+    // 各段自己查预设表和缓存，更换预设表后不会返回按旧预设拼出的结果
+    if (lang == LANG_UNKNOWN || lang == LANG_CHINESE || lang == LANG_JAPANESE) {
+        char *mixed = engine_convert_mixed(engine, lang, text);
+        if (mixed) {
+            return mixed;
+        }
+    }
+    
+    EngineRequest request = { engine, lang, text };
+    if (!engine->g2p_cache) {
+        return engine_request_compute(&request);
+    }
+    
+    const char *lang_key = lang == LANG_UNKNOWN ? "auto" : misaki_language_name(lang);
+    return misaki_g2p_cache_get_or_compute(engine->g2p_cache, text, lang_key, NULL,
+                                           engine_request_compute, &request);
+}
+
+/**
+ * 音素字符串写入输出缓冲区（释放 phonemes）
+ */
+static int engine_write_phonemes(char *phonemes, char *output_buffer, int buffer_size) {
+    if (!phonemes) {
+        return -1;
+    }
+    
+    strncpy(output_buffer, phonemes, buffer_size - 1);
+    output_buffer[buffer_size - 1] = '\0';
+    free(phonemes);
+    return 0;
+}
+
+MISAKI_API int misaki_engine_text_to_phonemes(
+    const MisakiEngine *engine,
+    const char *text,
+    char *output_buffer,
+    int buffer_size
+) {
+    if (!engine || !text || !output_buffer || buffer_size <= 0) {
+        return -1;
+    }
+    
+    return engine_write_phonemes(engine_phonemes(engine, LANG_UNKNOWN, text),
+                                 output_buffer, buffer_size);
+}
+
+MISAKI_API int misaki_engine_text_to_phonemes_lang(
+    const MisakiEngine *engine,
     const char *text,
     const char *lang,
     char *output_buffer,
     int buffer_size
 ) {
-    if (!g_misaki.initialized) {
+    if (!engine || !text || !lang || !output_buffer || buffer_size <= 0) {
         return -1;
     }
     
-    if (!text || !lang || !output_buffer || buffer_size <= 0) {
+    MisakiLanguage detected_lang = engine_parse_lang(lang);
+    if (detected_lang == LANG_UNKNOWN) {
         return -1;
     }
     
-    // 解析语言代码
-    MisakiLanguage detected_lang = LANG_UNKNOWN;
-    if (strcmp(lang, "ja") == 0 || strcmp(lang, "jp") == 0) {
-        detected_lang = LANG_JAPANESE;
-    } else if (strcmp(lang, "zh") == 0 || strcmp(lang, "cn") == 0) {
-        detected_lang = LANG_CHINESE;
-    } else if (strcmp(lang, "en") == 0) {
-        detected_lang = LANG_ENGLISH;
-    } else if (strcmp(lang, "qya") == 0 || strcmp(lang, "quenya") == 0) {
-        detected_lang = LANG_QUENYA;
+    return engine_write_phonemes(engine_phonemes(engine, detected_lang, text),
+                                 output_buffer, buffer_size);
+}
+
+/* ============================================================================
+ * 模型输入 ID
+ * ========================================================================== */
+
+MISAKI_API int misaki_engine_load_vocab(MisakiEngine *engine, const char *path) {
+    if (!engine) {
+        return -1;
+    }
+    
+    MisakiVocab *vocab = path ? misaki_vocab_load(path) : misaki_vocab_create_default();
+    if (!vocab) {
+        return -1;
+    }
+    
+    misaki_vocab_free(engine->vocab);
+    engine->vocab = vocab;
+    return 0;
+}
+
+MISAKI_API int misaki_engine_phonemes_to_ids(
+    const MisakiEngine *engine,
+    const char *phonemes,
+    int max_tokens,
+    int64_t *ids,
+    int max_ids,
+    int *chunk_lengths,
+    int max_chunks
+) {
+    if (!engine || !engine->vocab) {
+        return -1;
+    }
+    
+    return misaki_vocab_encode(engine->vocab, phonemes, max_tokens,
+                               ids, max_ids, chunk_lengths, max_chunks);
+}
+
+MISAKI_API int misaki_engine_text_to_ids(
+    const MisakiEngine *engine,
+    const char *text,
+    const char *lang,
+    int max_tokens,
+    int64_t *ids,
+    int max_ids,
+    int *chunk_lengths,
+    int max_chunks
+) {
+    if (!engine || !engine->vocab || !text) {
+        return -1;
+    }
+    
+    MisakiLanguage request_lang = LANG_UNKNOWN;
+    if (lang) {
+        request_lang = engine_parse_lang(lang);
+        if (request_lang == LANG_UNKNOWN) {
+            return -1;
+        }
+    }
+    
+    // 音素（缓存命中时就是缓存里的结果）直接编码，不经过调用者的缓冲区
+    char *phonemes = engine_phonemes(engine, request_lang, text);
+    if (!phonemes) {
+        return -1;
+    }
+    
+    int chunks = misaki_vocab_encode(engine->vocab, phonemes, max_tokens,
+                                     ids, max_ids, chunk_lengths, max_chunks);
+    free(phonemes);
+    return chunks;
+}
+
+/* ============================================================================
+ * 批量转换
+ * ========================================================================== */
+
+/**
+ * 每个工作线程的输出区：结果依次追加，最后按输入顺序拼接
+ */
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+    bool failed;                // 追加时内存不足
+} BatchWorkspace;
+
+/**
+ * 单条结果在工作区中的位置
+ */
+typedef struct {
+    int worker;                 // -1 表示转换失败
+    size_t offset;
+    size_t length;
+} BatchSlot;
+
+typedef struct {
+    const MisakiEngine *engine;
+    const char *const *texts;
+    MisakiLanguage lang;        // LANG_UNKNOWN 表示逐条检测
+    BatchWorkspace *workspaces;
+    BatchSlot *slots;
+} BatchJob;
+
+static bool batch_append(BatchWorkspace *ws, const char *str, size_t length) {
+    if (ws->length + length + 1 > ws->capacity) {
+        size_t capacity = ws->capacity > 0 ? ws->capacity * 2 : 4096;
+        while (capacity < ws->length + length + 1) {
+            capacity *= 2;
+        }
+        char *data = (char *)realloc(ws->data, capacity);
+        if (!data) {
+            return false;
+        }
+        ws->data = data;
+        ws->capacity = capacity;
+    }
+    
+    memcpy(ws->data + ws->length, str, length + 1);
+    ws->length += length + 1;
+    return true;
+}
+
+static void batch_convert_one(void *ctx, int worker, int index) {
+    BatchJob *job = (BatchJob *)ctx;
+    BatchSlot *slot = &job->slots[index];
+    const char *text = job->texts[index];
+    slot->worker = -1;
+    
+    if (!text) {
+        return;
+    }
+    
+    char *phonemes = engine_phonemes(job->engine, job->lang, text);
+    if (!phonemes) {
+        return;
+    }
+    
+    BatchWorkspace *ws = &job->workspaces[worker];
+    size_t length = strlen(phonemes);
+    if (batch_append(ws, phonemes, length)) {
+        slot->worker = worker;
+        slot->offset = ws->length - length - 1;
+        slot->length = length;
     } else {
+        ws->failed = true;
+    }
+    free(phonemes);
+}
+
+MISAKI_API int misaki_engine_text_to_phonemes_batch(
+    const MisakiEngine *engine,
+    const char *const *texts,
+    int count,
+    const char *lang,
+    int num_threads,
+    char **output,
+    int *offsets
+) {
+    if (!engine || (!texts && count > 0) || count < 0 || !output || (!offsets && count > 0)) {
         return -1;
     }
+    *output = NULL;
     
-    // 调用 G2P
-    MisakiTokenList *tokens = NULL;
-    G2POptions options = misaki_g2p_default_options();
+    BatchJob job = { engine, texts, LANG_UNKNOWN, NULL, NULL };
+    if (lang) {
+        job.lang = engine_parse_lang(lang);
+        if (job.lang == LANG_UNKNOWN) {
+            return -1;
+        }
+    }
     
-    switch (detected_lang) {
-        case LANG_ENGLISH:
-            if (g_misaki.en_dict) {
-                tokens = misaki_en_g2p(g_misaki.en_dict, text, &options);
-            }
-            break;
-            
-        case LANG_CHINESE:
-            if (g_misaki.zh_dict && g_misaki.zh_tokenizer) {
-                tokens = misaki_zh_g2p(g_misaki.zh_dict, g_misaki.zh_phrase_dict,
-                                      g_misaki.zh_tokenizer, text, &options);
+    num_threads = misaki_parallel_threads(count, num_threads);
+    job.workspaces = (BatchWorkspace *)calloc((size_t)num_threads, sizeof(BatchWorkspace));
+    job.slots = (BatchSlot *)calloc(count > 0 ? (size_t)count : 1, sizeof(BatchSlot));
+    
+    int ret = -1;
+    if (job.workspaces && job.slots &&
+        misaki_thread_pool_for(engine->pool, count, num_threads, batch_convert_one, &job) == 0) {
+        // 按输入顺序拼接（与线程调度无关）
+        size_t total = 0;
+        bool failed = false;
+        for (int w = 0; w < num_threads; w++) {
+            total += job.workspaces[w].length;
+            failed = failed || job.workspaces[w].failed;
+        }
+        
+        char *packed = failed ? NULL : (char *)malloc(total > 0 ? total : 1);
+        if (packed) {
+            size_t length = 0;
+            for (int i = 0; i < count; i++) {
+                const BatchSlot *slot = &job.slots[i];
+                if (slot->worker < 0 || length > INT_MAX) {
+                    offsets[i] = -1;
+                    continue;
+                }
+                memcpy(packed + length, job.workspaces[slot->worker].data + slot->offset,
+                       slot->length + 1);
+                offsets[i] = (int)length;
+                length += slot->length + 1;
             }
+            *output = packed;
+            ret = 0;
+        }
+    }
+    
+    if (job.workspaces) {
+        for (int w = 0; w < num_threads; w++) {
+            free(job.workspaces[w].data);
+        }
+    }
+    free(job.workspaces);
+    free(job.slots);
+    return ret;
+}
+
+/* ============================================================================
+ * 流式转换
+ * ========================================================================== */
+
+/**
+ * 一个句子（指向输入文本，已去掉首尾空白）
+ */
+typedef struct {
+    const char *text;
+    int length;
+    char *phonemes;             // 转换结果（失败为 NULL）
+    bool ready;                 // 已转换（受 lock 保护）
+} StreamSentence;
+
+/**
+ * 句子由调用线程和预取线程共同认领：谁先认领谁转换，
+ * 回调始终在调用线程上按顺序执行
+ */
+typedef struct {
+    const MisakiEngine *engine;
+    MisakiLanguage lang;        // LANG_UNKNOWN 表示逐句检测
+    StreamSentence *sentences;
+    int count;
+    int lookahead;
+    MisakiMutex lock;
+    MisakiCond cond;
+    int next;                   // 下一个待认领的句子
+    int delivered;              // 已回调完的句子数
+    bool stopped;               // 回调要求停止
+} StreamJob;
+
+#define STREAM_IDEOGRAPHIC_SPACE "　"    // 全角空格（UTF-8 3 字节）
+
+/**
+ * 去掉首尾空白（含全角空格）
+ */
+static void stream_trim(const char **begin, const char **end) {
+    while (*begin < *end) {
+        if (misaki_isspace(**begin)) {
+            (*begin)++;
+        } else if (*end - *begin >= 3 && memcmp(*begin, STREAM_IDEOGRAPHIC_SPACE, 3) == 0) {
+            *begin += 3;
+        } else {
             break;
-            
-        case LANG_JAPANESE:
-            if (g_misaki.ja_tokenizer && g_misaki.ja_trie) {
-                tokens = misaki_ja_g2p(g_misaki.ja_trie, g_misaki.ja_tokenizer, text, &options);
-            }
+        }
+    }
+    while (*end > *begin) {
+        if (misaki_isspace((*end)[-1])) {
+            (*end)--;
+        } else if (*end - *begin >= 3 && memcmp(*end - 3, STREAM_IDEOGRAPHIC_SPACE, 3) == 0) {
+            *end -= 3;
+        } else {
             break;
-            
-        case LANG_QUENYA:
-            {
-                // 昆雅语特殊处理：直接调用 G2P，不需要词典
-                char* phonemes_str = NULL;
-                if (misaki_g2p_qya_convert(text, &phonemes_str) == 0 && phonemes_str) {
-                    strncpy(output_buffer, phonemes_str, buffer_size - 1);
-                    output_buffer[buffer_size - 1] = '\0';
-                    free(phonemes_str);
-                    return 0;
-                }
+        }
+    }
+}
+
+/**
+ * 切分句子，返回句子数（-1 表示内存不足）
+ */
+static int stream_split(const char *text, StreamSentence **out) {
+    int count = 0;
+    int capacity = 0;
+    StreamSentence *sentences = NULL;
+    
+    while (*text) {
+        size_t length = misaki_sentence_length(text);
+        const char *begin = text;
+        const char *end = text + length;
+        text = end;
+        
+        stream_trim(&begin, &end);
+        if (begin == end || end - begin > INT_MAX) {
+            continue;
+        }
+        
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            StreamSentence *grown = (StreamSentence *)realloc(sentences,
+                                                              capacity * sizeof(StreamSentence));
+            if (!grown) {
+                free(sentences);
                 return -1;
             }
+            sentences = grown;
+        }
+        sentences[count++] = (StreamSentence){ begin, (int)(end - begin), NULL, false };
+    }
+    
+    *out = sentences;
+    return count;
+}
+
+/**
+ * 转换输入文本中的一段（不以 '\0' 结尾）
+ */
+static char* stream_convert_span(const MisakiEngine *engine, MisakiLanguage lang,
+                                 const char *span, int length) {
+    char *text = (char *)malloc((size_t)length + 1);
+    if (!text) {
+        return NULL;
+    }
+    memcpy(text, span, (size_t)length);
+    text[length] = '\0';
+    
+    char *phonemes = engine_phonemes(engine, lang, text);
+    free(text);
+    return phonemes;
+}
+
+/**
+ * 转换已认领的句子 index（调用前已解锁，返回时已加锁）
+ */
+static void stream_convert_claimed(StreamJob *job, int index) {
+    const StreamSentence *sentence = &job->sentences[index];
+    char *phonemes = stream_convert_span(job->engine, job->lang, sentence->text, sentence->length);
+    
+    misaki_mutex_lock(&job->lock);
+    job->sentences[index].phonemes = phonemes;
+    job->sentences[index].ready = true;
+    misaki_cond_broadcast(&job->cond);
+}
+
+/**
+ * 预取线程：在调用者回调第 N 句时转换第 N+1..N+lookahead 句
+ */
+static void stream_prefetch_main(void *ctx) {
+    StreamJob *job = (StreamJob *)ctx;
+    
+    misaki_mutex_lock(&job->lock);
+    while (true) {
+        while (!job->stopped && job->next < job->count &&
+               job->next > job->delivered + job->lookahead) {
+            misaki_cond_wait(&job->cond, &job->lock);
+        }
+        if (job->stopped || job->next >= job->count) {
             break;
-            
-        default:
+        }
+        
+        int index = job->next++;
+        misaki_mutex_unlock(&job->lock);
+        stream_convert_claimed(job, index);
+    }
+    misaki_mutex_unlock(&job->lock);
+}
+
+MISAKI_API int misaki_engine_stream_convert(
+    const MisakiEngine *engine,
+    const char *text,
+    const char *lang,
+    int lookahead,
+    MisakiStreamCallback callback,
+    void *user
+) {
+    if (!engine || !text || !callback || lookahead < 0) {
+        return -1;
+    }
+    
+    StreamJob job = {
+        .engine = engine,
+        .lang = LANG_UNKNOWN,
+        .lookahead = lookahead
+    };
+    if (lang) {
+        job.lang = engine_parse_lang(lang);
+        if (job.lang == LANG_UNKNOWN) {
             return -1;
+        }
     }
     
-    if (!tokens) {
+    job.count = stream_split(text, &job.sentences);
+    if (job.count < 0) {
         return -1;
     }
     
-    // 合并音素
-    char *merged = misaki_merge_phonemes(tokens, " ");
-    if (merged) {
-        strncpy(output_buffer, merged, buffer_size - 1);
-        output_buffer[buffer_size - 1] = '\0';
-        free(merged);
-        misaki_token_list_free(tokens);
+    misaki_mutex_init(&job.lock);
+    misaki_cond_init(&job.cond);
+    
+    // 只有一句时没有可以提前转换的；线程启动失败时退化为逐句转换
+    MisakiThread *prefetch = NULL;
+    if (lookahead > 0 && job.count > 1) {
+        prefetch = misaki_thread_start(stream_prefetch_main, &job);
+    }
+    
+    int delivered = 0;
+    misaki_mutex_lock(&job.lock);
+    for (int i = 0; i < job.count; i++) {
+        StreamSentence *sentence = &job.sentences[i];
+        if (job.next == i) {
+            // 预取线程还没认领：调用线程自己转换，不干等
+            job.next++;
+            misaki_mutex_unlock(&job.lock);
+            stream_convert_claimed(&job, i);
+        }
+        while (!sentence->ready) {
+            misaki_cond_wait(&job.cond, &job.lock);
+        }
+        misaki_mutex_unlock(&job.lock);
+        
+        int stop = callback(user, i, sentence->text, sentence->length, sentence->phonemes);
+        free(sentence->phonemes);
+        sentence->phonemes = NULL;
+        delivered++;
+        
+        misaki_mutex_lock(&job.lock);
+        job.delivered = delivered;
+        if (stop) {
+            job.stopped = true;
+        }
+        misaki_cond_broadcast(&job.cond);
+        if (stop) {
+            break;
+        }
+    }
+    misaki_mutex_unlock(&job.lock);
+    
+    misaki_thread_join(prefetch);
+    
+    // 停止时已经提前转换、没有回调的句子
+    for (int i = delivered; i < job.count; i++) {
+        free(job.sentences[i].phonemes);
+    }
+    misaki_cond_destroy(&job.cond);
+    misaki_mutex_destroy(&job.lock);
+    free(job.sentences);
+    return delivered;
+}
+
+/* ============================================================================
+ * 增量输入
+ * ========================================================================== */
+
+// 默认的分句提交阈值（字节数，约 32 个汉字 / 假名）
+#define MISAKI_STREAM_CLAUSE_BYTES 96
+
+struct MisakiStream {
+    const MisakiEngine *engine;
+    MisakiLanguage lang;        // LANG_UNKNOWN 表示逐句检测
+    MisakiStreamCallback callback;
+    void *user;
+    char *buffer;               // 还没提交的输入（'\0' 结尾）
+    size_t length;
+    size_t capacity;
+    size_t clause_threshold;
+    int index;                  // 下一个回调的句子序号
+    bool stopped;               // 回调要求停止
+};
+
+MISAKI_API MisakiStream* misaki_stream_create(
+    const MisakiEngine *engine,
+    const char *lang,
+    MisakiStreamCallback callback,
+    void *user
+) {
+    if (!engine || !callback) {
+        return NULL;
+    }
+    
+    MisakiLanguage parsed = LANG_UNKNOWN;
+    if (lang) {
+        parsed = engine_parse_lang(lang);
+        if (parsed == LANG_UNKNOWN) {
+            return NULL;
+        }
+    }
+    
+    MisakiStream *stream = (MisakiStream *)calloc(1, sizeof(MisakiStream));
+    if (!stream) {
+        return NULL;
+    }
+    stream->engine = engine;
+    stream->lang = parsed;
+    stream->callback = callback;
+    stream->user = user;
+    stream->clause_threshold = MISAKI_STREAM_CLAUSE_BYTES;
+    return stream;
+}
+
+MISAKI_API void misaki_stream_set_clause_threshold(MisakiStream *stream, int bytes) {
+    if (!stream) {
+        return;
+    }
+    stream->clause_threshold = bytes > 0 ? (size_t)bytes : 0;
+}
+
+/**
+ * 去掉末尾不完整的 UTF-8 字符后的长度（片段可能在字符中间切开）
+ */
+static size_t stream_complete_length(const char *text, size_t length) {
+    for (size_t back = 1; back <= 3 && back <= length; back++) {
+        unsigned char c = (unsigned char)text[length - back];
+        if ((c & 0xC0) == 0x80) {
+            continue;   // 后续字节，继续往前找首字节
+        }
+        size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        return need > back ? length - back : length;
+    }
+    return length;
+}
+
+/**
+ * 未结束的句子够长时，在最后一个已确定的分句处提交
+ * 
+ * @return 提交的字节数（0 表示继续等待）
+ */
+static size_t stream_clause_span(const MisakiStream *stream, const char *text, size_t length) {
+    if (stream->clause_threshold == 0 || length < stream->clause_threshold) {
         return 0;
     }
     
-    misaki_token_list_free(tokens);
-    return -1;
+    size_t committed = 0;
+    while (committed < length) {
+        size_t clause = misaki_clause_length(text + committed);
+        if (committed + clause >= length) {
+            break;      // 最后一个分句还可能继续
+        }
+        committed += clause;
+    }
+    
+    if (committed == 0 && length >= stream->clause_threshold * 4) {
+        committed = length;
+    }
+    return committed;
 }
 
 /**
- * 清理
+ * 转换并回调一段（去掉首尾空白后为空时跳过）
+ * 
+ * @return 回调了返回 1，跳过返回 0
  */
-MISAKI_API void misaki_cleanup(void) {
-    if (!g_misaki.initialized) {
-        return;
+static int stream_emit(MisakiStream *stream, const char *text, size_t length) {
+    const char *begin = text;
+    const char *end = text + length;
+    stream_trim(&begin, &end);
+    if (begin == end || end - begin > INT_MAX) {
+        return 0;
     }
     
-    if (g_misaki.en_dict) {
-        misaki_en_dict_free(g_misaki.en_dict);
+    int span = (int)(end - begin);
+    char *phonemes = stream_convert_span(stream->engine, stream->lang, begin, span);
+    if (stream->callback(stream->user, stream->index++, begin, span, phonemes)) {
+        stream->stopped = true;
     }
-    if (g_misaki.zh_dict) {
-        misaki_zh_dict_free(g_misaki.zh_dict);
+    free(phonemes);
+    return 1;
+}
+
+/**
+ * 提交缓冲区中已确定的句子（final 时提交全部）
+ */
+static int stream_commit(MisakiStream *stream, bool final) {
+    if (stream->length == 0) {
+        return 0;
     }
-    if (g_misaki.zh_phrase_dict) {
-        misaki_zh_phrase_dict_free(g_misaki.zh_phrase_dict);
+    
+    // 只扫描完整的字符：临时在不完整的尾部前截断
+    size_t complete = final ? stream->length
+                            : stream_complete_length(stream->buffer, stream->length);
+    char saved = stream->buffer[complete];
+    stream->buffer[complete] = '\0';
+    
+    int emitted = 0;
+    size_t pos = 0;
+    while (pos < complete && !stream->stopped) {
+        size_t span = misaki_sentence_length(stream->buffer + pos);
+        if (!final && pos + span >= complete) {
+            // 句子还没结束（后面的文本还没到）
+            span = stream_clause_span(stream, stream->buffer + pos, complete - pos);
+            if (span == 0) {
+                break;
+            }
+        }
+        emitted += stream_emit(stream, stream->buffer + pos, span);
+        pos += span;
     }
-    if (g_misaki.zh_hmm_model) {
-        misaki_hmm_free(g_misaki.zh_hmm_model);
+    
+    stream->buffer[complete] = saved;
+    memmove(stream->buffer, stream->buffer + pos, stream->length - pos + 1);
+    stream->length -= pos;
+    return emitted;
+}
+
+MISAKI_API int misaki_stream_feed(MisakiStream *stream, const char *chunk) {
+    if (!stream || !chunk || stream->stopped) {
+        return -1;
     }
-    if (g_misaki.zh_tokenizer) {
-        misaki_zh_tokenizer_free(g_misaki.zh_tokenizer);
+    
+    size_t length = strlen(chunk);
+    if (stream->length + length + 1 > stream->capacity) {
+        size_t capacity = stream->capacity > 0 ? stream->capacity * 2 : 256;
+        while (capacity < stream->length + length + 1) {
+            capacity *= 2;
+        }
+        char *buffer = (char *)realloc(stream->buffer, capacity);
+        if (!buffer) {
+            return -1;
+        }
+        stream->buffer = buffer;
+        stream->capacity = capacity;
     }
-    if (g_misaki.ja_tokenizer) {
-        misaki_ja_tokenizer_free(g_misaki.ja_tokenizer);
+    memcpy(stream->buffer + stream->length, chunk, length + 1);
+    stream->length += length;
+    
+    return stream_commit(stream, false);
+}
+
+MISAKI_API int misaki_stream_flush(MisakiStream *stream) {
+    if (!stream || stream->stopped) {
+        return -1;
     }
-    if (g_misaki.zh_trie) {
-        misaki_trie_free(g_misaki.zh_trie);
+    
+    int emitted = stream_commit(stream, true);
+    stream->length = 0;
+    return emitted;
+}
+
+MISAKI_API void misaki_stream_free(MisakiStream *stream) {
+    if (!stream) {
+        return;
     }
-    if (g_misaki.ja_trie) {
-        misaki_trie_free(g_misaki.ja_trie);
+    
+    free(stream->buffer);
+    free(stream);
+}
+
+MISAKI_API void misaki_free_buffer(char *buffer) {
+    free(buffer);
+}
+
+/* ============================================================================
+ * 旧 API（默认引擎）
+ * ========================================================================== */
+
+/**
+ * 初始化 Misaki G2P 引擎
+ */
+MISAKI_API int misaki_init(const char *data_dir) {
+    if (g_engine) {
+        return 0;  // 已初始化
     }
-    if (g_misaki.lang_detector) {
-        misaki_lang_detector_free(g_misaki.lang_detector);
+    
+    g_engine = misaki_engine_create(data_dir);
+    return g_engine ? 0 : -1;
+}
+
+/**
+ * 文本转音素（自动检测语言）
+ */
+MISAKI_API int misaki_text_to_phonemes(
+    const char *text,
+    char *output_buffer,
+    int buffer_size
+) {
+    return misaki_engine_text_to_phonemes(g_engine, text, output_buffer, buffer_size);
+}
+
+/**
+ * 文本转音素（指定语言）
+ */
+MISAKI_API int misaki_text_to_phonemes_lang(
+    const char *text,
+    const char *lang,
+    char *output_buffer,
+    int buffer_size
+) {
+    return misaki_engine_text_to_phonemes_lang(g_engine, text, lang, output_buffer, buffer_size);
+}
+
+/**
+ * 批量文本转音素
+ */
+MISAKI_API int misaki_text_to_phonemes_batch(
+    const char *const *texts,
+    int count,
+    const char *lang,
+    char **output,
+    int *offsets
+) {
+    return misaki_engine_text_to_phonemes_batch(g_engine, texts, count, lang, 0, output, offsets);
+}
+
+/**
+ * 文本转模型输入 ID
+ */
+MISAKI_API int misaki_text_to_ids(
+    const char *text,
+    const char *lang,
+    int64_t *ids,
+    int max_ids,
+    int *chunk_lengths,
+    int max_chunks
+) {
+    return misaki_engine_text_to_ids(g_engine, text, lang, 0, ids, max_ids,
+                                     chunk_lengths, max_chunks);
+}
+
+/**
+ * 流式文本转音素
+ */
+MISAKI_API int misaki_stream_convert(
+    const char *text,
+    MisakiStreamCallback callback,
+    void *user
+) {
+    return misaki_engine_stream_convert(g_engine, text, NULL, 1, callback, user);
+}
+
+/**
+ * 清理
+ */
+MISAKI_API void misaki_cleanup(void) {
+    if (!g_engine) {
+        return;
     }
     
+    misaki_engine_free(g_engine);
+    g_engine = NULL;
+    
     // 清理昆雅语 G2P
     misaki_g2p_qya_cleanup();
     misaki_tokenizer_qya_cleanup();
-    
-    memset(&g_misaki, 0, sizeof(g_misaki));
 }
 
 /**
@@ -0,0 +1,243 @@
+/**
+ * misaki_arena.c
+ * 
+ * Misaki C Port - Arena Allocator Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// 默认块大小
+#define MISAKI_ARENA_DEFAULT_CHUNK (16 * 1024)
+
+// 对齐（与 malloc 保持一致）
+#define MISAKI_ARENA_ALIGN (_Alignof(max_align_t))
+
+// 块头大小（向上对齐，保证数据区对齐）
+#define MISAKI_ARENA_HEADER \
+    ((sizeof(MisakiArenaChunk) + MISAKI_ARENA_ALIGN - 1) & ~(MISAKI_ARENA_ALIGN - 1))
+
+/* ============================================================================
+ * 内部函数
+ * ========================================================================== */
+
+static inline unsigned char* chunk_data(MisakiArenaChunk *chunk) {
+    return (unsigned char *)chunk + MISAKI_ARENA_HEADER;
+}
+
+static MisakiArenaChunk* chunk_create(size_t size) {
+    MisakiArenaChunk *chunk = (MisakiArenaChunk *)malloc(MISAKI_ARENA_HEADER + size);
+    if (!chunk) {
+        return NULL;
+    }
+    
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+/* ============================================================================
+ * 区域分配器操作实现
+ * ========================================================================== */
+
+MisakiArena* misaki_arena_create(size_t chunk_size) {
+    MisakiArena *arena = (MisakiArena *)calloc(1, sizeof(MisakiArena));
+    if (!arena) {
+        return NULL;
+    }
+    
+    arena->chunk_size = chunk_size > 0 ? chunk_size : MISAKI_ARENA_DEFAULT_CHUNK;
+    return arena;
+}
+
+void misaki_arena_free(MisakiArena *arena) {
+    if (!arena) {
+        return;
+    }
+    
+    MisakiArenaChunk *chunk = arena->head;
+    while (chunk) {
+        MisakiArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    
+    free(arena);
+}
+
+void misaki_arena_reset(MisakiArena *arena) {
+    if (!arena || !arena->head) {
+        return;
+    }
+    
+    // 只保留当前块（通常也是最大的块）
+    MisakiArenaChunk *chunk = arena->head->next;
+    while (chunk) {
+        MisakiArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    
+    arena->head->next = NULL;
+    arena->head->used = 0;
+}
+
+void* misaki_arena_alloc(MisakiArena *arena, size_t size) {
+    if (!arena) {
+        return NULL;
+    }
+    
+    size_t aligned = (size + MISAKI_ARENA_ALIGN - 1) & ~(MISAKI_ARENA_ALIGN - 1);
+    if (aligned == 0) {
+        aligned = MISAKI_ARENA_ALIGN;
+    }
+    
+    MisakiArenaChunk *chunk = arena->head;
+    if (!chunk || chunk->size - chunk->used < aligned) {
+        size_t chunk_size = arena->chunk_size;
+        while (chunk_size < aligned) {
+            chunk_size *= 2;
+        }
+        
+        MisakiArenaChunk *new_chunk = chunk_create(chunk_size);
+        if (!new_chunk) {
+            return NULL;
+        }
+        new_chunk->next = chunk;
+        arena->head = new_chunk;
+        chunk = new_chunk;
+    }
+    
+    void *ptr = chunk_data(chunk) + chunk->used;
+    chunk->used += aligned;
+    memset(ptr, 0, aligned);
+    return ptr;
+}
+
+char* misaki_arena_strdup(MisakiArena *arena, const char *str) {
+    if (!str) {
+        return NULL;
+    }
+    
+    size_t len = strlen(str);
+    char *dup = (char *)misaki_arena_alloc(arena, len + 1);
+    if (dup) {
+        memcpy(dup, str, len + 1);
+    }
+    return dup;
+}
+
+size_t misaki_arena_used(const MisakiArena *arena) {
+    if (!arena) {
+        return 0;
+    }
+    
+    size_t used = 0;
+    for (const MisakiArenaChunk *chunk = arena->head; chunk; chunk = chunk->next) {
+        used += chunk->used;
+    }
+    return used;
+}
+
+/* ============================================================================
+ * 字符串池实现
+ * ========================================================================== */
+
+// 初始槽数（2 的幂）
+#define MISAKI_STRING_POOL_INITIAL 256
+
+static uint32_t string_pool_hash(const char *str) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * 扩容并重新放置所有字符串（负载超过 1/2 时）
+ */
+static bool string_pool_grow(MisakiStringPool *pool) {
+    size_t capacity = pool->capacity > 0 ? pool->capacity * 2 : MISAKI_STRING_POOL_INITIAL;
+    const char **slots = (const char **)calloc(capacity, sizeof(const char *));
+    if (!slots) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < pool->capacity; i++) {
+        const char *str = pool->slots[i];
+        if (!str) {
+            continue;
+        }
+        size_t slot = string_pool_hash(str) & (capacity - 1);
+        while (slots[slot]) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        slots[slot] = str;
+    }
+    
+    free(pool->slots);
+    pool->slots = slots;
+    pool->capacity = capacity;
+    return true;
+}
+
+MisakiStringPool* misaki_string_pool_create(void) {
+    MisakiStringPool *pool = (MisakiStringPool *)calloc(1, sizeof(MisakiStringPool));
+    if (!pool) {
+        return NULL;
+    }
+    
+    pool->arena = misaki_arena_create(0);
+    if (!pool->arena || !string_pool_grow(pool)) {
+        misaki_string_pool_free(pool);
+        return NULL;
+    }
+    
+    return pool;
+}
+
+void misaki_string_pool_free(MisakiStringPool *pool) {
+    if (!pool) {
+        return;
+    }
+    
+    misaki_arena_free(pool->arena);
+    free(pool->slots);
+    free(pool);
+}
+
+const char* misaki_string_pool_intern(MisakiStringPool *pool, const char *str) {
+    if (!pool || !str) {
+        return NULL;
+    }
+    
+    if ((pool->count + 1) * 2 > pool->capacity && !string_pool_grow(pool)) {
+        return NULL;
+    }
+    
+    size_t slot = string_pool_hash(str) & (pool->capacity - 1);
+    while (pool->slots[slot]) {
+        if (strcmp(pool->slots[slot], str) == 0) {
+            return pool->slots[slot];
+        }
+        slot = (slot + 1) & (pool->capacity - 1);
+    }
+    
+    char *dup = misaki_arena_strdup(pool->arena, str);
+    if (!dup) {
+        return NULL;
+    }
+    
+    pool->slots[slot] = dup;
+    pool->count++;
+    return dup;
+}
@@ -0,0 +1,893 @@
+/**
+ * misaki_cache.c
+ * 
+ * Misaki C Port - LRU Cache Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 分片数上限（2 的幂）
+#define CACHE_MAX_SHARDS 16
+
+// 每个分片至少分到的容量（容量不足时减少分片数）
+#define CACHE_MIN_SHARD_CAPACITY 64
+
+/* ============================================================================
+ * 内部函数
+ * ========================================================================== */
+
+static uint64_t cache_hash(const char *key) {
+    // FNV-1a (64 位)
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ull;
+    }
+    
+    // 短键的高位分布不均（分片用高位），再做一次混合
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint64_t cache_now_ms(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+static void* cache_memdup(const void *value, size_t size) {
+    void *copy = malloc(size > 0 ? size : 1);
+    if (copy && size > 0) {
+        memcpy(copy, value, size);
+    }
+    return copy;
+}
+
+/**
+ * 分片用哈希的高位，桶用低位
+ */
+static inline CacheShard* cache_shard(const LRUCache *cache, uint64_t hash) {
+    return &cache->shards[(hash >> 32) & (uint64_t)(cache->shard_count - 1)];
+}
+
+static inline CacheEntry** shard_bucket(CacheShard *shard, uint64_t hash) {
+    return &shard->table[hash & (uint64_t)(shard->table_size - 1)];
+}
+
+static CacheEntry* shard_find(CacheShard *shard, const char *key, uint64_t hash) {
+    for (CacheEntry *entry = *shard_bucket(shard, hash); entry; entry = entry->chain) {
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void shard_list_unlink(CacheShard *shard, CacheEntry *entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        shard->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        shard->tail = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void shard_list_push_front(CacheShard *shard, CacheEntry *entry) {
+    entry->prev = NULL;
+    entry->next = shard->head;
+    if (shard->head) {
+        shard->head->prev = entry;
+    } else {
+        shard->tail = entry;
+    }
+    shard->head = entry;
+}
+
+static void entry_free_value(CacheEntry *entry, void (*value_free)(void*)) {
+    if (entry->owned) {
+        free(entry->value);
+    } else if (value_free && entry->value) {
+        value_free(entry->value);
+    }
+    entry->value = NULL;
+}
+
+/**
+ * 从分片中删除条目并释放
+ */
+static void shard_remove(CacheShard *shard, CacheEntry *entry, void (*value_free)(void*)) {
+    CacheEntry **link = shard_bucket(shard, entry->hash);
+    while (*link != entry) {
+        link = &(*link)->chain;
+    }
+    *link = entry->chain;
+    shard_list_unlink(shard, entry);
+    
+    size_t key_size = strlen(entry->key) + 1;
+    shard->count--;
+    shard->key_bytes -= key_size;
+    shard->memory_used -= key_size + entry->value_size;
+    
+    entry_free_value(entry, value_free);
+    free(entry->key);
+    free(entry);
+}
+
+static bool entry_expired(const LRUCache *cache, const CacheEntry *entry, uint64_t now) {
+    return cache->ttl_seconds > 0 &&
+           now - entry->insert_time >= (uint64_t)cache->ttl_seconds * 1000;
+}
+
+/**
+ * 选出要淘汰的条目（LRU/FIFO 为链表尾；LFU 为访问次数最少的，次数相同取较旧的）
+ */
+static CacheEntry* shard_victim(const LRUCache *cache, CacheShard *shard) {
+    if (cache->policy != CACHE_EVICT_LFU) {
+        return shard->tail;
+    }
+    
+    CacheEntry *victim = shard->tail;
+    for (CacheEntry *entry = shard->tail; entry; entry = entry->prev) {
+        if (entry->access_count < victim->access_count) {
+            victim = entry;
+        }
+    }
+    return victim;
+}
+
+/**
+ * 查找条目（更新统计、访问顺序；过期的条目会被删除）
+ */
+static CacheEntry* shard_lookup(const LRUCache *cache, CacheShard *shard,
+                                const char *key, uint64_t hash) {
+    CacheEntry *entry = shard_find(shard, key, hash);
+    uint64_t now = entry ? cache_now_ms() : 0;
+    
+    if (entry && entry_expired(cache, entry, now)) {
+        shard_remove(shard, entry, cache->value_free);
+        entry = NULL;
+    }
+    
+    if (!entry) {
+        shard->miss_count++;
+        return NULL;
+    }
+    
+    shard->hit_count++;
+    entry->access_time = now;
+    entry->access_count++;
+    if (cache->policy != CACHE_EVICT_FIFO && shard->head != entry) {
+        shard_list_unlink(shard, entry);
+        shard_list_push_front(shard, entry);
+    }
+    return entry;
+}
+
+/**
+ * 插入或更新条目（必要时淘汰旧条目）
+ * 
+ * 失败时 value 的所有权仍归调用者
+ */
+static bool shard_insert(const LRUCache *cache, CacheShard *shard, const char *key,
+                         uint64_t hash, void *value, size_t value_size, bool owned) {
+    size_t key_size = strlen(key) + 1;
+    if (shard->memory_limit > 0 && key_size + value_size > shard->memory_limit) {
+        return false;
+    }
+    
+    CacheEntry *entry = shard_find(shard, key, hash);
+    if (entry) {
+        shard_remove(shard, entry, cache->value_free);
+    }
+    
+    while (shard->tail && (shard->count >= shard->capacity ||
+           (shard->memory_limit > 0 &&
+            shard->memory_used + key_size + value_size > shard->memory_limit))) {
+        shard_remove(shard, shard_victim(cache, shard), cache->value_free);
+    }
+    
+    entry = (CacheEntry *)calloc(1, sizeof(CacheEntry));
+    char *key_copy = entry ? (char *)malloc(key_size) : NULL;
+    if (!key_copy) {
+        free(entry);
+        return false;
+    }
+    memcpy(key_copy, key, key_size);
+    
+    entry->key = key_copy;
+    entry->hash = hash;
+    entry->value = value;
+    entry->value_size = value_size;
+    entry->owned = owned;
+    entry->insert_time = cache_now_ms();
+    entry->access_time = entry->insert_time;
+    
+    CacheEntry **bucket = shard_bucket(shard, hash);
+    entry->chain = *bucket;
+    *bucket = entry;
+    shard_list_push_front(shard, entry);
+    
+    shard->count++;
+    shard->key_bytes += key_size;
+    shard->memory_used += key_size + value_size;
+    return true;
+}
+
+/**
+ * 查询并用 copy 复制值（复制在持锁时完成）
+ */
+static void* cache_get_with(LRUCache *cache, const char *key,
+                            void* (*copy)(const void*, size_t), size_t *value_size) {
+    if (!cache || !key) {
+        return NULL;
+    }
+    
+    uint64_t hash = cache_hash(key);
+    CacheShard *shard = cache_shard(cache, hash);
+    
+    misaki_mutex_lock(&shard->lock);
+    CacheEntry *entry = shard_lookup(cache, shard, key, hash);
+    void *result = NULL;
+    if (entry) {
+        result = copy(entry->value, entry->value_size);
+        if (result && value_size) {
+            *value_size = entry->value_size;
+        }
+    }
+    misaki_mutex_unlock(&shard->lock);
+    
+    return result;
+}
+
+/* ============================================================================
+ * Cache 操作实现
+ * ========================================================================== */
+
+LRUCache* misaki_cache_create(int capacity, size_t memory_limit) {
+    if (capacity <= 0) {
+        return NULL;
+    }
+    
+    LRUCache *cache = (LRUCache *)calloc(1, sizeof(LRUCache));
+    if (!cache) {
+        return NULL;
+    }
+    
+    int shard_count = 1;
+    while (shard_count < CACHE_MAX_SHARDS &&
+           capacity / (shard_count * 2) >= CACHE_MIN_SHARD_CAPACITY) {
+        shard_count *= 2;
+    }
+    
+    cache->shards = (CacheShard *)calloc((size_t)shard_count, sizeof(CacheShard));
+    if (!cache->shards) {
+        free(cache);
+        return NULL;
+    }
+    cache->shard_count = shard_count;
+    cache->capacity = capacity;
+    cache->memory_limit = memory_limit;
+    cache->policy = CACHE_EVICT_LRU;
+    
+    int shard_capacity = (capacity + shard_count - 1) / shard_count;
+    int table_size = 16;
+    while (table_size < shard_capacity * 2) {
+        table_size *= 2;
+    }
+    
+    for (int i = 0; i < shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        misaki_mutex_init(&shard->lock);
+        misaki_cond_init(&shard->flight_done);
+        shard->capacity = shard_capacity;
+        shard->memory_limit = memory_limit > 0 ? (memory_limit + shard_count - 1) / shard_count : 0;
+        shard->table_size = table_size;
+        shard->table = (CacheEntry **)calloc((size_t)table_size, sizeof(CacheEntry *));
+        if (!shard->table) {
+            cache->shard_count = i + 1;
+            misaki_cache_free(cache, NULL);
+            return NULL;
+        }
+    }
+    
+    return cache;
+}
+
+void misaki_cache_free(LRUCache *cache, void (*value_free)(void*)) {
+    if (!cache) {
+        return;
+    }
+    
+    misaki_cache_clear(cache, value_free);
+    for (int i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        free(shard->table);
+        misaki_cond_destroy(&shard->flight_done);
+        misaki_mutex_destroy(&shard->lock);
+    }
+    
+    free(cache->shards);
+    free(cache);
+}
+
+bool misaki_cache_put(LRUCache *cache,
+                      const char *key,
+                      void *value,
+                      size_t value_size,
+                      bool copy) {
+    if (!cache || !key) {
+        return false;
+    }
+    
+    void *stored = value;
+    if (copy) {
+        stored = cache_memdup(value, value_size);
+        if (!stored) {
+            return false;
+        }
+    }
+    
+    uint64_t hash = cache_hash(key);
+    CacheShard *shard = cache_shard(cache, hash);
+    
+    misaki_mutex_lock(&shard->lock);
+    bool ok = shard_insert(cache, shard, key, hash, stored, value_size, copy);
+    misaki_mutex_unlock(&shard->lock);
+    
+    if (!ok && copy) {
+        free(stored);
+    }
+    return ok;
+}
+
+void* misaki_cache_get(LRUCache *cache, const char *key) {
+    if (!cache || !key) {
+        return NULL;
+    }
+    
+    uint64_t hash = cache_hash(key);
+    CacheShard *shard = cache_shard(cache, hash);
+    
+    misaki_mutex_lock(&shard->lock);
+    CacheEntry *entry = shard_lookup(cache, shard, key, hash);
+    void *value = entry ? entry->value : NULL;
+    misaki_mutex_unlock(&shard->lock);
+    
+    return value;
+}
+
+void* misaki_cache_get_copy(LRUCache *cache, const char *key, size_t *value_size) {
+    return cache_get_with(cache, key, cache_memdup, value_size);
+}
+
+void* misaki_cache_get_or_compute(LRUCache *cache,
+                                  const char *key,
+                                  CacheComputeFn compute,
+                                  void *ctx,
+                                  size_t *value_size) {
+    if (!cache || !key || !compute) {
+        return NULL;
+    }
+    
+    uint64_t hash = cache_hash(key);
+    CacheShard *shard = cache_shard(cache, hash);
+    void *result = NULL;
+    size_t size = 0;
+    
+    misaki_mutex_lock(&shard->lock);
+    
+    CacheEntry *entry = shard_lookup(cache, shard, key, hash);
+    if (entry) {
+        result = cache_memdup(entry->value, entry->value_size);
+        size = entry->value_size;
+        misaki_mutex_unlock(&shard->lock);
+        if (result && value_size) {
+            *value_size = size;
+        }
+        return result;
+    }
+    
+    // 已有线程在计算同一个键：等它完成，复制它的结果
+    for (CacheFlight *flight = shard->flights; flight; flight = flight->next) {
+        if (flight->hash != hash || strcmp(flight->key, key) != 0) {
+            continue;
+        }
+        
+        flight->waiters++;
+        while (!flight->done) {
+            misaki_cond_wait(&shard->flight_done, &shard->lock);
+        }
+        if (flight->value) {
+            result = cache_memdup(flight->value, flight->value_size);
+            size = flight->value_size;
+        }
+        if (--flight->waiters == 0) {
+            free(flight->value);
+            free(flight->key);
+            free(flight);
+        }
+        misaki_mutex_unlock(&shard->lock);
+        if (result && value_size) {
+            *value_size = size;
+        }
+        return result;
+    }
+    
+    // 由本线程计算
+    CacheFlight *flight = (CacheFlight *)calloc(1, sizeof(CacheFlight));
+    char *flight_key = flight ? strdup(key) : NULL;
+    if (flight_key) {
+        flight->key = flight_key;
+        flight->hash = hash;
+        flight->next = shard->flights;
+        shard->flights = flight;
+    } else {
+        free(flight);
+        flight = NULL;
+    }
+    misaki_mutex_unlock(&shard->lock);
+    
+    result = compute(ctx, &size);
+    
+    misaki_mutex_lock(&shard->lock);
+    if (result) {
+        void *stored = cache_memdup(result, size);
+        if (stored && !shard_insert(cache, shard, key, hash, stored, size, true)) {
+            free(stored);
+        }
+    }
+    
+    if (flight) {
+        CacheFlight **link = &shard->flights;
+        while (*link != flight) {
+            link = &(*link)->next;
+        }
+        *link = flight->next;
+        
+        if (flight->waiters > 0) {
+            if (result) {
+                flight->value = cache_memdup(result, size);
+                flight->value_size = size;
+            }
+            flight->done = true;
+            misaki_cond_broadcast(&shard->flight_done);
+        } else {
+            free(flight->key);
+            free(flight);
+        }
+    }
+    misaki_mutex_unlock(&shard->lock);
+    
+    if (result && value_size) {
+        *value_size = size;
+    }
+    return result;
+}
+
+bool misaki_cache_remove(LRUCache *cache,
+                         const char *key,
+                         void (*value_free)(void*)) {
+    if (!cache || !key) {
+        return false;
+    }
+    
+    uint64_t hash = cache_hash(key);
+    CacheShard *shard = cache_shard(cache, hash);
+    
+    misaki_mutex_lock(&shard->lock);
+    CacheEntry *entry = shard_find(shard, key, hash);
+    if (entry) {
+        shard_remove(shard, entry, value_free ? value_free : cache->value_free);
+    }
+    misaki_mutex_unlock(&shard->lock);
+    
+    return entry != NULL;
+}
+
+void misaki_cache_clear(LRUCache *cache, void (*value_free)(void*)) {
+    if (!cache) {
+        return;
+    }
+    
+    if (!value_free) {
+        value_free = cache->value_free;
+    }
+    
+    for (int i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        misaki_mutex_lock(&shard->lock);
+        while (shard->head) {
+            shard_remove(shard, shard->head, value_free);
+        }
+        misaki_mutex_unlock(&shard->lock);
+    }
+}
+
+bool misaki_cache_contains(const LRUCache *cache, const char *key) {
+    if (!cache || !key) {
+        return false;
+    }
+    
+    uint64_t hash = cache_hash(key);
+    CacheShard *shard = cache_shard(cache, hash);
+    
+    misaki_mutex_lock(&shard->lock);
+    CacheEntry *entry = shard_find(shard, key, hash);
+    bool found = entry && !entry_expired(cache, entry, cache_now_ms());
+    misaki_mutex_unlock(&shard->lock);
+    
+    return found;
+}
+
+/* ============================================================================
+ * 分词结果缓存实现
+ * ========================================================================== */
+
+static MisakiTokenList* token_list_clone(const MisakiTokenList *tokens) {
+    MisakiTokenList *clone = misaki_token_list_create();
+    if (!clone) {
+        return NULL;
+    }
+    
+    for (int i = 0; i < tokens->count; i++) {
+        if (!misaki_token_list_add(clone, &tokens->tokens[i])) {
+            misaki_token_list_free(clone);
+            return NULL;
+        }
+    }
+    return clone;
+}
+
+static void* token_list_copy_value(const void *value, size_t value_size) {
+    (void)value_size;
+    return token_list_clone((const MisakiTokenList *)value);
+}
+
+static void token_list_free_value(void *value) {
+    misaki_token_list_free((MisakiTokenList *)value);
+}
+
+TokenizerCache* misaki_tokenizer_cache_create(int capacity) {
+    TokenizerCache *cache = (TokenizerCache *)calloc(1, sizeof(TokenizerCache));
+    if (!cache) {
+        return NULL;
+    }
+    
+    cache->cache = misaki_cache_create(capacity, 0);
+    if (!cache->cache) {
+        free(cache);
+        return NULL;
+    }
+    misaki_cache_set_value_free(cache->cache, token_list_free_value);
+    return cache;
+}
+
+void misaki_tokenizer_cache_free(TokenizerCache *cache) {
+    if (!cache) {
+        return;
+    }
+    
+    misaki_cache_free(cache->cache, token_list_free_value);
+    free(cache);
+}
+
+bool misaki_tokenizer_cache_put(TokenizerCache *cache,
+                                 const char *text,
+                                 const MisakiTokenList *tokens) {
+    if (!cache || !text || !tokens) {
+        return false;
+    }
+    
+    MisakiTokenList *clone = token_list_clone(tokens);
+    if (!clone) {
+        return false;
+    }
+    
+    // 内存统计按 Token 数估算
+    size_t value_size = sizeof(MisakiTokenList) + (size_t)clone->count * sizeof(MisakiToken);
+    if (!misaki_cache_put(cache->cache, text, clone, value_size, false)) {
+        misaki_token_list_free(clone);
+        return false;
+    }
+    return true;
+}
+
+MisakiTokenList* misaki_tokenizer_cache_get(TokenizerCache *cache,
+                                             const char *text) {
+    if (!cache) {
+        return NULL;
+    }
+    return (MisakiTokenList *)cache_get_with(cache->cache, text, token_list_copy_value, NULL);
+}
+
+/* ============================================================================
+ * G2P 结果缓存实现
+ * ========================================================================== */
+
+/**
+ * 组合键：语言、选项位图、文本（用 0x1F 分隔）
+ */
+static char* g2p_cache_key(const char *text, const char *lang, const G2POptions *options) {
+    G2POptions defaults;
+    if (!options) {
+        defaults = misaki_g2p_default_options();
+        options = &defaults;
+    }
+    
+    const bool flags[] = {
+        options->normalize_text, options->remove_punctuation, options->output_separators,
+        options->zh_tone_sandhi, options->zh_erhua, options->zh_neutral_tone,
+        options->ja_accent, options->ja_long_vowel,
+        options->en_use_gb, options->en_syllable_boundary,
+    };
+    unsigned int bits = 0;
+    for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        bits |= (unsigned int)flags[i] << i;
+    }
+    
+    size_t size = strlen(lang) + strlen(text) + 16;
+    char *key = (char *)malloc(size);
+    if (key) {
+        snprintf(key, size, "%s\x1f%x\x1f%s", lang, bits, text);
+    }
+    return key;
+}
+
+typedef struct {
+    MisakiStore *store;
+    const char *key;
+    G2PComputeFn compute;
+    void *ctx;
+} G2PCompute;
+
+/**
+ * 内存中未命中：先查持久化存储，没有时计算并追加到存储
+ */
+static void* g2p_cache_compute(void *ctx, size_t *value_size) {
+    G2PCompute *g2p = (G2PCompute *)ctx;
+    char *phonemes = misaki_store_get(g2p->store, g2p->key);
+    if (!phonemes) {
+        phonemes = g2p->compute(g2p->ctx);
+        if (phonemes) {
+            misaki_store_put(g2p->store, g2p->key, phonemes);
+        }
+    }
+    if (phonemes) {
+        *value_size = strlen(phonemes) + 1;
+    }
+    return phonemes;
+}
+
+G2PCache* misaki_g2p_cache_create(int capacity) {
+    G2PCache *cache = (G2PCache *)calloc(1, sizeof(G2PCache));
+    if (!cache) {
+        return NULL;
+    }
+    
+    cache->cache = misaki_cache_create(capacity, 0);
+    if (!cache->cache) {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void misaki_g2p_cache_set_store(G2PCache *cache, MisakiStore *store) {
+    if (cache) {
+        cache->store = store;
+    }
+}
+
+void misaki_g2p_cache_free(G2PCache *cache) {
+    if (!cache) {
+        return;
+    }
+    
+    misaki_cache_free(cache->cache, NULL);
+    free(cache);
+}
+
+bool misaki_g2p_cache_put(G2PCache *cache,
+                          const char *text,
+                          const char *lang,
+                          const G2POptions *options,
+                          const char *phonemes) {
+    if (!cache || !text || !lang || !phonemes) {
+        return false;
+    }
+    
+    char *key = g2p_cache_key(text, lang, options);
+    if (!key) {
+        return false;
+    }
+    
+    bool ok = misaki_cache_put(cache->cache, key, (void *)phonemes, strlen(phonemes) + 1, true);
+    if (ok && cache->store) {
+        misaki_store_put(cache->store, key, phonemes);
+    }
+    free(key);
+    return ok;
+}
+
+char* misaki_g2p_cache_get(G2PCache *cache,
+                           const char *text,
+                           const char *lang,
+                           const G2POptions *options) {
+    if (!cache || !text || !lang) {
+        return NULL;
+    }
+    
+    char *key = g2p_cache_key(text, lang, options);
+    if (!key) {
+        return NULL;
+    }
+    
+    char *phonemes = (char *)misaki_cache_get_copy(cache->cache, key, NULL);
+    if (!phonemes && cache->store) {
+        phonemes = misaki_store_get(cache->store, key);
+        if (phonemes) {
+            misaki_cache_put(cache->cache, key, phonemes, strlen(phonemes) + 1, true);
+        }
+    }
+    free(key);
+    return phonemes;
+}
+
+char* misaki_g2p_cache_get_or_compute(G2PCache *cache,
+                                      const char *text,
+                                      const char *lang,
+                                      const G2POptions *options,
+                                      G2PComputeFn compute,
+                                      void *ctx) {
+    if (!cache || !text || !lang || !compute) {
+        return NULL;
+    }
+    
+    char *key = g2p_cache_key(text, lang, options);
+    if (!key) {
+        return NULL;
+    }
+    
+    G2PCompute g2p = { cache->store, key, compute, ctx };
+    char *phonemes = (char *)misaki_cache_get_or_compute(cache->cache, key, g2p_cache_compute,
+                                                         &g2p, NULL);
+    free(key);
+    return phonemes;
+}
+
+/* ============================================================================
+ * 缓存统计实现
+ * ========================================================================== */
+
+void misaki_cache_get_stats(const LRUCache *cache, CacheStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(CacheStats));
+    if (!cache) {
+        return;
+    }
+    
+    size_t key_bytes = 0;
+    for (int i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        misaki_mutex_lock(&shard->lock);
+        stats->count += shard->count;
+        stats->memory_used += shard->memory_used;
+        stats->hit_count += shard->hit_count;
+        stats->miss_count += shard->miss_count;
+        key_bytes += shard->key_bytes;
+        misaki_mutex_unlock(&shard->lock);
+    }
+    
+    stats->capacity = cache->capacity;
+    stats->memory_limit = cache->memory_limit;
+    
+    uint64_t lookups = stats->hit_count + stats->miss_count;
+    stats->hit_rate = lookups > 0 ? (double)stats->hit_count / (double)lookups : 0.0;
+    
+    if (stats->count > 0) {
+        stats->avg_key_size = (int)(key_bytes / (size_t)stats->count);
+        stats->avg_value_size = (int)((stats->memory_used - key_bytes) / (size_t)stats->count);
+    }
+}
+
+void misaki_cache_print_stats(const LRUCache *cache) {
+    CacheStats stats;
+    misaki_cache_get_stats(cache, &stats);
+    
+    printf("Cache Statistics:\n");
+    printf("  Entries: %d / %d\n", stats.count, stats.capacity);
+    printf("  Memory: %zu bytes", stats.memory_used);
+    if (stats.memory_limit > 0) {
+        printf(" / %zu bytes", stats.memory_limit);
+    }
+    printf("\n");
+    printf("  Hits: %llu, Misses: %llu, Hit rate: %.2f%%\n",
+           (unsigned long long)stats.hit_count, (unsigned long long)stats.miss_count,
+           stats.hit_rate * 100);
+    printf("  Avg key size: %d bytes, Avg value size: %d bytes\n",
+           stats.avg_key_size, stats.avg_value_size);
+}
+
+void misaki_cache_reset_stats(LRUCache *cache) {
+    if (!cache) {
+        return;
+    }
+    
+    for (int i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        misaki_mutex_lock(&shard->lock);
+        shard->hit_count = 0;
+        shard->miss_count = 0;
+        misaki_mutex_unlock(&shard->lock);
+    }
+}
+
+/* ============================================================================
+ * 缓存策略配置实现
+ * ========================================================================== */
+
+void misaki_cache_set_evict_policy(LRUCache *cache, CacheEvictPolicy policy) {
+    if (cache) {
+        cache->policy = policy;
+    }
+}
+
+void misaki_cache_set_ttl(LRUCache *cache, int ttl_seconds) {
+    if (cache) {
+        cache->ttl_seconds = ttl_seconds > 0 ? ttl_seconds : 0;
+    }
+}
+
+int misaki_cache_expire(LRUCache *cache, void (*value_free)(void*)) {
+    if (!cache || cache->ttl_seconds <= 0) {
+        return 0;
+    }
+    
+    if (!value_free) {
+        value_free = cache->value_free;
+    }
+    
+    int expired = 0;
+    uint64_t now = cache_now_ms();
+    for (int i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        misaki_mutex_lock(&shard->lock);
+        CacheEntry *entry = shard->head;
+        while (entry) {
+            CacheEntry *next = entry->next;
+            if (entry_expired(cache, entry, now)) {
+                shard_remove(shard, entry, value_free);
+                expired++;
+            }
+            entry = next;
+        }
+        misaki_mutex_unlock(&shard->lock);
+    }
+    return expired;
+}
+
+void misaki_cache_set_value_free(LRUCache *cache, void (*value_free)(void*)) {
+    if (cache) {
+        cache->value_free = value_free;
+    }
+}
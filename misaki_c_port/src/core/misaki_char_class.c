@@ -0,0 +1,149 @@
+/**
+ * misaki_char_class.c
+ * 
+ * Misaki C Port - Character Class Table Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_char_class.h"
+#include <stddef.h>
+
+/* ============================================================================
+ * 类别参数
+ * ========================================================================== */
+
+// 与 MeCab (IPADIC) 的 char.def 基本一致，以下几类为了 TTS 做了调整：
+//   SYMBOL   不合并：标点是韵律边界，需要单独成词
+//   HIRAGANA 不合并：避免把未登录的平假名和助词连成一块
+//   KANJI    只生成单字节点（同原来的行为）
+//   KATAKANA 只合并，不额外生成短节点（外来语整体作为一个节点）
+static const MisakiCharCategory CHAR_CATEGORIES[MISAKI_CHAR_CLASS_COUNT] = {
+    [MISAKI_CHAR_DEFAULT]      = { "DEFAULT",      false, true,  0 },
+    [MISAKI_CHAR_SPACE]        = { "SPACE",        false, true,  0 },
+    [MISAKI_CHAR_KANJI]        = { "KANJI",        false, false, 1 },
+    [MISAKI_CHAR_SYMBOL]       = { "SYMBOL",       false, false, 1 },
+    [MISAKI_CHAR_NUMERIC]      = { "NUMERIC",      true,  true,  0 },
+    [MISAKI_CHAR_ALPHA]        = { "ALPHA",        true,  true,  0 },
+    [MISAKI_CHAR_HIRAGANA]     = { "HIRAGANA",     false, false, 1 },
+    [MISAKI_CHAR_KATAKANA]     = { "KATAKANA",     true,  true,  0 },
+    [MISAKI_CHAR_KANJINUMERIC] = { "KANJINUMERIC", true,  true,  0 },
+    [MISAKI_CHAR_GREEK]        = { "GREEK",        true,  true,  0 },
+    [MISAKI_CHAR_CYRILLIC]     = { "CYRILLIC",     true,  true,  0 },
+};
+
+/* ============================================================================
+ * 码点 → 类别表
+ * ========================================================================== */
+
+typedef struct {
+    uint32_t first;            // 起始码点
+    uint32_t last;             // 结束码点（含）
+    uint8_t char_class;        // 类别
+} CharRange;
+
+// 按码点排序、互不重叠（二分查找）；未列出的码点为 DEFAULT
+static const CharRange CHAR_RANGES[] = {
+    { 0x0009, 0x000D, MISAKI_CHAR_SPACE },
+    { 0x0020, 0x0020, MISAKI_CHAR_SPACE },
+    { 0x0021, 0x002F, MISAKI_CHAR_SYMBOL },
+    { 0x0030, 0x0039, MISAKI_CHAR_NUMERIC },
+    { 0x003A, 0x0040, MISAKI_CHAR_SYMBOL },
+    { 0x0041, 0x005A, MISAKI_CHAR_ALPHA },
+    { 0x005B, 0x0060, MISAKI_CHAR_SYMBOL },
+    { 0x0061, 0x007A, MISAKI_CHAR_ALPHA },
+    { 0x007B, 0x007E, MISAKI_CHAR_SYMBOL },
+    { 0x00A0, 0x00A0, MISAKI_CHAR_SPACE },
+    { 0x00A1, 0x00BF, MISAKI_CHAR_SYMBOL },
+    { 0x00C0, 0x00D6, MISAKI_CHAR_ALPHA },
+    { 0x00D7, 0x00D7, MISAKI_CHAR_SYMBOL },
+    { 0x00D8, 0x00F6, MISAKI_CHAR_ALPHA },
+    { 0x00F7, 0x00F7, MISAKI_CHAR_SYMBOL },
+    { 0x00F8, 0x024F, MISAKI_CHAR_ALPHA },
+    { 0x0370, 0x03FF, MISAKI_CHAR_GREEK },
+    { 0x0400, 0x04FF, MISAKI_CHAR_CYRILLIC },
+    { 0x2000, 0x200B, MISAKI_CHAR_SPACE },
+    { 0x2010, 0x2BFF, MISAKI_CHAR_SYMBOL },
+    { 0x3000, 0x3000, MISAKI_CHAR_SPACE },
+    { 0x3001, 0x3004, MISAKI_CHAR_SYMBOL },
+    { 0x3005, 0x3005, MISAKI_CHAR_KANJI },         // 々
+    { 0x3006, 0x3006, MISAKI_CHAR_SYMBOL },
+    { 0x3007, 0x3007, MISAKI_CHAR_KANJINUMERIC },  // 〇
+    { 0x3008, 0x303F, MISAKI_CHAR_SYMBOL },
+    { 0x3041, 0x309F, MISAKI_CHAR_HIRAGANA },
+    { 0x30A0, 0x30A0, MISAKI_CHAR_SYMBOL },
+    { 0x30A1, 0x30FA, MISAKI_CHAR_KATAKANA },
+    { 0x30FB, 0x30FB, MISAKI_CHAR_SYMBOL },        // ・
+    { 0x30FC, 0x30FF, MISAKI_CHAR_KATAKANA },      // ー ヽ ヾ ヿ
+    { 0x31F0, 0x31FF, MISAKI_CHAR_KATAKANA },
+    { 0x3400, 0x4DBF, MISAKI_CHAR_KANJI },
+    { 0x4E00, 0x9FFF, MISAKI_CHAR_KANJI },
+    { 0xF900, 0xFAFF, MISAKI_CHAR_KANJI },
+    { 0xFF01, 0xFF0F, MISAKI_CHAR_SYMBOL },
+    { 0xFF10, 0xFF19, MISAKI_CHAR_NUMERIC },
+    { 0xFF1A, 0xFF20, MISAKI_CHAR_SYMBOL },
+    { 0xFF21, 0xFF3A, MISAKI_CHAR_ALPHA },
+    { 0xFF3B, 0xFF40, MISAKI_CHAR_SYMBOL },
+    { 0xFF41, 0xFF5A, MISAKI_CHAR_ALPHA },
+    { 0xFF5B, 0xFF65, MISAKI_CHAR_SYMBOL },
+    { 0xFF66, 0xFF9F, MISAKI_CHAR_KATAKANA },      // 半角片假名
+    { 0x20000, 0x2FFFF, MISAKI_CHAR_KANJI },
+};
+
+// 汉字数字（在 CJK 基本区内，先于区间表检查；已排序）
+static const uint32_t KANJI_NUMERALS[] = {
+    0x4E00, 0x4E03, 0x4E07, 0x4E09, 0x4E5D, 0x4E8C, 0x4E94, 0x5104,
+    0x5146, 0x516B, 0x516D, 0x5341, 0x5343, 0x56DB, 0x767E,
+};
+
+/* ============================================================================
+ * 查询实现
+ * ========================================================================== */
+
+static bool is_kanji_numeral(uint32_t codepoint) {
+    size_t lo = 0;
+    size_t hi = sizeof(KANJI_NUMERALS) / sizeof(KANJI_NUMERALS[0]);
+    
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (KANJI_NUMERALS[mid] == codepoint) {
+            return true;
+        }
+        if (KANJI_NUMERALS[mid] < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+MisakiCharClass misaki_char_class(uint32_t codepoint) {
+    if (codepoint >= 0x4E00 && codepoint <= 0x767E && is_kanji_numeral(codepoint)) {
+        return MISAKI_CHAR_KANJINUMERIC;
+    }
+    
+    size_t lo = 0;
+    size_t hi = sizeof(CHAR_RANGES) / sizeof(CHAR_RANGES[0]);
+    
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const CharRange *range = &CHAR_RANGES[mid];
+        if (codepoint < range->first) {
+            hi = mid;
+        } else if (codepoint > range->last) {
+            lo = mid + 1;
+        } else {
+            return (MisakiCharClass)range->char_class;
+        }
+    }
+    
+    return MISAKI_CHAR_DEFAULT;
+}
+
+const MisakiCharCategory* misaki_char_category(MisakiCharClass char_class) {
+    if ((int)char_class < 0 || char_class >= MISAKI_CHAR_CLASS_COUNT) {
+        char_class = MISAKI_CHAR_DEFAULT;
+    }
+    return &CHAR_CATEGORIES[char_class];
+}
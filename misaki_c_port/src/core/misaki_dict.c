@@ -10,10 +10,15 @@
 #include "misaki_dict.h"
 #include "misaki_string.h"
 #include "misaki_trie.h"
+#include "misaki_memo.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+// 词级音素记忆表的槽数（每个词典一张，每槽 128 字节）
+#define EN_DICT_MEMO_CAPACITY 4096
+#define ZH_DICT_MEMO_CAPACITY 4096
+
 /* ============================================================================
  * 英文词典实现
  * ========================================================================== */
@@ -31,6 +36,7 @@ EnDict* misaki_en_dict_load(const char *file_path) {
     
     dict->count = 0;
     dict->capacity = 1000;  // 初始容量
+    dict->memo = NULL;
     dict->entries = (EnDictEntry *)malloc(sizeof(EnDictEntry) * dict->capacity);
     if (!dict->entries) {
         free(dict);
@@ -88,6 +94,9 @@ EnDict* misaki_en_dict_load(const char *file_path) {
     }
     
     misaki_tsv_parser_free(parser);
+    
+    // 词级记忆表（创建失败时不记忆）
+    dict->memo = misaki_memo_create(EN_DICT_MEMO_CAPACITY);
     return dict;
 }
 
@@ -101,6 +110,7 @@ void misaki_en_dict_free(EnDict *dict) {
         free(dict->entries[i].phonemes);
     }
     
+    misaki_memo_free(dict->memo);
     free(dict->entries);
     free(dict);
 }
@@ -196,6 +206,7 @@ ZhDict* misaki_zh_dict_load(const char *file_path) {
     
     dict->count = 0;
     dict->capacity = 5000;  // 初始容量（汉字数量较多）
+    dict->memo = NULL;
     dict->entries = (ZhDictEntry *)malloc(sizeof(ZhDictEntry) * dict->capacity);
     if (!dict->entries) {
         free(dict);
@@ -243,38 +254,37 @@ ZhDict* misaki_zh_dict_load(const char *file_path) {
         }
         entry->hanzi = hanzi;
         
-        // 解析拼音（可能有多个，逗号分隔）
-        char *pinyin_str = strndup(fields[1].data, fields[1].length);
-        if (!pinyin_str) {
-            break;
-        }
-        
-        // 分割拼音（按逗号）
+        // 解析拼音（可能有多个，逗号分隔，跳过空段）
         entry->pinyin_count = 0;
         entry->pinyins = (char **)malloc(sizeof(char *) * 8);  // 最多 8 个读音
         if (!entry->pinyins) {
-            free(pinyin_str);
             break;
         }
         
-        char *token = strtok(pinyin_str, ",");
-        while (token && entry->pinyin_count < 8) {
-            entry->pinyins[entry->pinyin_count] = misaki_strdup(token);
-            if (!entry->pinyins[entry->pinyin_count]) {
-                break;
+        const char *p = fields[1].data;
+        const char *end = fields[1].data + fields[1].length;
+        while (p < end && entry->pinyin_count < 8) {
+            const char *comma = memchr(p, ',', end - p);
+            const char *segment_end = comma ? comma : end;
+            if (segment_end > p) {
+                entry->pinyins[entry->pinyin_count] = strndup(p, segment_end - p);
+                if (!entry->pinyins[entry->pinyin_count]) {
+                    break;
+                }
+                entry->pinyin_count++;
             }
-            entry->pinyin_count++;
-            token = strtok(NULL, ",");
+            p = segment_end + 1;
         }
         
-        free(pinyin_str);
-        
         if (entry->pinyin_count > 0) {
             dict->count++;
         }
     }
     
     misaki_tsv_parser_free(parser);
+    
+    // 词级记忆表（创建失败时不记忆）
+    dict->memo = misaki_memo_create(ZH_DICT_MEMO_CAPACITY);
     return dict;
 }
 
@@ -290,6 +300,7 @@ void misaki_zh_dict_free(ZhDict *dict) {
         free(dict->entries[i].pinyins);
     }
     
+    misaki_memo_free(dict->memo);
     free(dict->entries);
     free(dict);
 }
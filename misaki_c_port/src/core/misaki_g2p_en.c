@@ -10,6 +10,7 @@
 #include "misaki_dict.h"
 #include "misaki_tokenizer.h"
 #include "misaki_string.h"
+#include "misaki_memo.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -27,14 +28,23 @@ char* misaki_en_g2p_word(const EnDict *dict,
     
     (void)options;  // TODO: 使用选项（英式/美式发音）
     
-    // 在词典中查找单词
-    const char *phonemes = misaki_en_dict_lookup(dict, word);
-    if (phonemes) {
-        return misaki_strdup(phonemes);
+    // 常用词只查一次词典（词典是线性查找）
+    char cached[MISAKI_MEMO_VALUE_MAX];
+    if (misaki_memo_get(dict->memo, word, 0, cached, sizeof(cached))) {
+        return misaki_strdup(cached);
     }
     
-    // 未找到，尝试 OOV 处理
-    return misaki_en_g2p_oov(word);
+    // 在词典中查找单词；未找到，尝试 OOV 处理
+    const char *phonemes = misaki_en_dict_lookup(dict, word);
+    char *result = phonemes ? misaki_strdup(phonemes) : misaki_en_g2p_oov(word);
+    if (result) {
+        misaki_memo_put(dict->memo, word, 0, result);
+    }
+    return result;
+}
+
+void misaki_en_memo_stats(const EnDict *dict, MisakiMemoStats *stats) {
+    misaki_memo_stats(dict ? dict->memo : NULL, stats);
 }
 
 MisakiTokenList* misaki_en_g2p(const EnDict *dict,
@@ -57,7 +67,7 @@ MisakiTokenList* misaki_en_g2p(const EnDict *dict,
         // 查询词典
         char *phonemes = misaki_en_g2p_word(dict, token->text, options);
         if (phonemes) {
-            token->phonemes = phonemes;
+            misaki_token_take_phonemes(token, phonemes);
         }
     }
     
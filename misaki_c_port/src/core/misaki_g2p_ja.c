@@ -16,6 +16,9 @@
 #include "misaki_string.h"
 #include "misaki_kana_map.h"
 #include "misaki_trie.h"
+#include "misaki_arena.h"  // 字符串池（预计算的 IPA）
+#include "misaki_memo.h"
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -25,15 +28,15 @@
  * ========================================================================== */
 
 /**
- * 假名→IPA 转换（使用新的 kana_map 模块）
+ * 假名→IPA 转换，长音在同一遍里处理
  */
-char* misaki_ja_kana_to_ipa(const char *kana) {
+static char* ja_kana_to_ipa(const char *kana, bool long_vowel) {
     if (!kana) {
         return NULL;
     }
     
     char result[1024] = {0};
-    int len = misaki_kana_string_to_ipa(kana, result, sizeof(result));
+    int len = misaki_kana_string_to_ipa_ex(kana, result, sizeof(result), long_vowel);
     
     if (len > 0) {
         return misaki_strdup(result);
@@ -42,6 +45,65 @@ char* misaki_ja_kana_to_ipa(const char *kana) {
     return NULL;
 }
 
+/* ============================================================================
+ * 读音→IPA 记忆表（进程内共享：转换只取决于读音和长音选项）
+ * ========================================================================== */
+
+// 记忆表的槽数（每槽 128 字节）
+#define JA_MEMO_CAPACITY 4096
+
+static _Atomic(MisakiMemo *) g_ja_memo = NULL;
+
+/**
+ * 第一次使用时创建（多个线程同时创建时只保留一个）
+ */
+static MisakiMemo* ja_memo(void) {
+    MisakiMemo *memo = atomic_load_explicit(&g_ja_memo, memory_order_acquire);
+    if (memo) {
+        return memo;
+    }
+    
+    MisakiMemo *created = misaki_memo_create(JA_MEMO_CAPACITY);
+    if (!created) {
+        return NULL;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&g_ja_memo, &memo, created,
+                                                 memory_order_acq_rel,
+                                                 memory_order_acquire)) {
+        misaki_memo_free(created);
+        return memo;
+    }
+    return created;
+}
+
+/**
+ * 读音→IPA（先查记忆表）
+ */
+static char* ja_reading_to_ipa(const char *kana, bool long_vowel) {
+    MisakiMemo *memo = ja_memo();
+    char cached[MISAKI_MEMO_VALUE_MAX];
+    if (misaki_memo_get(memo, kana, long_vowel, cached, sizeof(cached))) {
+        return misaki_strdup(cached);
+    }
+    
+    char *ipa = ja_kana_to_ipa(kana, long_vowel);
+    if (ipa) {
+        misaki_memo_put(memo, kana, long_vowel, ipa);
+    }
+    return ipa;
+}
+
+void misaki_ja_memo_stats(MisakiMemoStats *stats) {
+    misaki_memo_stats(atomic_load_explicit(&g_ja_memo, memory_order_acquire), stats);
+}
+
+/**
+ * 假名→IPA 转换（使用新的 kana_map 模块）
+ */
+char* misaki_ja_kana_to_ipa(const char *kana) {
+    return ja_kana_to_ipa(kana, false);
+}
+
 /**
  * 日文 G2P 完整流程
  * 
@@ -54,7 +116,8 @@ char* misaki_ja_kana_to_ipa(const char *kana) {
  *   文本 → 分词（Viterbi）→ 词典查询读音 → 假名→IPA 转换
  * 
  * 降级策略：
- *   - 优先：从 dict_trie 查询读音（支持汉字→假名）
+ *   - 优先：分词时从词典匹配带出的读音（token->reading，不再查一次 Trie）
+ *   - 其次：从 dict_trie 查询读音（支持汉字→假名）
  *   - 降级：直接转换 token 文本（仅支持纯假名）
  *   - 兜底：保留原文 + 警告
  * 
@@ -74,6 +137,13 @@ MisakiTokenList* misaki_ja_g2p(const Trie *dict_trie,
         return NULL;
     }
     
+    // 长音处理（⭐ 默认启用，因为这是日文核心特性）
+    bool enable_long_vowel = true;
+    if (options) {
+        // 如果提供了 options，尊重其设置
+        enable_long_vowel = options->ja_long_vowel;
+    }
+    
     // 1. 日文分词（使用 Viterbi 算法）
     MisakiTokenList *tokens = misaki_ja_tokenize(tokenizer, text);
     if (!tokens) {
@@ -84,64 +154,91 @@ MisakiTokenList* misaki_ja_g2p(const Trie *dict_trie,
     for (int i = 0; i < tokens->count; i++) {
         MisakiToken *token = &tokens->tokens[i];
         
-        // ⭐ 优先：从词典查询读音（假名）
-        const char *pron = NULL;
-        if (dict_trie && misaki_trie_lookup_with_pron(dict_trie, token->text, &pron, NULL, NULL)) {
+        // ⭐ 最快：词典加载时预先计算的 IPA（已做长音处理）
+        if (enable_long_vowel && token->ipa) {
+            misaki_token_set_phonemes(token, token->ipa);
+            continue;
+        }
+        
+        // 其次：分词时带出的读音；没有时从词典查询读音（假名）
+        const char *pron = token->reading;
+        if (pron || (dict_trie && misaki_trie_lookup_with_pron(dict_trie, token->text, &pron, NULL, NULL))) {
             if (pron && strlen(pron) > 0) {
-                // 将假名读音转换为 IPA
-                char *phonemes = misaki_ja_kana_to_ipa(pron);
+                // 将假名读音转换为 IPA（含长音处理）
+                char *phonemes = ja_reading_to_ipa(pron, enable_long_vowel);
                 if (phonemes) {
-                    // ⭐ 安全：释放旧的 phonemes（如果存在且不是 text）
-                    if (token->phonemes && token->phonemes != token->text) {
-                        free(token->phonemes);
-                    }
-                    token->phonemes = phonemes;
+                    misaki_token_take_phonemes(token, phonemes);
                     continue;  // 成功转换，处理下一个 token
                 }
             }
         }
         
         // 降级：尝试直接将文本转换为 IPA（适用于纯假名文本）
-        char *phonemes = misaki_ja_kana_to_ipa(token->text);
+        char *phonemes = ja_reading_to_ipa(token->text, enable_long_vowel);
         if (phonemes) {
-            // ⭐ 安全：释放旧的 phonemes（如果存在且不是 text）
-            if (token->phonemes && token->phonemes != token->text) {
-                free(token->phonemes);
-            }
-            token->phonemes = phonemes;
+            misaki_token_take_phonemes(token, phonemes);
         } else {
             // 无法转换的情况（未登录词、汉字等）
             // 保留原文作为后备
             if (!token->phonemes) {
-                // ⭐ 安全：使用 strdup 而不是直接引用
-                token->phonemes = misaki_strdup(token->text);
+                misaki_token_set_phonemes(token, token->text);
             }
             fprintf(stderr, "[G2P Warning] Cannot convert to IPA: %s\n", token->text);
         }
     }
     
-    // 3. 长音处理（⭐ 默认启用，因为这是日文核心特性）
-    bool enable_long_vowel = true;
-    if (options) {
-        // 如果提供了 options，尊重其设置
-        enable_long_vowel = options->ja_long_vowel;
+    return tokens;
+}
+
+/**
+ * 日文长音处理（单个音素串）
+ * 
+ * 假名转换时已经处理了大部分长音（misaki_kana_string_to_ipa_ex）：
+ *   - 长音符：コーヒー → koːçiː
+ *   - 特殊组合：おう → oː, えい → eː
+ * 这里只对已有的音素串补做 ei → eː
+ * 
+ * @param phonemes 音素串
+ * @param result 输出缓冲区（1024 字节）
+ * @return 有修改返回 true
+ */
+static bool ja_long_vowel_apply(const char *phonemes, char result[1024]) {
+    int len = strlen(phonemes);
+    int pos = 0;
+    
+    for (int j = 0; j < len && pos < 1021; ) {
+        // 检测 "ei" → "eː" (如 けい、せい、めい)
+        if (j + 2 <= len && phonemes[j] == 'e' && phonemes[j+1] == 'i') {
+            result[pos++] = 'e';
+            result[pos++] = (char)0xCB;  // ː (U+02D0)
+            result[pos++] = (char)0x90;
+            j += 2;
+        }
+        // 其他字符直接复制
+        else {
+            result[pos++] = phonemes[j++];
+        }
     }
     
-    if (enable_long_vowel) {
-        misaki_ja_long_vowel(tokens);
+    result[pos] = '\0';
+    return strcmp(result, phonemes) != 0;
+}
+
+static void ja_token_long_vowel(MisakiToken *token) {
+    if (!token->phonemes) {
+        return;
     }
     
-    return tokens;
+    // 如果有修改，更新 phonemes
+    char result[1024];
+    if (ja_long_vowel_apply(token->phonemes, result)) {
+        misaki_token_set_phonemes(token, result);
+    }
 }
 
 /**
  * 日文长音处理
  * 
- * 处理日文中的长音现象，例如：
- *   - 长音符：コーヒー → koːçiː (已由 kana_map 处理)
- *   - 同元音重复：おおきい → oːkiː
- *   - 特殊组合：えい → eː, おう → oː (⭐ 重要！)
- * 
  * @param tokens Token 列表
  */
 void misaki_ja_long_vowel(MisakiTokenList *tokens) {
@@ -149,49 +246,43 @@ void misaki_ja_long_vowel(MisakiTokenList *tokens) {
         return;
     }
     
-    // ⭐ 实现核心长音规则：处理日文长音现象
     for (int i = 0; i < tokens->count; i++) {
-        MisakiToken *token = &tokens->tokens[i];
-        if (!token->phonemes) {
-            continue;
-        }
-        
-        char *phonemes = token->phonemes;
-        int len = strlen(phonemes);
-        char result[1024] = {0};
-        int pos = 0;
-        
-        for (int j = 0; j < len; ) {
-            // ⭐ 检测 "oɯ" → "oː" (如 とう、そう、こう)
-            if (j + 2 <= len && phonemes[j] == 'o' && phonemes[j+1] == 'ɯ') {
-                result[pos++] = 'o';
-                result[pos++] = 'ː';
-                j += 2;
-            }
-            // ⭐ 检测 "ei" → "eː" (如 けい、せい、めい)
-            else if (j + 2 <= len && phonemes[j] == 'e' && phonemes[j+1] == 'i') {
-                result[pos++] = 'e';
-                result[pos++] = 'ː';
-                j += 2;
-            }
-            // ⭐ 检测 "aɯ" → "aː" (如 おう、かう)
-            else if (j + 2 <= len && phonemes[j] == 'a' && phonemes[j+1] == 'ɯ') {
-                result[pos++] = 'a';
-                result[pos++] = 'ː';
-                j += 2;
-            }
-            // 其他字符直接复制
-            else {
-                result[pos++] = phonemes[j++];
-            }
+        ja_token_long_vowel(&tokens->tokens[i]);
+    }
+}
+
+/* ============================================================================
+ * 词典 IPA 预计算
+ * ========================================================================== */
+
+static int ja_precompute_node(TrieNode *node, MisakiStringPool *pool) {
+    int count = 0;
+    
+    if (node->pron && !node->ipa) {
+        char ipa[1024] = {0};
+        if (misaki_kana_string_to_ipa_ex(node->pron, ipa, sizeof(ipa), true) > 0) {
+            node->ipa = misaki_string_pool_intern(pool, ipa);
+            count += node->ipa ? 1 : 0;
         }
-        
-        result[pos] = '\0';
-        
-        // 如果有修改，更新 phonemes
-        if (strcmp(result, phonemes) != 0) {
-            free(token->phonemes);
-            token->phonemes = misaki_strdup(result);
+    }
+    
+    for (int i = 0; i < node->children_count; i++) {
+        count += ja_precompute_node(node->children[i], pool);
+    }
+    return count;
+}
+
+int misaki_ja_precompute_ipa(Trie *trie) {
+    if (!trie || !trie->root) {
+        return -1;
+    }
+    
+    if (!trie->strings) {
+        trie->strings = misaki_string_pool_create();
+        if (!trie->strings) {
+            return -1;
         }
     }
+    
+    return ja_precompute_node(trie->root, trie->strings);
 }
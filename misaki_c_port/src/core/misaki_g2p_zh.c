@@ -11,6 +11,7 @@
 #include "misaki_tokenizer.h"
 #include "misaki_string.h"
 #include "misaki_num2cn.h"  // ⭐ 新增：数字转中文
+#include "misaki_memo.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -546,6 +547,10 @@ char* misaki_zh_pinyin_to_ipa(const char *pinyin) {
  * 中文 G2P 主函数
  * ========================================================================== */
 
+// 词级记忆表的上下文标志：同一字符串作为词面（逐字查询）和作为词组拼音时结果不同
+#define ZH_MEMO_CHARS  0
+#define ZH_MEMO_PHRASE 1
+
 /**
  * 将词组拼音（空格分隔）转换为 IPA
  * 
@@ -563,15 +568,29 @@ static char* convert_phrase_pinyin_to_ipa(const char *phrase_pinyin) {
     char result[512] = {0};
     int result_pos = 0;
     
-    // 复制一份用于 strtok
+    // 复制一份用于分割（不用 strtok：多线程同时调用）
     char *copy = misaki_strdup(phrase_pinyin);
     if (!copy) {
         return NULL;
     }
     
     // 按空格分割拼音，但拼接时不加空格（词内连读）
-    char *token = strtok(copy, " ");
-    while (token) {
+    char *p = copy;
+    while (*p) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        char *token = p;
+        while (*p && *p != ' ') {
+            p++;
+        }
+        if (*p) {
+            *p++ = '\0';
+        }
+        
         // 转换单个拼音为 IPA
         char *ipa = misaki_zh_pinyin_to_ipa(token);
         if (ipa) {
@@ -583,8 +602,6 @@ static char* convert_phrase_pinyin_to_ipa(const char *phrase_pinyin) {
             }
             free(ipa);
         }
-        
-        token = strtok(NULL, " ");
     }
     
     free(copy);
@@ -628,17 +645,28 @@ MisakiTokenList* misaki_zh_g2p(const ZhDict *dict,
         const char *phrase_pinyin = NULL;
         if (phrase_dict && 
             misaki_zh_phrase_dict_lookup(phrase_dict, token->text, &phrase_pinyin)) {
-            // 找到词组拼音，直接转换为 IPA
+            // 找到词组拼音，直接转换为 IPA（转换结果按拼音记忆）
+            char cached[MISAKI_MEMO_VALUE_MAX];
+            if (misaki_memo_get(dict->memo, phrase_pinyin, ZH_MEMO_PHRASE, cached, sizeof(cached))) {
+                misaki_token_set_phonemes(token, cached);
+                continue;
+            }
             char *ipa = convert_phrase_pinyin_to_ipa(phrase_pinyin);
             if (ipa) {
-                token->phonemes = ipa;
+                misaki_memo_put(dict->memo, phrase_pinyin, ZH_MEMO_PHRASE, ipa);
+                misaki_token_take_phonemes(token, ipa);
                 continue;  // 处理下一个 token
             }
         }
         
-        // 降级：逐字查询单字拼音
-        // ⭐ 修复：词内音节不加空格，保持连读（避免"一字一顿"）
+        // 降级：逐字查询单字拼音（整词的结果按词面记忆，避免重复线性查找）
         char ipa_result[512] = {0};
+        if (misaki_memo_get(dict->memo, token->text, ZH_MEMO_CHARS, ipa_result, sizeof(ipa_result))) {
+            misaki_token_set_phonemes(token, ipa_result);
+            continue;
+        }
+        
+        // ⭐ 修复：词内音节不加空格，保持连读（避免"一字一顿"）
         int ipa_pos = 0;
         
         const char *p = token->text;
@@ -670,7 +698,8 @@ MisakiTokenList* misaki_zh_g2p(const ZhDict *dict,
         }
         
         if (ipa_pos > 0) {
-            token->phonemes = misaki_strdup(ipa_result);
+            misaki_memo_put(dict->memo, token->text, ZH_MEMO_CHARS, ipa_result);
+            misaki_token_set_phonemes(token, ipa_result);
         }
     }
     
@@ -687,6 +716,10 @@ MisakiTokenList* misaki_zh_g2p(const ZhDict *dict,
     return tokens;
 }
 
+void misaki_zh_memo_stats(const ZhDict *dict, MisakiMemoStats *stats) {
+    misaki_memo_stats(dict ? dict->memo : NULL, stats);
+}
+
 /* ============================================================================
  * 声调变化和儿化音
  * ========================================================================== */
@@ -819,8 +852,7 @@ void misaki_zh_tone_sandhi(MisakiTokenList *tokens,
             if (!current_last) {
                 char *new_phonemes = change_ipa_tone(current->phonemes, new_tone);
                 if (new_phonemes) {
-                    free(current->phonemes);
-                    current->phonemes = new_phonemes;
+                    misaki_token_take_phonemes(current, new_phonemes);
                 }
             } else {
                 // 多个音节，只替换最后一个
@@ -832,8 +864,7 @@ void misaki_zh_tone_sandhi(MisakiTokenList *tokens,
                     new_phonemes[prefix_len] = '\0';
                     strncat(new_phonemes, new_last, sizeof(new_phonemes) - prefix_len - 1);
                     
-                    free(current->phonemes);
-                    current->phonemes = misaki_strdup(new_phonemes);
+                    misaki_token_set_phonemes(current, new_phonemes);
                     free(new_last);
                 }
             }
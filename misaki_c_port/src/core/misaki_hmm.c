@@ -16,9 +16,90 @@
 #include <stdio.h>
 #include <math.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MISAKI_HMM_SSE 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MISAKI_HMM_NEON 1
+#endif
+
 // 最小概率（log 空间）
 #define MIN_PROB -3.14e100
 
+// PrevStatus 约束（与 jieba 一致），每个状态只有两个合法前驱：
+// B ← E, S    M ← M, B    E ← B, M    S ← S, E
+static const HmmState hmm_prev_status[HMM_STATE_COUNT][2] = {
+    {HMM_STATE_E, HMM_STATE_S},  // B 的前驱: E, S
+    {HMM_STATE_M, HMM_STATE_B},  // M 的前驱: M, B
+    {HMM_STATE_B, HMM_STATE_M},  // E 的前驱: B, M
+    {HMM_STATE_S, HMM_STATE_E}   // S 的前驱: S, E
+};
+
+/* ============================================================================
+ * 发射概率表
+ * ========================================================================== */
+
+static int hmm_state_index(char state) {
+    return (state == 'B') ? HMM_STATE_B :
+           (state == 'M') ? HMM_STATE_M :
+           (state == 'E') ? HMM_STATE_E : HMM_STATE_S;
+}
+
+/**
+ * 分配一页发射概率（256 行，全部初始化为下界）
+ */
+static HmmEmitRow* hmm_emit_page_create(void) {
+    HmmEmitRow *page = (HmmEmitRow*)malloc(sizeof(HmmEmitRow) * HMM_EMIT_PAGE_SIZE);
+    if (!page) {
+        return NULL;
+    }
+    
+    for (int i = 0; i < HMM_EMIT_PAGE_SIZE; i++) {
+        for (int s = 0; s < HMM_STATE_COUNT; s++) {
+            page[i].prob[s] = HMM_EMIT_MIN_PROB;
+        }
+    }
+    
+    return page;
+}
+
+/**
+ * 写入一个字符在某状态下的发射概率（按需分配所在页）
+ */
+static bool hmm_emit_set(HmmModel *model, uint32_t codepoint, int state, double prob) {
+    if (codepoint >= 0x110000) {
+        return false;
+    }
+    
+    uint32_t page_idx = codepoint >> HMM_EMIT_PAGE_BITS;
+    if (model->emit_pages[page_idx] == model->emit_default) {
+        HmmEmitRow *page = hmm_emit_page_create();
+        if (!page) {
+            return false;
+        }
+        model->emit_pages[page_idx] = page;
+        model->emit_page_count++;
+    }
+    
+    model->emit_pages[page_idx][codepoint & (HMM_EMIT_PAGE_SIZE - 1)].prob[state] = (float)prob;
+    return true;
+}
+
+/**
+ * 表中的 float 下界映射回 double 下界（与 jieba 的 MIN_FLOAT 一致）
+ */
+static inline double hmm_emit_to_double(float prob) {
+    return prob <= HMM_EMIT_MIN_PROB ? MIN_PROB : (double)prob;
+}
+
+/**
+ * double 概率转 float（低于 float 下界的截断为下界）
+ */
+static inline float hmm_prob_to_float(double prob) {
+    return prob <= HMM_EMIT_MIN_PROB ? HMM_EMIT_MIN_PROB : (float)prob;
+}
+
 /* ============================================================================
  * HMM 模型加载
  * ========================================================================== */
@@ -34,9 +115,14 @@ HmmModel* misaki_hmm_load(const char *file_path) {
         return NULL;
     }
     
-    // 初始化发射概率 Trie 树
-    for (int i = 0; i < HMM_STATE_COUNT; i++) {
-        model->prob_emit[i] = misaki_trie_create();
+    // 初始化发射概率表：所有页先指向共享的默认页
+    model->emit_default = hmm_emit_page_create();
+    if (!model->emit_default) {
+        free(model);
+        return NULL;
+    }
+    for (int i = 0; i < HMM_EMIT_PAGE_COUNT; i++) {
+        model->emit_pages[i] = model->emit_default;
     }
     
     // 提取基础路径（file_path 可能是 hmm_model.json 或 hmm_prob_emit.txt）
@@ -65,10 +151,7 @@ HmmModel* misaki_hmm_load(const char *file_path) {
             char state;
             double prob;
             if (sscanf(line, "%c\t%lf", &state, &prob) == 2) {
-                int idx = (state == 'B') ? HMM_STATE_B :
-                         (state == 'M') ? HMM_STATE_M :
-                         (state == 'E') ? HMM_STATE_E : HMM_STATE_S;
-                model->prob_start[idx] = prob;
+                model->prob_start[hmm_state_index(state)] = prob;
             }
         }
         fclose(f);
@@ -98,13 +181,7 @@ HmmModel* misaki_hmm_load(const char *file_path) {
             char from_state, to_state;
             double prob;
             if (sscanf(line, "%c\t%c\t%lf", &from_state, &to_state, &prob) == 3) {
-                int from_idx = (from_state == 'B') ? HMM_STATE_B :
-                              (from_state == 'M') ? HMM_STATE_M :
-                              (from_state == 'E') ? HMM_STATE_E : HMM_STATE_S;
-                int to_idx = (to_state == 'B') ? HMM_STATE_B :
-                            (to_state == 'M') ? HMM_STATE_M :
-                            (to_state == 'E') ? HMM_STATE_E : HMM_STATE_S;
-                model->prob_trans[from_idx][to_idx] = prob;
+                model->prob_trans[hmm_state_index(from_state)][hmm_state_index(to_state)] = prob;
             }
         }
         fclose(f);
@@ -134,16 +211,17 @@ HmmModel* misaki_hmm_load(const char *file_path) {
             double prob;
             
             // 解析格式：状态 \t 字符 \t 概率
-            if (sscanf(line, "%c\t%[^\t]\t%lf", &state, ch, &prob) == 3) {
-                int state_idx = (state == 'B') ? HMM_STATE_B :
-                               (state == 'M') ? HMM_STATE_M :
-                               (state == 'E') ? HMM_STATE_E : HMM_STATE_S;
+            if (sscanf(line, "%c\t%15[^\t]\t%lf", &state, ch, &prob) == 3) {
+                // 每行只有一个字符，直接按码点写入发射概率表
+                uint32_t codepoint;
+                int bytes = misaki_utf8_decode(ch, &codepoint);
+                if (bytes == 0 || ch[bytes] != '\0') {
+                    continue;
+                }
                 
-                // 将概率存储到 Trie 树（使用 tag 字段存储概率）
-                char prob_str[32];
-                snprintf(prob_str, sizeof(prob_str), "%.10f", prob);
-                misaki_trie_insert(model->prob_emit[state_idx], ch, prob, prob_str);
-                line_count++;
+                if (hmm_emit_set(model, codepoint, hmm_state_index(state), prob)) {
+                    line_count++;
+                }
             }
         }
         fclose(f);
@@ -153,6 +231,15 @@ HmmModel* misaki_hmm_load(const char *file_path) {
         model->total_chars = 0;
     }
     
+    // 4. 预计算 float 版本的初始/转移概率（向量化 Viterbi 使用）
+    for (int s = 0; s < HMM_STATE_COUNT; s++) {
+        model->start_f.prob[s] = hmm_prob_to_float(model->prob_start[s]);
+        for (int k = 0; k < 2; k++) {
+            HmmState prev = hmm_prev_status[s][k];
+            model->prev_trans[k].prob[s] = hmm_prob_to_float(model->prob_trans[prev][s]);
+        }
+    }
+    
     printf("✅ HMM 模型加载成功\n");
     printf("   - 初始概率: ✅\n");
     printf("   - 转移概率: ✅\n");
@@ -168,12 +255,13 @@ void misaki_hmm_free(HmmModel *model) {
         return;
     }
     
-    // 释放发射概率 Trie 树
-    for (int i = 0; i < HMM_STATE_COUNT; i++) {
-        if (model->prob_emit[i]) {
-            misaki_trie_free(model->prob_emit[i]);
+    // 释放发射概率表（默认页是共享的，只释放一次）
+    for (int i = 0; i < HMM_EMIT_PAGE_COUNT; i++) {
+        if (model->emit_pages[i] != model->emit_default) {
+            free(model->emit_pages[i]);
         }
     }
+    free(model->emit_default);
     
     free(model);
 }
@@ -185,128 +273,250 @@ void misaki_hmm_free(HmmModel *model) {
 double misaki_hmm_get_emit_prob(const HmmModel *model,
                                 HmmState state,
                                 uint32_t codepoint) {
-    if (!model || !model->prob_emit[state]) {
+    if (!model || (int)state < 0 || (int)state >= HMM_STATE_COUNT) {
         return MIN_PROB;
     }
     
-    // 将 Unicode 码点转为 UTF-8 字符串
-    char ch[5] = {0};
-    if (codepoint < 0x80) {
-        ch[0] = codepoint;
-    } else if (codepoint < 0x800) {
-        ch[0] = 0xC0 | (codepoint >> 6);
-        ch[1] = 0x80 | (codepoint & 0x3F);
-    } else if (codepoint < 0x10000) {
-        ch[0] = 0xE0 | (codepoint >> 12);
-        ch[1] = 0x80 | ((codepoint >> 6) & 0x3F);
-        ch[2] = 0x80 | (codepoint & 0x3F);
-    } else {
-        ch[0] = 0xF0 | (codepoint >> 18);
-        ch[1] = 0x80 | ((codepoint >> 12) & 0x3F);
-        ch[2] = 0x80 | ((codepoint >> 6) & 0x3F);
-        ch[3] = 0x80 | (codepoint & 0x3F);
-    }
-    
-    // 从 Trie 树中查找
-    TrieMatch match;
-    if (misaki_trie_match_longest(model->prob_emit[state], ch, 0, &match)) {
-        // 概率存储在 frequency 字段
-        return match.frequency;
+    // 按码点直接查表，不存在的字符落在默认行（下界）
+    return hmm_emit_to_double(misaki_hmm_emit_row(model, codepoint)->prob[state]);
+}
+
+/* ============================================================================
+ * 解码工作区
+ * ========================================================================== */
+
+HmmWorkspace* misaki_hmm_workspace_create(void) {
+    return (HmmWorkspace*)calloc(1, sizeof(HmmWorkspace));
+}
+
+void misaki_hmm_workspace_free(HmmWorkspace *ws) {
+    if (!ws) {
+        return;
     }
     
-    // 如果找不到，返回默认最小发射概率
-    return MIN_PROB;
+    free(ws->choice);
+    free(ws->states);
+    free(ws->span_chars);
+    free(ws);
 }
 
-int misaki_hmm_viterbi(const HmmModel *model, 
-                       const char *text,
-                       HmmState *states) {
-    if (!model || !text || !states) {
-        return 0;
+static bool hmm_workspace_reserve(HmmWorkspace *ws, int char_count, int span_count) {
+    if (char_count > ws->capacity) {
+        int new_capacity = ws->capacity > 0 ? ws->capacity : 64;
+        while (new_capacity < char_count) {
+            new_capacity *= 2;
+        }
+        
+        uint8_t *choice = (uint8_t*)realloc(ws->choice, new_capacity);
+        if (!choice) {
+            return false;
+        }
+        ws->choice = choice;
+        
+        HmmState *states = (HmmState*)realloc(ws->states, sizeof(HmmState) * new_capacity);
+        if (!states) {
+            return false;
+        }
+        ws->states = states;
+        ws->capacity = new_capacity;
     }
     
-    // ⭐ 添加：定义 PrevStatus 约束（与 jieba 一致）
-    // B 只能从 E 或 S 转移而来
-    // M 只能从 M 或 B 转移而来
-    // E 只能从 B 或 M 转移而来
-    // S 只能从 S 或 E 转移而来
-    static const HmmState prev_status[HMM_STATE_COUNT][2] = {
-        {HMM_STATE_E, HMM_STATE_S},  // B 的前驱: E, S
-        {HMM_STATE_M, HMM_STATE_B},  // M 的前驱: M, B
-        {HMM_STATE_B, HMM_STATE_M},  // E 的前驱: B, M
-        {HMM_STATE_S, HMM_STATE_E}   // S 的前驱: S, E
-    };
-    
-    // 1. 统计字符数量
-    int char_count = 0;
-    uint32_t chars[256];  // 假设最多 256 个字符
+    if (span_count > ws->span_capacity) {
+        int *span_chars = (int*)realloc(ws->span_chars, sizeof(int) * span_count);
+        if (!span_chars) {
+            return false;
+        }
+        ws->span_chars = span_chars;
+        ws->span_capacity = span_count;
+    }
     
-    const char *p = text;
-    while (*p && char_count < 256) {
+    return true;
+}
+
+/* ============================================================================
+ * 向量化 Viterbi（四状态 max-plus）
+ * 
+ * 每一步：
+ *   c1[s] = V[prev1(s)] + trans(prev1(s) → s)
+ *   c2[s] = V[prev2(s)] + trans(prev2(s) → s)
+ *   V'[s] = max(c1[s], c2[s]) + emit(s, ch)
+ * 四个状态正好是一个 float4，前驱选择压缩成 4 bit 存入 choice[t]
+ * ========================================================================== */
+
+/**
+ * 解码单个片段
+ * 
+ * @return 片段的字符数
+ */
+static int hmm_viterbi_span(const HmmModel *model,
+                            const char *p,
+                            const char *end,
+                            uint8_t *choice,
+                            HmmState *states) {
+    float last[HMM_STATE_COUNT];
+    int n = 0;
+    
+#if defined(MISAKI_HMM_SSE)
+    const __m128 trans1 = _mm_loadu_ps(model->prev_trans[0].prob);
+    const __m128 trans2 = _mm_loadu_ps(model->prev_trans[1].prob);
+    __m128 v = _mm_setzero_ps();
+#elif defined(MISAKI_HMM_NEON)
+    // 前驱重排：prev1 = [E, M, B, S]，prev2 = [S, B, M, E]
+    static const uint8_t perm1_bytes[16] = {8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15};
+    static const uint8_t perm2_bytes[16] = {12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+    const uint8x16_t perm1 = vld1q_u8(perm1_bytes);
+    const uint8x16_t perm2 = vld1q_u8(perm2_bytes);
+    const uint32x4_t bits = vld1q_u32(lane_bits);
+    const float32x4_t trans1 = vld1q_f32(model->prev_trans[0].prob);
+    const float32x4_t trans2 = vld1q_f32(model->prev_trans[1].prob);
+    float32x4_t v = vdupq_n_f32(0.0f);
+#else
+    float v[HMM_STATE_COUNT] = {0};
+#endif
+    
+    while (p < end && *p) {
         uint32_t codepoint;
         int bytes = misaki_utf8_decode(p, &codepoint);
         if (bytes == 0) break;
-        
-        chars[char_count++] = codepoint;
         p += bytes;
+        
+        const HmmEmitRow *row = misaki_hmm_emit_row(model, codepoint);
+        
+        if (n == 0) {
+            // 第一个字符：初始概率 + 发射概率
+            choice[0] = 0;
+#if defined(MISAKI_HMM_SSE)
+            v = _mm_add_ps(_mm_loadu_ps(model->start_f.prob), _mm_loadu_ps(row->prob));
+#elif defined(MISAKI_HMM_NEON)
+            v = vaddq_f32(vld1q_f32(model->start_f.prob), vld1q_f32(row->prob));
+#else
+            for (int s = 0; s < HMM_STATE_COUNT; s++) {
+                v[s] = model->start_f.prob[s] + row->prob[s];
+            }
+#endif
+            n++;
+            continue;
+        }
+        
+#if defined(MISAKI_HMM_SSE)
+        __m128 c1 = _mm_add_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2)), trans1);
+        __m128 c2 = _mm_add_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 0, 3)), trans2);
+        choice[n] = (uint8_t)_mm_movemask_ps(_mm_cmpgt_ps(c2, c1));
+        v = _mm_add_ps(_mm_max_ps(c1, c2), _mm_loadu_ps(row->prob));
+#elif defined(MISAKI_HMM_NEON)
+        uint8x16_t vb = vreinterpretq_u8_f32(v);
+        float32x4_t c1 = vaddq_f32(vreinterpretq_f32_u8(vqtbl1q_u8(vb, perm1)), trans1);
+        float32x4_t c2 = vaddq_f32(vreinterpretq_f32_u8(vqtbl1q_u8(vb, perm2)), trans2);
+        choice[n] = (uint8_t)vaddvq_u32(vandq_u32(vcgtq_f32(c2, c1), bits));
+        v = vaddq_f32(vmaxq_f32(c1, c2), vld1q_f32(row->prob));
+#else
+        float next[HMM_STATE_COUNT];
+        uint8_t mask = 0;
+        for (int s = 0; s < HMM_STATE_COUNT; s++) {
+            float c1 = v[hmm_prev_status[s][0]] + model->prev_trans[0].prob[s];
+            float c2 = v[hmm_prev_status[s][1]] + model->prev_trans[1].prob[s];
+            if (c2 > c1) {
+                mask |= (uint8_t)(1u << s);
+                c1 = c2;
+            }
+            next[s] = c1 + row->prob[s];
+        }
+        choice[n] = mask;
+        memcpy(v, next, sizeof(next));
+#endif
+        n++;
     }
     
-    if (char_count == 0) {
+    if (n == 0) {
         return 0;
     }
     
-    // 2. 初始化 Viterbi DP 表
-    double V[256][HMM_STATE_COUNT];  // V[t][s] = 时刻 t 状态 s 的最大概率
-    int path[256][HMM_STATE_COUNT];  // path[t][s] = 到达 V[t][s] 的前一个状态
+#if defined(MISAKI_HMM_SSE)
+    _mm_storeu_ps(last, v);
+#elif defined(MISAKI_HMM_NEON)
+    vst1q_f32(last, v);
+#else
+    memcpy(last, v, sizeof(last));
+#endif
+    
+    // 回溯：最后一个状态只能是 E 或 S（与 jieba 一致）
+    int state = last[HMM_STATE_S] > last[HMM_STATE_E] ? HMM_STATE_S : HMM_STATE_E;
+    for (int t = n - 1; t >= 0; t--) {
+        states[t] = (HmmState)state;
+        state = hmm_prev_status[state][(choice[t] >> state) & 1];
+    }
     
-    // 初始化第一个字符
-    for (int s = 0; s < HMM_STATE_COUNT; s++) {
-        double emit_prob = misaki_hmm_get_emit_prob(model, s, chars[0]);
-        V[0][s] = model->prob_start[s] + emit_prob;
-        path[0][s] = -1;  // 第一个字符无前驱
+    return n;
+}
+
+int misaki_hmm_viterbi_spans(const HmmModel *model,
+                             const char *text,
+                             const HmmSpan *spans,
+                             int span_count,
+                             HmmWorkspace *ws) {
+    if (!model || !text || !ws || (span_count > 0 && !spans) || span_count < 0) {
+        return -1;
     }
     
-    // 3. 动态规划：前向传播
-    for (int t = 1; t < char_count; t++) {
-        for (int s = 0; s < HMM_STATE_COUNT; s++) {
-            double max_prob = MIN_PROB;
-            int best_prev = 0;
-            
-            // ⭐ 修复：只遍历合法的前驱状态（使用 PrevStatus 约束）
-            for (int i = 0; i < 2; i++) {
-                int prev_s = prev_status[s][i];
-                double prob = V[t-1][prev_s] + model->prob_trans[prev_s][s];
-                if (prob > max_prob) {
-                    max_prob = prob;
-                    best_prev = prev_s;
-                }
-            }
-            
-            double emit_prob = misaki_hmm_get_emit_prob(model, s, chars[t]);
-            V[t][s] = max_prob + emit_prob;
-            path[t][s] = best_prev;
+    // 字符数不超过字节数，按字节数预留即可
+    int total_bytes = 0;
+    for (int i = 0; i < span_count; i++) {
+        if (spans[i].start < 0 || spans[i].length < 0) {
+            return -1;
         }
+        total_bytes += spans[i].length;
     }
     
-    // 4. 回溯：找到最优路径
-    // ⭐ 修复：最后一个状态只能是 E 或 S（与 jieba 一致）
-    double max_prob = MIN_PROB;
-    int best_state = 0;
-    for (int s = 0; s < HMM_STATE_COUNT; s++) {
-        if (s == HMM_STATE_E || s == HMM_STATE_S) {  // 只考虑 E 和 S
-            if (V[char_count-1][s] > max_prob) {
-                max_prob = V[char_count-1][s];
-                best_state = s;
-            }
+    if (!hmm_workspace_reserve(ws, total_bytes, span_count)) {
+        return -1;
+    }
+    
+    int total = 0;
+    for (int i = 0; i < span_count; i++) {
+        const char *start = text + spans[i].start;
+        int n = hmm_viterbi_span(model, start, start + spans[i].length,
+                                 ws->choice + total, ws->states + total);
+        ws->span_chars[i] = n;
+        total += n;
+    }
+    
+    ws->count = total;
+    return total;
+}
+
+int misaki_hmm_viterbi(const HmmModel *model, 
+                       const char *text,
+                       HmmState *states) {
+    if (!model || !text || !states) {
+        return 0;
+    }
+    
+    HmmWorkspace *ws = misaki_hmm_workspace_create();
+    if (!ws) {
+        return 0;
+    }
+    
+    // 只取前 HMM_VITERBI_MAX_CHARS 个字符（调用者按此分配 states）
+    int length = 0;
+    for (int i = 0; i < HMM_VITERBI_MAX_CHARS && text[length]; i++) {
+        uint32_t codepoint;
+        int bytes = misaki_utf8_decode(text + length, &codepoint);
+        if (bytes == 0) {
+            break;
         }
+        length += bytes;
     }
     
-    // 回溯路径
-    states[char_count-1] = best_state;
-    for (int t = char_count - 2; t >= 0; t--) {
-        states[t] = path[t+1][states[t+1]];
+    HmmSpan span = {0, length};
+    int char_count = misaki_hmm_viterbi_spans(model, text, &span, 1, ws);
+    if (char_count > 0) {
+        memcpy(states, ws->states, sizeof(HmmState) * char_count);
+    } else {
+        char_count = 0;
     }
     
+    misaki_hmm_workspace_free(ws);
     return char_count;
 }
 
@@ -314,22 +524,20 @@ int misaki_hmm_viterbi(const HmmModel *model,
  * 状态序列转换为分词结果
  * ========================================================================== */
 
-MisakiTokenList* misaki_hmm_states_to_tokens(const char *text,
-                                             const HmmState *states,
-                                             int state_count) {
-    if (!text || !states || state_count == 0) {
-        return NULL;
-    }
-    
-    MisakiTokenList *tokens = misaki_token_list_create();
-    if (!tokens) {
-        return NULL;
-    }
-    
-    // 根据状态序列切分（与 jieba 的 __cut 函数逻辑一致）
-    // B-M-E 表示一个词，S 表示单字词
-    
-    int word_start_idx = 0;  // 词的起始字符索引
+/**
+ * 根据状态序列切分一段文本，把结果追加到 Token 列表
+ * （与 jieba 的 __cut 函数逻辑一致：B-M-E 表示一个词，S 表示单字词）
+ * 
+ * @param base_offset 片段在原文中的字节偏移（写入 token.start）
+ * @return 追加的 Token 数量
+ */
+static int hmm_append_tokens(MisakiTokenList *tokens,
+                             const char *text,
+                             int base_offset,
+                             const HmmState *states,
+                             int state_count) {
+    int added = 0;
+    int word_start_idx = 0;   // 词的起始字符索引
     int word_start_byte = 0;  // 词的起始字节位置
     
     const char *p = text;
@@ -348,28 +556,11 @@ MisakiTokenList* misaki_hmm_states_to_tokens(const char *text,
         }
         // 如果是 E 或 S，表示词结束
         else if (states[char_idx] == HMM_STATE_E || states[char_idx] == HMM_STATE_S) {
-            // 计算词的字节长度
             int word_byte_len = byte_pos + bytes - word_start_byte;
-            
-            // 提取词
-            char *word = (char*)malloc(word_byte_len + 1);
-            if (word) {
-                memcpy(word, text + word_start_byte, word_byte_len);
-                word[word_byte_len] = '\0';
-                
-                // 创建 MisakiToken
-                MisakiToken token = {
-                    .text = word,
-                    .tag = NULL,
-                    .phonemes = NULL,
-                    .whitespace = NULL,
-                    .start = word_start_byte,
-                    .length = word_byte_len,
-                    .score = 0.0
-                };
-                
-                misaki_token_list_add(tokens, &token);  // 先 add（会复制 word）
-                free(word);  // 再 free
+            MisakiStringView word = misaki_sv_from_length(text + word_start_byte, word_byte_len);
+            if (misaki_token_list_add_view(tokens, word, NULL, base_offset + word_start_byte,
+                                           word_byte_len, 0.0)) {
+                added++;
             }
             
             // 下一个词的起始位置
@@ -386,41 +577,77 @@ MisakiTokenList* misaki_hmm_states_to_tokens(const char *text,
     if (word_start_idx < state_count) {
         int word_byte_len = byte_pos - word_start_byte;
         if (word_byte_len > 0) {
-            char *word = (char*)malloc(word_byte_len + 1);
-            if (word) {
-                memcpy(word, text + word_start_byte, word_byte_len);
-                word[word_byte_len] = '\0';
-                
-                MisakiToken token = {
-                    .text = word,
-                    .tag = NULL,
-                    .phonemes = NULL,
-                    .whitespace = NULL,
-                    .start = word_start_byte,
-                    .length = word_byte_len,
-                    .score = 0.0
-                };
-                
-                misaki_token_list_add(tokens, &token);
-                free(word);
+            MisakiStringView word = misaki_sv_from_length(text + word_start_byte, word_byte_len);
+            if (misaki_token_list_add_view(tokens, word, NULL, base_offset + word_start_byte,
+                                           word_byte_len, 0.0)) {
+                added++;
             }
         }
     }
     
+    return added;
+}
+
+MisakiTokenList* misaki_hmm_states_to_tokens(const char *text,
+                                             const HmmState *states,
+                                             int state_count) {
+    if (!text || !states || state_count == 0) {
+        return NULL;
+    }
+    
+    MisakiTokenList *tokens = misaki_token_list_create();
+    if (!tokens) {
+        return NULL;
+    }
+    
+    hmm_append_tokens(tokens, text, 0, states, state_count);
     return tokens;
 }
 
+int misaki_hmm_cut_spans(const HmmModel *model,
+                         const char *text,
+                         const HmmSpan *spans,
+                         int span_count,
+                         HmmWorkspace *ws,
+                         MisakiTokenList *out) {
+    if (!out) {
+        return -1;
+    }
+    
+    if (misaki_hmm_viterbi_spans(model, text, spans, span_count, ws) < 0) {
+        return -1;
+    }
+    
+    int added = 0;
+    int offset = 0;
+    for (int i = 0; i < span_count; i++) {
+        int n = ws->span_chars[i];
+        if (n > 0) {
+            added += hmm_append_tokens(out, text + spans[i].start, spans[i].start,
+                                       ws->states + offset, n);
+        }
+        offset += n;
+    }
+    
+    return added;
+}
+
 MisakiTokenList* misaki_hmm_cut(const HmmModel *model, const char *text) {
     if (!model || !text) {
         return NULL;
     }
     
-    HmmState states[256];
-    int char_count = misaki_hmm_viterbi(model, text, states);
-    
-    if (char_count == 0) {
+    HmmWorkspace *ws = misaki_hmm_workspace_create();
+    if (!ws) {
         return NULL;
     }
     
-    return misaki_hmm_states_to_tokens(text, states, char_count);
+    HmmSpan span = {0, (int)strlen(text)};
+    MisakiTokenList *tokens = NULL;
+    if (misaki_hmm_viterbi_spans(model, text, &span, 1, ws) > 0) {
+        tokens = misaki_hmm_states_to_tokens(text, ws->states, ws->count);
+    }
+    
+    misaki_hmm_workspace_free(ws);
+    return tokens;
 }
@@ -642,3 +642,229 @@ const char* misaki_language_name(MisakiLanguage lang) {
         default:              return "未知";
     }
 }
+
+/* ============================================================================
+ * 文字段切分
+ * ========================================================================== */
+
+typedef enum {
+    SCRIPT_NEUTRAL,     // 数字、标点、空白、符号
+    SCRIPT_LATIN,
+    SCRIPT_KANA,
+    SCRIPT_HAN,
+    SCRIPT_HANGUL,
+    SCRIPT_OTHER        // 其他字母文字（希腊、西里尔、阿拉伯、泰文等）
+} ScriptClass;
+
+static ScriptClass script_class(uint32_t cp) {
+    if (is_latin(cp) || (cp >= 0x00C0 && cp <= 0x024F && cp != 0x00D7 && cp != 0x00F7)) {
+        return SCRIPT_LATIN;
+    }
+    if (is_hiragana(cp) || is_katakana(cp) || (cp >= 0xFF66 && cp <= 0xFF9F)) {
+        return SCRIPT_KANA;     // 含半角片假名、长音符
+    }
+    if (is_kanji(cp) || (cp >= 0x3005 && cp <= 0x3007)) {
+        return SCRIPT_HAN;      // 含々〆〇
+    }
+    if (is_hangul(cp) || (cp >= 0x3130 && cp <= 0x318F)) {
+        return SCRIPT_HANGUL;
+    }
+    if (cp >= 0x0370 && cp <= 0x1FFF) {
+        return SCRIPT_OTHER;
+    }
+    return SCRIPT_NEUTRAL;
+}
+
+/**
+ * 假名和汉字同属一段（日文句子里两者交替出现）
+ */
+static ScriptClass script_family(ScriptClass cls) {
+    return cls == SCRIPT_KANA ? SCRIPT_HAN : cls;
+}
+
+typedef struct {
+    MisakiScriptRun *runs;
+    int count;
+    int capacity;
+} ScriptRunList;
+
+/**
+ * 是否为汉字/假名段（只有标点的段不算）
+ */
+static bool script_run_is_cjk(const MisakiScriptRun *run) {
+    return !run->neutral && (run->lang == LANG_CHINESE || run->lang == LANG_JAPANESE);
+}
+
+/**
+ * 结束一个文字段（汉字段先按本段有无假名记为日文/中文，扫描完再确定；
+ * family 为 SCRIPT_NEUTRAL 时是只有标点的段，语言也在扫描完后确定）
+ */
+static bool script_run_push(ScriptRunList *list, size_t begin, size_t end,
+                            ScriptClass family, bool has_kana) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 8;
+        MisakiScriptRun *runs = (MisakiScriptRun *)realloc(list->runs,
+                                                           capacity * sizeof(MisakiScriptRun));
+        if (!runs) {
+            return false;
+        }
+        list->runs = runs;
+        list->capacity = capacity;
+    }
+    
+    MisakiLanguage lang = LANG_UNKNOWN;
+    switch (family) {
+        case SCRIPT_LATIN:  lang = LANG_ENGLISH; break;
+        case SCRIPT_HAN:    lang = has_kana ? LANG_JAPANESE : LANG_CHINESE; break;
+        case SCRIPT_HANGUL: lang = LANG_KOREAN; break;
+        default:            break;
+    }
+    list->runs[list->count++] = (MisakiScriptRun){ begin, end - begin, lang,
+                                                   family == SCRIPT_NEUTRAL };
+    return true;
+}
+
+int misaki_segment_scripts(const char *text, MisakiLanguage cjk_lang, MisakiScriptRun **runs) {
+    if (!text || !runs) {
+        return -1;
+    }
+    *runs = NULL;
+    
+    ScriptRunList list = { NULL, 0, 0 };
+    bool ok = true;
+    bool text_kana = false;
+    
+    ScriptClass current = SCRIPT_NEUTRAL;   // 当前段的文字（NEUTRAL 表示还没有段）
+    bool current_kana = false;
+    size_t run_begin = 0;
+    size_t run_end = 0;
+    
+    // 当前段之后、还没归属的中性字符（首尾的空白除外）
+    bool has_pending = false;
+    bool pending_ascii = true;  // 都是 ASCII（「」、。等全角标点不归拉丁字母段）
+    size_t pending_begin = 0;
+    size_t pending_end = 0;
+    
+    size_t pos = 0;
+    while (text[pos] && ok) {
+        uint32_t cp;
+        int len = misaki_utf8_decode(text + pos, &cp);
+        if (len == 0) {
+            cp = 0xFFFD;    // 非法字节按中性字符处理
+            len = 1;
+        }
+        size_t next = pos + (size_t)len;
+        
+        ScriptClass cls = script_class(cp);
+        if (cls == SCRIPT_NEUTRAL) {
+            if (!(cp < 0x80 && misaki_isspace((char)cp)) && cp != 0x3000) {
+                if (!has_pending) {
+                    pending_begin = pos;
+                    has_pending = true;
+                    pending_ascii = true;
+                }
+                pending_ascii = pending_ascii && cp < 0x80;
+                pending_end = next;
+            }
+            pos = next;
+            continue;
+        }
+        
+        ScriptClass family = script_family(cls);
+        if (current == SCRIPT_NEUTRAL) {
+            // 第一段：前面的中性字符归这一段（拉丁字母段前的全角标点单独成段）
+            run_begin = has_pending ? pending_begin : pos;
+            if (has_pending && family == SCRIPT_LATIN && !pending_ascii) {
+                ok = script_run_push(&list, pending_begin, pending_end, SCRIPT_NEUTRAL, false);
+                run_begin = pos;
+            }
+        } else if (family != current) {
+            // 中间的中性字符默认归前一段；拉丁字母段之后接汉字/假名段时归后一段，
+            // 接其他文字时全角标点单独成段
+            size_t begin = pos;
+            bool split = false;
+            if (has_pending && current == SCRIPT_LATIN && family == SCRIPT_HAN) {
+                begin = pending_begin;
+            } else if (has_pending && current == SCRIPT_LATIN && !pending_ascii) {
+                split = true;
+            } else if (has_pending) {
+                run_end = pending_end;
+            }
+            ok = script_run_push(&list, run_begin, run_end, current, current_kana);
+            if (ok && split) {
+                ok = script_run_push(&list, pending_begin, pending_end, SCRIPT_NEUTRAL, false);
+            }
+            run_begin = begin;
+            current_kana = false;
+        }
+        
+        current = family;
+        current_kana = current_kana || cls == SCRIPT_KANA;
+        text_kana = text_kana || cls == SCRIPT_KANA;
+        run_end = next;
+        has_pending = false;
+        pos = next;
+    }
+    
+    if (ok && current != SCRIPT_NEUTRAL) {
+        bool split = has_pending && current == SCRIPT_LATIN && !pending_ascii;
+        ok = script_run_push(&list, run_begin, has_pending && !split ? pending_end : run_end,
+                             current, current_kana);
+        if (ok && split) {
+            ok = script_run_push(&list, pending_begin, pending_end, SCRIPT_NEUTRAL, false);
+        }
+    }
+    if (!ok) {
+        free(list.runs);
+        return -1;
+    }
+    
+    // 指定了语言时汉字/假名段都用它；否则整个文本里有假名时，没有假名的汉字段也是日文
+    for (int i = 0; i < list.count; i++) {
+        MisakiLanguage lang = list.runs[i].lang;
+        if (lang != LANG_CHINESE && lang != LANG_JAPANESE) {
+            continue;
+        }
+        if (cjk_lang != LANG_UNKNOWN) {
+            list.runs[i].lang = cjk_lang;
+        } else if (text_kana) {
+            list.runs[i].lang = LANG_JAPANESE;
+        }
+    }
+    
+    // 只有标点的段用最近的汉字/假名段的语言（距离相同时取前一段）：
+    // 先从后往前记下每段右边最近的汉字/假名段，再从前往后与左边最近的比较
+    int *next_cjk = (int *)malloc(sizeof(int) * (list.count > 0 ? list.count : 1));
+    if (!next_cjk) {
+        free(list.runs);
+        return -1;
+    }
+    int nearest = -1;
+    for (int i = list.count - 1; i >= 0; i--) {
+        next_cjk[i] = nearest;
+        if (script_run_is_cjk(&list.runs[i])) {
+            nearest = i;
+        }
+    }
+    
+    nearest = -1;
+    for (int i = 0; i < list.count; i++) {
+        if (script_run_is_cjk(&list.runs[i])) {
+            nearest = i;
+            continue;
+        }
+        if (!list.runs[i].neutral) {
+            continue;
+        }
+        int next = next_cjk[i];
+        if (nearest >= 0 && (next < 0 || i - nearest <= next - i)) {
+            list.runs[i].lang = list.runs[nearest].lang;
+        } else if (next >= 0) {
+            list.runs[i].lang = list.runs[next].lang;
+        }
+    }
+    free(next_cjk);
+    
+    *runs = list.runs;
+    return list.count;
+}
@@ -0,0 +1,232 @@
+/**
+ * misaki_memo.c
+ * 
+ * Misaki C Port - Token Memo Table Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_memo.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * 槽内数据的明文形式
+ */
+typedef union {
+    uint64_t words[MISAKI_MEMO_SLOT_WORDS];
+    struct {
+        uint32_t flags;
+        char text[MISAKI_MEMO_SLOT_WORDS * 8 - 4];  // 键 '\0' 值 '\0'
+    } entry;
+} MemoPayload;
+
+/* ============================================================================
+ * 内部函数
+ * ========================================================================== */
+
+static uint64_t memo_hash(const char *key, uint32_t flags) {
+    // FNV-1a (64 位)，再混合一次（桶号取低位）
+    uint64_t hash = 14695981039346656037ull ^ flags;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ull;
+    }
+    
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * 读取槽（读到正在写入或读的过程中被改写时返回 false）
+ */
+static bool slot_read(MisakiMemoSlot *slot, uint64_t tag, MemoPayload *payload) {
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if ((seq & 1) || atomic_load_explicit(&slot->tag, memory_order_relaxed) != tag) {
+        return false;
+    }
+    
+    for (int i = 0; i < MISAKI_MEMO_SLOT_WORDS; i++) {
+        payload->words[i] = atomic_load_explicit(&slot->words[i], memory_order_relaxed);
+    }
+    
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq;
+}
+
+/**
+ * 写入槽（槽正被其他线程写入时放弃）
+ */
+static bool slot_write(MisakiMemoSlot *slot, uint64_t tag, const MemoPayload *payload) {
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    if ((seq & 1) ||
+        !atomic_compare_exchange_strong_explicit(&slot->seq, &seq, seq + 1,
+                                                 memory_order_relaxed,
+                                                 memory_order_relaxed)) {
+        return false;
+    }
+    atomic_thread_fence(memory_order_release);
+    
+    atomic_store_explicit(&slot->tag, tag, memory_order_relaxed);
+    for (int i = 0; i < MISAKI_MEMO_SLOT_WORDS; i++) {
+        atomic_store_explicit(&slot->words[i], payload->words[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&slot->referenced, 1, memory_order_relaxed);
+    
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    return true;
+}
+
+/**
+ * 槽里的键是否就是 key（键相同时返回值的起始位置）
+ */
+static const char* payload_match(const MemoPayload *payload, const char *key, uint32_t flags) {
+    if (payload->entry.flags != flags) {
+        return NULL;
+    }
+    
+    size_t size = sizeof(payload->entry.text);
+    size_t key_len = strnlen(payload->entry.text, size);
+    if (key_len >= size || strcmp(payload->entry.text, key) != 0) {
+        return NULL;
+    }
+    
+    const char *value = payload->entry.text + key_len + 1;
+    if (strnlen(value, size - key_len - 1) >= size - key_len - 1) {
+        return NULL;
+    }
+    return value;
+}
+
+/* ============================================================================
+ * 记忆表操作实现
+ * ========================================================================== */
+
+MisakiMemo* misaki_memo_create(int capacity) {
+    uint32_t slot_count = MISAKI_MEMO_WAYS;
+    while ((int64_t)slot_count < capacity && slot_count < (1u << 30)) {
+        slot_count *= 2;
+    }
+    
+    MisakiMemo *memo = (MisakiMemo *)calloc(1, sizeof(MisakiMemo));
+    if (!memo) {
+        return NULL;
+    }
+    
+    memo->slots = (MisakiMemoSlot *)calloc(slot_count, sizeof(MisakiMemoSlot));
+    if (!memo->slots) {
+        free(memo);
+        return NULL;
+    }
+    
+    memo->mask = slot_count - 1;
+    return memo;
+}
+
+void misaki_memo_free(MisakiMemo *memo) {
+    if (!memo) {
+        return;
+    }
+    
+    free(memo->slots);
+    free(memo);
+}
+
+bool misaki_memo_get(MisakiMemo *memo, const char *key, uint32_t flags,
+                     char *value, size_t value_size) {
+    if (!memo || !key || !value || value_size == 0) {
+        return false;
+    }
+    
+    uint64_t tag = memo_hash(key, flags);
+    uint32_t base = (uint32_t)tag & memo->mask & ~(uint32_t)(MISAKI_MEMO_WAYS - 1);
+    
+    for (int way = 0; way < MISAKI_MEMO_WAYS; way++) {
+        MisakiMemoSlot *slot = &memo->slots[base + way];
+        MemoPayload payload;
+        if (!slot_read(slot, tag, &payload)) {
+            continue;
+        }
+        
+        const char *cached = payload_match(&payload, key, flags);
+        size_t len = cached ? strlen(cached) : 0;
+        if (!cached || len + 1 > value_size) {
+            continue;
+        }
+        
+        memcpy(value, cached, len + 1);
+        if (!atomic_load_explicit(&slot->referenced, memory_order_relaxed)) {
+            atomic_store_explicit(&slot->referenced, 1, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&memo->hit_count, 1, memory_order_relaxed);
+        return true;
+    }
+    
+    atomic_fetch_add_explicit(&memo->miss_count, 1, memory_order_relaxed);
+    return false;
+}
+
+bool misaki_memo_put(MisakiMemo *memo, const char *key, uint32_t flags, const char *value) {
+    if (!memo || !key || !value) {
+        return false;
+    }
+    
+    size_t key_len = strlen(key);
+    size_t value_len = strlen(value);
+    MemoPayload payload;
+    if (key_len + value_len + 2 > sizeof(payload.entry.text)) {
+        return false;
+    }
+    
+    memset(&payload, 0, sizeof(payload));
+    payload.entry.flags = flags;
+    memcpy(payload.entry.text, key, key_len + 1);
+    memcpy(payload.entry.text + key_len + 1, value, value_len + 1);
+    
+    uint64_t tag = memo_hash(key, flags);
+    uint32_t base = (uint32_t)tag & memo->mask & ~(uint32_t)(MISAKI_MEMO_WAYS - 1);
+    
+    // 已有（其他线程刚写入）时不再重复；否则优先用空槽
+    for (int way = 0; way < MISAKI_MEMO_WAYS; way++) {
+        MisakiMemoSlot *slot = &memo->slots[base + way];
+        uint64_t slot_tag = atomic_load_explicit(&slot->tag, memory_order_relaxed);
+        if (slot_tag == tag) {
+            return true;
+        }
+        if (slot_tag == 0) {
+            return slot_write(slot, tag, &payload);
+        }
+    }
+    
+    // CLOCK：从指针处开始，清掉访问位，选第一个没被访问过的槽
+    uint32_t start = atomic_fetch_add_explicit(&memo->hand, 1, memory_order_relaxed);
+    MisakiMemoSlot *victim = NULL;
+    for (int step = 0; step < 2 * MISAKI_MEMO_WAYS; step++) {
+        MisakiMemoSlot *slot = &memo->slots[base + (start + step) % MISAKI_MEMO_WAYS];
+        if (!atomic_exchange_explicit(&slot->referenced, 0, memory_order_relaxed)) {
+            victim = slot;
+            break;
+        }
+    }
+    if (!victim) {
+        victim = &memo->slots[base + start % MISAKI_MEMO_WAYS];
+    }
+    
+    return slot_write(victim, tag, &payload);
+}
+
+void misaki_memo_stats(const MisakiMemo *memo, MisakiMemoStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(MisakiMemoStats));
+    if (!memo) {
+        return;
+    }
+    
+    stats->hit_count = atomic_load_explicit(&memo->hit_count, memory_order_relaxed);
+    stats->miss_count = atomic_load_explicit(&memo->miss_count, memory_order_relaxed);
+    stats->capacity = (int)memo->mask + 1;
+}
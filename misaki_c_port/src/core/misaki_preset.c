@@ -0,0 +1,422 @@
+/**
+ * misaki_preset.c
+ * 
+ * Misaki C Port - Preset Phrase Table Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_preset.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PRESET_MAGIC "MSKPRSET"
+#define PRESET_VERSION 1
+#define PRESET_HEADER_SIZE 32
+#define PRESET_SLOT_SIZE 16
+
+// 每个桶尝试的种子数上限（桶平均 4 个键、槽的负载 0.8 时通常几十次以内）
+#define PRESET_MAX_SEED (1u << 20)
+
+struct MisakiPresetTable {
+    unsigned char *owned;           // 从文件读入的数据（from_memory 时为 NULL）
+    const unsigned char *seeds;
+    const unsigned char *slots;
+    const char *pool;
+    uint32_t count;
+    uint32_t bucket_count;
+    uint32_t slot_count;
+};
+
+/**
+ * 编译时的键
+ */
+typedef struct {
+    uint32_t lang;
+    const char *text;
+    size_t len;
+    const char *phonemes;
+    uint32_t slot;
+} PresetKey;
+
+/* ============================================================================
+ * 内部函数
+ * ========================================================================== */
+
+static uint64_t preset_hash(uint32_t lang, const char *text, size_t len, uint32_t seed) {
+    // FNV-1a（初值随种子、语言变化），再做一次完整的混合
+    uint64_t hash = 14695981039346656037ull ^ ((uint64_t)seed * 0x9e3779b97f4a7c15ull) ^ lang;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ull;
+    }
+    
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint32_t read_u32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static void write_u32(unsigned char *p, uint32_t value) {
+    memcpy(p, &value, 4);
+}
+
+/**
+ * 去掉同一语言下重复的文本（保留第一条），返回剩下的条目数
+ */
+static int preset_unique(PresetKey *keys, int count) {
+    uint32_t capacity = 16;
+    while (capacity < (uint32_t)count * 2) {
+        capacity *= 2;
+    }
+    int *set = (int *)malloc(capacity * sizeof(int));
+    if (!set) {
+        return -1;
+    }
+    memset(set, -1, capacity * sizeof(int));
+    
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        PresetKey *key = &keys[i];
+        uint32_t j = (uint32_t)preset_hash(key->lang, key->text, key->len, 0) & (capacity - 1);
+        bool duplicate = false;
+        while (set[j] >= 0) {
+            const PresetKey *other = &keys[set[j]];
+            if (other->lang == key->lang && other->len == key->len &&
+                memcmp(other->text, key->text, key->len) == 0) {
+                duplicate = true;
+                break;
+            }
+            j = (j + 1) & (capacity - 1);
+        }
+        if (!duplicate) {
+            keys[unique] = *key;
+            set[j] = unique;
+            unique++;
+        }
+    }
+    
+    free(set);
+    return unique;
+}
+
+/**
+ * 为每个桶找种子（键多的桶先放），结果写入 seeds 和每个键的 slot
+ */
+static bool preset_place(PresetKey *keys, int count, uint32_t bucket_count,
+                         uint32_t slot_count, uint32_t *seeds) {
+    uint32_t *bucket_of = (uint32_t *)malloc((size_t)count * sizeof(uint32_t) + 1);
+    uint32_t *bucket_start = (uint32_t *)calloc((size_t)bucket_count + 1, sizeof(uint32_t));
+    uint32_t *members = (uint32_t *)malloc((size_t)count * sizeof(uint32_t) + 1);
+    uint32_t *order = (uint32_t *)malloc((size_t)bucket_count * sizeof(uint32_t));
+    unsigned char *occupied = (unsigned char *)calloc(slot_count, 1);
+    uint32_t *trial = (uint32_t *)malloc((size_t)count * sizeof(uint32_t) + 1);
+    bool ok = bucket_of && bucket_start && members && order && occupied && trial;
+    
+    // 分桶（计数排序）
+    for (int i = 0; ok && i < count; i++) {
+        bucket_of[i] = (uint32_t)(preset_hash(keys[i].lang, keys[i].text, keys[i].len, 0) %
+                                  bucket_count);
+        bucket_start[bucket_of[i] + 1]++;
+    }
+    for (uint32_t b = 0; ok && b < bucket_count; b++) {
+        bucket_start[b + 1] += bucket_start[b];
+        order[b] = b;
+    }
+    if (ok) {
+        uint32_t *fill = (uint32_t *)malloc((size_t)bucket_count * sizeof(uint32_t));
+        ok = fill != NULL;
+        if (ok) {
+            memcpy(fill, bucket_start, (size_t)bucket_count * sizeof(uint32_t));
+            for (int i = 0; i < count; i++) {
+                members[fill[bucket_of[i]]++] = (uint32_t)i;
+            }
+            free(fill);
+        }
+    }
+    
+    // 桶按大小降序（插入排序足够：桶的大小只有几种）
+    for (uint32_t i = 1; ok && i < bucket_count; i++) {
+        uint32_t b = order[i];
+        uint32_t size = bucket_start[b + 1] - bucket_start[b];
+        uint32_t j = i;
+        while (j > 0 && bucket_start[order[j - 1] + 1] - bucket_start[order[j - 1]] < size) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = b;
+    }
+    
+    for (uint32_t i = 0; ok && i < bucket_count; i++) {
+        uint32_t b = order[i];
+        uint32_t start = bucket_start[b];
+        uint32_t size = bucket_start[b + 1] - start;
+        if (size == 0) {
+            break;
+        }
+        
+        bool placed = false;
+        for (uint32_t seed = 1; seed < PRESET_MAX_SEED && !placed; seed++) {
+            placed = true;
+            for (uint32_t k = 0; k < size && placed; k++) {
+                const PresetKey *key = &keys[members[start + k]];
+                uint32_t slot = (uint32_t)(preset_hash(key->lang, key->text, key->len, seed) %
+                                           slot_count);
+                if (occupied[slot]) {
+                    placed = false;
+                }
+                for (uint32_t m = 0; m < k && placed; m++) {
+                    if (trial[m] == slot) {
+                        placed = false;
+                    }
+                }
+                trial[k] = slot;
+            }
+            if (placed) {
+                seeds[b] = seed;
+                for (uint32_t k = 0; k < size; k++) {
+                    occupied[trial[k]] = 1;
+                    keys[members[start + k]].slot = trial[k];
+                }
+            }
+        }
+        ok = placed;
+    }
+    
+    free(bucket_of);
+    free(bucket_start);
+    free(members);
+    free(order);
+    free(occupied);
+    free(trial);
+    return ok;
+}
+
+/**
+ * 校验数据并建立预设表（data 归调用者或 owned）
+ */
+static MisakiPresetTable* preset_table_open(const unsigned char *data, size_t size,
+                                            unsigned char *owned) {
+    if (!data || size < PRESET_HEADER_SIZE || memcmp(data, PRESET_MAGIC, 8) != 0 ||
+        read_u32(data + 8) != PRESET_VERSION) {
+        return NULL;
+    }
+    
+    uint32_t count = read_u32(data + 12);
+    uint32_t bucket_count = read_u32(data + 16);
+    uint32_t slot_count = read_u32(data + 20);
+    uint32_t pool_size = read_u32(data + 24);
+    uint64_t expected = PRESET_HEADER_SIZE + (uint64_t)bucket_count * 4 +
+                        (uint64_t)slot_count * PRESET_SLOT_SIZE + pool_size;
+    if (bucket_count == 0 || slot_count == 0 || expected != size) {
+        return NULL;
+    }
+    
+    const unsigned char *seeds = data + PRESET_HEADER_SIZE;
+    const unsigned char *slots = seeds + (size_t)bucket_count * 4;
+    const char *pool = (const char *)(slots + (size_t)slot_count * PRESET_SLOT_SIZE);
+    
+    // 每个槽的键、值都要在字符串池内且以 '\0' 结尾
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < slot_count; i++) {
+        const unsigned char *slot = slots + (size_t)i * PRESET_SLOT_SIZE;
+        uint32_t key_offset = read_u32(slot + 4);
+        uint32_t key_len = read_u32(slot + 8);
+        uint32_t value_offset = read_u32(slot + 12);
+        if (key_len == 0) {
+            continue;
+        }
+        if ((uint64_t)key_offset + key_len >= pool_size || pool[key_offset + key_len] != '\0' ||
+            value_offset >= pool_size ||
+            !memchr(pool + value_offset, '\0', pool_size - value_offset)) {
+            return NULL;
+        }
+        used++;
+    }
+    if (used != count) {
+        return NULL;
+    }
+    
+    MisakiPresetTable *table = (MisakiPresetTable *)calloc(1, sizeof(MisakiPresetTable));
+    if (!table) {
+        return NULL;
+    }
+    table->owned = owned;
+    table->seeds = seeds;
+    table->slots = slots;
+    table->pool = pool;
+    table->count = count;
+    table->bucket_count = bucket_count;
+    table->slot_count = slot_count;
+    return table;
+}
+
+/* ============================================================================
+ * 编译实现
+ * ========================================================================== */
+
+int misaki_preset_table_build(const MisakiLanguage *langs,
+                              const char *const *texts,
+                              const char *const *phonemes,
+                              int count,
+                              unsigned char **out_data,
+                              size_t *out_size) {
+    if (!langs || !texts || !phonemes || count < 0 || !out_data || !out_size) {
+        return -1;
+    }
+    *out_data = NULL;
+    *out_size = 0;
+    
+    PresetKey *keys = (PresetKey *)calloc((size_t)count + 1, sizeof(PresetKey));
+    if (!keys) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!texts[i] || !texts[i][0] || !phonemes[i]) {
+            free(keys);
+            return -1;
+        }
+        keys[i].lang = (uint32_t)langs[i];
+        keys[i].text = texts[i];
+        keys[i].len = strlen(texts[i]);
+        keys[i].phonemes = phonemes[i];
+    }
+    
+    int unique = preset_unique(keys, count);
+    uint32_t bucket_count = (uint32_t)(unique > 0 ? unique : 0) / 4 + 1;
+    uint32_t slot_count = (uint32_t)(unique > 0 ? unique : 0) * 5 / 4 + 1;
+    uint32_t *seeds = (uint32_t *)calloc(bucket_count, sizeof(uint32_t));
+    if (unique < 0 || !seeds || !preset_place(keys, unique, bucket_count, slot_count, seeds)) {
+        free(seeds);
+        free(keys);
+        return -1;
+    }
+    
+    uint64_t pool_size = 0;
+    for (int i = 0; i < unique; i++) {
+        pool_size += keys[i].len + 1 + strlen(keys[i].phonemes) + 1;
+    }
+    uint64_t size = PRESET_HEADER_SIZE + (uint64_t)bucket_count * 4 +
+                    (uint64_t)slot_count * PRESET_SLOT_SIZE + pool_size;
+    unsigned char *data = pool_size <= UINT32_MAX ? (unsigned char *)calloc(1, size) : NULL;
+    if (!data) {
+        free(seeds);
+        free(keys);
+        return -1;
+    }
+    
+    memcpy(data, PRESET_MAGIC, 8);
+    write_u32(data + 8, PRESET_VERSION);
+    write_u32(data + 12, (uint32_t)unique);
+    write_u32(data + 16, bucket_count);
+    write_u32(data + 20, slot_count);
+    write_u32(data + 24, (uint32_t)pool_size);
+    
+    unsigned char *seed_data = data + PRESET_HEADER_SIZE;
+    unsigned char *slot_data = seed_data + (size_t)bucket_count * 4;
+    char *pool = (char *)(slot_data + (size_t)slot_count * PRESET_SLOT_SIZE);
+    for (uint32_t b = 0; b < bucket_count; b++) {
+        write_u32(seed_data + (size_t)b * 4, seeds[b]);
+    }
+    
+    uint32_t offset = 0;
+    for (int i = 0; i < unique; i++) {
+        unsigned char *slot = slot_data + (size_t)keys[i].slot * PRESET_SLOT_SIZE;
+        size_t value_len = strlen(keys[i].phonemes);
+        write_u32(slot, keys[i].lang);
+        write_u32(slot + 4, offset);
+        write_u32(slot + 8, (uint32_t)keys[i].len);
+        memcpy(pool + offset, keys[i].text, keys[i].len + 1);
+        offset += (uint32_t)keys[i].len + 1;
+        write_u32(slot + 12, offset);
+        memcpy(pool + offset, keys[i].phonemes, value_len + 1);
+        offset += (uint32_t)value_len + 1;
+    }
+    
+    free(seeds);
+    free(keys);
+    *out_data = data;
+    *out_size = (size_t)size;
+    return 0;
+}
+
+/* ============================================================================
+ * 加载与查询实现
+ * ========================================================================== */
+
+MisakiPresetTable* misaki_preset_table_load(const char *path) {
+    if (!path) {
+        return NULL;
+    }
+    
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    
+    unsigned char *data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 &&
+        fseek(file, 0, SEEK_SET) == 0) {
+        data = (unsigned char *)malloc((size_t)size);
+        if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    
+    MisakiPresetTable *table = data ? preset_table_open(data, (size_t)size, data) : NULL;
+    if (!table) {
+        free(data);
+    }
+    return table;
+}
+
+MisakiPresetTable* misaki_preset_table_from_memory(const void *data, size_t size) {
+    return preset_table_open((const unsigned char *)data, size, NULL);
+}
+
+void misaki_preset_table_free(MisakiPresetTable *table) {
+    if (!table) {
+        return;
+    }
+    
+    free(table->owned);
+    free(table);
+}
+
+const char* misaki_preset_table_lookup(const MisakiPresetTable *table,
+                                       MisakiLanguage lang,
+                                       const char *text) {
+    if (!table || !text || table->count == 0) {
+        return NULL;
+    }
+    
+    size_t len = strlen(text);
+    uint32_t bucket = (uint32_t)(preset_hash((uint32_t)lang, text, len, 0) % table->bucket_count);
+    uint32_t seed = read_u32(table->seeds + (size_t)bucket * 4);
+    uint32_t index = (uint32_t)(preset_hash((uint32_t)lang, text, len, seed) % table->slot_count);
+    
+    const unsigned char *slot = table->slots + (size_t)index * PRESET_SLOT_SIZE;
+    uint32_t key_len = read_u32(slot + 8);
+    if (key_len == 0 || key_len != len || read_u32(slot) != (uint32_t)lang ||
+        memcmp(table->pool + read_u32(slot + 4), text, len) != 0) {
+        return NULL;
+    }
+    return table->pool + read_u32(slot + 12);
+}
+
+int misaki_preset_table_count(const MisakiPresetTable *table) {
+    return table ? (int)table->count : 0;
+}
@@ -0,0 +1,730 @@
+/**
+ * misaki_store.c
+ * 
+ * Misaki C Port - Persistent Result Store Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+
+#include "misaki_sync.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STORE_MAGIC "MSKSTORE"
+#define STORE_VERSION 1
+#define STORE_HEADER_SIZE 64
+#define STORE_RECORD_HEADER 16
+
+// 键、值的长度上限（超过时视为残缺记录）
+#define STORE_MAX_FIELD (1u << 20)
+
+// 索引的初始槽数
+#define STORE_INDEX_INITIAL 1024
+
+// 旧记录比有效记录还多、且文件超过这个大小时，追加后自动压缩
+#define STORE_AUTO_COMPACT_BYTES ((size_t)4 << 20)
+
+/**
+ * 索引槽（offset 为 0 表示空槽；记录总在文件头之后）
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t offset;
+} StoreSlot;
+
+struct MisakiStore {
+    char *path;
+    bool read_only;
+    MisakiMutex lock;               // 保护以下所有字段
+    
+    int fd;
+    dev_t dev;                      // 打开的文件（与路径不一致说明被压缩替换了）
+    ino_t ino;
+    const unsigned char *map;       // 只读映射
+    size_t map_size;
+    size_t scanned;                 // 已校验并索引的日志长度（0 表示文件头还没校验）
+    
+    StoreSlot *slots;               // 开放寻址哈希索引
+    uint32_t slot_mask;
+    int count;
+    size_t live_bytes;
+    size_t dead_bytes;
+    
+    uint64_t hit_count;
+    uint64_t miss_count;
+    uint64_t append_count;
+};
+
+/* ============================================================================
+ * 内部函数：校验和、哈希
+ * ========================================================================== */
+
+static const uint32_t CRC32_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC32_NIBBLE[crc & 15];
+        crc = (crc >> 4) ^ CRC32_NIBBLE[crc & 15];
+    }
+    return ~crc;
+}
+
+static uint64_t store_hash(const char *key, size_t len) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ull;
+    }
+    
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static size_t record_size(uint32_t key_len, uint32_t value_len) {
+    size_t size = STORE_RECORD_HEADER + (size_t)key_len + value_len;
+    return (size + 7) & ~(size_t)7;
+}
+
+/**
+ * 记录的校验和（覆盖两个长度字段和键、值）
+ */
+static uint32_t record_crc(const unsigned char *record, uint32_t key_len, uint32_t value_len) {
+    uint32_t crc = crc32_update(0, record, 8);
+    return crc32_update(crc, record + STORE_RECORD_HEADER, (size_t)key_len + value_len);
+}
+
+/**
+ * 解析 offset 处的记录（不超过 end）
+ * 
+ * @return 记录大小，残缺或校验失败返回 0
+ */
+static size_t record_parse(const MisakiStore *store, size_t offset, size_t end,
+                           uint32_t *key_len, uint32_t *value_len) {
+    if (offset + STORE_RECORD_HEADER > end) {
+        return 0;
+    }
+    
+    const unsigned char *record = store->map + offset;
+    uint32_t header[4];
+    memcpy(header, record, sizeof(header));
+    if (header[0] == 0 || header[0] > STORE_MAX_FIELD || header[1] > STORE_MAX_FIELD ||
+        header[3] != 0) {
+        return 0;
+    }
+    
+    size_t size = record_size(header[0], header[1]);
+    if (offset + size > end || record_crc(record, header[0], header[1]) != header[2]) {
+        return 0;
+    }
+    
+    *key_len = header[0];
+    *value_len = header[1];
+    return size;
+}
+
+/**
+ * 已索引记录的键、值长度
+ */
+static void record_lengths(const MisakiStore *store, uint64_t offset,
+                           uint32_t *key_len, uint32_t *value_len) {
+    memcpy(key_len, store->map + offset, 4);
+    memcpy(value_len, store->map + offset + 4, 4);
+}
+
+/* ============================================================================
+ * 内部函数：索引
+ * ========================================================================== */
+
+static bool index_reset(MisakiStore *store) {
+    free(store->slots);
+    store->slots = (StoreSlot *)calloc(STORE_INDEX_INITIAL, sizeof(StoreSlot));
+    store->slot_mask = STORE_INDEX_INITIAL - 1;
+    store->count = 0;
+    store->live_bytes = 0;
+    store->dead_bytes = 0;
+    return store->slots != NULL;
+}
+
+/**
+ * 查找键所在的槽（没有时返回应插入的空槽）
+ */
+static StoreSlot* index_find(const MisakiStore *store, const char *key, uint32_t key_len,
+                             uint64_t hash) {
+    uint32_t i = (uint32_t)hash & store->slot_mask;
+    while (true) {
+        StoreSlot *slot = &store->slots[i];
+        if (slot->offset == 0) {
+            return slot;
+        }
+        if (slot->hash == hash) {
+            uint32_t slot_key_len, slot_value_len;
+            record_lengths(store, slot->offset, &slot_key_len, &slot_value_len);
+            if (slot_key_len == key_len &&
+                memcmp(store->map + slot->offset + STORE_RECORD_HEADER, key, key_len) == 0) {
+                return slot;
+            }
+        }
+        i = (i + 1) & store->slot_mask;
+    }
+}
+
+static bool index_grow(MisakiStore *store) {
+    uint32_t old_capacity = store->slot_mask + 1;
+    StoreSlot *old_slots = store->slots;
+    StoreSlot *slots = (StoreSlot *)calloc((size_t)old_capacity * 2, sizeof(StoreSlot));
+    if (!slots) {
+        return false;
+    }
+    
+    store->slots = slots;
+    store->slot_mask = old_capacity * 2 - 1;
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].offset == 0) {
+            continue;
+        }
+        uint32_t j = (uint32_t)old_slots[i].hash & store->slot_mask;
+        while (slots[j].offset != 0) {
+            j = (j + 1) & store->slot_mask;
+        }
+        slots[j] = old_slots[i];
+    }
+    
+    free(old_slots);
+    return true;
+}
+
+/**
+ * 索引一条记录（同一个键的旧记录变为无效）
+ */
+static bool index_add(MisakiStore *store, uint64_t offset, uint32_t key_len, size_t size) {
+    if ((uint64_t)(store->count + 1) * 10 > (uint64_t)(store->slot_mask + 1) * 7 &&
+        !index_grow(store)) {
+        return false;
+    }
+    
+    const char *key = (const char *)store->map + offset + STORE_RECORD_HEADER;
+    uint64_t hash = store_hash(key, key_len);
+    StoreSlot *slot = index_find(store, key, key_len, hash);
+    if (slot->offset != 0) {
+        uint32_t old_key_len, old_value_len;
+        record_lengths(store, slot->offset, &old_key_len, &old_value_len);
+        size_t old_size = record_size(old_key_len, old_value_len);
+        store->live_bytes -= old_size;
+        store->dead_bytes += old_size;
+    } else {
+        store->count++;
+    }
+    
+    slot->hash = hash;
+    slot->offset = offset;
+    store->live_bytes += size;
+    return true;
+}
+
+/* ============================================================================
+ * 内部函数：文件
+ * ========================================================================== */
+
+/**
+ * 确保映射覆盖文件的前 size 字节
+ */
+static bool store_map(MisakiStore *store, size_t size) {
+    if (size <= store->map_size) {
+        return true;
+    }
+    
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, store->fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    if (store->map) {
+        munmap((void *)store->map, store->map_size);
+    }
+    store->map = (const unsigned char *)map;
+    store->map_size = size;
+    return true;
+}
+
+static void store_unmap(MisakiStore *store) {
+    if (store->map) {
+        munmap((void *)store->map, store->map_size);
+    }
+    store->map = NULL;
+    store->map_size = 0;
+}
+
+/**
+ * 改用 fd 指向的文件（清空索引，之后由 store_refresh 扫描）
+ */
+static bool store_attach(MisakiStore *store, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !index_reset(store)) {
+        return false;
+    }
+    
+    if (store->fd >= 0) {
+        close(store->fd);
+    }
+    store_unmap(store);
+    store->fd = fd;
+    store->dev = st.st_dev;
+    store->ino = st.st_ino;
+    store->scanned = 0;
+    return true;
+}
+
+/**
+ * 重新打开路径上的文件（被其他进程压缩替换后）
+ */
+static bool store_reopen(MisakiStore *store) {
+    int fd = open(store->path, store->read_only ? O_RDONLY : O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    if (!store_attach(store, fd)) {
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 加文件锁（拿到锁时文件已被替换，就换到新文件上重新加锁）
+ */
+static bool store_flock(MisakiStore *store, int operation) {
+    for (int attempt = 0; attempt < 8; attempt++) {
+        while (flock(store->fd, operation) != 0) {
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+        
+        struct stat st;
+        if (stat(store->path, &st) != 0 ||
+            (st.st_dev == store->dev && st.st_ino == store->ino)) {
+            return true;
+        }
+        
+        flock(store->fd, LOCK_UN);
+        if (!store_reopen(store)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * 校验文件头并索引新追加的记录（须持有文件锁）
+ * 
+ * @return 文件大小；不是存储格式或出错返回 -1
+ */
+static long long store_refresh(MisakiStore *store) {
+    struct stat st;
+    if (fstat(store->fd, &st) != 0) {
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size < STORE_HEADER_SIZE) {
+        return (long long)size;
+    }
+    
+    if (!store_map(store, size)) {
+        return -1;
+    }
+    if (store->scanned == 0) {
+        uint32_t version;
+        memcpy(&version, store->map + 8, 4);
+        if (memcmp(store->map, STORE_MAGIC, 8) != 0 || version != STORE_VERSION) {
+            return -1;
+        }
+        store->scanned = STORE_HEADER_SIZE;
+    }
+    
+    // 扫描到第一条残缺的记录为止（残缺的尾部由写入者截掉）
+    while (store->scanned < size) {
+        uint32_t key_len, value_len;
+        size_t record = record_parse(store, store->scanned, size, &key_len, &value_len);
+        if (record == 0 || !index_add(store, store->scanned, key_len, record)) {
+            break;
+        }
+        store->scanned += record;
+    }
+    return (long long)size;
+}
+
+static bool write_all(int fd, const void *data, size_t size, size_t offset) {
+    const unsigned char *p = (const unsigned char *)data;
+    while (size > 0) {
+        ssize_t written = pwrite(fd, p, size, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += written;
+        size -= (size_t)written;
+        offset += (size_t)written;
+    }
+    return true;
+}
+
+static void header_init(unsigned char *header) {
+    uint32_t version = STORE_VERSION;
+    uint32_t header_size = STORE_HEADER_SIZE;
+    memset(header, 0, STORE_HEADER_SIZE);
+    memcpy(header, STORE_MAGIC, 8);
+    memcpy(header + 8, &version, 4);
+    memcpy(header + 12, &header_size, 4);
+}
+
+/**
+ * 写入前的准备（须持有排他锁）：新文件写文件头，残缺的尾部截掉
+ */
+static bool store_prepare_write(MisakiStore *store) {
+    long long size = store_refresh(store);
+    if (size < 0) {
+        return false;
+    }
+    
+    if (store->scanned == 0) {
+        unsigned char header[STORE_HEADER_SIZE];
+        header_init(header);
+        if (!write_all(store->fd, header, STORE_HEADER_SIZE, 0) ||
+            ftruncate(store->fd, STORE_HEADER_SIZE) != 0) {
+            return false;
+        }
+        return store_refresh(store) == STORE_HEADER_SIZE;
+    }
+    
+    if ((size_t)size > store->scanned && ftruncate(store->fd, (off_t)store->scanned) != 0) {
+        return false;
+    }
+    return true;
+}
+
+static char* store_lookup(const MisakiStore *store, const char *key) {
+    if (store->scanned == 0) {
+        return NULL;
+    }
+    
+    uint32_t key_len = (uint32_t)strlen(key);
+    StoreSlot *slot = index_find(store, key, key_len, store_hash(key, key_len));
+    if (slot->offset == 0) {
+        return NULL;
+    }
+    
+    uint32_t value_len;
+    record_lengths(store, slot->offset, &key_len, &value_len);
+    char *value = (char *)malloc((size_t)value_len + 1);
+    if (value) {
+        memcpy(value, store->map + slot->offset + STORE_RECORD_HEADER + key_len, value_len);
+        value[value_len] = '\0';
+    }
+    return value;
+}
+
+/**
+ * 压缩（须持有互斥锁和排他锁，且已 store_prepare_write）
+ */
+static int store_compact_locked(MisakiStore *store) {
+    size_t size = STORE_HEADER_SIZE + store->live_bytes;
+    unsigned char *buffer = (unsigned char *)malloc(size);
+    if (!buffer) {
+        return -1;
+    }
+    
+    header_init(buffer);
+    size_t used = STORE_HEADER_SIZE;
+    for (uint32_t i = 0; i <= store->slot_mask; i++) {
+        uint64_t offset = store->slots[i].offset;
+        if (offset == 0) {
+            continue;
+        }
+        uint32_t key_len, value_len;
+        record_lengths(store, offset, &key_len, &value_len);
+        size_t record = record_size(key_len, value_len);
+        memcpy(buffer + used, store->map + offset, record);
+        used += record;
+    }
+    
+    size_t path_len = strlen(store->path) + 32;
+    char *tmp_path = (char *)malloc(path_len);
+    if (!tmp_path) {
+        free(buffer);
+        return -1;
+    }
+    snprintf(tmp_path, path_len, "%s.compact.%ld", store->path, (long)getpid());
+    
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && write_all(fd, buffer, used, 0) && fsync(fd) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+    ok = ok && rename(tmp_path, store->path) == 0;
+    if (!ok) {
+        unlink(tmp_path);
+    }
+    free(tmp_path);
+    free(buffer);
+    if (!ok) {
+        return -1;
+    }
+    
+    // 等待旧文件锁的进程拿到锁后会发现文件被替换；本进程换到新文件上
+    if (!store_reopen(store) || !store_flock(store, LOCK_EX) || store_refresh(store) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 存储操作实现
+ * ========================================================================== */
+
+MisakiStore* misaki_store_open(const char *path, bool read_only) {
+    if (!path) {
+        return NULL;
+    }
+    
+    MisakiStore *store = (MisakiStore *)calloc(1, sizeof(MisakiStore));
+    if (!store) {
+        return NULL;
+    }
+    store->fd = -1;
+    store->read_only = read_only;
+    store->path = strdup(path);
+    misaki_mutex_init(&store->lock);
+    
+    int fd = read_only ? open(path, O_RDONLY) : open(path, O_RDWR | O_CREAT, 0644);
+    if (!store->path || fd < 0 || !store_attach(store, fd)) {
+        if (fd >= 0 && store->fd != fd) {
+            close(fd);
+        }
+        misaki_store_close(store);
+        return NULL;
+    }
+    
+    bool ok = store_flock(store, read_only ? LOCK_SH : LOCK_EX);
+    if (ok) {
+        ok = read_only ? store_refresh(store) >= 0 : store_prepare_write(store);
+        flock(store->fd, LOCK_UN);
+    }
+    if (!ok) {
+        misaki_store_close(store);
+        return NULL;
+    }
+    return store;
+}
+
+void misaki_store_close(MisakiStore *store) {
+    if (!store) {
+        return;
+    }
+    
+    store_unmap(store);
+    if (store->fd >= 0) {
+        close(store->fd);
+    }
+    misaki_mutex_destroy(&store->lock);
+    free(store->slots);
+    free(store->path);
+    free(store);
+}
+
+char* misaki_store_get(MisakiStore *store, const char *key) {
+    if (!store || !key) {
+        return NULL;
+    }
+    
+    misaki_mutex_lock(&store->lock);
+    char *value = store_lookup(store, key);
+    if (!value && store_flock(store, LOCK_SH)) {
+        // 其他进程可能刚追加了这个键
+        store_refresh(store);
+        flock(store->fd, LOCK_UN);
+        value = store_lookup(store, key);
+    }
+    
+    if (value) {
+        store->hit_count++;
+    } else {
+        store->miss_count++;
+    }
+    misaki_mutex_unlock(&store->lock);
+    return value;
+}
+
+bool misaki_store_put(MisakiStore *store, const char *key, const char *value) {
+    if (!store || !key || !value || store->read_only) {
+        return false;
+    }
+    
+    size_t key_len = strlen(key);
+    size_t value_len = strlen(value);
+    if (key_len == 0 || key_len > STORE_MAX_FIELD || value_len > STORE_MAX_FIELD) {
+        return false;
+    }
+    
+    size_t size = record_size((uint32_t)key_len, (uint32_t)value_len);
+    unsigned char *record = (unsigned char *)calloc(1, size);
+    if (!record) {
+        return false;
+    }
+    uint32_t header[4] = { (uint32_t)key_len, (uint32_t)value_len, 0, 0 };
+    memcpy(record, header, sizeof(header));
+    memcpy(record + STORE_RECORD_HEADER, key, key_len);
+    memcpy(record + STORE_RECORD_HEADER + key_len, value, value_len);
+    header[2] = record_crc(record, header[0], header[1]);
+    memcpy(record + 8, &header[2], 4);
+    
+    misaki_mutex_lock(&store->lock);
+    bool ok = store_flock(store, LOCK_EX);
+    if (ok) {
+        ok = store_prepare_write(store);
+        
+        // 其他进程已经写入了相同的值
+        char *existing = ok ? store_lookup(store, key) : NULL;
+        bool duplicate = existing && strcmp(existing, value) == 0;
+        free(existing);
+        
+        if (ok && !duplicate) {
+            size_t offset = store->scanned;
+            ok = write_all(store->fd, record, size, offset) &&
+                 store_map(store, offset + size) &&
+                 index_add(store, offset, (uint32_t)key_len, size);
+            if (ok) {
+                store->scanned = offset + size;
+                store->append_count++;
+            } else {
+                // 截掉写了一半的记录（截不掉时由下一次写入截掉）
+                int truncated = ftruncate(store->fd, (off_t)offset);
+                (void)truncated;
+            }
+        }
+        
+        if (ok && store->dead_bytes > store->live_bytes &&
+            store->scanned > STORE_AUTO_COMPACT_BYTES) {
+            store_compact_locked(store);
+        }
+        flock(store->fd, LOCK_UN);
+    }
+    misaki_mutex_unlock(&store->lock);
+    
+    free(record);
+    return ok;
+}
+
+int misaki_store_compact(MisakiStore *store) {
+    if (!store || store->read_only) {
+        return -1;
+    }
+    
+    misaki_mutex_lock(&store->lock);
+    int result = -1;
+    if (store_flock(store, LOCK_EX)) {
+        if (store_prepare_write(store)) {
+            result = store_compact_locked(store);
+        }
+        flock(store->fd, LOCK_UN);
+    }
+    misaki_mutex_unlock(&store->lock);
+    return result;
+}
+
+int misaki_store_sync(MisakiStore *store) {
+    if (!store) {
+        return -1;
+    }
+    
+    misaki_mutex_lock(&store->lock);
+    int result = store->read_only || fsync(store->fd) == 0 ? 0 : -1;
+    misaki_mutex_unlock(&store->lock);
+    return result;
+}
+
+void misaki_store_get_stats(MisakiStore *store, MisakiStoreStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(MisakiStoreStats));
+    if (!store) {
+        return;
+    }
+    
+    misaki_mutex_lock(&store->lock);
+    stats->count = store->count;
+    stats->file_size = store->scanned;
+    stats->live_bytes = store->live_bytes;
+    stats->dead_bytes = store->dead_bytes;
+    stats->hit_count = store->hit_count;
+    stats->miss_count = store->miss_count;
+    stats->append_count = store->append_count;
+    misaki_mutex_unlock(&store->lock);
+}
+
+#else /* _WIN32 */
+
+/* Windows 下暂不支持（misaki_store_open 返回 NULL，其余函数为空操作） */
+
+MisakiStore* misaki_store_open(const char *path, bool read_only) {
+    (void)path;
+    (void)read_only;
+    return NULL;
+}
+
+void misaki_store_close(MisakiStore *store) {
+    (void)store;
+}
+
+char* misaki_store_get(MisakiStore *store, const char *key) {
+    (void)store;
+    (void)key;
+    return NULL;
+}
+
+bool misaki_store_put(MisakiStore *store, const char *key, const char *value) {
+    (void)store;
+    (void)key;
+    (void)value;
+    return false;
+}
+
+int misaki_store_compact(MisakiStore *store) {
+    (void)store;
+    return -1;
+}
+
+int misaki_store_sync(MisakiStore *store) {
+    (void)store;
+    return -1;
+}
+
+void misaki_store_get_stats(MisakiStore *store, MisakiStoreStats *stats) {
+    (void)store;
+    if (stats) {
+        memset(stats, 0, sizeof(MisakiStoreStats));
+    }
+}
+
+#endif /* _WIN32 */
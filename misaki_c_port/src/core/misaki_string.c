@@ -605,3 +605,105 @@ bool misaki_isdigit(char c) {
 bool misaki_isalpha(char c) {
     return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
+
+/**
+ * 句末标点
+ */
+static bool sentence_is_terminal(uint32_t cp) {
+    return cp == 0x3002 || cp == 0xFF01 || cp == 0xFF1F ||    // 。！？
+           cp == 0xFF1B || cp == 0x2026 ||                    // ；…
+           cp == '!' || cp == '?' || cp == ';' || cp == '\n';
+}
+
+/**
+ * 句末标点之后仍属于本句的右引号、右括号
+ */
+static bool sentence_is_closer(uint32_t cp) {
+    return cp == 0x300D || cp == 0x300F || cp == 0xFF09 ||    // 」』）
+           cp == 0x3011 || cp == 0x300B ||                    // 】》
+           cp == 0x201D || cp == 0x2019 ||                    // ” ’
+           cp == ')' || cp == '"' || cp == '\'';
+}
+
+/**
+ * 空白（含全角空格）
+ */
+static bool sentence_is_space(uint32_t cp) {
+    return (cp < 0x80 && misaki_isspace((char)cp)) || cp == 0x3000;
+}
+
+size_t misaki_sentence_length(const char *text) {
+    if (!text) {
+        return 0;
+    }
+    
+    const char *p = text;
+    bool ended = false;
+    bool spaced = false;
+    while (*p) {
+        uint32_t cp;
+        int len = misaki_utf8_decode(p, &cp);
+        if (len == 0) {
+            // 非法字节：跳过，不影响切分
+            if (ended) {
+                break;
+            }
+            p++;
+            continue;
+        }
+        
+        bool terminal = sentence_is_terminal(cp);
+        if (cp == '.') {
+            // "." 后面是空白、结尾、右引号或其他句末标点时才算句末
+            uint32_t next = 0;
+            if (p[1] != '\0') {
+                misaki_utf8_decode(p + 1, &next);
+            }
+            terminal = next == 0 || next == '.' || sentence_is_space(next) ||
+                       sentence_is_closer(next) || sentence_is_terminal(next);
+        }
+        
+        if (sentence_is_space(cp)) {
+            // 句末之后的空白归本句；之后再出现的引号属于下一句
+            spaced = ended;
+        } else if (ended && (spaced || (!terminal && !sentence_is_closer(cp)))) {
+            break;
+        }
+        ended = ended || terminal;
+        p += len;
+    }
+    
+    return (size_t)(p - text);
+}
+
+size_t misaki_clause_length(const char *text) {
+    if (!text) {
+        return 0;
+    }
+    
+    const char *p = text;
+    bool ended = false;
+    while (*p) {
+        uint32_t cp;
+        int len = misaki_utf8_decode(p, &cp);
+        if (len == 0) {
+            if (ended) {
+                break;
+            }
+            p++;
+            continue;
+        }
+        
+        if (ended && !sentence_is_space(cp)) {
+            break;
+        }
+        if (cp == 0x3001 || cp == 0xFF0C || cp == 0xFF1A) {        // 、，：
+            ended = true;
+        } else if (cp == ',' || cp == ':') {
+            ended = misaki_isspace(p[1]);
+        }
+        p += len;
+    }
+    
+    return (size_t)(p - text);
+}
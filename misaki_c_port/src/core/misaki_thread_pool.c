@@ -0,0 +1,459 @@
+/**
+ * misaki_thread_pool.c
+ * 
+ * Misaki C Port - Parallel Loop Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_thread_pool.h"
+#include "misaki_sync.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* ============================================================================
+ * 数据结构
+ * ========================================================================== */
+
+/**
+ * 每个工作线程的任务区间 [begin, end)，打包在一个 64 位原子量里：
+ * 本线程从头部取，其他线程从尾部窃取，都用 CAS 修改
+ */
+typedef struct {
+    _Atomic uint64_t range;
+    char padding[64 - sizeof(uint64_t)];  // 避免相邻线程的区间共享缓存行
+} WorkerQueue;
+
+typedef struct {
+    WorkerQueue *queues;
+    int num_threads;
+    MisakiParallelFn fn;
+    void *ctx;
+} ParallelJob;
+
+typedef struct {
+    MisakiThreadPool *pool;
+    int worker;
+} PoolWorker;
+
+/**
+ * 线程池：工作线程 1..num_threads-1 常驻，0 号是调用 misaki_thread_pool_for 的线程
+ */
+struct MisakiThreadPool {
+    int num_threads;            // 线程数（含调用线程）
+    bool spawned;               // 工作线程已启动
+#ifdef _WIN32
+    HANDLE *threads;
+#else
+    pthread_t *threads;
+#endif
+    bool *started;              // 各工作线程是否启动成功
+    PoolWorker *workers;        // 各工作线程的启动参数
+    int started_count;          // 启动成功的工作线程数
+    
+    MisakiMutex mutex;          // 保护以下字段
+    MisakiCond wake;            // 有新任务或要退出
+    MisakiCond done;            // 工作线程做完当前任务
+    ParallelJob *job;           // 当前任务
+    uint64_t generation;        // 任务编号（每提交一个任务加 1）
+    int running;                // 还没做完当前任务的工作线程数
+    bool shutdown;
+    
+    atomic_flag busy;           // 同一时间只执行一个任务
+};
+
+
+static inline uint64_t range_pack(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+static inline uint32_t range_begin(uint64_t range) {
+    return (uint32_t)(range >> 32);
+}
+
+static inline uint32_t range_end(uint64_t range) {
+    return (uint32_t)range;
+}
+
+/* ============================================================================
+ * 工作窃取
+ * ========================================================================== */
+
+/**
+ * 从自己的区间头部取一个任务
+ */
+static bool queue_pop(WorkerQueue *queue, int *index) {
+    uint64_t range = atomic_load_explicit(&queue->range, memory_order_acquire);
+    while (range_begin(range) < range_end(range)) {
+        uint64_t next = range_pack(range_begin(range) + 1, range_end(range));
+        if (atomic_compare_exchange_weak_explicit(&queue->range, &range, next,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *index = (int)range_begin(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 从剩余最多的线程尾部窃取一半，放进自己（已空）的区间
+ */
+static bool queue_steal(ParallelJob *job, int worker) {
+    for (;;) {
+        int victim = -1;
+        uint32_t most = 0;
+        for (int i = 0; i < job->num_threads; i++) {
+            uint64_t range = atomic_load_explicit(&job->queues[i].range, memory_order_acquire);
+            uint32_t remaining = range_end(range) - range_begin(range);
+            if (i != worker && range_begin(range) < range_end(range) && remaining > most) {
+                victim = i;
+                most = remaining;
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+        
+        WorkerQueue *queue = &job->queues[victim];
+        uint64_t range = atomic_load_explicit(&queue->range, memory_order_acquire);
+        uint32_t begin = range_begin(range);
+        uint32_t end = range_end(range);
+        if (begin >= end) {
+            continue;
+        }
+        
+        uint32_t split = end - (end - begin + 1) / 2;
+        if (atomic_compare_exchange_strong_explicit(&queue->range, &range,
+                                                    range_pack(begin, split),
+                                                    memory_order_acq_rel,
+                                                    memory_order_acquire)) {
+            // 自己的区间为空时其他线程不会修改它，直接写入即可
+            atomic_store_explicit(&job->queues[worker].range, range_pack(split, end),
+                                  memory_order_release);
+            return true;
+        }
+    }
+}
+
+static void worker_run(ParallelJob *job, int worker) {
+    WorkerQueue *queue = &job->queues[worker];
+    int index;
+    
+    do {
+        while (queue_pop(queue, &index)) {
+            job->fn(job->ctx, worker, index);
+        }
+    } while (queue_steal(job, worker));
+}
+
+/* ============================================================================
+ * 线程池
+ * ========================================================================== */
+
+/**
+ * 工作线程：等待新任务，执行自己编号的区间（任务用不到的线程直接跳过），直到退出
+ */
+static void pool_worker_loop(MisakiThreadPool *pool, int worker) {
+    uint64_t seen = 0;
+    
+    misaki_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            misaki_cond_wait(&pool->wake, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        ParallelJob *job = pool->job;
+        
+        if (worker < job->num_threads) {
+            misaki_mutex_unlock(&pool->mutex);
+            worker_run(job, worker);
+            misaki_mutex_lock(&pool->mutex);
+        }
+        if (--pool->running == 0) {
+            misaki_cond_broadcast(&pool->done);
+        }
+    }
+    misaki_mutex_unlock(&pool->mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg) {
+    PoolWorker *start = (PoolWorker *)arg;
+    pool_worker_loop(start->pool, start->worker);
+    return 0;
+}
+#else
+static void* worker_main(void *arg) {
+    PoolWorker *start = (PoolWorker *)arg;
+    pool_worker_loop(start->pool, start->worker);
+    return NULL;
+}
+#endif
+
+/**
+ * 启动工作线程（启动失败的线程的区间会被其他线程窃取，不影响结果）
+ */
+static void pool_spawn(MisakiThreadPool *pool) {
+    pool->spawned = true;
+    for (int i = 1; i < pool->num_threads; i++) {
+        pool->workers[i] = (PoolWorker){ pool, i };
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, worker_main, &pool->workers[i], 0, NULL);
+        pool->started[i] = pool->threads[i] != NULL;
+#else
+        pool->started[i] = pthread_create(&pool->threads[i], NULL, worker_main,
+                                          &pool->workers[i]) == 0;
+#endif
+        pool->started_count += pool->started[i];
+    }
+}
+
+/* ============================================================================
+ * 公开接口
+ * ========================================================================== */
+
+int misaki_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
+
+int misaki_parallel_threads(int count, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = misaki_cpu_count();
+    }
+    if (num_threads > count) {
+        num_threads = count;
+    }
+    return num_threads > 0 ? num_threads : 1;
+}
+
+int misaki_parallel_for(int count, int num_threads, MisakiParallelFn fn, void *ctx) {
+    if (count < 0 || !fn) {
+        return -1;
+    }
+    
+    num_threads = misaki_parallel_threads(count, num_threads);
+    if (num_threads == 1) {
+        for (int i = 0; i < count; i++) {
+            fn(ctx, 0, i);
+        }
+        return 0;
+    }
+    
+    // 临时的线程池：只用这一次
+    MisakiThreadPool *pool = misaki_thread_pool_create(num_threads);
+    if (!pool) {
+        return -1;
+    }
+    int ret = misaki_thread_pool_for(pool, count, num_threads, fn, ctx);
+    misaki_thread_pool_free(pool);
+    return ret;
+}
+
+MisakiThreadPool* misaki_thread_pool_create(int num_threads) {
+    MisakiThreadPool *pool = (MisakiThreadPool *)calloc(1, sizeof(MisakiThreadPool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->num_threads = num_threads > 0 ? num_threads : misaki_cpu_count();
+    
+#ifdef _WIN32
+    pool->threads = (HANDLE *)calloc((size_t)pool->num_threads, sizeof(HANDLE));
+#else
+    pool->threads = (pthread_t *)calloc((size_t)pool->num_threads, sizeof(pthread_t));
+#endif
+    pool->started = (bool *)calloc((size_t)pool->num_threads, sizeof(bool));
+    pool->workers = (PoolWorker *)calloc((size_t)pool->num_threads, sizeof(PoolWorker));
+    if (!pool->threads || !pool->started || !pool->workers) {
+        free(pool->threads);
+        free(pool->started);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    
+    misaki_mutex_init(&pool->mutex);
+    misaki_cond_init(&pool->wake);
+    misaki_cond_init(&pool->done);
+    atomic_flag_clear(&pool->busy);
+    return pool;
+}
+
+void misaki_thread_pool_free(MisakiThreadPool *pool) {
+    if (!pool) {
+        return;
+    }
+    
+    misaki_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    misaki_cond_broadcast(&pool->wake);
+    misaki_mutex_unlock(&pool->mutex);
+    
+    for (int i = 1; i < pool->num_threads; i++) {
+        if (!pool->started[i]) {
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+    
+    misaki_cond_destroy(&pool->done);
+    misaki_cond_destroy(&pool->wake);
+    misaki_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool->started);
+    free(pool->workers);
+    free(pool);
+}
+
+int misaki_thread_pool_for(MisakiThreadPool *pool, int count, int num_threads,
+                           MisakiParallelFn fn, void *ctx) {
+    if (count < 0 || !fn) {
+        return -1;
+    }
+    
+    num_threads = misaki_parallel_threads(count, num_threads);
+    if (num_threads == 1) {
+        for (int i = 0; i < count; i++) {
+            fn(ctx, 0, i);
+        }
+        return 0;
+    }
+    
+    // 线程池不够大或正在执行其他调用的任务（包括在回调里再次调用）时临时创建线程
+    if (!pool || num_threads > pool->num_threads) {
+        return misaki_parallel_for(count, num_threads, fn, ctx);
+    }
+    if (atomic_flag_test_and_set_explicit(&pool->busy, memory_order_acquire)) {
+        return misaki_parallel_for(count, num_threads, fn, ctx);
+    }
+    
+    WorkerQueue *queues = (WorkerQueue *)calloc((size_t)num_threads, sizeof(WorkerQueue));
+    if (!queues) {
+        atomic_flag_clear_explicit(&pool->busy, memory_order_release);
+        return -1;
+    }
+    
+    // 平均分配初始区间
+    for (int i = 0; i < num_threads; i++) {
+        uint32_t begin = (uint32_t)((int64_t)count * i / num_threads);
+        uint32_t end = (uint32_t)((int64_t)count * (i + 1) / num_threads);
+        atomic_init(&queues[i].range, range_pack(begin, end));
+    }
+    ParallelJob job = { queues, num_threads, fn, ctx };
+    
+    if (!pool->spawned) {
+        pool_spawn(pool);
+    }
+    
+    misaki_mutex_lock(&pool->mutex);
+    pool->job = &job;
+    pool->running = pool->started_count;
+    pool->generation++;
+    misaki_cond_broadcast(&pool->wake);
+    misaki_mutex_unlock(&pool->mutex);
+    
+    worker_run(&job, 0);
+    
+    // 等所有工作线程离开本次任务后才能释放 job
+    misaki_mutex_lock(&pool->mutex);
+    while (pool->running > 0) {
+        misaki_cond_wait(&pool->done, &pool->mutex);
+    }
+    pool->job = NULL;
+    misaki_mutex_unlock(&pool->mutex);
+    
+    free(queues);
+    atomic_flag_clear_explicit(&pool->busy, memory_order_release);
+    return 0;
+}
+
+/* ============================================================================
+ * 后台线程
+ * ========================================================================== */
+
+struct MisakiThread {
+    MisakiThreadFn fn;
+    void *ctx;
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+};
+
+#ifdef _WIN32
+static DWORD WINAPI thread_main(LPVOID arg) {
+    MisakiThread *thread = (MisakiThread *)arg;
+    thread->fn(thread->ctx);
+    return 0;
+}
+#else
+static void* thread_main(void *arg) {
+    MisakiThread *thread = (MisakiThread *)arg;
+    thread->fn(thread->ctx);
+    return NULL;
+}
+#endif
+
+MisakiThread* misaki_thread_start(MisakiThreadFn fn, void *ctx) {
+    if (!fn) {
+        return NULL;
+    }
+    
+    MisakiThread *thread = (MisakiThread *)calloc(1, sizeof(MisakiThread));
+    if (!thread) {
+        return NULL;
+    }
+    thread->fn = fn;
+    thread->ctx = ctx;
+    
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+    bool started = thread->handle != NULL;
+#else
+    bool started = pthread_create(&thread->handle, NULL, thread_main, thread) == 0;
+#endif
+    if (!started) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void misaki_thread_join(MisakiThread *thread) {
+    if (!thread) {
+        return;
+    }
+    
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    free(thread);
+}
@@ -15,11 +15,89 @@
 #include "misaki_tokenizer.h"
 #include "misaki_string.h"
 #include "misaki_trie.h"
+#include "misaki_sync.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stddef.h>
 #include <math.h>
 
+/* ============================================================================
+ * Token 内部辅助函数
+ * ========================================================================== */
+
+/**
+ * 释放 Token 的音素（内联存储不释放）
+ */
+static void token_release_phonemes(MisakiToken *token) {
+    if (token->phonemes != token->phonemes_inline) {
+        free(token->phonemes);
+    }
+    token->phonemes = NULL;
+}
+
+/**
+ * 释放 Token 拥有的全部字符串（不释放 Token 本身）
+ */
+static void token_release(MisakiToken *token) {
+    free(token->text);
+    free(token->tag);
+    token_release_phonemes(token);
+    free(token->whitespace);
+}
+
+/**
+ * 复制音素到 Token（短串内联）
+ */
+static bool token_store_phonemes(MisakiToken *token, const char *phonemes) {
+    if (!phonemes) {
+        token->phonemes = NULL;
+        return true;
+    }
+    
+    size_t len = strlen(phonemes);
+    if (len < MISAKI_TOKEN_INLINE_PHONEMES) {
+        memcpy(token->phonemes_inline, phonemes, len + 1);
+        token->phonemes = token->phonemes_inline;
+        return true;
+    }
+    
+    token->phonemes = misaki_strdup(phonemes);
+    return token->phonemes != NULL;
+}
+
+/**
+ * Token 被整体搬到新地址后，修正指向旧地址内联缓冲区的 phonemes
+ * 
+ * @param token 新地址上的 Token
+ * @param old_address Token 原来的地址
+ */
+static void token_rebase(MisakiToken *token, uintptr_t old_address) {
+    uintptr_t old_inline = old_address + offsetof(MisakiToken, phonemes_inline);
+    if ((uintptr_t)token->phonemes == old_inline) {
+        token->phonemes = token->phonemes_inline;
+    }
+}
+
+/**
+ * 从视图 Token 复制出 text（移入普通列表时使用）
+ */
+static void token_materialize(MisakiToken *token) {
+    if (token->text || !token->surface.data) {
+        return;
+    }
+    
+    token->text = (char *)malloc(token->surface.length + 1);
+    if (token->text) {
+        memcpy(token->text, token->surface.data, token->surface.length);
+        token->text[token->surface.length] = '\0';
+        token->surface.data = token->text;
+    }
+    if (!token->tag && token->tag_id != MISAKI_TAG_NONE) {
+        token->tag = misaki_strdup(misaki_tag_name(token->tag_id));
+    }
+}
+
 /* ============================================================================
  * Token 操作实现
  * ========================================================================== */
@@ -42,6 +120,8 @@ MisakiToken* misaki_token_create(const char *text,
     token->start = start;
     token->length = length;
     token->score = 0.0;
+    token->surface = misaki_sv_from_cstr(token->text);
+    token->tag_id = misaki_tag_intern(tag);
     
     return token;
 }
@@ -51,10 +131,7 @@ void misaki_token_free(MisakiToken *token) {
         return;
     }
     
-    free(token->text);
-    free(token->tag);
-    free(token->phonemes);
-    free(token->whitespace);
+    token_release(token);
     free(token);
 }
 
@@ -66,9 +143,11 @@ MisakiToken* misaki_token_clone(const MisakiToken *token) {
     MisakiToken *clone = misaki_token_create(token->text, token->tag,
                                               token->start, token->length);
     if (clone) {
-        clone->phonemes = token->phonemes ? misaki_strdup(token->phonemes) : NULL;
+        token_store_phonemes(clone, token->phonemes);
         clone->whitespace = token->whitespace ? misaki_strdup(token->whitespace) : NULL;
         clone->score = token->score;
+        clone->reading = token->reading;
+        clone->ipa = token->ipa;
     }
     
     return clone;
@@ -79,8 +158,40 @@ bool misaki_token_set_phonemes(MisakiToken *token, const char *phonemes) {
         return false;
     }
     
-    free(token->phonemes);
-    token->phonemes = phonemes ? misaki_strdup(phonemes) : NULL;
+    if (!phonemes) {
+        token_release_phonemes(token);
+        return true;
+    }
+    
+    // 先复制再释放旧值（phonemes 可能指向 Token 自身的存储）
+    size_t len = strlen(phonemes);
+    if (len < MISAKI_TOKEN_INLINE_PHONEMES) {
+        char buffer[MISAKI_TOKEN_INLINE_PHONEMES];
+        memcpy(buffer, phonemes, len + 1);
+        token_release_phonemes(token);
+        memcpy(token->phonemes_inline, buffer, len + 1);
+        token->phonemes = token->phonemes_inline;
+        return true;
+    }
+    
+    char *copy = misaki_strdup(phonemes);
+    if (!copy) {
+        return false;
+    }
+    token_release_phonemes(token);
+    token->phonemes = copy;
+    return true;
+}
+
+bool misaki_token_take_phonemes(MisakiToken *token, char *phonemes) {
+    if (!token) {
+        return false;
+    }
+    
+    if (phonemes != token->phonemes) {
+        token_release_phonemes(token);
+        token->phonemes = phonemes;
+    }
     return true;
 }
 
@@ -90,12 +201,94 @@ void misaki_token_set_score(MisakiToken *token, double score) {
     }
 }
 
+MisakiStringView misaki_token_surface(const MisakiToken *token) {
+    if (!token) {
+        return misaki_sv_from_length(NULL, 0);
+    }
+    
+    if (token->surface.data) {
+        return token->surface;
+    }
+    return misaki_sv_from_cstr(token->text);
+}
+
+const char* misaki_token_tag(const MisakiToken *token) {
+    if (!token) {
+        return NULL;
+    }
+    
+    return token->tag ? token->tag : misaki_tag_name(token->tag_id);
+}
+
+/* ============================================================================
+ * 词性标签驻留实现
+ * ========================================================================== */
+
+#define MISAKI_TAG_CAPACITY 256
+
+// 预置标签：日文词典（ja_pron_dict.tsv）的全部词性 + 未登录词
+// 查询不加锁：新标签先写入名称，再发布 g_tag_count（release / acquire）
+static const char *g_tag_names[MISAKI_TAG_CAPACITY] = {
+    NULL,
+    "名詞", "動詞", "副詞", "形容詞", "形状詞", "接尾辞", "感動詞", "助動詞",
+    "助詞", "代名詞", "接頭辞", "連体詞", "記号", "接続詞", "補助記号", "UNK"
+};
+static _Atomic int g_tag_count = 17;
+static MisakiSpinLock g_tag_lock = MISAKI_SPIN_LOCK_INIT;
+
+static MisakiTagId tag_find(const char *tag, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        if (strcmp(g_tag_names[i], tag) == 0) {
+            return (MisakiTagId)i;
+        }
+    }
+    return MISAKI_TAG_NONE;
+}
+
+MisakiTagId misaki_tag_intern(const char *tag) {
+    if (!tag || !*tag) {
+        return MISAKI_TAG_NONE;
+    }
+    
+    int count = atomic_load_explicit(&g_tag_count, memory_order_acquire);
+    MisakiTagId id = tag_find(tag, 1, count);
+    if (id != MISAKI_TAG_NONE) {
+        return id;
+    }
+    
+    // 新标签（只增不减，进程结束时释放）；加锁后再查一次其他线程刚加入的标签
+    misaki_spin_lock(&g_tag_lock);
+    int current = atomic_load_explicit(&g_tag_count, memory_order_relaxed);
+    id = tag_find(tag, count, current);
+    if (id == MISAKI_TAG_NONE && current < MISAKI_TAG_CAPACITY) {
+        char *name = misaki_strdup(tag);
+        if (name) {
+            g_tag_names[current] = name;
+            atomic_store_explicit(&g_tag_count, current + 1, memory_order_release);
+            id = (MisakiTagId)current;
+        }
+    }
+    misaki_spin_unlock(&g_tag_lock);
+    return id;
+}
+
+const char* misaki_tag_name(MisakiTagId id) {
+    if (id == MISAKI_TAG_NONE || id >= atomic_load_explicit(&g_tag_count, memory_order_acquire)) {
+        return NULL;
+    }
+    return g_tag_names[id];
+}
+
+int misaki_tag_count(void) {
+    return atomic_load_explicit(&g_tag_count, memory_order_acquire);
+}
+
 /* ============================================================================
  * Token 列表操作实现
  * ========================================================================== */
 
 MisakiTokenList* misaki_token_list_create(void) {
-    MisakiTokenList *list = (MisakiTokenList *)malloc(sizeof(MisakiTokenList));
+    MisakiTokenList *list = (MisakiTokenList *)calloc(1, sizeof(MisakiTokenList));
     if (!list) {
         return NULL;
     }
@@ -118,31 +311,120 @@ void misaki_token_list_free(MisakiTokenList *list) {
     }
     
     for (int i = 0; i < list->count; i++) {
-        free(list->tokens[i].text);
-        free(list->tokens[i].tag);
-        free(list->tokens[i].phonemes);
-        free(list->tokens[i].whitespace);
+        token_release(&list->tokens[i]);
     }
     
     free(list->tokens);
     free(list);
 }
 
+MisakiTokenList* misaki_token_list_create_view(const char *source) {
+    if (!source) {
+        return NULL;
+    }
+    
+    MisakiTokenList *list = misaki_token_list_create();
+    if (list) {
+        list->source = source;
+        list->view_mode = true;
+    }
+    return list;
+}
+
+/**
+ * 确保列表容量不小于 needed（数组搬家后修正内联音素指针）
+ */
+static bool token_list_reserve(MisakiTokenList *list, int needed) {
+    if (needed <= list->capacity) {
+        return true;
+    }
+    
+    int new_capacity = list->capacity > 0 ? list->capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    
+    uintptr_t old_base = (uintptr_t)list->tokens;
+    MisakiToken *new_tokens = (MisakiToken *)realloc(
+        list->tokens, sizeof(MisakiToken) * new_capacity);
+    if (!new_tokens) {
+        return false;
+    }
+    
+    if ((uintptr_t)new_tokens != old_base) {
+        for (int i = 0; i < list->count; i++) {
+            token_rebase(&new_tokens[i], old_base + sizeof(MisakiToken) * i);
+        }
+    }
+    
+    list->tokens = new_tokens;
+    list->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * 确保列表还能再放一个 Token
+ */
+static bool token_list_reserve_one(MisakiTokenList *list) {
+    return token_list_reserve(list, list->count + 1);
+}
+
+/**
+ * 把 src 的 n 个 Token 搬到 dst（整体移动，不复制字符串）
+ */
+static void token_list_move_tokens(MisakiTokenList *dst_list, MisakiToken *dst,
+                                   MisakiToken *src, int n) {
+    memcpy(dst, src, sizeof(MisakiToken) * n);
+    for (int i = 0; i < n; i++) {
+        token_rebase(&dst[i], (uintptr_t)&src[i]);
+        if (!dst_list->view_mode) {
+            token_materialize(&dst[i]);
+        }
+    }
+}
+
+MisakiToken* misaki_token_list_add_view(MisakiTokenList *list,
+                                        MisakiStringView surface,
+                                        const char *tag,
+                                        int start,
+                                        int length,
+                                        double score) {
+    if (!list || !surface.data || !token_list_reserve_one(list)) {
+        return NULL;
+    }
+    
+    MisakiToken *dest = &list->tokens[list->count];
+    memset(dest, 0, sizeof(MisakiToken));
+    
+    if (list->view_mode) {
+        dest->surface = surface;
+    } else {
+        dest->text = (char *)malloc(surface.length + 1);
+        if (!dest->text) {
+            return NULL;
+        }
+        memcpy(dest->text, surface.data, surface.length);
+        dest->text[surface.length] = '\0';
+        dest->tag = tag ? misaki_strdup(tag) : NULL;
+        dest->surface = misaki_sv_from_length(dest->text, surface.length);
+    }
+    dest->tag_id = misaki_tag_intern(tag);
+    dest->start = start;
+    dest->length = length;
+    dest->score = score;
+    
+    list->count++;
+    return dest;
+}
+
 bool misaki_token_list_add(MisakiTokenList *list, const MisakiToken *token) {
     if (!list || !token) {
         return false;
     }
     
     // 扩容
-    if (list->count >= list->capacity) {
-        int new_capacity = list->capacity * 2;
-        MisakiToken *new_tokens = (MisakiToken *)realloc(
-            list->tokens, sizeof(MisakiToken) * new_capacity);
-        if (!new_tokens) {
-            return false;
-        }
-        list->tokens = new_tokens;
-        list->capacity = new_capacity;
+    if (!token_list_reserve_one(list)) {
+        return false;
     }
     
     // 复制 token
@@ -151,16 +433,108 @@ bool misaki_token_list_add(MisakiTokenList *list, const MisakiToken *token) {
     
     dest->text = misaki_strdup(token->text);
     dest->tag = token->tag ? misaki_strdup(token->tag) : NULL;
-    dest->phonemes = token->phonemes ? misaki_strdup(token->phonemes) : NULL;
+    token_store_phonemes(dest, token->phonemes);
     dest->whitespace = token->whitespace ? misaki_strdup(token->whitespace) : NULL;
     dest->start = token->start;
     dest->length = token->length;
     dest->score = token->score;
+    dest->type = token->type;
+    dest->reading = token->reading;
+    dest->ipa = token->ipa;
+    
+    // 视图 Token 加入普通列表时，从 surface 复制出 text
+    if (!dest->text && token->surface.data) {
+        dest->text = (char *)malloc(token->surface.length + 1);
+        if (dest->text) {
+            memcpy(dest->text, token->surface.data, token->surface.length);
+            dest->text[token->surface.length] = '\0';
+        }
+    }
+    dest->surface = misaki_sv_from_cstr(dest->text);
+    dest->tag_id = token->tag_id ? token->tag_id : misaki_tag_intern(token->tag);
+    
+    list->count++;
+    return true;
+}
+
+bool misaki_token_list_push_owned(MisakiTokenList *list, MisakiToken *token) {
+    if (!list || !token || !token_list_reserve_one(list)) {
+        return false;
+    }
+    
+    MisakiToken *dest = &list->tokens[list->count];
+    token_list_move_tokens(list, dest, token, 1);
+    if (dest->text && !dest->surface.data) {
+        dest->surface = misaki_sv_from_cstr(dest->text);
+    }
+    if (dest->tag_id == MISAKI_TAG_NONE) {
+        dest->tag_id = misaki_tag_intern(dest->tag);
+    }
     
+    memset(token, 0, sizeof(MisakiToken));
     list->count++;
     return true;
 }
 
+bool misaki_token_list_append_list(MisakiTokenList *dst, MisakiTokenList *src) {
+    if (!dst || !src || dst == src) {
+        return false;
+    }
+    
+    if (!token_list_reserve(dst, dst->count + src->count)) {
+        return false;
+    }
+    
+    token_list_move_tokens(dst, dst->tokens + dst->count, src->tokens, src->count);
+    dst->count += src->count;
+    src->count = 0;
+    return true;
+}
+
+bool misaki_token_list_splice(MisakiTokenList *list,
+                              int index,
+                              int remove_count,
+                              MisakiTokenList *insert) {
+    if (!list || insert == list || index < 0 || index > list->count || remove_count < 0) {
+        return false;
+    }
+    
+    if (remove_count > list->count - index) {
+        remove_count = list->count - index;
+    }
+    int insert_count = insert ? insert->count : 0;
+    
+    if (!token_list_reserve(list, list->count - remove_count + insert_count)) {
+        return false;
+    }
+    
+    // 1. 释放被删除的 Token
+    for (int i = index; i < index + remove_count; i++) {
+        token_release(&list->tokens[i]);
+    }
+    
+    // 2. 移动尾部
+    int tail = list->count - index - remove_count;
+    if (tail > 0 && insert_count != remove_count) {
+        MisakiToken *old_tail = list->tokens + index + remove_count;
+        MisakiToken *new_tail = list->tokens + index + insert_count;
+        uintptr_t old_base = (uintptr_t)old_tail;
+        memmove(new_tail, old_tail, sizeof(MisakiToken) * tail);
+        for (int i = 0; i < tail; i++) {
+            token_rebase(&new_tail[i], old_base + sizeof(MisakiToken) * i);
+        }
+    }
+    
+    // 3. 移入新 Token
+    if (insert_count > 0) {
+        token_list_move_tokens(list, list->tokens + index, insert->tokens, insert_count);
+        insert->count = 0;
+    }
+    
+    list->count += insert_count - remove_count;
+    return true;
+}
+
 MisakiToken* misaki_token_list_get(const MisakiTokenList *list, int index) {
     if (!list || index < 0 || index >= list->count) {
         return NULL;
@@ -179,10 +553,7 @@ void misaki_token_list_clear(MisakiTokenList *list) {
     }
     
     for (int i = 0; i < list->count; i++) {
-        free(list->tokens[i].text);
-        free(list->tokens[i].tag);
-        free(list->tokens[i].phonemes);
-        free(list->tokens[i].whitespace);
+        token_release(&list->tokens[i]);
     }
     
     list->count = 0;
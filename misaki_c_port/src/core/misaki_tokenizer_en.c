@@ -28,6 +28,23 @@ static bool is_punctuation(char c) {
            (c >= 123 && c <= 126);   // { | } ~
 }
 
+// 追加 text[start, start + len) 为一个 Token（只分配一次 text）
+static void en_push_token(MisakiTokenList *list, const char *text, int start, int len) {
+    MisakiToken token = {0};
+    token.text = (char *)malloc(len + 1);
+    if (!token.text) {
+        return;
+    }
+    memcpy(token.text, text + start, len);
+    token.text[len] = '\0';
+    token.start = start;
+    token.length = len;
+    
+    if (!misaki_token_list_push_owned(list, &token)) {
+        free(token.text);
+    }
+}
+
 /* ============================================================================
  * 英文分词主函数
  * ========================================================================== */
@@ -59,15 +76,7 @@ MisakiTokenList* misaki_en_tokenize_ex(const char *text, bool keep_punctuation)
             if (in_token) {
                 int token_len = current_pos - token_start;
                 if (token_len > 0) {
-                    char word[256];
-                    memcpy(word, text + token_start, token_len);
-                    word[token_len] = '\0';
-                    
-                    MisakiToken *token = misaki_token_create(word, NULL, token_start, token_len);
-                    if (token) {
-                        misaki_token_list_add(list, token);
-                        misaki_token_free(token);
-                    }
+                    en_push_token(list, text, token_start, token_len);
                 }
                 in_token = false;
             }
@@ -77,27 +86,14 @@ MisakiTokenList* misaki_en_tokenize_ex(const char *text, bool keep_punctuation)
                 // 结束当前 token
                 int token_len = current_pos - token_start;
                 if (token_len > 0) {
-                    char word[256];
-                    memcpy(word, text + token_start, token_len);
-                    word[token_len] = '\0';
-                    
-                    MisakiToken *token = misaki_token_create(word, NULL, token_start, token_len);
-                    if (token) {
-                        misaki_token_list_add(list, token);
-                        misaki_token_free(token);
-                    }
+                    en_push_token(list, text, token_start, token_len);
                 }
                 in_token = false;
             }
             
             // 如果保留标点，添加为单独 token
             if (keep_punctuation) {
-                char punct[2] = {c, '\0'};
-                MisakiToken *token = misaki_token_create(punct, NULL, current_pos, 1);
-                if (token) {
-                    misaki_token_list_add(list, token);
-                    misaki_token_free(token);
-                }
+                en_push_token(list, text, current_pos, 1);
             }
         } else {
             // 普通字符
@@ -115,15 +111,7 @@ MisakiTokenList* misaki_en_tokenize_ex(const char *text, bool keep_punctuation)
     if (in_token) {
         int token_len = current_pos - token_start;
         if (token_len > 0) {
-            char word[256];
-            memcpy(word, text + token_start, token_len);
-            word[token_len] = '\0';
-            
-            MisakiToken *token = misaki_token_create(word, NULL, token_start, token_len);
-            if (token) {
-                misaki_token_list_add(list, token);
-                misaki_token_free(token);
-            }
+            en_push_token(list, text, token_start, token_len);
         }
     }
     
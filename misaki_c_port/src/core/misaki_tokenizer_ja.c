@@ -16,6 +16,8 @@
 #include "misaki_string.h"
 #include "misaki_trie.h"
 #include "misaki_transition_rules.h"  // 添加词性转移规则
+#include "misaki_char_class.h"  // 未登录词的字符类别
+#include "misaki_sync.h"        // 多线程共享同一个分词器
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -27,7 +29,14 @@
 typedef struct {
     Trie *dict_trie;       // 词典 Trie 树
     bool use_simple_model; // 使用简化模型（false=使用Viterbi）
-    CostMatrix *cost_matrix; // 成本矩阵（可选）
+    _Atomic(CostMatrix *) cost_matrix; // 连接成本矩阵（按词性 ID 查表）
+    CostMatrix *cost_overrides; // 从文件加载的成本（可为 NULL）
+    CostMatrix **retired;  // 被替换的旧矩阵（其他线程可能还在用，释放分词器时才释放）
+    int retired_count;
+    ViterbiBeam beam;      // 束搜索参数（全为 0 时为精确搜索）
+    int max_matches;       // 每个位置保留的词典匹配数（0 = 不限）
+    ViterbiPruneStats prune_stats; // 剪枝计数（各次调用结束时合并）
+    MisakiSpinLock lock;   // 保护矩阵替换和计数合并
 } JaTokenizer;
 
 /* ============================================================================
@@ -46,7 +55,18 @@ void* misaki_ja_tokenizer_create(const JaTokenizerConfig *config) {
     
     tokenizer->dict_trie = config->dict_trie;
     tokenizer->use_simple_model = config->use_simple_model;
-    tokenizer->cost_matrix = NULL; // TODO: 加载成本矩阵
+    tokenizer->beam.beam_width = config->beam_width > 0 ? config->beam_width : 0;
+    tokenizer->beam.cost_threshold = config->beam_threshold > 0.0f ? config->beam_threshold : 0.0f;
+    tokenizer->max_matches = config->max_matches > 0 ? config->max_matches : 0;
+    
+    // 连接成本矩阵：内置词性规则预计算成矩阵，文件中的成本优先
+    // （词典加载时已驻留全部词性，矩阵覆盖所有词典节点）
+    if (config->cost_matrix_path) {
+        tokenizer->cost_overrides = misaki_cost_matrix_load(config->cost_matrix_path);
+    }
+    atomic_init(&tokenizer->cost_matrix,
+                misaki_transition_matrix_build_with(tokenizer->cost_overrides));
+    atomic_flag_clear(&tokenizer->lock);
     
     return tokenizer;
 }
@@ -54,9 +74,12 @@ void* misaki_ja_tokenizer_create(const JaTokenizerConfig *config) {
 void misaki_ja_tokenizer_free(void *tokenizer) {
     if (tokenizer) {
         JaTokenizer *ja = (JaTokenizer *)tokenizer;
-        if (ja->cost_matrix) {
-            misaki_cost_matrix_free(ja->cost_matrix);
+        misaki_cost_matrix_free(atomic_load(&ja->cost_matrix));
+        misaki_cost_matrix_free(ja->cost_overrides);
+        for (int i = 0; i < ja->retired_count; i++) {
+            misaki_cost_matrix_free(ja->retired[i]);
         }
+        free(ja->retired);
         free(tokenizer);
     }
 }
@@ -66,47 +89,164 @@ void misaki_ja_tokenizer_free(void *tokenizer) {
  * ========================================================================== */
 
 /**
- * Viterbi 模式：构建 Lattice 并求最优路径
+ * 取本次调用使用的连接成本矩阵，必要时重建以覆盖所有已驻留的词性
+ * （之后加载的词典可能带来新词性）
+ * 
+ * 矩阵本身只读；重建时换上新矩阵，旧矩阵留到释放分词器时再释放，
+ * 所以并发的调用可以继续使用各自取到的矩阵（超出范围的词性按 0 成本处理）
  */
-static MisakiTokenList* ja_tokenize_viterbi(JaTokenizer *ja, const char *text) {
-    // 1. 计算文本长度（字符数）
-    int text_len = misaki_utf8_length(text);
-    if (text_len == 0) {
-        return NULL;
+static const CostMatrix* ja_sync_cost_matrix(JaTokenizer *ja) {
+    CostMatrix *matrix = atomic_load_explicit(&ja->cost_matrix, memory_order_acquire);
+    if (matrix && matrix->left_size >= misaki_tag_count()) {
+        return matrix;
     }
     
-    // 2. 创建 Lattice
-    Lattice *lattice = misaki_lattice_create(text_len);
-    if (!lattice) {
-        return NULL;
+    misaki_spin_lock(&ja->lock);
+    matrix = atomic_load_explicit(&ja->cost_matrix, memory_order_relaxed);
+    if (!matrix || matrix->left_size < misaki_tag_count()) {
+        CostMatrix *rebuilt = misaki_transition_matrix_build_with(ja->cost_overrides);
+        CostMatrix **retired = (CostMatrix **)realloc(ja->retired,
+                                                      sizeof(CostMatrix *) * (ja->retired_count + 1));
+        if (retired) {
+            ja->retired = retired;
+        }
+        if (rebuilt && retired) {
+            if (matrix) {
+                ja->retired[ja->retired_count++] = matrix;
+            }
+            atomic_store_explicit(&ja->cost_matrix, rebuilt, memory_order_release);
+            matrix = rebuilt;
+        } else {
+            misaki_cost_matrix_free(rebuilt);
+        }
+    }
+    misaki_spin_unlock(&ja->lock);
+    return matrix;
+}
+
+/**
+ * 把一次调用的剪枝计数合并到分词器
+ */
+static void ja_merge_prune_stats(JaTokenizer *ja, const ViterbiPruneStats *stats) {
+    if (!stats->beam_hits && !stats->pruned_paths && !stats->pruned_matches &&
+        !stats->exact_fallbacks) {
+        return;
     }
     
-    // 3. 构建 Lattice：添加所有可能的节点和边
-    // 存储每个位置的所有节点（用于连接边）
-    LatticeNode ***nodes_by_pos = (LatticeNode ***)calloc(text_len + 1, sizeof(LatticeNode **));
-    int *counts_by_pos = (int *)calloc(text_len + 1, sizeof(int));
+    misaki_spin_lock(&ja->lock);
+    ja->prune_stats.beam_hits += stats->beam_hits;
+    ja->prune_stats.pruned_paths += stats->pruned_paths;
+    ja->prune_stats.pruned_matches += stats->pruned_matches;
+    ja->prune_stats.exact_fallbacks += stats->exact_fallbacks;
+    misaki_spin_unlock(&ja->lock);
+}
+
+// 合并节点的最大字符数
+#define JA_UNK_MAX_GROUP 256
+
+// 未登录词节点成本（与长度无关，同 MeCab unk.def）
+// 单字符的成本较高（惩罚），提高惩罚值使得分词器更倾向于选择长词（⭐ 30.0）；
+// 合并节点不享受长度奖励，所以由词典词拼成的复合词仍然优先
+#define JA_UNK_COST 30.0f
+
+/**
+ * 从 p 开始扫描同类别的连续字符
+ * 
+ * @return 字符数（最多 max_chars），bytes 输出对应的字节数
+ */
+static int ja_scan_run(const char *p, MisakiCharClass char_class, int max_chars, int *bytes) {
+    int chars = 0;
+    int total = 0;
     
-    if (!nodes_by_pos || !counts_by_pos) {
-        misaki_lattice_free(lattice);
-        free(nodes_by_pos);
-        free(counts_by_pos);
+    while (chars < max_chars && p[total]) {
+        uint32_t codepoint;
+        int n = misaki_utf8_decode(p + total, &codepoint);
+        if (n == 0 || misaki_char_class(codepoint) != char_class) {
+            break;
+        }
+        total += n;
+        chars++;
+    }
+    
+    *bytes = total;
+    return chars;
+}
+
+/**
+ * 词典匹配剪枝：标记要保留的匹配（成本最低的 max_matches 个，
+ * 以及与最优匹配差距不超过阈值的），返回丢弃的个数
+ * 
+ * 最优匹配总是保留，所以每个有匹配的位置仍有节点出发
+ */
+static int ja_prune_matches(const JaTokenizer *ja, const float *costs, int count, bool *keep) {
+    float best = INFINITY;
+    for (int i = 0; i < count; i++) {
+        keep[i] = true;
+        if (costs[i] < best) {
+            best = costs[i];
+        }
+    }
+    
+    int dropped = 0;
+    if (ja->beam.cost_threshold > 0.0f) {
+        for (int i = 0; i < count; i++) {
+            if (costs[i] > best + ja->beam.cost_threshold) {
+                keep[i] = false;
+                dropped++;
+            }
+        }
+    }
+    
+    // 每轮丢掉剩下的成本最高的匹配（匹配数最多 100，直接选择即可）
+    while (ja->max_matches > 0 && count - dropped > ja->max_matches) {
+        int worst = -1;
+        for (int i = 0; i < count; i++) {
+            if (keep[i] && (worst < 0 || costs[i] >= costs[worst])) {
+                worst = i;
+            }
+        }
+        keep[worst] = false;
+        dropped++;
+    }
+    
+    return dropped;
+}
+
+/**
+ * 构建 Lattice：添加所有可能的节点（连接成本在搜索时计算，不建边）
+ * 
+ * @param stats 本次调用的剪枝计数
+ * @return 紧凑 Lattice，空文本或失败返回 NULL
+ */
+static CompactLattice* ja_build_lattice(const JaTokenizer *ja, const char *text,
+                                        ViterbiPruneStats *stats) {
+    // 1. 计算文本长度（字符数）
+    int text_len = misaki_utf8_length(text);
+    if (text_len == 0) {
         return NULL;
     }
     
-    // 为每个位置分配节点数组
-    for (int i = 0; i <= text_len; i++) {
-        nodes_by_pos[i] = (LatticeNode **)calloc(100, sizeof(LatticeNode *));
+    // 2. 创建紧凑 Lattice（SoA 布局，节点以偏移引用原文）
+    CompactLattice *lattice = misaki_compact_lattice_create(text);
+    if (!lattice) {
+        return NULL;
     }
     
+    // 3. 构建 Lattice：添加所有可能的节点（连接成本在搜索时计算，不建边）
     int byte_pos = 0;
     const char *p = text;
+    MisakiTagId unk_tag = misaki_tag_intern("UNK");
+    MisakiCharClass prev_class = MISAKI_CHAR_CLASS_COUNT;
+    int group_end = 0;  // 最近一个合并节点覆盖到的位置
     
     for (int char_pos = 0; char_pos < text_len; char_pos++) {
         // 从当前位置查找所有可能的词
         TrieMatch matches[100];
         int match_count = misaki_trie_match_all(ja->dict_trie, text, byte_pos, matches, 100);
         
-        bool has_match = false;
+        float match_costs[100];
+        int match_chars[100];
+        bool match_keep[100];
         for (int i = 0; i < match_count; i++) {
             TrieMatch *m = &matches[i];
             
@@ -121,106 +261,124 @@ static MisakiTokenList* ja_tokenize_viterbi(JaTokenizer *ja, const char *text) {
             // 增大长度奖励，使得长词更有优势
             // ⭐ 增加到 25.0 确保「くれました」等补助动词完整性！
             double node_cost = -log(freq) - (word_char_len - 1) * 25.0;
-            
-            // 添加节点到 Lattice
-            LatticeNode *node = misaki_lattice_add_node(
-                lattice, char_pos, m->word, m->tag, NULL, node_cost);
-            
-            if (node) {
-                // 计算这个词跨越的字符数
-                node->length = word_char_len;
-                
-                // 存储节点（用于后续连接边）
-                if (counts_by_pos[char_pos] < 100) {
-                    nodes_by_pos[char_pos][counts_by_pos[char_pos]++] = node;
-                    has_match = true;
-                }
-            }
+            match_costs[i] = (float)node_cost;
+            match_chars[i] = word_char_len;
+            match_keep[i] = true;
+        }
+        
+        // 可选：限制每个位置的匹配数（长假名串上匹配数很多）
+        if (match_count > 1 && (ja->max_matches > 0 || ja->beam.cost_threshold > 0.0f)) {
+            int dropped = ja_prune_matches(ja, match_costs, match_count, match_keep);
+            stats->pruned_matches += (uint64_t)dropped;
         }
         
-        // 如果没有匹配，添加单字符节点（未登录词、标点符号等）
-        if (!has_match) {
-            uint32_t codepoint;
-            int bytes = misaki_utf8_decode(p, &codepoint);
-            if (bytes > 0) {
-                char single_char[8];
-                memcpy(single_char, p, bytes);
-                single_char[bytes] = '\0';
-                
-                // 单字符的成本较高（惩罚）
-                // 提高惩罚值，使得分词器更倾向于选择长词
-                // ⭐ 进一步提高到 30.0！
-                LatticeNode *node = misaki_lattice_add_node(
-                    lattice, char_pos, single_char, "UNK", NULL, 30.0);
-                
-                if (node) {
-                    node->length = 1;  // 单字符
-                    if (counts_by_pos[char_pos] < 100) {
-                        nodes_by_pos[char_pos][counts_by_pos[char_pos]++] = node;
-                    }
-                }
+        bool has_match = false;
+        for (int i = 0; i < match_count; i++) {
+            if (!match_keep[i]) {
+                continue;
+            }
+            
+            // 添加节点到 Lattice（读音随节点带到 Token，G2P 不必再查词典）
+            int node = misaki_compact_lattice_add(lattice, char_pos, match_chars[i], byte_pos,
+                                                  matches[i].length, matches[i].tag_id,
+                                                  match_costs[i]);
+            if (node >= 0) {
+                misaki_compact_lattice_set_reading(lattice, node, matches[i].pron, matches[i].ipa);
+                has_match = true;
             }
         }
         
-        // 移动到下一个字符
         uint32_t codepoint;
         int bytes = misaki_utf8_decode(p, &codepoint);
         if (bytes == 0) break;
         
+        // 未登录词（MeCab char.def 风格）：按字符类别决定是否生成、是否合并
+        MisakiCharClass char_class = misaki_char_class(codepoint);
+        const MisakiCharCategory *category = misaki_char_category(char_class);
+        bool run_start = char_class != prev_class || char_pos == group_end;
+        bool invoke = category->invoke || !has_match;
+        bool has_single = false;
+        prev_class = char_class;
+        
+        // 同类别连续字符合并成一个节点（外来语、拉丁字母、数字串）
+        int group_length = 0;
+        if (invoke && category->group && run_start) {
+            int group_bytes = 0;
+            group_length = ja_scan_run(p, char_class, JA_UNK_MAX_GROUP, &group_bytes);
+            misaki_compact_lattice_add(lattice, char_pos, group_length, byte_pos, group_bytes,
+                                       unk_tag, JA_UNK_COST);
+            group_end = char_pos + group_length;
+            has_single = group_length == 1;
+        }
+        
+        // 额外的 1..length 字符节点
+        for (int n = 1; invoke && n <= category->length; n++) {
+            int unk_bytes = 0;
+            if (ja_scan_run(p, char_class, n, &unk_bytes) < n) {
+                break;
+            }
+            if (n == group_length) {
+                continue;
+            }
+            misaki_compact_lattice_add(lattice, char_pos, n, byte_pos, unk_bytes,
+                                       unk_tag, JA_UNK_COST);
+            has_single = has_single || n == 1;
+        }
+        
+        // 兜底：没有任何节点从这里开始、也不在合并节点内部时，添加单字符节点，
+        // 保证 Lattice 连通
+        if (!has_match && !has_single && char_pos >= group_end) {
+            misaki_compact_lattice_add(lattice, char_pos, 1, byte_pos, bytes,
+                                       unk_tag, JA_UNK_COST);
+        }
+        
+        // 移动到下一个字符
         p += bytes;
         byte_pos += bytes;
     }
     
-    // 4. 连接边：从 BOS 到第一个位置的所有节点
-    for (int i = 0; i < counts_by_pos[0]; i++) {
-        misaki_lattice_add_edge(lattice->bos, nodes_by_pos[0][i], 0.0);
+    return lattice;
+}
+
+/**
+ * Viterbi 模式：构建 Lattice 并求最优路径，结果写入 result
+ */
+static MisakiTokenList* ja_tokenize_viterbi(JaTokenizer *ja, const char *text,
+                                            MisakiTokenList *result) {
+    if (!result) {
+        return NULL;
     }
     
-    // 连接边：每个节点到其后继节点
-    for (int pos = 0; pos < text_len; pos++) {
-        for (int i = 0; i < counts_by_pos[pos]; i++) {
-            LatticeNode *from = nodes_by_pos[pos][i];
-            int next_pos = pos + from->length;
-            
-            if (next_pos < text_len) {
-                // 连接到下一个位置的所有节点
-                for (int j = 0; j < counts_by_pos[next_pos]; j++) {
-                    LatticeNode *to = nodes_by_pos[next_pos][j];
-                    
-                    // ⭐ 添加词性转移成本！
-                    double trans_cost = misaki_get_transition_cost(from->feature, to->feature);
-                    
-                    misaki_lattice_add_edge(from, to, trans_cost);
-                }
-            } else if (next_pos == text_len) {
-                // 连接到 EOS
-                misaki_lattice_add_edge(from, lattice->eos, 0.0);
-            }
-        }
+    ViterbiPruneStats stats = {0};
+    CompactLattice *lattice = ja_build_lattice(ja, text, &stats);
+    if (!lattice) {
+        misaki_token_list_free(result);
+        return NULL;
     }
     
-    // 5. 执行 Viterbi 算法
-    bool success = misaki_viterbi_search(lattice);
-    if (!success) {
-        misaki_lattice_free(lattice);
-        for (int i = 0; i <= text_len; i++) {
-            free(nodes_by_pos[i]);
-        }
-        free(nodes_by_pos);
-        free(counts_by_pos);
+    // 4. 执行 Viterbi 算法（⭐ 词性转移成本按每对相邻节点查表）
+    // （配置了束宽/阈值时剪枝；剪枝后无解则退回精确搜索）
+    const CostMatrix *matrix = ja_sync_cost_matrix(ja);
+    bool found = misaki_compact_viterbi_search_beam(lattice, matrix, &ja->beam, &stats);
+    if (!found && (ja->beam.beam_width > 0 || ja->beam.cost_threshold > 0.0f)) {
+        stats.exact_fallbacks++;
+        found = misaki_compact_viterbi_search(lattice, matrix);
+    }
+    ja_merge_prune_stats(ja, &stats);
+    if (!found) {
+        misaki_token_list_free(result);
+        misaki_compact_lattice_free(lattice);
         return NULL;
     }
     
-    // 6. 提取最优路径
-    MisakiTokenList *result = misaki_viterbi_extract_tokens(lattice);
-    
-    // 7. 清理
-    misaki_lattice_free(lattice);
-    for (int i = 0; i <= text_len; i++) {
-        free(nodes_by_pos[i]);
+    // 5. 提取最优路径
+    if (misaki_compact_viterbi_append_tokens(lattice, result) <= 0) {
+        misaki_token_list_free(result);
+        result = NULL;
     }
-    free(nodes_by_pos);
-    free(counts_by_pos);
+    
+    // 6. 清理
+    misaki_compact_lattice_free(lattice);
     
     return result;
 }
@@ -233,5 +391,76 @@ MisakiTokenList* misaki_ja_tokenize(void *tokenizer, const char *text) {
     JaTokenizer *ja = (JaTokenizer *)tokenizer;
     
     // 强制使用 Viterbi 模式
-    return ja_tokenize_viterbi(ja, text);
+    return ja_tokenize_viterbi(ja, text, misaki_token_list_create());
+}
+
+MisakiTokenList* misaki_ja_tokenize_view(void *tokenizer, const char *text) {
+    if (!tokenizer || !text) {
+        return NULL;
+    }
+    
+    return ja_tokenize_viterbi((JaTokenizer *)tokenizer, text, misaki_token_list_create_view(text));
+}
+
+void misaki_ja_tokenizer_get_prune_stats(void *tokenizer, ViterbiPruneStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(ViterbiPruneStats));
+    if (!tokenizer) {
+        return;
+    }
+    
+    // 与 ja_merge_prune_stats 同一把锁，读到的四个计数属于同一时刻
+    JaTokenizer *ja = (JaTokenizer *)tokenizer;
+    misaki_spin_lock(&ja->lock);
+    *stats = ja->prune_stats;
+    misaki_spin_unlock(&ja->lock);
+}
+
+int misaki_ja_tokenize_nbest(void *tokenizer, const char *text, int n,
+                             MisakiTokenList **results) {
+    if (!tokenizer || !text || n <= 0 || !results) {
+        return 0;
+    }
+    
+    JaTokenizer *ja = (JaTokenizer *)tokenizer;
+    ViterbiPruneStats stats = {0};
+    CompactLattice *lattice = ja_build_lattice(ja, text, &stats);
+    ja_merge_prune_stats(ja, &stats);
+    if (!lattice) {
+        return 0;
+    }
+    
+    // 后向 A* 需要精确的前向成本，这里不做束剪枝
+    const CostMatrix *matrix = ja_sync_cost_matrix(ja);
+    if (!misaki_compact_viterbi_search(lattice, matrix)) {
+        misaki_compact_lattice_free(lattice);
+        return 0;
+    }
+    
+    NBestResult *paths = (NBestResult *)calloc(n, sizeof(NBestResult));
+    if (!paths) {
+        misaki_compact_lattice_free(lattice);
+        return 0;
+    }
+    
+    int path_count = misaki_compact_viterbi_nbest(lattice, matrix, n, paths);
+    int count = 0;
+    for (int i = 0; i < path_count; i++) {
+        MisakiTokenList *list = misaki_token_list_create();
+        if (!list) {
+            break;
+        }
+        if (misaki_compact_nbest_append_tokens(lattice, matrix, &paths[i], list) < 0) {
+            misaki_token_list_free(list);
+            break;
+        }
+        results[count++] = list;
+    }
+    
+    misaki_nbest_free(paths, path_count);
+    free(paths);
+    misaki_compact_lattice_free(lattice);
+    return count;
 }
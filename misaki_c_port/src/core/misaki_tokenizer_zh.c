@@ -178,44 +178,137 @@ static bool calculate_route(const DAG *dag, const Trie *trie,
     return true;
 }
 
+/* ============================================================================
+ * 路径切分辅助函数
+ * ========================================================================== */
+
+/**
+ * 连续单字片段（可能是未登录词，交给 HMM 重新切分）
+ */
+typedef struct {
+    int char_start;   // 起始字符位置
+    int byte_start;   // 起始字节位置
+    int char_count;   // 单字数量
+    int byte_length;  // 字节长度
+} ZhSingleRun;
+
+/**
+ * 按词典路径追加一个词
+ * score = log(freq) + 词长奖励（与 calculate_route 一致）
+ */
+static void zh_append_word(MisakiTokenList *result, const Trie *trie,
+                           const char *text, int byte_start,
+                           int byte_length, int char_length) {
+    // 只有完全匹配时才使用词典频率
+    TrieMatch match;
+    double freq = 1.0;
+    if (misaki_trie_match_longest(trie, text, byte_start, &match)) {
+        if (match.length == byte_length) {
+            freq = match.frequency > 0 ? match.frequency : 1.0;
+        }
+    }
+    
+    double score = log(freq) + (char_length - 1) * 15.0;
+    misaki_token_list_add_view(result, misaki_sv_from_length(text + byte_start, byte_length),
+                               NULL, byte_start, byte_length, score);
+}
+
+/**
+ * DAG 中是否存在 from → to 的边（即 text[from, to) 是词典词）
+ */
+static bool zh_dag_has_edge(const DAG *dag, int from, int to) {
+    if (from < 0 || from >= dag->length) {
+        return false;
+    }
+    
+    const DAGNode *node = &dag->nodes[from];
+    for (int i = 0; i < node->count; i++) {
+        if (node->next_positions[i] == to) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 输出一段连续单字
+ * 
+ * 2 个以上连续单字用 HMM 重新切分；但如果最后一个单字和后面的多字词
+ * 能组成词典词（next_end 为该多字词的结束位置，没有则为 -1），保持原样
+ */
+static void zh_flush_single_run(ZhTokenizer *zh, const DAG *dag,
+                                const char *text, ZhSingleRun *run,
+                                int next_end, HmmWorkspace **ws,
+                                MisakiTokenList *result) {
+    if (run->char_count == 0) {
+        return;
+    }
+    
+    bool use_hmm = zh->enable_hmm && zh->hmm_model && run->char_count >= 2;
+    if (use_hmm && next_end > 0 &&
+        zh_dag_has_edge(dag, run->char_start + run->char_count - 1, next_end)) {
+        use_hmm = false;
+    }
+    
+    if (use_hmm) {
+        if (!*ws) {
+            *ws = misaki_hmm_workspace_create();
+        }
+        
+        HmmSpan span = {run->byte_start, run->byte_length};
+        if (*ws && misaki_hmm_cut_spans(zh->hmm_model, text, &span, 1, *ws, result) > 0) {
+            run->char_count = 0;
+            return;
+        }
+    }
+    
+    // 不用 HMM（或 HMM 失败），逐字输出
+    int byte_pos = run->byte_start;
+    int byte_end = run->byte_start + run->byte_length;
+    while (byte_pos < byte_end) {
+        uint32_t codepoint;
+        int bytes = misaki_utf8_decode(text + byte_pos, &codepoint);
+        if (bytes == 0) break;
+        zh_append_word(result, zh->dict_trie, text, byte_pos, bytes, 1);
+        byte_pos += bytes;
+    }
+    run->char_count = 0;
+}
+
 /* ============================================================================
  * 中文分词主函数
  * ========================================================================== */
 
-MisakiTokenList* misaki_zh_tokenize(void *tokenizer, const char *text) {
-    if (!tokenizer || !text) {
+/**
+ * 分词结果写入 result（普通模式和视图模式共用）
+ */
+static MisakiTokenList* zh_tokenize_into(ZhTokenizer *zh, const char *text,
+                                         MisakiTokenList *result) {
+    
+    if (!result) {
         return NULL;
     }
     
-    ZhTokenizer *zh = (ZhTokenizer *)tokenizer;
-    
     // 1. 构建 DAG
     DAG *dag = misaki_dag_build(text, zh->dict_trie);
     if (!dag) {
+        misaki_token_list_free(result);
         return NULL;
     }
     
     // 2. 动态规划计算路径
     int *route = (int *)calloc(dag->length, sizeof(int));
-    if (!route) {
-        misaki_dag_free(dag);
-        return NULL;
-    }
-    
-    if (!calculate_route(dag, zh->dict_trie, text, route, NULL)) {
-        free(route);
-        misaki_dag_free(dag);
-        return NULL;
-    }
-    
-    // 3. 根据路径切分文本
-    MisakiTokenList *result = misaki_token_list_create();
-    if (!result) {
+    if (!route || !calculate_route(dag, zh->dict_trie, text, route, NULL)) {
         free(route);
         misaki_dag_free(dag);
+        misaki_token_list_free(result);
         return NULL;
     }
     
+    // 3. 根据路径切分文本（连续单字在遇到多字词或结尾时一并交给 HMM）
+
+    ZhSingleRun run = {0, 0, 0, 0};
+    HmmWorkspace *ws = NULL;
     int char_pos = 0;
     int byte_pos = 0;
     
@@ -234,28 +327,20 @@ MisakiTokenList* misaki_zh_tokenize(void *tokenizer, const char *text) {
             word_byte_len += bytes;
         }
         
-        // 创建 Token
         if (word_byte_len > 0) {
-            char word[256];
-            memcpy(word, text + byte_pos, word_byte_len);
-            word[word_byte_len] = '\0';
-            
-            MisakiToken *token = misaki_token_create(word, NULL, byte_pos, word_byte_len);
-            if (token) {
-                // ⭐ 计算并设置 score（基于词频）
-                TrieMatch match;
-                double freq = 1.0;
-                if (misaki_trie_match_longest(zh->dict_trie, text, byte_pos, &match)) {
-                    if (match.length == word_byte_len) {
-                        freq = match.frequency > 0 ? match.frequency : 1.0;
-                    }
+            if (word_char_len == 1) {
+                // 单字：先累积
+                if (run.char_count == 0) {
+                    run.char_start = char_pos;
+                    run.byte_start = byte_pos;
+                    run.byte_length = 0;
                 }
-                // score = log(freq) + 词长奖励
-                double score = log(freq) + (word_char_len - 1) * 15.0;
-                token->score = score;
-                
-                misaki_token_list_add(result, token);
-                misaki_token_free(token);
+                run.char_count++;
+                run.byte_length += word_byte_len;
+            } else {
+                zh_flush_single_run(zh, dag, text, &run, next_pos, &ws, result);
+                zh_append_word(result, zh->dict_trie, text, byte_pos,
+                               word_byte_len, word_char_len);
             }
         }
         
@@ -263,111 +348,29 @@ MisakiTokenList* misaki_zh_tokenize(void *tokenizer, const char *text) {
         byte_pos += word_byte_len;
     }
     
+    zh_flush_single_run(zh, dag, text, &run, -1, &ws, result);
+    
+    misaki_hmm_workspace_free(ws);
     free(route);
     misaki_dag_free(dag);
     
-    // 4. HMM 后处理：对连续的单字进行 HMM 重新切分
-    if (zh->enable_hmm && zh->hmm_model && result->count > 0) {
-        MisakiTokenList *hmm_result = misaki_token_list_create();
-        if (hmm_result) {
-            int i = 0;
-            while (i < result->count) {
-                // 检测是否是连续的单字（可能是未登录词）
-                int start = i;
-                int single_char_count = 0;
-                
-                // 统计连续单字数量
-                while (i < result->count) {
-                    const char *token_text = result->tokens[i].text;
-                    int char_len = 0;
-                    const char *p = token_text;
-                    while (*p) {
-                        uint32_t codepoint;
-                        int bytes = misaki_utf8_decode(p, &codepoint);
-                        if (bytes == 0) break;
-                        char_len++;
-                        p += bytes;
-                    }
-                    
-                    if (char_len == 1) {
-                        single_char_count++;
-                        i++;
-                    } else {
-                        break;
-                    }
-                }
-                
-                // 如果有 2 个以上连续单字，用 HMM 重新切分
-                // ⭐ 但是：如果下一个 token 是多字词且以当前单字组合开头，不合并
-                bool should_use_hmm = (single_char_count >= 2);
-                
-                if (should_use_hmm && (start + single_char_count) < result->count) {
-                    // 检查下一个 token
-                    const char *next_token = result->tokens[start + single_char_count].text;
-                    
-                    // 如果下一个 token 不是单字，且以最后一个单字开头
-                    int next_char_len = 0;
-                    const char *p_next = next_token;
-                    while (*p_next) {
-                        uint32_t codepoint;
-                        int bytes = misaki_utf8_decode(p_next, &codepoint);
-                        if (bytes == 0) break;
-                        next_char_len++;
-                        p_next += bytes;
-                    }
-                    
-                    if (next_char_len > 1) {
-                        // 检查是否有组合词（最后一个单字 + 下一个 token 的前缀）
-                        char combined[256] = {0};
-                        strcat(combined, result->tokens[start + single_char_count - 1].text);
-                        strcat(combined, next_token);
-                        
-                        // 查询组合词是否在词典中
-                        TrieMatch match_combined;
-                        ZhTokenizer *zh = (ZhTokenizer *)tokenizer;
-                        if (zh->dict_trie && misaki_trie_lookup(zh->dict_trie, combined, NULL, NULL)) {
-                            // 组合词存在，不用 HMM 合并
-                            should_use_hmm = false;
-                        }
-                    }
-                }
-                
-                if (should_use_hmm) {
-                    // 合并连续单字
-                    char oov_text[256] = {0};
-                    for (int j = start; j < start + single_char_count; j++) {
-                        strcat(oov_text, result->tokens[j].text);
-                    }
-                    
-                    // 用 HMM 切分
-                    MisakiTokenList *hmm_tokens = misaki_hmm_cut(zh->hmm_model, oov_text);
-                    if (hmm_tokens && hmm_tokens->count > 0) {
-                        // 添加 HMM 切分结果
-                        for (int j = 0; j < hmm_tokens->count; j++) {
-                            misaki_token_list_add(hmm_result, &hmm_tokens->tokens[j]);
-                        }
-                        misaki_token_list_free(hmm_tokens);
-                    } else {
-                        // HMM 失败，保持原样
-                        for (int j = start; j < start + single_char_count; j++) {
-                            misaki_token_list_add(hmm_result, &result->tokens[j]);
-                        }
-                    }
-                } else if (single_char_count == 1) {
-                    misaki_token_list_add(hmm_result, &result->tokens[start]);
-                } else {
-                    misaki_token_list_add(hmm_result, &result->tokens[i]);
-                    i++;
-                }
-            }
-            
-            // 替换结果
-            misaki_token_list_free(result);
-            result = hmm_result;
-        }
+    return result;
+}
+
+MisakiTokenList* misaki_zh_tokenize(void *tokenizer, const char *text) {
+    if (!tokenizer || !text) {
+        return NULL;
     }
     
-    return result;
+    return zh_tokenize_into((ZhTokenizer *)tokenizer, text, misaki_token_list_create());
+}
+
+MisakiTokenList* misaki_zh_tokenize_view(void *tokenizer, const char *text) {
+    if (!tokenizer || !text) {
+        return NULL;
+    }
+    
+    return zh_tokenize_into((ZhTokenizer *)tokenizer, text, misaki_token_list_create_view(text));
 }
 
 MisakiTokenList* misaki_zh_tokenize_all(void *tokenizer, const char *text) {
@@ -15,6 +15,7 @@
  */
 
 #include "misaki_transition_rules.h"
+#include "misaki_tokenizer.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -140,3 +141,43 @@ double misaki_get_transition_cost(const char *left_tag, const char *right_tag) {
     // 默认：无特殊处理
     return 0.0;
 }
+
+/* ============================================================================
+ * 预计算成本矩阵
+ * ========================================================================== */
+
+CostMatrix* misaki_transition_matrix_build(void) {
+    return misaki_transition_matrix_build_with(NULL);
+}
+
+CostMatrix* misaki_transition_matrix_build_with(const CostMatrix *overrides) {
+    int count = misaki_tag_count();
+    int left_size = count;
+    int right_size = count;
+    if (overrides) {
+        left_size = overrides->left_size > count ? overrides->left_size : count;
+        right_size = overrides->right_size > count ? overrides->right_size : count;
+    }
+    
+    CostMatrix *matrix = misaki_cost_matrix_create(left_size, right_size);
+    if (!matrix) {
+        return NULL;
+    }
+    
+    // ID 0（无词性）和未驻留的 ID 对应 NULL，规则返回 0
+    for (int left = 0; left < left_size; left++) {
+        const char *left_tag = misaki_tag_name((MisakiTagId)left);
+        for (int right = 0; right < right_size; right++) {
+            double cost;
+            if (misaki_cost_matrix_covers(overrides, left, right) &&
+                (!overrides->defined || (overrides->defined[left] && overrides->defined[right]))) {
+                cost = misaki_cost_matrix_get(overrides, left, right);
+            } else {
+                cost = misaki_get_transition_cost(left_tag, misaki_tag_name((MisakiTagId)right));
+            }
+            misaki_cost_matrix_set(matrix, left, right, (int16_t)cost);
+        }
+    }
+    
+    return matrix;
+}
@@ -9,7 +9,9 @@
 
 #include "misaki_trie.h"
 #include "misaki_string.h"
+#include "misaki_tokenizer.h"  // 词性标签驻留
 #include "misaki_dict.h"  // TSVParser 定义在这里
+#include "misaki_arena.h"  // 字符串池
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -29,6 +31,7 @@ static TrieNode* trie_node_create(uint32_t codepoint) {
     node->pron = NULL;  // 新增：读音字段
     node->frequency = 0.0;
     node->tag = NULL;
+    node->tag_id = MISAKI_TAG_NONE;
     node->children = NULL;
     node->children_count = 0;
     node->children_capacity = 0;
@@ -107,6 +110,7 @@ Trie* misaki_trie_create(void) {
     }
     
     trie->word_count = 0;
+    trie->strings = NULL;
     
     return trie;
 }
@@ -117,6 +121,7 @@ void misaki_trie_free(Trie *trie) {
     }
     
     trie_node_free(trie->root);
+    misaki_string_pool_free(trie->strings);
     free(trie);
 }
 
@@ -169,6 +174,7 @@ bool misaki_trie_insert(Trie *trie,
     // 保存词性
     if (tag && !current->tag) {
         current->tag = misaki_strdup(tag);
+        current->tag_id = misaki_tag_intern(tag);
     }
     
     return true;
@@ -303,6 +309,9 @@ int misaki_trie_match_all(const Trie *trie,
             matches[match_count].length = current_pos - start_pos;
             matches[match_count].frequency = current->frequency;
             matches[match_count].tag = current->tag;
+            matches[match_count].tag_id = current->tag_id;
+            matches[match_count].pron = current->pron;
+            matches[match_count].ipa = current->ipa;
             match_count++;
         }
         
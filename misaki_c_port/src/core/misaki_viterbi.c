@@ -9,15 +9,81 @@
 
 #include "misaki_viterbi.h"
 #include "misaki_string.h"
+#include "misaki_tokenizer.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <float.h>
+#include <stdint.h>
+#include <math.h>
 
 /* ============================================================================
  * Lattice 操作实现
  * ========================================================================== */
 
+// 每个位置节点数组的初始容量
+#define LATTICE_INITIAL_NODES 8
+
+/**
+ * 在 arena 中初始化位置数组和 BOS/EOS
+ */
+static bool lattice_init(Lattice *lattice, int text_length) {
+    MisakiArena *arena = lattice->arena;
+    
+    lattice->text_length = text_length;
+    lattice->nodes = (LatticeNode ***)misaki_arena_alloc(
+        arena, sizeof(LatticeNode **) * (text_length + 1));
+    lattice->node_counts = (int *)misaki_arena_alloc(arena, sizeof(int) * (text_length + 1));
+    lattice->node_capacities = (int *)misaki_arena_alloc(arena, sizeof(int) * (text_length + 1));
+    lattice->end_nodes = (LatticeNode ***)misaki_arena_alloc(
+        arena, sizeof(LatticeNode **) * (text_length + 1));
+    lattice->end_counts = (int *)misaki_arena_alloc(arena, sizeof(int) * (text_length + 1));
+    lattice->end_capacities = (int *)misaki_arena_alloc(arena, sizeof(int) * (text_length + 1));
+    lattice->bos = (LatticeNode *)misaki_arena_alloc(arena, sizeof(LatticeNode));
+    lattice->eos = (LatticeNode *)misaki_arena_alloc(arena, sizeof(LatticeNode));
+    
+    if (!lattice->nodes || !lattice->node_counts || !lattice->node_capacities ||
+        !lattice->end_nodes || !lattice->end_counts || !lattice->end_capacities ||
+        !lattice->bos || !lattice->eos) {
+        return false;
+    }
+    
+    // 初始化 BOS
+    lattice->bos->pos = 0;
+    lattice->bos->surface = misaki_arena_strdup(arena, "BOS");
+    lattice->bos->total_cost = 0.0;
+    lattice->bos->node_cost = 0.0;
+    
+    // 初始化 EOS
+    lattice->eos->pos = text_length;
+    lattice->eos->surface = misaki_arena_strdup(arena, "EOS");
+    lattice->eos->total_cost = DBL_MAX;
+    lattice->eos->node_cost = 0.0;
+    
+    return true;
+}
+
+/**
+ * 释放不在 arena 中的节点数据（next 数组、音素）
+ */
+static void lattice_release_nodes(Lattice *lattice) {
+    if (lattice->nodes) {
+        for (int i = 0; i <= lattice->text_length; i++) {
+            for (int j = 0; j < lattice->node_counts[i]; j++) {
+                LatticeNode *node = lattice->nodes[i][j];
+                free(node->phonemes);
+                free(node->next);
+                free(node->next_costs);
+            }
+        }
+    }
+    
+    if (lattice->bos) {
+        free(lattice->bos->next);
+        free(lattice->bos->next_costs);
+    }
+}
+
 Lattice* misaki_lattice_create(int text_length) {
     if (text_length <= 0) {
         return NULL;
@@ -28,53 +94,41 @@ Lattice* misaki_lattice_create(int text_length) {
         return NULL;
     }
     
-    lattice->text_length = text_length;
-    
-    // 分配节点数组（每个位置是一个动态数组）
-    lattice->nodes = (LatticeNode ***)calloc(text_length + 1, sizeof(LatticeNode **));
-    lattice->node_counts = (int *)calloc(text_length + 1, sizeof(int));
-    lattice->node_capacities = (int *)calloc(text_length + 1, sizeof(int));
-    
-    if (!lattice->nodes || !lattice->node_counts || !lattice->node_capacities) {
-        free(lattice->nodes);
-        free(lattice->node_counts);
-        free(lattice->node_capacities);
-        free(lattice);
+    lattice->arena = misaki_arena_create(0);
+    if (!lattice->arena || !lattice_init(lattice, text_length)) {
+        misaki_lattice_free(lattice);
         return NULL;
     }
     
-    // 为每个位置初始化数组
-    for (int i = 0; i <= text_length; i++) {
-        lattice->node_capacities[i] = 10;  // 初始容量
-        lattice->nodes[i] = (LatticeNode **)calloc(10, sizeof(LatticeNode *));
-        if (!lattice->nodes[i]) {
-            misaki_lattice_free(lattice);
-            return NULL;
-        }
-    }
-    
-    // 创建 BOS 和 EOS 节点
-    lattice->bos = (LatticeNode *)calloc(1, sizeof(LatticeNode));
-    lattice->eos = (LatticeNode *)calloc(1, sizeof(LatticeNode));
-    
-    if (!lattice->bos || !lattice->eos) {
-        misaki_lattice_free(lattice);
+    return lattice;
+}
+
+Lattice* misaki_lattice_create_for_text(const char *text) {
+    if (!text) {
         return NULL;
     }
     
-    // 初始化 BOS
-    lattice->bos->pos = 0;
-    lattice->bos->surface = misaki_strdup("BOS");
-    lattice->bos->total_cost = 0.0;
-    lattice->bos->node_cost = 0.0;
+    Lattice *lattice = misaki_lattice_create((int)misaki_utf8_length(text));
+    if (lattice) {
+        lattice->text = text;
+    }
+    return lattice;
+}
+
+bool misaki_lattice_reset(Lattice *lattice, const char *text) {
+    if (!lattice || !text) {
+        return false;
+    }
     
-    // 初始化 EOS
-    lattice->eos->pos = text_length;
-    lattice->eos->surface = misaki_strdup("EOS");
-    lattice->eos->total_cost = DBL_MAX;
-    lattice->eos->node_cost = 0.0;
+    int text_length = (int)misaki_utf8_length(text);
+    if (text_length <= 0) {
+        return false;
+    }
     
-    return lattice;
+    lattice_release_nodes(lattice);
+    misaki_arena_reset(lattice->arena);
+    lattice->text = text;
+    return lattice_init(lattice, text_length);
 }
 
 void misaki_lattice_free(Lattice *lattice) {
@@ -82,40 +136,66 @@ void misaki_lattice_free(Lattice *lattice) {
         return;
     }
     
-    // 释放所有位置的节点
-    for (int i = 0; i <= lattice->text_length; i++) {
-        if (lattice->nodes[i]) {
-            for (int j = 0; j < lattice->node_counts[i]; j++) {
-                LatticeNode *node = lattice->nodes[i][j];
-                if (node) {
-                    free(node->surface);
-                    free(node->feature);
-                    free(node->reading);
-                    free(node->phonemes);
-                    free(node->next);
-                    free(node);
-                }
-            }
-            free(lattice->nodes[i]);
+    // 节点、数组、字符串都在 arena 中
+    lattice_release_nodes(lattice);
+    misaki_arena_free(lattice->arena);
+    free(lattice);
+}
+
+/**
+ * 把节点放入位置数组（在 arena 中按倍数扩容）
+ */
+static bool lattice_array_push(MisakiArena *arena, LatticeNode ***arrays, int *counts,
+                               int *capacities, int pos, LatticeNode *node) {
+    if (counts[pos] >= capacities[pos]) {
+        int old_capacity = capacities[pos];
+        int new_capacity = old_capacity > 0 ? old_capacity * 2 : LATTICE_INITIAL_NODES;
+        LatticeNode **new_array = (LatticeNode **)misaki_arena_alloc(
+            arena, sizeof(LatticeNode *) * new_capacity);
+        if (!new_array) {
+            return false;
         }
+        if (old_capacity > 0) {
+            memcpy(new_array, arrays[pos], sizeof(LatticeNode *) * old_capacity);
+        }
+        arrays[pos] = new_array;
+        capacities[pos] = new_capacity;
     }
     
-    // 释放 BOS/EOS
-    if (lattice->bos) {
-        free(lattice->bos->surface);
-        free(lattice->bos->next);
-        free(lattice->bos);
+    arrays[pos][counts[pos]++] = node;
+    return true;
+}
+
+/**
+ * 登记节点：按起始位置和结束位置各放一份
+ */
+static bool lattice_push_node(Lattice *lattice, int pos, LatticeNode *node) {
+    if (!lattice_array_push(lattice->arena, lattice->nodes, lattice->node_counts,
+                            lattice->node_capacities, pos, node)) {
+        return false;
     }
     
-    if (lattice->eos) {
-        free(lattice->eos->surface);
-        free(lattice->eos);
+    // 超出文本的节点不会出现在任何路径上，不登记结束位置
+    int end = pos + node->char_length;
+    if (end > pos && end <= lattice->text_length) {
+        return lattice_array_push(lattice->arena, lattice->end_nodes, lattice->end_counts,
+                                  lattice->end_capacities, end, node);
     }
-    
-    free(lattice->nodes);
-    free(lattice->node_counts);
-    free(lattice->node_capacities);
-    free(lattice);
+    return true;
+}
+
+/**
+ * 从 (字符位置 from_char, 字节偏移 from_byte) 向后走到字符位置 to_char，返回其字节偏移
+ * （遇到字符串结尾时停下；非法字节按一个字符计）
+ */
+static int utf8_byte_offset(const char *text, int from_char, int from_byte, int to_char) {
+    int offset = from_byte;
+    for (int i = from_char; i < to_char && text[offset]; i++) {
+        uint32_t cp;
+        int len = misaki_utf8_decode(text + offset, &cp);
+        offset += len > 0 ? len : 1;
+    }
+    return offset;
 }
 
 LatticeNode* misaki_lattice_add_node(Lattice *lattice,
@@ -128,45 +208,78 @@ LatticeNode* misaki_lattice_add_node(Lattice *lattice,
         return NULL;
     }
     
-    LatticeNode *node = (LatticeNode *)calloc(1, sizeof(LatticeNode));
+    LatticeNode *node = (LatticeNode *)misaki_arena_alloc(lattice->arena, sizeof(LatticeNode));
     if (!node) {
         return NULL;
     }
     
     node->pos = pos;
-    node->surface = misaki_strdup(surface);
-    node->feature = feature ? misaki_strdup(feature) : NULL;
-    node->reading = reading ? misaki_strdup(reading) : NULL;
+    node->surface = misaki_arena_strdup(lattice->arena, surface);
+    node->feature = misaki_arena_strdup(lattice->arena, feature);
+    node->reading = misaki_arena_strdup(lattice->arena, reading);
     node->node_cost = node_cost;
     node->total_cost = DBL_MAX;
-    node->start = pos;
-    node->length = strlen(surface);
-    node->next = NULL;
-    node->next_count = 0;
-    node->prev = NULL;
+    node->start = lattice->text ? utf8_byte_offset(lattice->text, 0, 0, pos) : -1;
+    node->length = (int)strlen(surface);
+    node->char_length = (int)misaki_utf8_length(surface);
+    node->tag_id = misaki_tag_intern(feature);
     
-    // 检查是否需要扩容
-    if (lattice->node_counts[pos] >= lattice->node_capacities[pos]) {
-        int new_capacity = lattice->node_capacities[pos] * 2;
-        LatticeNode **new_array = (LatticeNode **)realloc(
-            lattice->nodes[pos], sizeof(LatticeNode *) * new_capacity);
-        if (!new_array) {
-            free(node->surface);
-            free(node->feature);
-            free(node->reading);
-            free(node);
-            return NULL;
-        }
-        lattice->nodes[pos] = new_array;
-        lattice->node_capacities[pos] = new_capacity;
+    if (!node->surface || !lattice_push_node(lattice, pos, node)) {
+        return NULL;
+    }
+    
+    return node;
+}
+
+LatticeNode* misaki_lattice_add_span(Lattice *lattice,
+                                      int pos,
+                                      int byte_start,
+                                      int byte_length,
+                                      int char_length,
+                                      MisakiTagId tag_id,
+                                      double node_cost) {
+    if (!lattice || !lattice->text || pos < 0 || pos >= lattice->text_length ||
+        byte_start < 0 || byte_length <= 0 || char_length <= 0) {
+        return NULL;
+    }
+    
+    LatticeNode *node = (LatticeNode *)misaki_arena_alloc(lattice->arena, sizeof(LatticeNode));
+    if (!node) {
+        return NULL;
     }
     
-    // 添加节点到数组
-    lattice->nodes[pos][lattice->node_counts[pos]++] = node;
+    node->pos = pos;
+    node->feature = (char *)misaki_tag_name(tag_id);  // 驻留表中的字符串，不复制
+    node->node_cost = node_cost;
+    node->total_cost = DBL_MAX;
+    node->start = byte_start;
+    node->length = byte_length;
+    node->char_length = char_length;
+    node->tag_id = tag_id;
+    
+    if (!lattice_push_node(lattice, pos, node)) {
+        return NULL;
+    }
     
     return node;
 }
 
+MisakiStringView misaki_lattice_node_surface(const Lattice *lattice,
+                                             const LatticeNode *node) {
+    if (!node) {
+        return misaki_sv_from_length(NULL, 0);
+    }
+    
+    if (node->surface) {
+        return misaki_sv_from_cstr(node->surface);
+    }
+    
+    if (lattice && lattice->text) {
+        return misaki_sv_from_length(lattice->text + node->start, node->length);
+    }
+    return misaki_sv_from_length(NULL, 0);
+}
+
 bool misaki_lattice_add_edge(LatticeNode *from,
                               LatticeNode *to,
                               double edge_cost) {
@@ -174,18 +287,28 @@ bool misaki_lattice_add_edge(LatticeNode *from,
         return false;
     }
     
-    // 扩展 next 数组
-    LatticeNode **new_next = (LatticeNode **)realloc(
-        from->next, sizeof(LatticeNode *) * (from->next_count + 1));
-    if (!new_next) {
-        return false;
+    // 扩展 next / next_costs 数组（按倍数扩容，避免每条边一次 realloc）
+    if (from->next_count >= from->next_capacity) {
+        int new_capacity = from->next_capacity > 0 ? from->next_capacity * 2 : 4;
+        LatticeNode **new_next = (LatticeNode **)realloc(
+            from->next, sizeof(LatticeNode *) * new_capacity);
+        if (!new_next) {
+            return false;
+        }
+        from->next = new_next;
+        
+        double *new_costs = (double *)realloc(from->next_costs, sizeof(double) * new_capacity);
+        if (!new_costs) {
+            return false;
+        }
+        from->next_costs = new_costs;
+        from->next_capacity = new_capacity;
     }
     
-    from->next = new_next;
-    from->next[from->next_count++] = to;
-    
-    // 更新边成本（简化：存储在 to 节点）
-    to->edge_cost = edge_cost;
+    // 成本存在边上（to 可能有多条入边）
+    from->next[from->next_count] = to;
+    from->next_costs[from->next_count] = edge_cost;
+    from->next_count++;
     
     return true;
 }
@@ -243,9 +366,11 @@ bool misaki_viterbi_search(Lattice *lattice) {
     // 首先处理 BOS 的后继
     for (int j = 0; j < lattice->bos->next_count; j++) {
         LatticeNode *next = lattice->bos->next[j];
-        double cost = lattice->bos->total_cost + next->node_cost + next->edge_cost;
+        double edge_cost = lattice->bos->next_costs[j];
+        double cost = lattice->bos->total_cost + next->node_cost + edge_cost;
         if (cost < next->total_cost) {
             next->total_cost = cost;
+            next->edge_cost = edge_cost;
             next->prev = lattice->bos;
         }
     }
@@ -258,10 +383,12 @@ bool misaki_viterbi_search(Lattice *lattice) {
             // 遍历所有后继节点
             for (int j = 0; j < node->next_count; j++) {
                 LatticeNode *next = node->next[j];
-                double cost = node->total_cost + next->node_cost + next->edge_cost;
+                double edge_cost = node->next_costs[j];
+                double cost = node->total_cost + next->node_cost + edge_cost;
                 
                 if (cost < next->total_cost) {
                     next->total_cost = cost;
+                    next->edge_cost = edge_cost;
                     next->prev = node;
                 }
             }
@@ -271,6 +398,63 @@ bool misaki_viterbi_search(Lattice *lattice) {
     return true;
 }
 
+/**
+ * 在 end_pos 结束的节点中为 node 选出最优前驱
+ */
+static void viterbi_relax(const Lattice *lattice, LatticeNode *node, int end_pos,
+                          LatticeConnectCost connect, void *user_data) {
+    node->total_cost = DBL_MAX;
+    node->prev = NULL;
+    
+    if (end_pos == 0) {
+        double cost = node->node_cost;
+        if (connect) {
+            cost += connect(lattice->bos, node, user_data);
+        }
+        node->total_cost = cost;
+        node->prev = lattice->bos;
+        return;
+    }
+    
+    for (int i = 0; i < lattice->end_counts[end_pos]; i++) {
+        LatticeNode *left = lattice->end_nodes[end_pos][i];
+        if (left->total_cost == DBL_MAX) {
+            continue;  // 不可达
+        }
+        
+        double cost = left->total_cost + node->node_cost;
+        if (connect) {
+            cost += connect(left, node, user_data);
+        }
+        
+        if (cost < node->total_cost) {
+            node->total_cost = cost;
+            node->prev = left;
+        }
+    }
+}
+
+bool misaki_viterbi_search_connect(Lattice *lattice,
+                                   LatticeConnectCost connect,
+                                   void *user_data) {
+    if (!lattice) {
+        return false;
+    }
+    
+    lattice->bos->total_cost = 0.0;
+    
+    // 节点按起始位置排列，前驱都在更早的位置结束，从左到右一遍即可
+    for (int pos = 0; pos < lattice->text_length; pos++) {
+        for (int i = 0; i < lattice->node_counts[pos]; i++) {
+            viterbi_relax(lattice, lattice->nodes[pos][i], pos, connect, user_data);
+        }
+    }
+    
+    viterbi_relax(lattice, lattice->eos, lattice->text_length, connect, user_data);
+    
+    return lattice->eos->prev != NULL;
+}
+
 int misaki_viterbi_backtrack(const Lattice *lattice,
                               LatticeNode **path,
                               int max_length) {
@@ -297,40 +481,76 @@ int misaki_viterbi_backtrack(const Lattice *lattice,
     return count;
 }
 
-MisakiTokenList* misaki_viterbi_extract_tokens(const Lattice *lattice) {
-    if (!lattice) {
-        return NULL;
+/**
+ * 最优路径上的节点数（不含 BOS/EOS）
+ */
+static int viterbi_path_length(const Lattice *lattice) {
+    int length = 0;
+    for (const LatticeNode *node = lattice->eos->prev;
+         node && node != lattice->bos; node = node->prev) {
+        length++;
+    }
+    return length;
+}
+
+int misaki_viterbi_append_tokens(const Lattice *lattice, MisakiTokenList *list) {
+    if (!lattice || !list) {
+        return -1;
     }
     
-    LatticeNode *path[1000];
-    int count = misaki_viterbi_backtrack(lattice, path, 1000);
+    // 按路径长度分配，长文本的路径不会被截断
+    int count = viterbi_path_length(lattice);
+    LatticeNode **path = (LatticeNode **)malloc(sizeof(LatticeNode *) * (count > 0 ? count : 1));
+    if (!path) {
+        return -1;
+    }
+    count = count > 0 ? misaki_viterbi_backtrack(lattice, path, count) : 0;
     
-    if (count == 0) {
-        return NULL;
+    // 视图模式下表层文本指向 source；不知道字节偏移的节点按字符位置在 source 中定位
+    int cursor_char = 0;
+    int cursor_byte = 0;
+    for (int i = 0; i < count; i++) {
+        const LatticeNode *node = path[i];
+        MisakiStringView surface = misaki_lattice_node_surface(lattice, node);
+        if (list->view_mode) {
+            int start = node->start;
+            if (start < 0) {
+                start = utf8_byte_offset(list->source, cursor_char, cursor_byte, node->pos);
+                cursor_char = node->pos;
+                cursor_byte = start;
+            }
+            surface.data = list->source + start;
+        }
+        
+        MisakiToken *token = misaki_token_list_add_view(list, surface, node->feature,
+                                                        node->pos, node->char_length,
+                                                        node->total_cost);
+        if (!token) {
+            free(path);
+            return -1;
+        }
+        if (node->phonemes) {
+            misaki_token_set_phonemes(token, node->phonemes);
+        }
     }
     
-    // 创建 Token 列表
-    MisakiTokenList *tokens = (MisakiTokenList *)malloc(sizeof(MisakiTokenList));
-    if (!tokens) {
+    free(path);
+    return count;
+}
+
+MisakiTokenList* misaki_viterbi_extract_tokens(const Lattice *lattice) {
+    if (!lattice) {
         return NULL;
     }
     
-    tokens->tokens = (MisakiToken *)calloc(count, sizeof(MisakiToken));
-    if (!tokens->tokens) {
-        free(tokens);
+    MisakiTokenList *tokens = misaki_token_list_create();
+    if (!tokens) {
         return NULL;
     }
     
-    tokens->count = count;
-    
-    // 填充 Token
-    for (int i = 0; i < count; i++) {
-        tokens->tokens[i].text = misaki_strdup(path[i]->surface);
-        tokens->tokens[i].tag = path[i]->feature ? misaki_strdup(path[i]->feature) : NULL;
-        tokens->tokens[i].phonemes = path[i]->phonemes ? misaki_strdup(path[i]->phonemes) : NULL;
-        tokens->tokens[i].start = path[i]->pos;
-        tokens->tokens[i].length = path[i]->length;
-        tokens->tokens[i].score = path[i]->total_cost;
+    if (misaki_viterbi_append_tokens(lattice, tokens) <= 0) {
+        misaki_token_list_free(tokens);
+        return NULL;
     }
     
     return tokens;
@@ -340,99 +560,1053 @@ MisakiTokenList* misaki_viterbi_extract_tokens(const Lattice *lattice) {
  * 成本矩阵实现
  * ========================================================================== */
 
-CostMatrix* misaki_cost_matrix_load(const char *file_path) {
-    // TODO: 实现从文件加载
-    (void)file_path;
-    return NULL;
-}
-
-void misaki_cost_matrix_free(CostMatrix *matrix) {
+CostMatrix* misaki_cost_matrix_create(int left_size, int right_size) {
+    if (left_size <= 0 || right_size <= 0) {
+        return NULL;
+    }
+    
+    CostMatrix *matrix = (CostMatrix *)calloc(1, sizeof(CostMatrix));
     if (!matrix) {
-        return;
+        return NULL;
     }
     
-    if (matrix->trans_cost) {
-        for (int i = 0; i < matrix->pos_count; i++) {
-            free(matrix->trans_cost[i]);
-        }
-        free(matrix->trans_cost);
+    matrix->costs = (int16_t *)calloc((size_t)left_size * right_size, sizeof(int16_t));
+    if (!matrix->costs) {
+        free(matrix);
+        return NULL;
     }
     
-    free(matrix);
+    matrix->left_size = left_size;
+    matrix->right_size = right_size;
+    return matrix;
 }
 
-double misaki_cost_matrix_get(const CostMatrix *matrix,
-                               int from_pos,
-                               int to_pos) {
-    if (!matrix || !matrix->trans_cost) {
-        return 0.0;
+/**
+ * 按词性表创建矩阵：大小取映射后的最大 ID，defined 标记文件中出现的词性
+ */
+static CostMatrix* cost_matrix_create_mapped(const int *remap, int count) {
+    int size = 1;
+    for (int i = 0; i < count; i++) {
+        if (remap[i] >= size) {
+            size = remap[i] + 1;
+        }
     }
     
-    if (from_pos < 0 || from_pos >= matrix->pos_count ||
-        to_pos < 0 || to_pos >= matrix->pos_count) {
-        return 0.0;
+    CostMatrix *matrix = misaki_cost_matrix_create(size, size);
+    if (!matrix) {
+        return NULL;
     }
-    
-    return matrix->trans_cost[from_pos][to_pos];
-}
-
-/* ============================================================================
- * N-Best 路径实现
- * ========================================================================== */
-
-int misaki_viterbi_nbest(const Lattice *lattice,
-                         int n,
-                         NBestResult *results) {
-    // TODO: 实现 N-Best 搜索
-    // 简化版：只返回最优路径
-    if (!lattice || n <= 0 || !results) {
-        return 0;
+    matrix->defined = (uint8_t *)calloc((size_t)size, sizeof(uint8_t));
+    if (!matrix->defined) {
+        misaki_cost_matrix_free(matrix);
+        return NULL;
     }
     
-    results[0].path = (LatticeNode **)malloc(sizeof(LatticeNode *) * 1000);
-    if (!results[0].path) {
-        return 0;
+    matrix->defined[MISAKI_TAG_NONE] = 1;
+    for (int i = 0; i < count; i++) {
+        if (remap[i] >= 0) {
+            matrix->defined[remap[i]] = 1;
+        }
     }
-    
-    results[0].path_length = misaki_viterbi_backtrack(lattice, results[0].path, 1000);
-    results[0].total_cost = lattice->eos->total_cost;
-    
-    return 1;
+    return matrix;
 }
 
-void misaki_nbest_free(NBestResult *results, int count) {
-    if (!results) {
-        return;
+/**
+ * 文件中的 ID 换成当前进程的 ID（有词性表时），无效返回 -1
+ */
+static int cost_matrix_map_id(const int *remap, int count, bool has_tags, int id, int limit) {
+    if (id < 0 || id >= limit) {
+        return -1;
     }
-    
-    for (int i = 0; i < count; i++) {
-        free(results[i].path);
+    if (!has_tags || id == MISAKI_TAG_NONE) {
+        return id;
     }
+    return id < count ? remap[id] : -1;
 }
 
-/* ============================================================================
- * 调试工具实现
- * ========================================================================== */
-
-void misaki_lattice_print(const Lattice *lattice) {
-    if (!lattice) {
-        return;
+CostMatrix* misaki_cost_matrix_load(const char *file_path) {
+    if (!file_path) {
+        return NULL;
     }
     
-    printf("Lattice (text_length=%d):\n", lattice->text_length);
+    FILE *f = fopen(file_path, "r");
+    if (!f) {
+        return NULL;
+    }
     
-    for (int pos = 0; pos <= lattice->text_length; pos++) {
-        printf("  Pos %d (%d nodes):\n", pos, lattice->node_counts[pos]);
+    CostMatrix *matrix = NULL;
+    int left_size = 0;
+    int right_size = 0;
+    int *remap = NULL;          // 词性表：文件中的 ID → 当前进程的 ID（-1 为未列出）
+    int remap_count = 0;
+    bool has_tags = false;
+    bool ok = true;
+    char line[1024];
+    
+    while (ok && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
         
-        LatticeNode *nodes[100];
-        int count = misaki_lattice_get_nodes_at(lattice, pos, nodes, 100);
+        // 第一行：矩阵大小
+        if (!remap) {
+            ok = sscanf(line, "%d %d", &left_size, &right_size) == 2 &&
+                 left_size > 0 && right_size > 0;
+            if (ok) {
+                remap_count = left_size > right_size ? left_size : right_size;
+                remap = (int *)malloc((size_t)remap_count * sizeof(int));
+                ok = remap != NULL;
+            }
+            for (int i = 0; ok && i < remap_count; i++) {
+                remap[i] = -1;
+            }
+            continue;
+        }
         
-        for (int i = 0; i < count; i++) {
-            printf("    [%d] %s (cost=%.2f)\n",
-                   i, nodes[i]->surface, nodes[i]->total_cost);
+        // 词性表（在成本之前）
+        if (line[0] == '@') {
+            int id = 0;
+            int name_start = 0;
+            line[strcspn(line, "\r\n")] = '\0';
+            ok = !matrix && sscanf(line, "@ %d %n", &id, &name_start) == 1 &&
+                 id > MISAKI_TAG_NONE && id < remap_count && name_start > 0;
+            if (ok) {
+                remap[id] = misaki_tag_intern(line + name_start);
+                ok = remap[id] != MISAKI_TAG_NONE;
+                has_tags = true;
+            }
+            continue;
         }
-    }
-    
+        
+        if (!matrix) {
+            matrix = has_tags ? cost_matrix_create_mapped(remap, remap_count)
+                              : misaki_cost_matrix_create(left_size, right_size);
+            ok = matrix != NULL;
+            if (!ok) {
+                break;
+            }
+        }
+        
+        int from_pos = 0;
+        int to_pos = 0;
+        int cost = 0;
+        ok = sscanf(line, "%d %d %d", &from_pos, &to_pos, &cost) == 3 &&
+             cost >= INT16_MIN && cost <= INT16_MAX;
+        if (ok) {
+            from_pos = cost_matrix_map_id(remap, remap_count, has_tags, from_pos, left_size);
+            to_pos = cost_matrix_map_id(remap, remap_count, has_tags, to_pos, right_size);
+            ok = misaki_cost_matrix_set(matrix, from_pos, to_pos, (int16_t)cost);
+        }
+    }
+    
+    // 没有成本项的文件
+    if (ok && remap && !matrix) {
+        matrix = has_tags ? cost_matrix_create_mapped(remap, remap_count)
+                          : misaki_cost_matrix_create(left_size, right_size);
+    }
+    if (!ok || !remap) {
+        misaki_cost_matrix_free(matrix);
+        matrix = NULL;
+    }
+    
+    free(remap);
+    fclose(f);
+    return matrix;
+}
+
+bool misaki_cost_matrix_save(const CostMatrix *matrix, const char *file_path) {
+    if (!matrix || !file_path) {
+        return false;
+    }
+    
+    FILE *f = fopen(file_path, "w");
+    if (!f) {
+        return false;
+    }
+    
+    fprintf(f, "%d %d\n", matrix->left_size, matrix->right_size);
+    
+    // 词性表：ID 只在本进程内有效，加载时按名字换成加载方的 ID
+    int size = matrix->left_size > matrix->right_size ? matrix->left_size : matrix->right_size;
+    for (int id = MISAKI_TAG_NONE + 1; id < size; id++) {
+        const char *name = misaki_tag_name((MisakiTagId)id);
+        if (name) {
+            fprintf(f, "@ %d %s\n", id, name);
+        }
+    }
+    
+    for (int i = 0; i < matrix->left_size; i++) {
+        for (int j = 0; j < matrix->right_size; j++) {
+            int16_t cost = matrix->costs[i * matrix->right_size + j];
+            if (cost != 0) {
+                fprintf(f, "%d %d %d\n", i, j, cost);
+            }
+        }
+    }
+    
+    return fclose(f) == 0;
+}
+
+void misaki_cost_matrix_free(CostMatrix *matrix) {
+    if (!matrix) {
+        return;
+    }
+    
+    free(matrix->costs);
+    free(matrix->defined);
+    free(matrix);
+}
+
+bool misaki_cost_matrix_set(CostMatrix *matrix, int from_pos, int to_pos, int16_t cost) {
+    if (!misaki_cost_matrix_covers(matrix, from_pos, to_pos)) {
+        return false;
+    }
+    
+    matrix->costs[from_pos * matrix->right_size + to_pos] = cost;
+    return true;
+}
+
+double misaki_cost_matrix_get(const CostMatrix *matrix,
+                               int from_pos,
+                               int to_pos) {
+    if (!misaki_cost_matrix_covers(matrix, from_pos, to_pos)) {
+        return 0.0;
+    }
+    
+    return matrix->costs[from_pos * matrix->right_size + to_pos];
+}
+
+/* ============================================================================
+ * 紧凑 Lattice（SoA 布局）实现
+ * ========================================================================== */
+
+/**
+ * 扩容一个数组（内容保留）
+ */
+static bool compact_grow(void **array, size_t elem_size, int capacity) {
+    void *new_array = realloc(*array, elem_size * (size_t)capacity);
+    if (!new_array) {
+        return false;
+    }
+    *array = new_array;
+    return true;
+}
+
+static bool compact_reserve_nodes(CompactLattice *lattice, int needed) {
+    if (needed <= lattice->capacity) {
+        return true;
+    }
+    
+    int capacity = lattice->capacity > 0 ? lattice->capacity : 64;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    
+    if (!compact_grow((void **)&lattice->start, sizeof(int32_t), capacity) ||
+        !compact_grow((void **)&lattice->length, sizeof(int32_t), capacity) ||
+        !compact_grow((void **)&lattice->byte_start, sizeof(int32_t), capacity) ||
+        !compact_grow((void **)&lattice->byte_length, sizeof(int32_t), capacity) ||
+        !compact_grow((void **)&lattice->word_cost, sizeof(float), capacity) ||
+        !compact_grow((void **)&lattice->tag_id, sizeof(MisakiTagId), capacity) ||
+        !compact_grow((void **)&lattice->reading, sizeof(const char *), capacity) ||
+        !compact_grow((void **)&lattice->ipa, sizeof(const char *), capacity) ||
+        !compact_grow((void **)&lattice->best_cost, sizeof(float), capacity) ||
+        !compact_grow((void **)&lattice->back, sizeof(int32_t), capacity) ||
+        !compact_grow((void **)&lattice->end_index, sizeof(int32_t), capacity) ||
+        !compact_grow((void **)&lattice->end_cost, sizeof(float), capacity) ||
+        !compact_grow((void **)&lattice->end_tag, sizeof(MisakiTagId), capacity) ||
+        !compact_grow((void **)&lattice->sort_scratch, sizeof(float), capacity) ||
+        !compact_grow((void **)&lattice->prune_scratch, sizeof(int32_t), capacity)) {
+        return false;
+    }
+    
+    lattice->capacity = capacity;
+    return true;
+}
+
+CompactLattice* misaki_compact_lattice_create(const char *text) {
+    if (!text) {
+        return NULL;
+    }
+    
+    CompactLattice *lattice = (CompactLattice *)calloc(1, sizeof(CompactLattice));
+    if (!lattice) {
+        return NULL;
+    }
+    
+    if (!misaki_compact_lattice_reset(lattice, text)) {
+        misaki_compact_lattice_free(lattice);
+        return NULL;
+    }
+    
+    return lattice;
+}
+
+bool misaki_compact_lattice_reset(CompactLattice *lattice, const char *text) {
+    if (!lattice || !text) {
+        return false;
+    }
+    
+    int text_length = (int)misaki_utf8_length(text);
+    if (text_length <= 0) {
+        return false;
+    }
+    
+    // 结束位置分桶需要 text_length + 3 个偏移（见 compact_build_end_index）
+    if (text_length + 3 > lattice->position_capacity) {
+        if (!compact_grow((void **)&lattice->end_offsets, sizeof(int32_t), text_length + 3)) {
+            return false;
+        }
+        lattice->position_capacity = text_length + 3;
+    }
+    
+    lattice->text = text;
+    lattice->text_length = text_length;
+    lattice->count = 0;
+    lattice->eos_cost = INFINITY;
+    lattice->eos_back = -1;
+    return true;
+}
+
+void misaki_compact_lattice_free(CompactLattice *lattice) {
+    if (!lattice) {
+        return;
+    }
+    
+    free(lattice->start);
+    free(lattice->length);
+    free(lattice->byte_start);
+    free(lattice->byte_length);
+    free(lattice->word_cost);
+    free(lattice->tag_id);
+    free(lattice->reading);
+    free(lattice->ipa);
+    free(lattice->best_cost);
+    free(lattice->back);
+    free(lattice->end_offsets);
+    free(lattice->end_index);
+    free(lattice->end_cost);
+    free(lattice->end_tag);
+    free(lattice->sort_scratch);
+    free(lattice->prune_scratch);
+    free(lattice);
+}
+
+int misaki_compact_lattice_add(CompactLattice *lattice,
+                               int start,
+                               int length,
+                               int byte_start,
+                               int byte_length,
+                               MisakiTagId tag_id,
+                               float word_cost) {
+    if (!lattice || start < 0 || start >= lattice->text_length ||
+        length <= 0 || byte_start < 0 || byte_length <= 0) {
+        return -1;
+    }
+    
+    int index = lattice->count;
+    if (index > 0 && start < lattice->start[index - 1]) {
+        return -1;  // 必须按起始位置顺序添加
+    }
+    
+    if (!compact_reserve_nodes(lattice, index + 1)) {
+        return -1;
+    }
+    
+    lattice->start[index] = start;
+    lattice->length[index] = length;
+    lattice->byte_start[index] = byte_start;
+    lattice->byte_length[index] = byte_length;
+    lattice->word_cost[index] = word_cost;
+    lattice->tag_id[index] = tag_id;
+    lattice->reading[index] = NULL;
+    lattice->ipa[index] = NULL;
+    lattice->best_cost[index] = INFINITY;
+    lattice->back[index] = -1;
+    lattice->count++;
+    
+    return index;
+}
+
+bool misaki_compact_lattice_set_reading(CompactLattice *lattice, int node,
+                                        const char *reading, const char *ipa) {
+    if (!lattice || node < 0 || node >= lattice->count) {
+        return false;
+    }
+    
+    lattice->reading[node] = reading;
+    lattice->ipa[node] = ipa;
+    return true;
+}
+
+/**
+ * 按结束位置分桶（计数排序，桶内保持节点下标顺序）
+ * 
+ * 计数放在 end_offsets[end + 2]，前缀和之后 end_offsets[end + 1] 是桶的起点，
+ * 填充时把它推进到桶的终点，结束后 end_offsets[end] 即为桶 end 的起点
+ */
+static void compact_build_end_index(CompactLattice *lattice) {
+    int32_t *offsets = lattice->end_offsets;
+    int text_length = lattice->text_length;
+    
+    memset(offsets, 0, sizeof(int32_t) * (text_length + 3));
+    for (int i = 0; i < lattice->count; i++) {
+        int end = lattice->start[i] + lattice->length[i];
+        if (end <= text_length) {
+            offsets[end + 2]++;
+        }
+    }
+    
+    for (int p = 2; p < text_length + 3; p++) {
+        offsets[p] += offsets[p - 1];
+    }
+    
+    for (int i = 0; i < lattice->count; i++) {
+        int end = lattice->start[i] + lattice->length[i];
+        if (end <= text_length) {
+            lattice->end_index[offsets[end + 1]++] = i;
+        }
+    }
+}
+
+/**
+ * 在结束位置 pos 的桶中选出最优前驱
+ * 
+ * 桶内的累积成本和词性已拷贝到连续数组，循环只做一次查表和一次比较
+ */
+static inline int compact_best_left(const CompactLattice *lattice, int begin, int end,
+                                    const int16_t *column, int row_stride, int left_size,
+                                    float *best_cost) {
+    const float *end_cost = lattice->end_cost;
+    const MisakiTagId *end_tag = lattice->end_tag;
+    
+    int best = -1;
+    float best_value = INFINITY;
+    
+    if (column) {
+        for (int k = begin; k < end; k++) {
+            int left = end_tag[k];
+            float cost = end_cost[k] + (left < left_size ? (float)column[left * row_stride] : 0.0f);
+            if (cost < best_value) {
+                best_value = cost;
+                best = k;
+            }
+        }
+    } else {
+        for (int k = begin; k < end; k++) {
+            if (end_cost[k] < best_value) {
+                best_value = end_cost[k];
+                best = k;
+            }
+        }
+    }
+    
+    *best_cost = best_value;
+    return best;
+}
+
+static int compare_float(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * 束剪枝：只保留桶内成本最低的前驱
+ * 
+ * 稳定划分，保留的排在前面，剪掉的依次排在后面（桶内仍是全部节点）
+ * 
+ * @return 保留部分的结束下标
+ */
+static int compact_prune_bucket(CompactLattice *lattice, int begin, int end,
+                                const ViterbiBeam *beam, ViterbiPruneStats *stats) {
+    int count = end - begin;
+    float limit = INFINITY;
+    
+    // 阈值：与桶内最优成本的差距
+    if (beam->cost_threshold > 0.0f) {
+        float best = INFINITY;
+        for (int k = begin; k < end; k++) {
+            if (lattice->end_cost[k] < best) {
+                best = lattice->end_cost[k];
+            }
+        }
+        limit = best + beam->cost_threshold;
+    }
+    
+    // 束宽：第 beam_width 小的成本
+    if (beam->beam_width > 0 && count > beam->beam_width) {
+        memcpy(lattice->sort_scratch, lattice->end_cost + begin, sizeof(float) * count);
+        qsort(lattice->sort_scratch, count, sizeof(float), compare_float);
+        float kth = lattice->sort_scratch[beam->beam_width - 1];
+        if (kth < limit) {
+            limit = kth;
+        }
+    }
+    
+    if (limit == INFINITY) {
+        return end;
+    }
+    
+    int kept = begin;
+    int removed = 0;
+    int max_kept = beam->beam_width > 0 ? beam->beam_width : count;
+    for (int k = begin; k < end; k++) {
+        if (lattice->end_cost[k] <= limit && kept - begin < max_kept) {
+            lattice->end_cost[kept] = lattice->end_cost[k];
+            lattice->end_tag[kept] = lattice->end_tag[k];
+            lattice->end_index[kept] = lattice->end_index[k];
+            kept++;
+        } else {
+            lattice->prune_scratch[removed++] = lattice->end_index[k];
+        }
+    }
+    
+    memcpy(lattice->end_index + kept, lattice->prune_scratch, sizeof(int32_t) * removed);
+    
+    if (stats && removed > 0) {
+        stats->pruned_paths += (uint64_t)removed;
+        stats->beam_hits++;
+    }
+    return kept;
+}
+
+/**
+ * 拷贝结束位置 pos 的桶（此时桶内节点的前向传播都已完成）
+ * 
+ * @return 参与比较的部分的结束下标（剪枝后可能小于桶的结束）
+ */
+static int compact_fill_bucket(CompactLattice *lattice, int pos,
+                               const ViterbiBeam *beam, ViterbiPruneStats *stats) {
+    int begin = lattice->end_offsets[pos];
+    int end = lattice->end_offsets[pos + 1];
+    
+    for (int k = begin; k < end; k++) {
+        int node = lattice->end_index[k];
+        lattice->end_cost[k] = lattice->best_cost[node];
+        lattice->end_tag[k] = lattice->tag_id[node];
+    }
+    
+    if (beam && end - begin > 1) {
+        return compact_prune_bucket(lattice, begin, end, beam, stats);
+    }
+    return end;
+}
+
+bool misaki_compact_viterbi_search(CompactLattice *lattice, const CostMatrix *matrix) {
+    return misaki_compact_viterbi_search_beam(lattice, matrix, NULL, NULL);
+}
+
+bool misaki_compact_viterbi_search_beam(CompactLattice *lattice,
+                                        const CostMatrix *matrix,
+                                        const ViterbiBeam *beam,
+                                        ViterbiPruneStats *stats) {
+    if (!lattice) {
+        return false;
+    }
+    
+    // 束宽和阈值都为 0 时就是精确搜索
+    if (beam && beam->beam_width <= 0 && beam->cost_threshold <= 0.0f) {
+        beam = NULL;
+    }
+    
+    compact_build_end_index(lattice);
+    
+    // 右侧词性固定时，矩阵的一列就是所有左侧词性的连接成本
+    int row_stride = matrix ? matrix->right_size : 0;
+    int left_size = matrix ? matrix->left_size : 0;
+    
+    int filled = -1;
+    int filled_end = 0;
+    for (int i = 0; i < lattice->count; i++) {
+        int pos = lattice->start[i];
+        const int16_t *column = (matrix && lattice->tag_id[i] < matrix->right_size) ?
+                                matrix->costs + lattice->tag_id[i] : NULL;
+        
+        if (pos == 0) {
+            // BOS → 节点（BOS 的词性为 0）
+            lattice->best_cost[i] = lattice->word_cost[i] +
+                                    (column && left_size > 0 ? (float)column[0] : 0.0f);
+            lattice->back[i] = -1;
+            continue;
+        }
+        
+        if (pos != filled) {
+            filled_end = compact_fill_bucket(lattice, pos, beam, stats);
+            filled = pos;
+        }
+        
+        float best_value;
+        int best = compact_best_left(lattice, lattice->end_offsets[pos], filled_end,
+                                     column, row_stride, left_size, &best_value);
+        lattice->best_cost[i] = best >= 0 ? best_value + lattice->word_cost[i] : INFINITY;
+        lattice->back[i] = best >= 0 ? lattice->end_index[best] : -1;
+    }
+    
+    // 节点 → EOS（EOS 的词性为 0）
+    int eos_end = compact_fill_bucket(lattice, lattice->text_length, NULL, NULL);
+    float best_value;
+    int best = compact_best_left(lattice, lattice->end_offsets[lattice->text_length], eos_end,
+                                 matrix ? matrix->costs : NULL, row_stride, left_size, &best_value);
+    
+    lattice->eos_back = (best >= 0 && best_value < INFINITY) ? lattice->end_index[best] : -1;
+    lattice->eos_cost = best_value;
+    
+    return lattice->eos_back >= 0;
+}
+
+int misaki_compact_viterbi_backtrack(const CompactLattice *lattice,
+                                     int *path,
+                                     int max_length) {
+    if (!lattice || lattice->eos_back < 0) {
+        return 0;
+    }
+    
+    int count = 0;
+    for (int node = lattice->eos_back; node >= 0; node = lattice->back[node]) {
+        count++;
+    }
+    
+    if (!path || count > max_length) {
+        return path ? -1 : count;
+    }
+    
+    int i = count;
+    for (int node = lattice->eos_back; node >= 0; node = lattice->back[node]) {
+        path[--i] = node;
+    }
+    
+    return count;
+}
+
+/**
+ * 把节点路径追加到 Token 列表（scores 为 NULL 时使用前向最优成本）
+ */
+static int compact_append_path(const CompactLattice *lattice, const int *path,
+                               const float *scores, int count, MisakiTokenList *list) {
+    for (int i = 0; i < count; i++) {
+        int node = path[i];
+        const char *base = list->view_mode ? list->source : lattice->text;
+        MisakiStringView surface = misaki_sv_from_length(base + lattice->byte_start[node],
+                                                         lattice->byte_length[node]);
+        
+        MisakiToken *token = misaki_token_list_add_view(list, surface,
+                                                        misaki_tag_name(lattice->tag_id[node]),
+                                                        lattice->start[node], lattice->length[node],
+                                                        scores ? scores[i] : lattice->best_cost[node]);
+        if (!token) {
+            return -1;
+        }
+        token->reading = lattice->reading[node];
+        token->ipa = lattice->ipa[node];
+    }
+    
+    return count;
+}
+
+int misaki_compact_viterbi_append_tokens(const CompactLattice *lattice,
+                                         MisakiTokenList *list) {
+    if (!lattice || !list) {
+        return -1;
+    }
+    
+    int count = misaki_compact_viterbi_backtrack(lattice, NULL, 0);
+    if (count <= 0) {
+        return count;
+    }
+    
+    int *path = (int *)malloc(sizeof(int) * count);
+    if (!path) {
+        return -1;
+    }
+    misaki_compact_viterbi_backtrack(lattice, path, count);
+    
+    count = compact_append_path(lattice, path, NULL, count, list);
+    free(path);
+    return count;
+}
+
+/* ============================================================================
+ * N-Best 路径实现
+ * ========================================================================== */
+
+// 部分路径池的上限（病态 Lattice 上限制内存，已找到的结果照常返回）
+#define NBEST_MAX_HYPOTHESES (1 << 20)
+
+// 紧凑 Lattice 中 BOS/EOS 的下标
+#define NBEST_BOS (-1)
+#define NBEST_EOS (-2)
+
+/**
+ * 后向 A* 的部分路径：从 node 到 EOS
+ * 
+ * 前向传播的累积成本就是 node 之前部分的精确最小值，
+ * 所以 f = 前向成本 + g 是经过这条部分路径的最优完整路径的成本，
+ * 按 f 出堆即按总成本从小到大得到完整路径
+ */
+typedef struct {
+    const LatticeNode *node;   // 通用 Lattice 的节点（紧凑版本不用）
+    int index;                 // 紧凑 Lattice 的节点下标（或 NBEST_BOS/NBEST_EOS）
+    int parent;                // 路径上后一个节点的部分路径（EOS 为 -1）
+    double g;                  // node 之后（不含进入 node 的连接）到 EOS 的成本
+    double f;                  // 前向成本 + g
+} NBestHypothesis;
+
+/**
+ * 部分路径池 + 按 f 排序的小顶堆（池中的部分路径通过 parent 共享后缀）
+ */
+typedef struct {
+    NBestHypothesis *hyps;     // 部分路径池（只增不删）
+    int *heap;                 // 小顶堆（池下标）
+    int count;                 // 池中数量
+    int capacity;              // 池和堆的容量
+    int heap_count;            // 堆中数量
+} NBestSearch;
+
+static void nbest_search_free(NBestSearch *search) {
+    free(search->hyps);
+    free(search->heap);
+}
+
+static bool nbest_push(NBestSearch *search, const NBestHypothesis *hyp) {
+    if (search->count >= search->capacity) {
+        if (search->capacity >= NBEST_MAX_HYPOTHESES) {
+            return false;
+        }
+        
+        int capacity = search->capacity > 0 ? search->capacity * 2 : 64;
+        NBestHypothesis *hyps = (NBestHypothesis *)realloc(search->hyps,
+                                                           sizeof(NBestHypothesis) * capacity);
+        if (!hyps) {
+            return false;
+        }
+        search->hyps = hyps;
+        
+        int *heap = (int *)realloc(search->heap, sizeof(int) * capacity);
+        if (!heap) {
+            return false;
+        }
+        search->heap = heap;
+        search->capacity = capacity;
+    }
+    
+    int index = search->count++;
+    search->hyps[index] = *hyp;
+    
+    // 上浮
+    int child = search->heap_count++;
+    while (child > 0) {
+        int parent = (child - 1) / 2;
+        if (search->hyps[search->heap[parent]].f <= hyp->f) {
+            break;
+        }
+        search->heap[child] = search->heap[parent];
+        child = parent;
+    }
+    search->heap[child] = index;
+    return true;
+}
+
+static int nbest_pop(NBestSearch *search) {
+    if (search->heap_count == 0) {
+        return -1;
+    }
+    
+    int top = search->heap[0];
+    int last = search->heap[--search->heap_count];
+    double f = search->hyps[last].f;
+    
+    // 下沉
+    int parent = 0;
+    for (;;) {
+        int child = parent * 2 + 1;
+        if (child >= search->heap_count) {
+            break;
+        }
+        if (child + 1 < search->heap_count &&
+            search->hyps[search->heap[child + 1]].f < search->hyps[search->heap[child]].f) {
+            child++;
+        }
+        if (f <= search->hyps[search->heap[child]].f) {
+            break;
+        }
+        search->heap[parent] = search->heap[child];
+        parent = child;
+    }
+    if (search->heap_count > 0) {
+        search->heap[parent] = last;
+    }
+    
+    return top;
+}
+
+/**
+ * 路径上 BOS 与 EOS 之间的节点数（top 为到达 BOS 的部分路径）
+ */
+static int nbest_path_length(const NBestSearch *search, int top) {
+    int length = 0;
+    for (int i = search->hyps[top].parent; i >= 0 && search->hyps[i].parent >= 0;
+         i = search->hyps[i].parent) {
+        length++;
+    }
+    return length;
+}
+
+/**
+ * 边连接成本：有边时为边成本，没有边时不可连接
+ */
+static double edge_connect_cost(const LatticeNode *left, const LatticeNode *right,
+                                void *user_data) {
+    (void)user_data;
+    for (int i = 0; i < left->next_count; i++) {
+        if (left->next[i] == right) {
+            return left->next_costs[i];
+        }
+    }
+    return DBL_MAX;
+}
+
+/**
+ * 从到达 BOS 的部分路径取出完整路径
+ */
+static bool nbest_collect_nodes(const NBestSearch *search, int top, NBestResult *result) {
+    int length = nbest_path_length(search, top);
+    
+    result->path = (LatticeNode **)malloc(sizeof(LatticeNode *) * (length > 0 ? length : 1));
+    if (!result->path) {
+        return false;
+    }
+    
+    int count = 0;
+    for (int i = search->hyps[top].parent; count < length; i = search->hyps[i].parent) {
+        result->path[count++] = (LatticeNode *)search->hyps[i].node;
+    }
+    
+    result->nodes = NULL;
+    result->path_length = length;
+    result->total_cost = search->hyps[top].g;
+    return true;
+}
+
+int misaki_viterbi_nbest(const Lattice *lattice,
+                         int n,
+                         NBestResult *results) {
+    return misaki_viterbi_nbest_connect(lattice, edge_connect_cost, NULL, n, results);
+}
+
+int misaki_viterbi_nbest_connect(const Lattice *lattice,
+                                 LatticeConnectCost connect,
+                                 void *user_data,
+                                 int n,
+                                 NBestResult *results) {
+    if (!lattice || n <= 0 || !results || lattice->eos->total_cost == DBL_MAX) {
+        return 0;
+    }
+    
+    NBestSearch search = { 0 };
+    NBestHypothesis start = { lattice->eos, 0, -1, 0.0, lattice->eos->total_cost };
+    int found = 0;
+    
+    bool ok = nbest_push(&search, &start);
+    while (ok && found < n) {
+        int top = nbest_pop(&search);
+        if (top < 0) {
+            break;
+        }
+        
+        NBestHypothesis hyp = search.hyps[top];
+        if (hyp.node == lattice->bos) {
+            if (!nbest_collect_nodes(&search, top, &results[found])) {
+                break;
+            }
+            found++;
+            continue;
+        }
+        
+        // 前驱：在 right 的起始位置结束的节点（位置 0 为 BOS）
+        const LatticeNode *right = hyp.node;
+        LatticeNode *const *lefts = right->pos > 0 ? lattice->end_nodes[right->pos] : &lattice->bos;
+        int left_count = right->pos > 0 ? lattice->end_counts[right->pos] : 1;
+        
+        for (int i = 0; ok && i < left_count; i++) {
+            const LatticeNode *left = lefts[i];
+            if (left->total_cost == DBL_MAX) {
+                continue;  // 不可达
+            }
+            
+            double cost = connect ? connect(left, right, user_data) : 0.0;
+            if (cost == DBL_MAX) {
+                continue;  // 不可连接
+            }
+            
+            double g = hyp.g + right->node_cost + cost;
+            NBestHypothesis next = { left, 0, top, g, left->total_cost + g };
+            ok = nbest_push(&search, &next);
+        }
+    }
+    
+    nbest_search_free(&search);
+    return found;
+}
+
+/**
+ * 紧凑 Lattice 的连接成本（与前向传播的查表规则一致）
+ */
+static inline float compact_connect_cost(const CostMatrix *matrix,
+                                         MisakiTagId left, MisakiTagId right) {
+    if (!matrix || left >= matrix->left_size || right >= matrix->right_size) {
+        return 0.0f;
+    }
+    return (float)matrix->costs[left * matrix->right_size + right];
+}
+
+static bool compact_nbest_collect(const NBestSearch *search, int top, NBestResult *result) {
+    int length = nbest_path_length(search, top);
+    
+    result->nodes = (int *)malloc(sizeof(int) * (length > 0 ? length : 1));
+    if (!result->nodes) {
+        return false;
+    }
+    
+    int count = 0;
+    for (int i = search->hyps[top].parent; count < length; i = search->hyps[i].parent) {
+        result->nodes[count++] = search->hyps[i].index;
+    }
+    
+    result->path = NULL;
+    result->path_length = length;
+    result->total_cost = search->hyps[top].g;
+    return true;
+}
+
+int misaki_compact_viterbi_nbest(const CompactLattice *lattice,
+                                 const CostMatrix *matrix,
+                                 int n,
+                                 NBestResult *results) {
+    if (!lattice || n <= 0 || !results || lattice->eos_back < 0) {
+        return 0;
+    }
+    
+    NBestSearch search = { 0 };
+    NBestHypothesis start = { NULL, NBEST_EOS, -1, 0.0, lattice->eos_cost };
+    int found = 0;
+    
+    bool ok = nbest_push(&search, &start);
+    while (ok && found < n) {
+        int top = nbest_pop(&search);
+        if (top < 0) {
+            break;
+        }
+        
+        NBestHypothesis hyp = search.hyps[top];
+        if (hyp.index == NBEST_BOS) {
+            if (!compact_nbest_collect(&search, top, &results[found])) {
+                break;
+            }
+            found++;
+            continue;
+        }
+        
+        // EOS 的词性为 0、没有节点成本
+        int pos = lattice->text_length;
+        MisakiTagId right_tag = MISAKI_TAG_NONE;
+        double word_cost = 0.0;
+        if (hyp.index != NBEST_EOS) {
+            pos = lattice->start[hyp.index];
+            right_tag = lattice->tag_id[hyp.index];
+            word_cost = lattice->word_cost[hyp.index];
+        }
+        
+        if (pos == 0) {
+            double g = hyp.g + word_cost + compact_connect_cost(matrix, MISAKI_TAG_NONE, right_tag);
+            NBestHypothesis next = { NULL, NBEST_BOS, top, g, g };
+            ok = nbest_push(&search, &next);
+            continue;
+        }
+        
+        // 桶内是全部前驱（束剪枝只改变顺序）
+        for (int k = lattice->end_offsets[pos]; ok && k < lattice->end_offsets[pos + 1]; k++) {
+            int left = lattice->end_index[k];
+            if (lattice->best_cost[left] == INFINITY) {
+                continue;  // 不可达
+            }
+            
+            double g = hyp.g + word_cost +
+                       compact_connect_cost(matrix, lattice->tag_id[left], right_tag);
+            NBestHypothesis next = { NULL, left, top, g, lattice->best_cost[left] + g };
+            ok = nbest_push(&search, &next);
+        }
+    }
+    
+    nbest_search_free(&search);
+    return found;
+}
+
+int misaki_compact_nbest_append_tokens(const CompactLattice *lattice,
+                                       const CostMatrix *matrix,
+                                       const NBestResult *result,
+                                       MisakiTokenList *list) {
+    if (!lattice || !result || !result->nodes || !list) {
+        return -1;
+    }
+    
+    float *scores = (float *)malloc(sizeof(float) * (result->path_length > 0 ? result->path_length : 1));
+    if (!scores) {
+        return -1;
+    }
+    
+    // Token 的 score 为沿这条路径的累积成本
+    float cost = 0.0f;
+    MisakiTagId left = MISAKI_TAG_NONE;
+    for (int i = 0; i < result->path_length; i++) {
+        int node = result->nodes[i];
+        cost += compact_connect_cost(matrix, left, lattice->tag_id[node]) + lattice->word_cost[node];
+        scores[i] = cost;
+        left = lattice->tag_id[node];
+    }
+    
+    int count = compact_append_path(lattice, result->nodes, scores, result->path_length, list);
+    free(scores);
+    return count;
+}
+
+void misaki_nbest_free(NBestResult *results, int count) {
+    if (!results) {
+        return;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        free(results[i].path);
+        free(results[i].nodes);
+        results[i].path = NULL;
+        results[i].nodes = NULL;
+    }
+}
+
+/* ============================================================================
+ * 调试工具实现
+ * ========================================================================== */
+
+void misaki_lattice_print(const Lattice *lattice) {
+    if (!lattice) {
+        return;
+    }
+    
+    printf("Lattice (text_length=%d):\n", lattice->text_length);
+    
+    for (int pos = 0; pos <= lattice->text_length; pos++) {
+        printf("  Pos %d (%d nodes):\n", pos, lattice->node_counts[pos]);
+        
+        LatticeNode *nodes[100];
+        int count = misaki_lattice_get_nodes_at(lattice, pos, nodes, 100);
+        
+        for (int i = 0; i < count; i++) {
+            MisakiStringView surface = misaki_lattice_node_surface(lattice, nodes[i]);
+            printf("    [%d] %.*s (cost=%.2f)\n",
+                   i, (int)surface.length, surface.data, nodes[i]->total_cost);
+        }
+    }
+    
     printf("  Best cost: %.2f\n", lattice->eos->total_cost);
 }
 
@@ -456,11 +1630,11 @@ bool misaki_lattice_export_dot(const Lattice *lattice, const char *file_path) {
     // 所有节点
     int node_id = 0;
     for (int pos = 0; pos <= lattice->text_length; pos++) {
-        LatticeNode *node = lattice->nodes[pos];
-        while (node) {
-            fprintf(f, "  N%d [label=\"%s\\npos=%d\\ncost=%.2f\"];\n",
-                    node_id++, node->surface, node->pos, node->total_cost);
-            node = node->next ? node->next[0] : NULL;
+        for (int i = 0; i < lattice->node_counts[pos]; i++) {
+            LatticeNode *node = lattice->nodes[pos][i];
+            MisakiStringView surface = misaki_lattice_node_surface(lattice, node);
+            fprintf(f, "  N%d [label=\"%.*s\\npos=%d\\ncost=%.2f\"];\n",
+                    node_id++, (int)surface.length, surface.data, node->pos, node->total_cost);
         }
     }
     
@@ -468,9 +1642,7 @@ bool misaki_lattice_export_dot(const Lattice *lattice, const char *file_path) {
     fprintf(f, "  EOS [label=\"EOS\\ncost=%.2f\"];\n", lattice->eos->total_cost);
     
     // 边（最优路径）
-    LatticeNode *path[1000];
-    int count = misaki_viterbi_backtrack(lattice, path, 1000);
-    
+    int count = viterbi_path_length(lattice);
     if (count > 0) {
         fprintf(f, "  BOS -> N%d [color=red];\n", 0);
         for (int i = 0; i < count - 1; i++) {
@@ -499,10 +1671,8 @@ void misaki_lattice_stats(const Lattice *lattice,
     for (int pos = 0; pos <= lattice->text_length; pos++) {
         t_nodes += lattice->node_counts[pos];
         
-        LatticeNode *node = lattice->nodes[pos];
-        while (node) {
-            t_edges += node->next_count;
-            node = node->next ? node->next[0] : NULL;
+        for (int i = 0; i < lattice->node_counts[pos]; i++) {
+            t_edges += lattice->nodes[pos][i]->next_count;
         }
     }
     
@@ -0,0 +1,497 @@
+/**
+ * misaki_vocab.c
+ * 
+ * Misaki C Port - Kokoro Vocabulary Encoder Implementation
+ * 
+ * License: MIT
+ */
+
+#include "misaki_vocab.h"
+#include "misaki_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VOCAB_PAGE_SIZE 256
+#define VOCAB_PAGE_COUNT 256    // 只收录 U+0000..U+FFFF
+#define VOCAB_MAX_ID 32767
+
+// 字符在分段时的作用
+#define VOCAB_KIND_NONE 0
+#define VOCAB_KIND_SPACE 1
+#define VOCAB_KIND_PUNCT 2
+
+struct MisakiVocab {
+    int16_t *pages[VOCAB_PAGE_COUNT];   // 码点高 8 位 → 页（NULL 表示整页都不在词表里）
+    uint8_t *kinds;                     // ID → 分段作用
+    int max_id;
+    int count;
+};
+
+/**
+ * 内置的 Kokoro 词表（models/vocab.json）
+ */
+static const struct {
+    uint32_t codepoint;
+    int id;
+} KOKORO_VOCAB[] = {
+    { 0x003B,   1 }, { 0x003A,   2 }, { 0x002C,   3 }, { 0x002E,   4 },     // ; : , .
+    { 0x0021,   5 }, { 0x003F,   6 }, { 0x2014,   9 }, { 0x2026,  10 },     // ! ? — …
+    { 0x0022,  11 }, { 0x0028,  12 }, { 0x0029,  13 }, { 0x201C,  14 },     // " ( ) “
+    { 0x201D,  15 }, { 0x0020,  16 }, { 0x0303,  17 }, { 0x02A3,  18 },     // ” 空格 ◌̃ ʣ
+    { 0x02A5,  19 }, { 0x02A6,  20 }, { 0x02A8,  21 }, { 0x1D5D,  22 },     // ʥ ʦ ʨ ᵝ
+    { 0xAB67,  23 }, { 0x0041,  24 }, { 0x0049,  25 }, { 0x004F,  31 },     // ꭧ A I O
+    { 0x0051,  33 }, { 0x0053,  35 }, { 0x0054,  36 }, { 0x0057,  39 },     // Q S T W
+    { 0x0059,  41 }, { 0x1D4A,  42 }, { 0x0061,  43 }, { 0x0062,  44 },     // Y ᵊ a b
+    { 0x0063,  45 }, { 0x0064,  46 }, { 0x0065,  47 }, { 0x0066,  48 },     // c d e f
+    { 0x0068,  50 }, { 0x0069,  51 }, { 0x006A,  52 }, { 0x006B,  53 },     // h i j k
+    { 0x006C,  54 }, { 0x006D,  55 }, { 0x006E,  56 }, { 0x006F,  57 },     // l m n o
+    { 0x0070,  58 }, { 0x0071,  59 }, { 0x0072,  60 }, { 0x0073,  61 },     // p q r s
+    { 0x0074,  62 }, { 0x0075,  63 }, { 0x0076,  64 }, { 0x0077,  65 },     // t u v w
+    { 0x0078,  66 }, { 0x0079,  67 }, { 0x007A,  68 }, { 0x0251,  69 },     // x y z ɑ
+    { 0x0250,  70 }, { 0x0252,  71 }, { 0x00E6,  72 }, { 0x03B2,  75 },     // ɐ ɒ æ β
+    { 0x0254,  76 }, { 0x0255,  77 }, { 0x00E7,  78 }, { 0x0256,  80 },     // ɔ ɕ ç ɖ
+    { 0x00F0,  81 }, { 0x02A4,  82 }, { 0x0259,  83 }, { 0x025A,  85 },     // ð ʤ ə ɚ
+    { 0x025B,  86 }, { 0x025C,  87 }, { 0x025F,  90 }, { 0x0261,  92 },     // ɛ ɜ ɟ ɡ
+    { 0x0265,  99 }, { 0x0268, 101 }, { 0x026A, 102 }, { 0x029D, 103 },     // ɥ ɨ ɪ ʝ
+    { 0x026F, 110 }, { 0x0270, 111 }, { 0x014B, 112 }, { 0x0273, 113 },     // ɯ ɰ ŋ ɳ
+    { 0x0272, 114 }, { 0x0274, 115 }, { 0x00F8, 116 }, { 0x0278, 118 },     // ɲ ɴ ø ɸ
+    { 0x03B8, 119 }, { 0x0153, 120 }, { 0x0279, 123 }, { 0x027E, 125 },     // θ œ ɹ ɾ
+    { 0x027B, 126 }, { 0x0281, 128 }, { 0x027D, 129 }, { 0x0282, 130 },     // ɻ ʁ ɽ ʂ
+    { 0x0283, 131 }, { 0x0288, 132 }, { 0x02A7, 133 }, { 0x028A, 135 },     // ʃ ʈ ʧ ʊ
+    { 0x028B, 136 }, { 0x028C, 138 }, { 0x0263, 139 }, { 0x0264, 140 },     // ʋ ʌ ɣ ɤ
+    { 0x03C7, 142 }, { 0x028E, 143 }, { 0x0292, 147 }, { 0x0294, 148 },     // χ ʎ ʒ ʔ
+    { 0x02C8, 156 }, { 0x02CC, 157 }, { 0x02D0, 158 }, { 0x02B0, 162 },     // ˈ ˌ ː ʰ
+    { 0x02B2, 164 }, { 0x2193, 169 }, { 0x2192, 171 }, { 0x2197, 172 },     // ʲ ↓ → ↗
+    { 0x2198, 173 }, { 0x1D7B, 177 },                                       // ↘ ᵻ
+};
+
+/* ============================================================================
+ * 创建与释放
+ * ========================================================================== */
+
+static uint8_t vocab_kind(uint32_t codepoint) {
+    if (codepoint == ' ') {
+        return VOCAB_KIND_SPACE;
+    }
+    if (codepoint == ';' || codepoint == ':' || codepoint == ',' || codepoint == '.' ||
+        codepoint == '!' || codepoint == '?' || codepoint == 0x2014 || codepoint == 0x2026) {
+        return VOCAB_KIND_PUNCT;    // ;:,.!?—…
+    }
+    return VOCAB_KIND_NONE;
+}
+
+MisakiVocab* misaki_vocab_create(const uint32_t *codepoints, const int *ids, int count) {
+    if ((!codepoints || !ids) && count > 0) {
+        return NULL;
+    }
+    
+    int max_id = 0;
+    for (int i = 0; i < count; i++) {
+        if (codepoints[i] > 0xFFFF || ids[i] <= 0 || ids[i] > VOCAB_MAX_ID) {
+            return NULL;
+        }
+        if (ids[i] > max_id) {
+            max_id = ids[i];
+        }
+    }
+    
+    MisakiVocab *vocab = (MisakiVocab *)calloc(1, sizeof(MisakiVocab));
+    if (!vocab) {
+        return NULL;
+    }
+    vocab->max_id = max_id;
+    vocab->kinds = (uint8_t *)calloc((size_t)max_id + 1, sizeof(uint8_t));
+    if (!vocab->kinds) {
+        misaki_vocab_free(vocab);
+        return NULL;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        int16_t **page = &vocab->pages[codepoints[i] / VOCAB_PAGE_SIZE];
+        if (!*page) {
+            *page = (int16_t *)malloc(VOCAB_PAGE_SIZE * sizeof(int16_t));
+            if (!*page) {
+                misaki_vocab_free(vocab);
+                return NULL;
+            }
+            for (int j = 0; j < VOCAB_PAGE_SIZE; j++) {
+                (*page)[j] = -1;
+            }
+        }
+        
+        // 重复的码点只保留第一条
+        int16_t *slot = &(*page)[codepoints[i] % VOCAB_PAGE_SIZE];
+        if (*slot < 0) {
+            *slot = (int16_t)ids[i];
+            vocab->kinds[ids[i]] = vocab_kind(codepoints[i]);
+            vocab->count++;
+        }
+    }
+    
+    return vocab;
+}
+
+MisakiVocab* misaki_vocab_create_default(void) {
+    int count = (int)(sizeof(KOKORO_VOCAB) / sizeof(KOKORO_VOCAB[0]));
+    uint32_t codepoints[sizeof(KOKORO_VOCAB) / sizeof(KOKORO_VOCAB[0])];
+    int ids[sizeof(KOKORO_VOCAB) / sizeof(KOKORO_VOCAB[0])];
+    for (int i = 0; i < count; i++) {
+        codepoints[i] = KOKORO_VOCAB[i].codepoint;
+        ids[i] = KOKORO_VOCAB[i].id;
+    }
+    return misaki_vocab_create(codepoints, ids, count);
+}
+
+void misaki_vocab_free(MisakiVocab *vocab) {
+    if (!vocab) {
+        return;
+    }
+    
+    for (int i = 0; i < VOCAB_PAGE_COUNT; i++) {
+        free(vocab->pages[i]);
+    }
+    free(vocab->kinds);
+    free(vocab);
+}
+
+/* ============================================================================
+ * vocab.json
+ * ========================================================================== */
+
+static const char* json_skip_space(const char *p) {
+    while (*p && misaki_isspace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static bool json_hex4(const char *p, uint32_t *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        int digit = c >= '0' && c <= '9' ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0) {
+            return false;
+        }
+        *value = *value * 16 + (uint32_t)digit;
+    }
+    return true;
+}
+
+/**
+ * 解析字符串（p 指向开头的引号）
+ * 
+ * @param codepoint 输出：字符串只有一个字符时为它的码点，否则为 UINT32_MAX
+ * @return 结尾引号之后的位置，格式错误返回 NULL
+ */
+static const char* json_parse_char(const char *p, uint32_t *codepoint) {
+    int chars = 0;
+    *codepoint = UINT32_MAX;
+    p++;
+    
+    while (*p != '"') {
+        uint32_t cp;
+        if (*p == '\0') {
+            return NULL;
+        } else if (*p == '\\') {
+            char c = p[1];
+            p += 2;
+            switch (c) {
+                case '"': case '\\': case '/': cp = (uint32_t)c; break;
+                case 'b': cp = '\b'; break;
+                case 'f': cp = '\f'; break;
+                case 'n': cp = '\n'; break;
+                case 'r': cp = '\r'; break;
+                case 't': cp = '\t'; break;
+                case 'u':
+                    if (!json_hex4(p, &cp)) {
+                        return NULL;
+                    }
+                    p += 4;
+                    // 代理对
+                    if (cp >= 0xD800 && cp <= 0xDBFF && p[0] == '\\' && p[1] == 'u') {
+                        uint32_t low;
+                        if (json_hex4(p + 2, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            p += 6;
+                        }
+                    }
+                    break;
+                default:
+                    return NULL;
+            }
+        } else {
+            int len = misaki_utf8_decode(p, &cp);
+            if (len == 0) {
+                return NULL;
+            }
+            p += len;
+        }
+        
+        chars++;
+        *codepoint = chars == 1 ? cp : UINT32_MAX;
+    }
+    
+    return p + 1;
+}
+
+/**
+ * 解析 {"字符": ID, ...}（多个字符的键跳过）
+ */
+static bool json_parse_vocab(const char *p, uint32_t **codepoints, int **ids, int *count) {
+    int capacity = 0;
+    *count = 0;
+    
+    p = json_skip_space(p);
+    if (*p++ != '{') {
+        return false;
+    }
+    p = json_skip_space(p);
+    if (*p == '}') {
+        return true;
+    }
+    
+    while (true) {
+        uint32_t cp;
+        p = json_skip_space(p);
+        if (*p != '"' || !(p = json_parse_char(p, &cp))) {
+            return false;
+        }
+        p = json_skip_space(p);
+        if (*p++ != ':') {
+            return false;
+        }
+        
+        char *end;
+        long id = strtol(p, &end, 10);
+        if (end == p) {
+            return false;
+        }
+        p = json_skip_space(end);
+        
+        if (cp != UINT32_MAX) {
+            if (*count == capacity) {
+                capacity = capacity ? capacity * 2 : 128;
+                uint32_t *grown_cps = (uint32_t *)realloc(*codepoints, capacity * sizeof(uint32_t));
+                if (grown_cps) {
+                    *codepoints = grown_cps;
+                }
+                int *grown_ids = (int *)realloc(*ids, capacity * sizeof(int));
+                if (grown_ids) {
+                    *ids = grown_ids;
+                }
+                if (!grown_cps || !grown_ids) {
+                    return false;
+                }
+            }
+            (*codepoints)[*count] = cp;
+            (*ids)[*count] = id > 0 && id <= VOCAB_MAX_ID ? (int)id : -1;
+            (*count)++;
+        }
+        
+        if (*p == ',') {
+            p++;
+        } else {
+            return *p == '}';
+        }
+    }
+}
+
+MisakiVocab* misaki_vocab_load(const char *path) {
+    if (!path) {
+        return NULL;
+    }
+    
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char *data = size >= 0 ? (char *)malloc((size_t)size + 1) : NULL;
+    bool ok = data && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    
+    uint32_t *codepoints = NULL;
+    int *ids = NULL;
+    int count = 0;
+    MisakiVocab *vocab = NULL;
+    if (ok) {
+        data[size] = '\0';
+        ok = json_parse_vocab(data, &codepoints, &ids, &count);
+    }
+    if (ok) {
+        vocab = misaki_vocab_create(codepoints, ids, count);
+    }
+    
+    free(data);
+    free(codepoints);
+    free(ids);
+    return vocab;
+}
+
+/* ============================================================================
+ * 查询与编码
+ * ========================================================================== */
+
+int misaki_vocab_lookup(const MisakiVocab *vocab, uint32_t codepoint) {
+    if (!vocab || codepoint > 0xFFFF) {
+        return -1;
+    }
+    
+    const int16_t *page = vocab->pages[codepoint / VOCAB_PAGE_SIZE];
+    return page ? page[codepoint % VOCAB_PAGE_SIZE] : -1;
+}
+
+/**
+ * 编码状态：当前段从 ids[start]（段首的 0）开始，已写到 ids[pos - 1]
+ */
+typedef struct {
+    const MisakiVocab *vocab;
+    int64_t *ids;
+    int max_ids;
+    int *chunk_lengths;
+    int max_chunks;
+    int chunks;
+    int pos;
+    int start;                  // -1 表示没有打开的段
+    int punct_cut;              // 段内最后一个标点之后的位置（-1 表示没有）
+    int space_cut;              // 段内最后一个空格之后的位置
+} VocabEncoder;
+
+static bool encoder_is_space(const VocabEncoder *enc, int index) {
+    return enc->vocab->kinds[enc->ids[index]] == VOCAB_KIND_SPACE;
+}
+
+/**
+ * 在 end 处结束当前段（去掉末尾的空格，写入段尾的 0）
+ * 
+ * @return 段尾之后的位置，输出数组不够时返回 -1
+ */
+static int encoder_finish(VocabEncoder *enc, int end) {
+    while (end > enc->start + 1 && encoder_is_space(enc, end - 1)) {
+        end--;
+    }
+    if (end >= enc->max_ids || enc->chunks >= enc->max_chunks) {
+        return -1;
+    }
+    
+    enc->ids[end] = 0;
+    enc->chunk_lengths[enc->chunks++] = end + 1 - enc->start;
+    enc->start = -1;
+    enc->punct_cut = -1;
+    enc->space_cut = -1;
+    return end + 1;
+}
+
+/**
+ * 当前段已满：在最后一个标点或空格处切开，切点之后的 ID 移到新的一段
+ */
+static bool encoder_split(VocabEncoder *enc) {
+    int cut = enc->punct_cut > 0 ? enc->punct_cut
+            : enc->space_cut > 0 ? enc->space_cut : enc->pos;
+    int tail_begin = cut;
+    while (tail_begin < enc->pos && encoder_is_space(enc, tail_begin)) {
+        tail_begin++;
+    }
+    int tail = enc->pos - tail_begin;
+    
+    // 先确定段尾的位置，把尾部挪到新段首的 0 之后，再写入两个 0
+    int end = cut;
+    while (end > enc->start + 1 && encoder_is_space(enc, end - 1)) {
+        end--;
+    }
+    if (end + 2 + tail > enc->max_ids) {
+        return false;
+    }
+    memmove(enc->ids + end + 2, enc->ids + tail_begin, (size_t)tail * sizeof(int64_t));
+    
+    int next = encoder_finish(enc, end);
+    if (next < 0) {
+        return false;
+    }
+    enc->start = next;
+    enc->ids[next] = 0;
+    enc->pos = next + 1 + tail;
+    
+    for (int i = next + 1; i < enc->pos; i++) {
+        uint8_t kind = enc->vocab->kinds[enc->ids[i]];
+        if (kind == VOCAB_KIND_PUNCT) {
+            enc->punct_cut = i + 1;
+        } else if (kind == VOCAB_KIND_SPACE) {
+            enc->space_cut = i + 1;
+        }
+    }
+    return true;
+}
+
+int misaki_vocab_encode(const MisakiVocab *vocab, const char *phonemes, int max_tokens,
+                        int64_t *ids, int max_ids, int *chunk_lengths, int max_chunks) {
+    if (!vocab || !phonemes || (!ids && max_ids > 0) || (!chunk_lengths && max_chunks > 0)) {
+        return -1;
+    }
+    if (max_tokens <= 0) {
+        max_tokens = MISAKI_VOCAB_MAX_TOKENS;
+    }
+    
+    VocabEncoder enc = { vocab, ids, max_ids, chunk_lengths, max_chunks, 0, 0, -1, -1, -1 };
+    const char *p = phonemes;
+    while (*p) {
+        uint32_t cp;
+        int len = misaki_utf8_decode(p, &cp);
+        if (len == 0) {
+            p++;
+            continue;
+        }
+        p += len;
+    
+        int id = misaki_vocab_lookup(vocab, cp);
+        if (id < 0) {
+            continue;   // 词表外的字符（与 Kokoro 的处理相同）
+        }
+        uint8_t kind = vocab->kinds[id];
+    
+        if (enc.start < 0) {
+            if (kind == VOCAB_KIND_SPACE) {
+                continue;   // 段首的空格
+            }
+            if (enc.pos >= max_ids) {
+                return -1;
+            }
+            enc.start = enc.pos;
+            enc.ids[enc.pos++] = 0;
+        } else if (enc.pos - enc.start - 1 == max_tokens) {
+            if (kind == VOCAB_KIND_SPACE) {
+                // 正好在上限处遇到空格：在这里结束
+                enc.pos = encoder_finish(&enc, enc.pos);
+                if (enc.pos < 0) {
+                    return -1;
+                }
+                continue;
+            }
+            if (!encoder_split(&enc)) {
+                return -1;
+            }
+        }
+    
+        if (enc.pos >= max_ids) {
+            return -1;
+        }
+        enc.ids[enc.pos++] = id;
+        if (kind == VOCAB_KIND_PUNCT) {
+            enc.punct_cut = enc.pos;
+        } else if (kind == VOCAB_KIND_SPACE) {
+            enc.space_cut = enc.pos;
+        }
+    }
+    
+    if (enc.start >= 0 && encoder_finish(&enc, enc.pos) < 0) {
+        return -1;
+    }
+    return enc.chunks;
+}
@@ -180,6 +180,7 @@ bool init_app(MisakiApp *app, const char *data_dir) {
     int ja_word_count = misaki_trie_load_ja_pron_dict(app->ja_trie, ja_dict_path);
     if (ja_word_count > 0) {
         printf("   ✅ 成功加载 %d 个日文词汇（含读音）\n", ja_word_count);
+        misaki_ja_precompute_ipa(app->ja_trie);
         
         // 创建日文分词器
         JaTokenizerConfig ja_config = {
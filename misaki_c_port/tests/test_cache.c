@@ -0,0 +1,251 @@
+/**
+ * test_cache.c
+ * 
+ * LRU 缓存测试（淘汰策略、过期、统计、single-flight）
+ */
+
+#include "misaki_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static bool put_str(LRUCache *cache, const char *key, const char *value) {
+    return misaki_cache_put(cache, key, (void *)value, strlen(value) + 1, true);
+}
+
+void test_cache_lru() {
+    printf("Testing LRU eviction...\n");
+    
+    LRUCache *cache = misaki_cache_create(3, 0);
+    assert(cache != NULL);
+    assert(cache->shard_count == 1);
+    
+    assert(put_str(cache, "a", "1"));
+    assert(put_str(cache, "b", "2"));
+    assert(put_str(cache, "c", "3"));
+    
+    // 访问 a 后插入 d：最久未用的 b 被淘汰
+    assert(strcmp((char *)misaki_cache_get(cache, "a"), "1") == 0);
+    assert(put_str(cache, "d", "4"));
+    assert(misaki_cache_contains(cache, "a"));
+    assert(!misaki_cache_contains(cache, "b"));
+    assert(misaki_cache_contains(cache, "c"));
+    assert(misaki_cache_contains(cache, "d"));
+    
+    // 更新已有的键不占新位置
+    assert(put_str(cache, "c", "33"));
+    size_t size = 0;
+    char *copy = (char *)misaki_cache_get_copy(cache, "c", &size);
+    assert(copy && strcmp(copy, "33") == 0 && size == 3);
+    free(copy);
+    
+    assert(misaki_cache_remove(cache, "a", NULL));
+    assert(!misaki_cache_remove(cache, "a", NULL));
+    assert(misaki_cache_get(cache, "a") == NULL);
+    
+    CacheStats stats;
+    misaki_cache_get_stats(cache, &stats);
+    assert(stats.count == 2);
+    assert(stats.hit_count == 2 && stats.miss_count == 1);
+    
+    misaki_cache_free(cache, NULL);
+    printf("✓ LRU eviction passed\n");
+}
+
+void test_cache_policies() {
+    printf("Testing LFU / FIFO policies...\n");
+    
+    LRUCache *lfu = misaki_cache_create(2, 0);
+    misaki_cache_set_evict_policy(lfu, CACHE_EVICT_LFU);
+    put_str(lfu, "a", "1");
+    put_str(lfu, "b", "2");
+    misaki_cache_get(lfu, "a");
+    misaki_cache_get(lfu, "a");
+    misaki_cache_get(lfu, "b");
+    put_str(lfu, "c", "3");          // b 访问次数最少
+    assert(misaki_cache_contains(lfu, "a"));
+    assert(!misaki_cache_contains(lfu, "b"));
+    misaki_cache_free(lfu, NULL);
+    
+    LRUCache *fifo = misaki_cache_create(2, 0);
+    misaki_cache_set_evict_policy(fifo, CACHE_EVICT_FIFO);
+    put_str(fifo, "a", "1");
+    put_str(fifo, "b", "2");
+    misaki_cache_get(fifo, "a");     // 访问不改变顺序
+    put_str(fifo, "c", "3");
+    assert(!misaki_cache_contains(fifo, "a"));
+    assert(misaki_cache_contains(fifo, "b"));
+    misaki_cache_free(fifo, NULL);
+    
+    printf("✓ LFU / FIFO policies passed\n");
+}
+
+void test_cache_memory_and_ttl() {
+    printf("Testing memory limit / TTL...\n");
+    
+    // 每条 2 (键) + 8 (值) 字节，限制 25 字节只能放 2 条
+    LRUCache *cache = misaki_cache_create(100, 25);
+    assert(put_str(cache, "a", "1234567"));
+    assert(put_str(cache, "b", "1234567"));
+    assert(put_str(cache, "c", "1234567"));
+    assert(!misaki_cache_contains(cache, "a"));
+    assert(misaki_cache_contains(cache, "c"));
+    assert(!put_str(cache, "big", "this value is far too large"));
+    misaki_cache_free(cache, NULL);
+    
+    cache = misaki_cache_create(10, 0);
+    misaki_cache_set_ttl(cache, 1);
+    put_str(cache, "a", "1");
+    put_str(cache, "b", "2");
+    assert(misaki_cache_get(cache, "a") != NULL);
+    usleep(1100 * 1000);
+    assert(!misaki_cache_contains(cache, "a"));
+    assert(misaki_cache_get(cache, "a") == NULL);
+    assert(misaki_cache_expire(cache, NULL) == 1);
+    
+    CacheStats stats;
+    misaki_cache_get_stats(cache, &stats);
+    assert(stats.count == 0);
+    misaki_cache_free(cache, NULL);
+    
+    printf("✓ Memory limit / TTL passed\n");
+}
+
+void test_cache_sharded() {
+    printf("Testing sharded cache...\n");
+    
+    LRUCache *cache = misaki_cache_create(4096, 0);
+    assert(cache->shard_count == 16);
+    
+    char key[32];
+    char value[32];
+    for (int i = 0; i < 2000; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        snprintf(value, sizeof(value), "value-%d", i);
+        assert(put_str(cache, key, value));
+    }
+    for (int i = 0; i < 2000; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        snprintf(value, sizeof(value), "value-%d", i);
+        char *copy = (char *)misaki_cache_get_copy(cache, key, NULL);
+        assert(copy && strcmp(copy, value) == 0);
+        free(copy);
+    }
+    
+    misaki_cache_print_stats(cache);
+    misaki_cache_reset_stats(cache);
+    CacheStats stats;
+    misaki_cache_get_stats(cache, &stats);
+    assert(stats.count == 2000 && stats.hit_count == 0);
+    
+    misaki_cache_free(cache, NULL);
+    printf("✓ Sharded cache passed\n");
+}
+
+void test_cache_specialized() {
+    printf("Testing tokenizer / G2P caches...\n");
+    
+    TokenizerCache *tokenizer_cache = misaki_tokenizer_cache_create(8);
+    MisakiTokenList *tokens = misaki_token_list_create();
+    MisakiToken *token = misaki_token_create("今日", "名詞", 0, 6);
+    misaki_token_list_add(tokens, token);
+    misaki_token_free(token);
+    
+    assert(misaki_tokenizer_cache_put(tokenizer_cache, "今日", tokens));
+    misaki_token_list_free(tokens);
+    MisakiTokenList *cached = misaki_tokenizer_cache_get(tokenizer_cache, "今日");
+    assert(cached && cached->count == 1);
+    assert(strcmp(cached->tokens[0].text, "今日") == 0);
+    misaki_token_list_free(cached);
+    assert(misaki_tokenizer_cache_get(tokenizer_cache, "明日") == NULL);
+    misaki_tokenizer_cache_free(tokenizer_cache);
+    
+    // 语言、选项不同的同一文本是不同的键
+    G2PCache *g2p_cache = misaki_g2p_cache_create(8);
+    G2POptions options = misaki_g2p_default_options();
+    options.ja_long_vowel = !options.ja_long_vowel;
+    
+    assert(misaki_g2p_cache_put(g2p_cache, "日本", "ja", NULL, "nihoɴ"));
+    char *phonemes = misaki_g2p_cache_get(g2p_cache, "日本", "ja", NULL);
+    assert(phonemes && strcmp(phonemes, "nihoɴ") == 0);
+    free(phonemes);
+    assert(misaki_g2p_cache_get(g2p_cache, "日本", "zh", NULL) == NULL);
+    assert(misaki_g2p_cache_get(g2p_cache, "日本", "ja", &options) == NULL);
+    misaki_g2p_cache_free(g2p_cache);
+    
+    printf("✓ Tokenizer / G2P caches passed\n");
+}
+
+/* ============================================================================
+ * single-flight
+ * ========================================================================== */
+
+#define FLIGHT_THREADS 8
+
+static atomic_int g_compute_calls;
+
+static char* slow_compute(void *ctx) {
+    atomic_fetch_add(&g_compute_calls, 1);
+    usleep(100 * 1000);
+    return strdup((const char *)ctx);
+}
+
+static void* flight_worker(void *arg) {
+    G2PCache *cache = (G2PCache *)arg;
+    return misaki_g2p_cache_get_or_compute(cache, "こんにちは", "ja", NULL,
+                                           slow_compute, "koɴnitɕiwa");
+}
+
+void test_cache_single_flight() {
+    printf("Testing single-flight...\n");
+    
+    G2PCache *cache = misaki_g2p_cache_create(16);
+    atomic_store(&g_compute_calls, 0);
+    
+    pthread_t threads[FLIGHT_THREADS];
+    for (int t = 0; t < FLIGHT_THREADS; t++) {
+        assert(pthread_create(&threads[t], NULL, flight_worker, cache) == 0);
+    }
+    for (int t = 0; t < FLIGHT_THREADS; t++) {
+        char *result = NULL;
+        pthread_join(threads[t], (void **)&result);
+        assert(result && strcmp(result, "koɴnitɕiwa") == 0);
+        free(result);
+    }
+    
+    printf("  %d threads, compute called %d time(s)\n",
+           FLIGHT_THREADS, atomic_load(&g_compute_calls));
+    assert(atomic_load(&g_compute_calls) == 1);
+    
+    // 之后的查询直接命中
+    char *result = misaki_g2p_cache_get_or_compute(cache, "こんにちは", "ja", NULL,
+                                                   slow_compute, "koɴnitɕiwa");
+    assert(result && atomic_load(&g_compute_calls) == 1);
+    free(result);
+    
+    misaki_g2p_cache_free(cache);
+    printf("✓ Single-flight passed\n");
+}
+
+int main() {
+    printf("==============================================\n");
+    printf("Misaki Cache Test\n");
+    printf("==============================================\n\n");
+    
+    test_cache_lru();
+    test_cache_policies();
+    test_cache_memory_and_ttl();
+    test_cache_sharded();
+    test_cache_specialized();
+    test_cache_single_flight();
+    
+    printf("\n==============================================\n");
+    printf("All cache tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
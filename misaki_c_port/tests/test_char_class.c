@@ -0,0 +1,79 @@
+/**
+ * test_char_class.c
+ * 
+ * 字符类别表测试（未登录词处理）
+ */
+
+#include "misaki_char_class.h"
+#include "misaki_string.h"
+#include <stdio.h>
+#include <assert.h>
+
+// 取 UTF-8 字符串第一个字符的类别
+static MisakiCharClass class_of(const char *str) {
+    uint32_t codepoint = 0;
+    misaki_utf8_decode(str, &codepoint);
+    return misaki_char_class(codepoint);
+}
+
+void test_char_class_lookup() {
+    printf("Testing char class lookup...\n");
+    
+    assert(class_of("あ") == MISAKI_CHAR_HIRAGANA);
+    assert(class_of("ア") == MISAKI_CHAR_KATAKANA);
+    assert(class_of("ー") == MISAKI_CHAR_KATAKANA);
+    assert(class_of("ｱ") == MISAKI_CHAR_KATAKANA);
+    assert(class_of("・") == MISAKI_CHAR_SYMBOL);
+    assert(class_of("漢") == MISAKI_CHAR_KANJI);
+    assert(class_of("々") == MISAKI_CHAR_KANJI);
+    assert(class_of("三") == MISAKI_CHAR_KANJINUMERIC);
+    assert(class_of("〇") == MISAKI_CHAR_KANJINUMERIC);
+    assert(class_of("a") == MISAKI_CHAR_ALPHA);
+    assert(class_of("Ｚ") == MISAKI_CHAR_ALPHA);
+    assert(class_of("é") == MISAKI_CHAR_ALPHA);
+    assert(class_of("7") == MISAKI_CHAR_NUMERIC);
+    assert(class_of("７") == MISAKI_CHAR_NUMERIC);
+    assert(class_of(" ") == MISAKI_CHAR_SPACE);
+    assert(class_of("　") == MISAKI_CHAR_SPACE);
+    assert(class_of("、") == MISAKI_CHAR_SYMBOL);
+    assert(class_of("？") == MISAKI_CHAR_SYMBOL);
+    assert(class_of("α") == MISAKI_CHAR_GREEK);
+    assert(class_of("Ж") == MISAKI_CHAR_CYRILLIC);
+    assert(class_of("😀") == MISAKI_CHAR_DEFAULT);
+    
+    printf("✓ Char class lookup passed\n");
+}
+
+void test_char_category() {
+    printf("Testing char categories...\n");
+    
+    const MisakiCharCategory *katakana = misaki_char_category(MISAKI_CHAR_KATAKANA);
+    assert(katakana->invoke && katakana->group);
+    
+    // 标点、平假名、汉字保持单字节点
+    const MisakiCharCategory *symbol = misaki_char_category(MISAKI_CHAR_SYMBOL);
+    assert(!symbol->group && symbol->length == 1);
+    assert(!misaki_char_category(MISAKI_CHAR_HIRAGANA)->group);
+    assert(!misaki_char_category(MISAKI_CHAR_KANJI)->group);
+    
+    // 无效类别退回 DEFAULT
+    assert(misaki_char_category(MISAKI_CHAR_CLASS_COUNT) ==
+           misaki_char_category(MISAKI_CHAR_DEFAULT));
+    
+    printf("✓ Char categories passed\n");
+}
+
+int main() {
+    printf("==============================================\n");
+    printf("Misaki Char Class Test\n");
+    printf("==============================================\n\n");
+    
+    test_char_class_lookup();
+    test_char_category();
+    
+    printf("\n==============================================\n");
+    printf("All char class tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
@@ -0,0 +1,578 @@
+/**
+ * test_engine.c
+ * 
+ * 引擎 API 测试（多线程共享同一个引擎）
+ */
+
+#include "misaki_api.h"
+#include "misaki_tokenizer.h"
+#include "misaki_g2p.h"
+#include "misaki_trie.h"
+#include "misaki_store.h"
+#include "misaki_preset.h"
+#include "misaki_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define THREAD_COUNT 4
+#define ROUNDS 50
+#define BATCH 64
+
+static const char *SENTENCES[] = {
+    "今日はいい天気ですね",
+    "私は学生です",
+    "コーヒーを飲みながら本を読みました",
+    "東京駅まで歩いて行きます",
+};
+#define SENTENCE_COUNT (int)(sizeof(SENTENCES) / sizeof(SENTENCES[0]))
+
+typedef struct {
+    const MisakiEngine *engine;
+    char (*expected)[1024];
+    int mismatches;
+} WorkerArgs;
+
+static void* worker(void *arg) {
+    WorkerArgs *args = (WorkerArgs *)arg;
+    char output[1024];
+    
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < SENTENCE_COUNT; i++) {
+            if (misaki_engine_text_to_phonemes_lang(args->engine, SENTENCES[i], "ja",
+                                                    output, sizeof(output)) != 0 ||
+                strcmp(output, args->expected[i]) != 0) {
+                args->mismatches++;
+            }
+        }
+    }
+    return NULL;
+}
+
+void test_engine_threads(const MisakiEngine *engine) {
+    printf("Testing shared engine across threads...\n");
+    
+    char expected[SENTENCE_COUNT][1024];
+    for (int i = 0; i < SENTENCE_COUNT; i++) {
+        assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[i], "ja",
+                                                   expected[i], sizeof(expected[i])) == 0);
+        printf("  %s → %s\n", SENTENCES[i], expected[i]);
+    }
+    
+    pthread_t threads[THREAD_COUNT];
+    WorkerArgs args[THREAD_COUNT];
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        args[t] = (WorkerArgs){ engine, expected, 0 };
+        assert(pthread_create(&threads[t], NULL, worker, &args[t]) == 0);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(threads[t], NULL);
+        assert(args[t].mismatches == 0);
+    }
+    
+    printf("✓ %d threads × %d rounds matched single-threaded output\n", THREAD_COUNT, ROUNDS);
+}
+
+typedef struct {
+    const MisakiEngine *engine;
+    const char **texts;
+    char (*expected)[1024];
+    int mismatches;
+} BatchArgs;
+
+static void* batch_worker(void *arg) {
+    BatchArgs *args = (BatchArgs *)arg;
+    
+    for (int round = 0; round < 5; round++) {
+        char *output = NULL;
+        int offsets[BATCH];
+        if (misaki_engine_text_to_phonemes_batch(args->engine, args->texts, BATCH, "ja",
+                                                 0, &output, offsets) != 0) {
+            args->mismatches++;
+            continue;
+        }
+        for (int i = 0; i < BATCH; i++) {
+            if (args->texts[i] && strcmp(output + offsets[i], args->expected[i]) != 0) {
+                args->mismatches++;
+            }
+        }
+        misaki_free_buffer(output);
+    }
+    return NULL;
+}
+
+void test_engine_batch(const MisakiEngine *engine) {
+    printf("Testing batch conversion...\n");
+    
+    // 多条文本（含 NULL 项），结果须与逐条转换一致，且与线程数无关
+    const char *texts[BATCH];
+    char expected[BATCH][1024];
+    for (int i = 0; i < BATCH; i++) {
+        texts[i] = (i % 17 == 5) ? NULL : SENTENCES[i % SENTENCE_COUNT];
+        if (texts[i]) {
+            assert(misaki_engine_text_to_phonemes_lang(engine, texts[i], "ja",
+                                                       expected[i], sizeof(expected[i])) == 0);
+        }
+    }
+    
+    const int thread_counts[] = { 1, 3, THREAD_COUNT, 0 };
+    for (int t = 0; t < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); t++) {
+        char *output = NULL;
+        int offsets[BATCH];
+        assert(misaki_engine_text_to_phonemes_batch(engine, texts, BATCH, "ja",
+                                                    thread_counts[t], &output, offsets) == 0);
+        assert(output != NULL);
+        for (int i = 0; i < BATCH; i++) {
+            if (!texts[i]) {
+                assert(offsets[i] == -1);
+            } else {
+                assert(offsets[i] >= 0);
+                assert(strcmp(output + offsets[i], expected[i]) == 0);
+            }
+        }
+        misaki_free_buffer(output);
+    }
+    
+    // 多个线程同时批量转换：引擎的线程池被占用时临时创建线程，结果不变
+    pthread_t threads[THREAD_COUNT];
+    BatchArgs args[THREAD_COUNT];
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        args[t] = (BatchArgs){ engine, texts, expected, 0 };
+        assert(pthread_create(&threads[t], NULL, batch_worker, &args[t]) == 0);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(threads[t], NULL);
+        assert(args[t].mismatches == 0);
+    }
+    
+    // 空批次、未知语言
+    char *output = NULL;
+    assert(misaki_engine_text_to_phonemes_batch(engine, texts, 0, "ja", 0, &output, NULL) == 0);
+    misaki_free_buffer(output);
+    assert(misaki_engine_text_to_phonemes_batch(engine, texts, 1, "xx", 0, &output, (int[1]){0}) == -1);
+    assert(output == NULL);
+    
+    printf("✓ Batch conversion passed\n");
+}
+
+static const char *TAGS[] = { "名詞", "UNK", "引擎テスト一", "引擎テスト二", "補助記号" };
+#define TAG_COUNT (int)(sizeof(TAGS) / sizeof(TAGS[0]))
+
+static void* tag_worker(void *arg) {
+    MisakiTagId *ids = (MisakiTagId *)arg;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < TAG_COUNT; i++) {
+            ids[i] = misaki_tag_intern(TAGS[i]);
+        }
+    }
+    return NULL;
+}
+
+void test_engine_tag_intern_threads() {
+    printf("Testing concurrent tag interning...\n");
+    
+    // 多个线程同时驻留同一批标签（含新标签），得到的 ID 必须一致
+    pthread_t threads[THREAD_COUNT];
+    MisakiTagId ids[THREAD_COUNT][TAG_COUNT];
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        assert(pthread_create(&threads[t], NULL, tag_worker, ids[t]) == 0);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    
+    for (int i = 0; i < TAG_COUNT; i++) {
+        for (int t = 1; t < THREAD_COUNT; t++) {
+            assert(ids[t][i] == ids[0][i]);
+        }
+        if (ids[0][i] != MISAKI_TAG_NONE) {
+            assert(strcmp(misaki_tag_name(ids[0][i]), TAGS[i]) == 0);
+        }
+    }
+    assert(ids[0][0] != MISAKI_TAG_NONE && ids[0][1] != MISAKI_TAG_NONE);
+    
+    printf("✓ Tag interning passed\n");
+}
+
+void test_engine_default_wrappers(const char *data_dir, const MisakiEngine *engine) {
+    printf("Testing default engine wrappers...\n");
+    
+    char wrapped[1024];
+    char direct[1024];
+    assert(misaki_text_to_phonemes_lang(SENTENCES[0], "ja", wrapped, sizeof(wrapped)) == -1);
+    
+    assert(misaki_init(data_dir) == 0);
+    assert(misaki_text_to_phonemes_lang(SENTENCES[0], "ja", wrapped, sizeof(wrapped)) == 0);
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[0], "ja",
+                                               direct, sizeof(direct)) == 0);
+    assert(strcmp(wrapped, direct) == 0);
+    
+    char *packed = NULL;
+    int offsets[SENTENCE_COUNT];
+    assert(misaki_text_to_phonemes_batch(SENTENCES, SENTENCE_COUNT, "ja", &packed, offsets) == 0);
+    assert(strcmp(packed + offsets[0], direct) == 0);
+    misaki_free_buffer(packed);
+    misaki_cleanup();
+    
+    assert(misaki_text_to_phonemes_lang(SENTENCES[0], "ja", wrapped, sizeof(wrapped)) == -1);
+    assert(misaki_engine_text_to_phonemes(NULL, SENTENCES[0], wrapped, sizeof(wrapped)) == -1);
+    
+    printf("✓ Default engine wrappers passed\n");
+}
+
+void test_engine_store(MisakiEngine *engine) {
+    printf("Testing persistent store...\n");
+    
+    const char *path = "test_engine_store.db";
+    unlink(path);
+    assert(misaki_engine_open_store(engine, path) == 0);
+    
+    char first[1024];
+    char again[1024];
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[1], "ja", first, sizeof(first)) == 0);
+    
+    // 换一个空的内存缓存：结果来自存储，与直接转换一致
+    assert(misaki_engine_set_cache_capacity(engine, 16) == 0);
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[1], "ja", again, sizeof(again)) == 0);
+    assert(strcmp(first, again) == 0);
+    
+    MisakiStore *store = misaki_store_open(path, true);
+    MisakiStoreStats stats;
+    misaki_store_get_stats(store, &stats);
+    assert(stats.count == 1);
+    misaki_store_close(store);
+    
+    assert(misaki_engine_open_store(engine, NULL) == 0);
+    unlink(path);
+    
+    printf("✓ Persistent store passed\n");
+}
+
+void test_engine_presets(MisakiEngine *engine) {
+    printf("Testing preset table...\n");
+    
+    // 预设表优先：收录的 (语言, 文本) 直接返回表中的音素
+    const MisakiLanguage langs[] = { LANG_JAPANESE, LANG_UNKNOWN };
+    const char *texts[] = { SENTENCES[0], SENTENCES[0] };
+    const char *phonemes[] = { "preset-ja", "preset-auto" };
+    unsigned char *data = NULL;
+    size_t size = 0;
+    assert(misaki_preset_table_build(langs, texts, phonemes, 2, &data, &size) == 0);
+    assert(misaki_engine_set_presets(engine, data, size) == 0);
+    
+    char output[1024];
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[0], "ja", output, sizeof(output)) == 0);
+    assert(strcmp(output, "preset-ja") == 0);
+    assert(misaki_engine_text_to_phonemes(engine, SENTENCES[0], output, sizeof(output)) == 0);
+    assert(strcmp(output, "preset-auto") == 0);
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[1], "ja", output, sizeof(output)) == 0);
+    assert(strcmp(output, "preset-ja") != 0);
+    
+    assert(misaki_engine_set_presets(engine, data, size - 1) == -1);
+    assert(misaki_engine_load_presets(engine, "does-not-exist.bin") == -1);
+    assert(misaki_engine_set_presets(engine, NULL, 0) == 0);
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[0], "ja", output, sizeof(output)) == 0);
+    assert(strcmp(output, "preset-ja") != 0);
+    free(data);
+    
+    printf("✓ Preset table passed\n");
+}
+
+/**
+ * 不分文字段、整段按日文转换（与引擎加载同一份词典），调用者 free
+ */
+static char* ja_whole_text(const char *data_dir, const char *text) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/ja/ja_pron_dict.tsv", data_dir);
+    Trie *trie = misaki_trie_create();
+    assert(misaki_trie_load_ja_pron_dict(trie, path) > 0);
+    misaki_ja_precompute_ipa(trie);
+    
+    JaTokenizerConfig config = {
+        .dict_trie = trie,
+        .use_simple_model = true,
+        .unidic_path = NULL
+    };
+    void *tokenizer = misaki_ja_tokenizer_create(&config);
+    G2POptions options = misaki_g2p_default_options();
+    MisakiTokenList *tokens = misaki_ja_g2p(trie, tokenizer, text, &options);
+    assert(tokens != NULL);
+    char *phonemes = misaki_merge_phonemes(tokens, " ");
+    
+    misaki_token_list_free(tokens);
+    misaki_ja_tokenizer_free(tokenizer);
+    misaki_trie_free(trie);
+    return phonemes;
+}
+
+void test_engine_mixed(const char *data_dir, MisakiEngine *engine) {
+    printf("Testing mixed-script dispatch...\n");
+    
+    // 先在没有预设表时转换一次，之后加载/卸载预设表都不能返回旧的结果
+    char before[2048];
+    assert(misaki_engine_text_to_phonemes(engine, "日本のiPhoneは高い", before, sizeof(before)) == 0);
+    
+    // 英文段由预设表提供（测试数据里不一定有英文词典）
+    const MisakiLanguage langs[] = { LANG_ENGLISH };
+    const char *texts[] = { "iPhone" };
+    const char *phonemes[] = { "ˈIfOn" };
+    unsigned char *data = NULL;
+    size_t size = 0;
+    assert(misaki_preset_table_build(langs, texts, phonemes, 1, &data, &size) == 0);
+    assert(misaki_engine_set_presets(engine, data, size) == 0);
+    
+    // 各段分别转换，结果用空格连接
+    char head[1024];
+    char tail[1024];
+    char expected[sizeof(head) + sizeof(tail) + 16];
+    char output[2048];
+    assert(misaki_engine_text_to_phonemes_lang(engine, "日本の", "ja", head, sizeof(head)) == 0);
+    assert(misaki_engine_text_to_phonemes_lang(engine, "は高い", "ja", tail, sizeof(tail)) == 0);
+    snprintf(expected, sizeof(expected), "%s ˈIfOn %s", head, tail);
+    assert(misaki_engine_text_to_phonemes(engine, "日本のiPhoneは高い", output, sizeof(output)) == 0);
+    assert(strcmp(output, expected) == 0);
+    assert(misaki_engine_text_to_phonemes_lang(engine, "日本のiPhoneは高い", "ja",
+                                               output, sizeof(output)) == 0);
+    assert(strcmp(output, expected) == 0);
+    
+    // 卸载预设表后同一文本不再使用预设的音素
+    assert(misaki_engine_set_presets(engine, NULL, 0) == 0);
+    assert(misaki_engine_text_to_phonemes(engine, "日本のiPhoneは高い", output, sizeof(output)) == 0);
+    assert(strcmp(output, before) == 0);
+    
+    // 有段转换失败（没有预设、没有英文词典）时整段转换，结果与之前相同
+    assert(misaki_engine_text_to_phonemes_lang(engine, "日本のAndroidは高い", "ja",
+                                               output, sizeof(output)) == 0);
+    char *whole = ja_whole_text(data_dir, "日本のAndroidは高い");
+    assert(strcmp(output, whole) == 0);
+    free(whole);
+    free(data);
+    
+    printf("✓ Mixed-script dispatch passed\n");
+}
+
+/* ============================================================================
+ * 流式转换
+ * ========================================================================== */
+
+#define STREAM_TEXT "今日はいい天気ですね。　私は学生です！\n「コーヒーを飲みながら本を読みました？」東京駅まで歩いて行きます"
+
+typedef struct {
+    const MisakiEngine *engine;
+    int calls;
+    int stop_after;             // 回调这么多次后要求停止（0 表示不停止）
+    int mismatches;
+} StreamCheck;
+
+static int stream_check(void *user, int index, const char *sentence,
+                        int sentence_length, const char *phonemes) {
+    StreamCheck *check = (StreamCheck *)user;
+    
+    // 按顺序回调，每句的结果与单独转换这一句相同
+    char text[256];
+    char expected[1024];
+    memcpy(text, sentence, (size_t)sentence_length);
+    text[sentence_length] = '\0';
+    if (index != check->calls || !phonemes ||
+        misaki_engine_text_to_phonemes_lang(check->engine, text, "ja",
+                                            expected, sizeof(expected)) != 0 ||
+        strcmp(expected, phonemes) != 0) {
+        check->mismatches++;
+    }
+    
+    check->calls++;
+    return check->stop_after > 0 && check->calls >= check->stop_after;
+}
+
+void test_engine_stream(const char *data_dir, const MisakiEngine *engine) {
+    printf("Testing streaming conversion...\n");
+    
+    // 句子切分：句末标点、其后的右括号和空白归前一句
+    const char *text = STREAM_TEXT;
+    const char *expected[] = {
+        "今日はいい天気ですね。　", "私は学生です！\n",
+        "「コーヒーを飲みながら本を読みました？」", "東京駅まで歩いて行きます",
+    };
+    for (int i = 0; i < 4; i++) {
+        size_t length = misaki_sentence_length(text);
+        assert(length == strlen(expected[i]) && strncmp(text, expected[i], length) == 0);
+        text += length;
+    }
+    assert(*text == '\0');
+    assert(misaki_sentence_length("Pi is 3.14. Next") == strlen("Pi is 3.14. "));
+    assert(misaki_sentence_length("Wait!? \"Yes\"") == strlen("Wait!? "));
+    assert(misaki_sentence_length("") == 0);
+    
+    // 有无预取线程结果相同
+    for (int lookahead = 0; lookahead <= 3; lookahead++) {
+        StreamCheck check = { engine, 0, 0, 0 };
+        assert(misaki_engine_stream_convert(engine, STREAM_TEXT, "ja", lookahead,
+                                            stream_check, &check) == 4);
+        assert(check.calls == 4 && check.mismatches == 0);
+    }
+    
+    // 回调要求停止
+    StreamCheck check = { engine, 0, 2, 0 };
+    assert(misaki_engine_stream_convert(engine, STREAM_TEXT, "ja", 2, stream_check, &check) == 2);
+    assert(check.calls == 2 && check.mismatches == 0);
+    
+    check = (StreamCheck){ engine, 0, 0, 0 };
+    assert(misaki_engine_stream_convert(engine, " \n　", "ja", 1, stream_check, &check) == 0);
+    assert(misaki_engine_stream_convert(engine, STREAM_TEXT, "xx", 1, stream_check, &check) == -1);
+    assert(misaki_engine_stream_convert(engine, NULL, "ja", 1, stream_check, &check) == -1);
+    assert(check.calls == 0);
+    
+    // 默认引擎
+    assert(misaki_stream_convert(STREAM_TEXT, stream_check, &check) == -1);
+    assert(misaki_init(data_dir) == 0);
+    assert(misaki_stream_convert(STREAM_TEXT, stream_check, &check) == 4);
+    assert(check.calls == 4);
+    misaki_cleanup();
+    
+    printf("✓ Streaming conversion passed\n");
+}
+
+typedef struct {
+    int calls;
+    char sentences[8][256];
+    char phonemes[8][1024];
+} StreamRecord;
+
+static int stream_record(void *user, int index, const char *sentence,
+                         int sentence_length, const char *phonemes) {
+    StreamRecord *record = (StreamRecord *)user;
+    assert(index == record->calls && index < 8 && phonemes);
+    memcpy(record->sentences[index], sentence, (size_t)sentence_length);
+    record->sentences[index][sentence_length] = '\0';
+    strcpy(record->phonemes[index], phonemes);
+    record->calls++;
+    return 0;
+}
+
+void test_engine_stream_feed(const MisakiEngine *engine) {
+    printf("Testing incremental stream feed...\n");
+    
+    StreamRecord whole = { 0 };
+    assert(misaki_engine_stream_convert(engine, STREAM_TEXT, "ja", 0, stream_record, &whole) == 4);
+    
+    // 逐字节输入（UTF-8 字符被切开）：句子在下一句开始时提交，结果与整段流式转换相同
+    StreamRecord fed = { 0 };
+    MisakiStream *stream = misaki_stream_create(engine, "ja", stream_record, &fed);
+    assert(stream != NULL);
+    const char *text = STREAM_TEXT;
+    size_t first_end = misaki_sentence_length(text);
+    char byte[2] = { 0, 0 };
+    for (size_t i = 0; text[i]; i++) {
+        byte[0] = text[i];
+        assert(misaki_stream_feed(stream, byte) >= 0);
+        if (i < first_end) {
+            assert(fed.calls == 0);
+        }
+    }
+    assert(fed.calls == 3);      // 最后一句要等输入结束
+    assert(misaki_stream_flush(stream) == 1);
+    assert(misaki_stream_flush(stream) == 0);
+    assert(fed.calls == 4);
+    for (int i = 0; i < 4; i++) {
+        assert(strcmp(fed.sentences[i], whole.sentences[i]) == 0);
+        assert(strcmp(fed.phonemes[i], whole.phonemes[i]) == 0);
+    }
+    misaki_stream_free(stream);
+    
+    // 没有句末标点的长句在分句处提交
+    StreamRecord clauses = { 0 };
+    stream = misaki_stream_create(engine, "ja", stream_record, &clauses);
+    misaki_stream_set_clause_threshold(stream, 30);
+    assert(misaki_stream_feed(stream, "今日はいい天気ですね、") == 0);
+    assert(misaki_stream_feed(stream, "コーヒーを飲みながら") == 1);
+    assert(strcmp(clauses.sentences[0], "今日はいい天気ですね、") == 0);
+    assert(misaki_stream_feed(stream, "本を読みました") == 0);
+    assert(misaki_stream_flush(stream) == 1);
+    assert(strcmp(clauses.sentences[1], "コーヒーを飲みながら本を読みました") == 0);
+    misaki_stream_free(stream);
+    
+    // 回调要求停止后流不再接受输入
+    StreamCheck check = { engine, 0, 1, 0 };
+    stream = misaki_stream_create(engine, "ja", stream_check, &check);
+    assert(misaki_stream_feed(stream, STREAM_TEXT) == 1);
+    assert(misaki_stream_feed(stream, "私は学生です。") == -1);
+    assert(misaki_stream_flush(stream) == -1);
+    assert(check.calls == 1 && check.mismatches == 0);
+    misaki_stream_free(stream);
+    
+    assert(misaki_stream_create(engine, "xx", stream_check, &check) == NULL);
+    assert(misaki_stream_create(NULL, "ja", stream_check, &check) == NULL);
+    
+    printf("✓ Incremental stream feed passed\n");
+}
+
+void test_engine_ids(MisakiEngine *engine) {
+    printf("Testing token ids...\n");
+    
+    // 文本转 ID 与先转音素再编码的结果相同
+    char phonemes[1024];
+    assert(misaki_engine_text_to_phonemes_lang(engine, SENTENCES[0], "ja", phonemes, sizeof(phonemes)) == 0);
+    int64_t ids[1024], expected[1024];
+    int lengths[8], expected_lengths[8];
+    int count = misaki_engine_text_to_ids(engine, SENTENCES[0], "ja", 0, ids, 1024, lengths, 8);
+    assert(count == 1);
+    assert(misaki_engine_phonemes_to_ids(engine, phonemes, 0, expected, 1024, expected_lengths, 8) == count);
+    assert(lengths[0] == expected_lengths[0]);
+    assert(memcmp(ids, expected, lengths[0] * sizeof(int64_t)) == 0);
+    assert(ids[0] == 0 && ids[lengths[0] - 1] == 0);
+    
+    // 限制每段长度后分成多段
+    int small = misaki_engine_text_to_ids(engine, SENTENCES[0], "ja", 4, ids, 1024, lengths, 8);
+    assert(small > 1);
+    for (int i = 0; i < small; i++) {
+        assert(lengths[i] <= 4 + 2);
+    }
+    
+    assert(misaki_engine_text_to_ids(engine, SENTENCES[0], "xx", 0, ids, 1024, lengths, 8) == -1);
+    assert(misaki_engine_text_to_ids(engine, SENTENCES[0], "ja", 0, ids, 2, lengths, 8) == -1);
+    assert(misaki_engine_load_vocab(engine, "nonexistent/vocab.json") == -1);
+    assert(misaki_engine_load_vocab(engine, NULL) == 0);
+    assert(misaki_engine_text_to_ids(engine, SENTENCES[0], "ja", 0, ids, 1024, lengths, 8) == count);
+    assert(memcmp(ids, expected, lengths[0] * sizeof(int64_t)) == 0);
+    
+    printf("✓ Token ids passed\n");
+}
+
+int main(int argc, char **argv) {
+    printf("==============================================\n");
+    printf("Misaki Engine Test\n");
+    printf("==============================================\n\n");
+    
+    const char *data_dir = argc > 1 ? argv[1] : "../extracted_data";
+    MisakiEngine *engine = misaki_engine_create(data_dir);
+    assert(engine != NULL);
+    
+    char probe[1024];
+    if (misaki_engine_text_to_phonemes_lang(engine, SENTENCES[0], "ja", probe, sizeof(probe)) != 0) {
+        printf("⚠️  未找到日文词典（%s/ja/ja_pron_dict.tsv），跳过\n", data_dir);
+        misaki_engine_free(engine);
+        return 0;
+    }
+    
+    test_engine_threads(engine);
+    test_engine_batch(engine);
+    test_engine_tag_intern_threads();
+    test_engine_default_wrappers(data_dir, engine);
+    test_engine_store(engine);
+    test_engine_presets(engine);
+    test_engine_mixed(data_dir, engine);
+    test_engine_stream(data_dir, engine);
+    test_engine_stream_feed(engine);
+    test_engine_ids(engine);
+    
+    misaki_engine_free(engine);
+    
+    printf("\n==============================================\n");
+    printf("All engine tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
@@ -70,6 +70,36 @@ void test_hmm_basic() {
     misaki_hmm_free(model);
 }
 
+void test_hmm_emit_table() {
+    printf("\n========================================\n");
+    printf("测试 1b: 发射概率查表\n");
+    printf("========================================\n");
+    
+    HmmModel *model = misaki_hmm_load("../extracted_data/zh/hmm_model.json");
+    if (!model) {
+        printf("❌ 无法加载 HMM 模型\n");
+        return;
+    }
+    
+    // 「一」在 B 状态下的发射概率（hmm_prob_emit.txt: B 一 -3.6544978750449433）
+    double prob = misaki_hmm_get_emit_prob(model, HMM_STATE_B, 0x4E00);
+    printf("  一(B): %.6f %s\n", prob, (prob > -3.6546 && prob < -3.6544) ? "✅" : "❌");
+    
+    // 四个状态一次取出
+    const HmmEmitRow *row = misaki_hmm_emit_row(model, 0x4E00);
+    printf("  一(B/M/E/S): %.4f %.4f %.4f %.4f\n",
+           row->prob[HMM_STATE_B], row->prob[HMM_STATE_M],
+           row->prob[HMM_STATE_E], row->prob[HMM_STATE_S]);
+    
+    // 不在表中的字符返回下界
+    prob = misaki_hmm_get_emit_prob(model, HMM_STATE_S, 'A');
+    printf("  A(S): %g %s\n", prob, prob < -1e99 ? "✅" : "❌");
+    
+    printf("  已分配页数: %d\n", model->emit_page_count);
+    
+    misaki_hmm_free(model);
+}
+
 void test_hmm_viterbi() {
     printf("\n========================================\n");
     printf("测试 2: HMM Viterbi 解码\n");
@@ -149,13 +179,70 @@ void test_hmm_cut() {
     misaki_hmm_free(model);
 }
 
+void test_hmm_spans() {
+    printf("\n========================================\n");
+    printf("测试 4: 多片段解码 / 长文本\n");
+    printf("========================================\n");
+    
+    HmmModel *model = misaki_hmm_load("../extracted_data/zh/hmm_model.json");
+    if (!model) {
+        printf("❌ 无法加载 HMM 模型\n");
+        return;
+    }
+    
+    HmmWorkspace *ws = misaki_hmm_workspace_create();
+    
+    // 同一段文本里的两个片段，一次解码
+    const char *text = "韩冰是好人，杭研大厦很高";
+    HmmSpan spans[2] = {
+        {0, (int)strlen("韩冰是好人")},
+        {(int)strlen("韩冰是好人，"), (int)strlen("杭研大厦很高")}
+    };
+    
+    MisakiTokenList *tokens = misaki_token_list_create();
+    int added = misaki_hmm_cut_spans(model, text, spans, 2, ws, tokens);
+    printf("  片段切分: %d 个词\n    ", added);
+    for (int i = 0; i < misaki_token_list_size(tokens); i++) {
+        MisakiToken *token = misaki_token_list_get(tokens, i);
+        printf("%s(%d) ", token->text, token->start);
+    }
+    printf("\n");
+    misaki_token_list_free(tokens);
+    
+    // 超过旧版 256 字上限的长文本
+    char long_text[1024 * 3 + 1];
+    long_text[0] = '\0';
+    for (int i = 0; i < 100; i++) {
+        strcat(long_text, "我爱北京天安门");
+    }
+    HmmSpan whole = {0, (int)strlen(long_text)};
+    int count = misaki_hmm_viterbi_spans(model, long_text, &whole, 1, ws);
+    printf("  长文本: %d 字 %s\n", count, count == 700 ? "✅" : "❌");
+    
+    // misaki_hmm_viterbi 只解码前 256 字，不会写出调用者的数组
+    HmmState states[HMM_VITERBI_MAX_CHARS + 1];
+    states[HMM_VITERBI_MAX_CHARS] = HMM_STATE_B;
+    int wrapper_count = misaki_hmm_viterbi(model, long_text, states);
+    HmmSpan head = {0, (int)strlen("我") * HMM_VITERBI_MAX_CHARS};
+    misaki_hmm_viterbi_spans(model, long_text, &head, 1, ws);
+    bool same = wrapper_count == HMM_VITERBI_MAX_CHARS &&
+                states[HMM_VITERBI_MAX_CHARS] == HMM_STATE_B &&
+                memcmp(states, ws->states, sizeof(HmmState) * wrapper_count) == 0;
+    printf("  misaki_hmm_viterbi 截断到 %d 字: %s\n", wrapper_count, same ? "✅" : "❌");
+    
+    misaki_hmm_workspace_free(ws);
+    misaki_hmm_free(model);
+}
+
 int main() {
     printf("🧪 Misaki HMM 未登录词识别测试\n");
     printf("====================================\n");
     
     test_hmm_basic();
+    test_hmm_emit_table();
     test_hmm_viterbi();
     test_hmm_cut();
+    test_hmm_spans();
     
     printf("\n====================================\n");
     printf("✅ 所有测试完成\n");
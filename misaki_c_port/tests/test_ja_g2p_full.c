@@ -10,6 +10,7 @@
 #include "misaki_kana_map.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdbool.h>
 #include <assert.h>
 
 // 测试结果统计
@@ -108,6 +109,41 @@ void test_kana_string_conversion() {
     printf("  ✅ 假名字符串转换测试通过\n");
 }
 
+void test_kana_transducer() {
+    printf("  测试单遍转换（拗音、拨音同化、长音）\n");
+    
+    struct {
+        const char *kana;
+        bool long_vowel;
+        const char *expected_ipa;
+    } tests[] = {
+        {"しゃしん", false, "ɕaɕiɴ"},          // 平假名拗音
+        {"シャシン", false, "ɕijaɕiɴ"},        // 片假名逐字转换
+        {"さんぽ", false, "sampo"},            // ん → m
+        {"てんき", false, "teŋki"},            // ん → ŋ
+        {"コンニチワ", false, "konnitɕiwa"},   // ん → n
+        {"おとうさん", false, "otoːsaɴ"},      // おう → oː
+        {"セイト", false, "seːto"},            // えい → eː
+        {"ねぃ", false, "nei"},
+        {"ねぃ", true, "neː"},                 // ei → eː（同一遍）
+        {"か\xffき", false, "kaki"},           // 非法 UTF-8 跳过
+    };
+    
+    for (size_t i = 0; i < sizeof(tests)/sizeof(tests[0]); i++) {
+        char ipa_buffer[256] = {0};
+        int len = misaki_kana_string_to_ipa_ex(tests[i].kana, ipa_buffer, sizeof(ipa_buffer),
+                                               tests[i].long_vowel);
+        
+        printf("    '%s' → '%s' (expected: '%s')\n",
+               tests[i].kana, ipa_buffer, tests[i].expected_ipa);
+        
+        TEST_ASSERT(len == (int)strlen(tests[i].expected_ipa), "长度应该匹配");
+        TEST_ASSERT(strcmp(ipa_buffer, tests[i].expected_ipa) == 0, "IPA应该匹配");
+    }
+    
+    printf("  ✅ 单遍转换测试通过\n");
+}
+
 void test_full_g2p_pipeline() {
     printf("  测试完整 G2P 流程\n");
     
@@ -164,6 +200,7 @@ int main(void) {
     
     RUN_TEST(test_kana_to_ipa_basic);
     RUN_TEST(test_kana_string_conversion);
+    RUN_TEST(test_kana_transducer);
     RUN_TEST(test_full_g2p_pipeline);
     
     // 总结
@@ -7,6 +7,8 @@
  */
 
 #include "misaki_trie.h"
+#include "misaki_g2p.h"
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -123,6 +125,42 @@ void test_insert_with_pron() {
     printf("  ✅ 带读音插入测试通过\n");
 }
 
+void test_precompute_ipa() {
+    Trie *trie = misaki_trie_create();
+    TEST_ASSERT(trie != NULL, "Trie 应该创建成功");
+    
+    misaki_trie_insert_with_pron(trie, "こんにちは", "コンニチワ", 10000, "感動詞");
+    misaki_trie_insert_with_pron(trie, "今日は", "コンニチワ", 5000, "感動詞");
+    misaki_trie_insert(trie, "無読", 100, NULL);
+    
+    TEST_ASSERT(misaki_ja_precompute_ipa(trie) == 2, "应该预计算 2 个词");
+    
+    TrieMatch matches[4];
+    TEST_ASSERT(misaki_trie_match_all(trie, "こんにちは", 0, matches, 4) == 1, "应该匹配");
+    const char *ipa = matches[0].ipa;
+    TEST_ASSERT(ipa != NULL, "IPA 不应为 NULL");
+    
+    // 与运行时转换一致
+    char *runtime = misaki_ja_kana_to_ipa("コンニチワ");
+    printf("  'こんにちは' → '%s'\n", ipa);
+    TEST_ASSERT(runtime && strcmp(ipa, runtime) == 0, "应与运行时转换一致");
+    free(runtime);
+    
+    // 相同的 IPA 只存一份
+    TEST_ASSERT(misaki_trie_match_all(trie, "今日は", 0, matches, 4) == 1, "应该匹配");
+    TEST_ASSERT(matches[0].ipa == ipa, "相同 IPA 应共享字符串");
+    
+    // 没有读音的词没有 IPA
+    TEST_ASSERT(misaki_trie_match_all(trie, "無読", 0, matches, 4) == 1, "应该匹配");
+    TEST_ASSERT(matches[0].ipa == NULL, "没有读音时 IPA 为 NULL");
+    
+    // 重复调用只处理新词
+    TEST_ASSERT(misaki_ja_precompute_ipa(trie) == 0, "没有新词");
+    
+    misaki_trie_free(trie);
+    printf("  ✅ IPA 预计算测试通过\n");
+}
+
 int main(void) {
     printf("════════════════════════════════════════════════════════════\n");
     printf("  日文读音词典测试\n");
@@ -131,6 +169,7 @@ int main(void) {
     RUN_TEST(test_insert_with_pron);
     RUN_TEST(test_load_dict);
     RUN_TEST(test_lookup_with_pron);
+    RUN_TEST(test_precompute_ipa);
     
     // 总结
     printf("\n════════════════════════════════════════════════════════════\n");
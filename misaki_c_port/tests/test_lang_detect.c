@@ -71,6 +71,84 @@ bool run_test(LangDetector *detector, const TestCase *test, TestStats *stats) {
     return passed;
 }
 
+/**
+ * 检查文字段切分结果（段的文本和语言）
+ */
+static void check_runs(const char *text, MisakiLanguage cjk_lang,
+                       const char **expected_texts, const MisakiLanguage *expected_langs,
+                       int expected_count) {
+    MisakiScriptRun *runs = NULL;
+    int count = misaki_segment_scripts(text, cjk_lang, &runs);
+    
+    printf("文本: \"%s\" →", text);
+    for (int i = 0; i < count; i++) {
+        printf(" [%.*s|%s]", (int)runs[i].length, text + runs[i].offset,
+               misaki_language_name(runs[i].lang));
+    }
+    printf("\n");
+    
+    assert(count == expected_count);
+    for (int i = 0; i < count; i++) {
+        assert(runs[i].length == strlen(expected_texts[i]));
+        assert(strncmp(text + runs[i].offset, expected_texts[i], runs[i].length) == 0);
+        assert(runs[i].lang == expected_langs[i]);
+    }
+    free(runs);
+}
+
+/**
+ * 文字段切分测试
+ */
+void test_segment_scripts(void) {
+    printf("═══════════════════════════════════════════════════════════\n");
+    printf("   文字段切分测试\n");
+    printf("═══════════════════════════════════════════════════════════\n\n");
+    
+    const char *zh_texts[] = { "我用", "iPhone", "打电话" };
+    const MisakiLanguage zh_langs[] = { LANG_CHINESE, LANG_ENGLISH, LANG_CHINESE };
+    check_runs("我用iPhone打电话", LANG_UNKNOWN, zh_texts, zh_langs, 3);
+    
+    // 有假名时汉字段也是日文；拉丁字母段之后的数字、标点归后面的日文段
+    const char *ja_texts[] = { "東京で", "iPhone", "15を購入。" };
+    const MisakiLanguage ja_langs[] = { LANG_JAPANESE, LANG_ENGLISH, LANG_JAPANESE };
+    check_runs("東京でiPhone 15を購入。", LANG_UNKNOWN, ja_texts, ja_langs, 3);
+    
+    // 指定语言时汉字段用指定的语言；首尾空白和全角括号不归拉丁字母段
+    const char *quote_texts[] = { "「", "iPhone", "」は 東京" };
+    const MisakiLanguage quote_langs[] = { LANG_CHINESE, LANG_ENGLISH, LANG_CHINESE };
+    check_runs("  「iPhone」は 東京", LANG_CHINESE, quote_texts, quote_langs, 3);
+    
+    // 拉丁字母段旁边的全角标点单独成段，语言取最近的汉字/假名段
+    const char *stop_texts[] = { "我买了", "iPhone", "。" };
+    const MisakiLanguage stop_langs[] = { LANG_CHINESE, LANG_ENGLISH, LANG_CHINESE };
+    check_runs("我买了iPhone。", LANG_UNKNOWN, stop_texts, stop_langs, 3);
+    
+    const char *bracket_texts[] = { "「", "iPhone", "」を買った" };
+    const MisakiLanguage bracket_langs[] = { LANG_JAPANESE, LANG_ENGLISH, LANG_JAPANESE };
+    check_runs("「iPhone」を買った", LANG_UNKNOWN, bracket_texts, bracket_langs, 3);
+    
+    const char *other_texts[] = { "안녕", "iPhone", "。" };
+    const MisakiLanguage other_langs[] = { LANG_KOREAN, LANG_ENGLISH, LANG_UNKNOWN };
+    check_runs("안녕 iPhone。", LANG_UNKNOWN, other_texts, other_langs, 3);
+    
+    MisakiScriptRun *runs = NULL;
+    assert(misaki_segment_scripts("我买了iPhone。", LANG_UNKNOWN, &runs) == 3);
+    assert(!runs[0].neutral && !runs[1].neutral && runs[2].neutral);
+    free(runs);
+    
+    // 单一文字、韩文、只有标点
+    const char *en_texts[] = { "Hello, world!" };
+    const MisakiLanguage en_langs[] = { LANG_ENGLISH };
+    check_runs(" Hello, world! ", LANG_UNKNOWN, en_texts, en_langs, 1);
+    
+    const char *ko_texts[] = { "안녕하세요", "hello" };
+    const MisakiLanguage ko_langs[] = { LANG_KOREAN, LANG_ENGLISH };
+    check_runs("안녕하세요 hello", LANG_UNKNOWN, ko_texts, ko_langs, 2);
+    
+    check_runs("123, !?", LANG_UNKNOWN, NULL, NULL, 0);
+    printf("\n");
+}
+
 /**
  * 主测试函数
  */
@@ -153,6 +231,8 @@ int main(void) {
     }
     printf("\n");
     
+    test_segment_scripts();
+    
     // 销毁检测器
     misaki_lang_detector_free(detector);
     
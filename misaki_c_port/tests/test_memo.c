@@ -0,0 +1,158 @@
+/**
+ * test_memo.c
+ * 
+ * 词级音素记忆表测试（读写、上下文标志、淘汰、多线程）
+ */
+
+#include "misaki_memo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+void test_memo_basic() {
+    printf("Testing get / put...\n");
+    
+    MisakiMemo *memo = misaki_memo_create(64);
+    assert(memo != NULL);
+    
+    char value[MISAKI_MEMO_VALUE_MAX];
+    assert(!misaki_memo_get(memo, "hello", 0, value, sizeof(value)));
+    assert(misaki_memo_put(memo, "hello", 0, "həlˈO"));
+    assert(misaki_memo_get(memo, "hello", 0, value, sizeof(value)));
+    assert(strcmp(value, "həlˈO") == 0);
+    
+    // 同一词面、不同标志是不同的键
+    assert(!misaki_memo_get(memo, "hello", 1, value, sizeof(value)));
+    assert(misaki_memo_put(memo, "hello", 1, "HELLO"));
+    assert(misaki_memo_get(memo, "hello", 1, value, sizeof(value)));
+    assert(strcmp(value, "HELLO") == 0);
+    assert(misaki_memo_get(memo, "hello", 0, value, sizeof(value)));
+    assert(strcmp(value, "həlˈO") == 0);
+    
+    // 缓冲区不够时当作未命中
+    char small[4];
+    assert(!misaki_memo_get(memo, "hello", 0, small, sizeof(small)));
+    
+    // 键、值过长的不记忆
+    char long_value[200];
+    memset(long_value, 'a', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+    assert(!misaki_memo_put(memo, "long", 0, long_value));
+    assert(!misaki_memo_get(memo, "long", 0, value, sizeof(value)));
+    
+    MisakiMemoStats stats;
+    misaki_memo_stats(memo, &stats);
+    assert(stats.capacity == 64);
+    assert(stats.hit_count == 3 && stats.miss_count == 4);
+    
+    // NULL 记忆表总是未命中
+    assert(!misaki_memo_get(NULL, "hello", 0, value, sizeof(value)));
+    misaki_memo_stats(NULL, &stats);
+    assert(stats.capacity == 0 && stats.hit_count == 0);
+    
+    misaki_memo_free(memo);
+    printf("✓ get / put passed\n");
+}
+
+void test_memo_eviction() {
+    printf("Testing bounded eviction...\n");
+    
+    MisakiMemo *memo = misaki_memo_create(64);
+    char key[32];
+    char expect[32];
+    char value[MISAKI_MEMO_VALUE_MAX];
+    
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "word-%d", i);
+        snprintf(expect, sizeof(expect), "ipa-%d", i);
+        assert(misaki_memo_put(memo, key, 0, expect));
+    }
+    
+    // 最多留下 64 条，留下的值都正确
+    int found = 0;
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "word-%d", i);
+        snprintf(expect, sizeof(expect), "ipa-%d", i);
+        if (misaki_memo_get(memo, key, 0, value, sizeof(value))) {
+            assert(strcmp(value, expect) == 0);
+            found++;
+        }
+    }
+    printf("  %d of 1000 entries kept (64 slots)\n", found);
+    assert(found > 0 && found <= 64);
+    
+    misaki_memo_free(memo);
+    printf("✓ Bounded eviction passed\n");
+}
+
+/* ============================================================================
+ * 多线程
+ * ========================================================================== */
+
+#define MEMO_THREADS 4
+#define MEMO_KEYS 512
+
+static void* memo_worker(void *arg) {
+    MisakiMemo *memo = (MisakiMemo *)arg;
+    char key[32];
+    char expect[32];
+    char value[MISAKI_MEMO_VALUE_MAX];
+    
+    // 各线程读写同一批键：读到的值必须与键对应
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < MEMO_KEYS; i++) {
+            snprintf(key, sizeof(key), "k%d", i);
+            snprintf(expect, sizeof(expect), "v%d", i);
+            if (misaki_memo_get(memo, key, 0, value, sizeof(value))) {
+                if (strcmp(value, expect) != 0) {
+                    return (void *)1;
+                }
+            } else {
+                misaki_memo_put(memo, key, 0, expect);
+            }
+        }
+    }
+    return NULL;
+}
+
+void test_memo_threads() {
+    printf("Testing concurrent access...\n");
+    
+    // 槽数小于键数，读写和淘汰同时发生
+    MisakiMemo *memo = misaki_memo_create(256);
+    
+    pthread_t threads[MEMO_THREADS];
+    for (int t = 0; t < MEMO_THREADS; t++) {
+        assert(pthread_create(&threads[t], NULL, memo_worker, memo) == 0);
+    }
+    for (int t = 0; t < MEMO_THREADS; t++) {
+        void *result = NULL;
+        pthread_join(threads[t], &result);
+        assert(result == NULL);
+    }
+    
+    MisakiMemoStats stats;
+    misaki_memo_stats(memo, &stats);
+    assert(stats.hit_count + stats.miss_count == (uint64_t)MEMO_THREADS * 20 * MEMO_KEYS);
+    
+    misaki_memo_free(memo);
+    printf("✓ Concurrent access passed\n");
+}
+
+int main() {
+    printf("==============================================\n");
+    printf("Misaki Memo Test\n");
+    printf("==============================================\n\n");
+    
+    test_memo_basic();
+    test_memo_eviction();
+    test_memo_threads();
+    
+    printf("\n==============================================\n");
+    printf("All memo tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
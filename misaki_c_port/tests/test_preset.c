@@ -0,0 +1,157 @@
+/**
+ * test_preset.c
+ * 
+ * 预设表测试（完美哈希、语言区分、文件往返、格式校验）
+ */
+
+#include "misaki_preset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+void test_preset_basic() {
+    printf("Testing build / lookup...\n");
+    
+    const MisakiLanguage langs[] = {
+        LANG_JAPANESE, LANG_JAPANESE, LANG_UNKNOWN, LANG_CHINESE, LANG_JAPANESE,
+    };
+    const char *texts[] = { "こんにちは", "ありがとう", "こんにちは", "你好", "こんにちは" };
+    const char *phonemes[] = { "koɴnitɕiwa", "aɾiɡatoː", "auto-koɴnitɕiwa", "ni↓xau↓", "duplicate" };
+    
+    unsigned char *data = NULL;
+    size_t size = 0;
+    assert(misaki_preset_table_build(langs, texts, phonemes, 5, &data, &size) == 0);
+    
+    MisakiPresetTable *table = misaki_preset_table_from_memory(data, size);
+    assert(table != NULL);
+    assert(misaki_preset_table_count(table) == 4);   // 重复的 (ja, こんにちは) 只保留第一条
+    
+    // 语言不同是不同的条目
+    assert(strcmp(misaki_preset_table_lookup(table, LANG_JAPANESE, "こんにちは"), "koɴnitɕiwa") == 0);
+    assert(strcmp(misaki_preset_table_lookup(table, LANG_UNKNOWN, "こんにちは"), "auto-koɴnitɕiwa") == 0);
+    assert(strcmp(misaki_preset_table_lookup(table, LANG_CHINESE, "你好"), "ni↓xau↓") == 0);
+    assert(misaki_preset_table_lookup(table, LANG_JAPANESE, "你好") == NULL);
+    assert(misaki_preset_table_lookup(table, LANG_JAPANESE, "こんにち") == NULL);
+    assert(misaki_preset_table_lookup(table, LANG_JAPANESE, "") == NULL);
+    assert(misaki_preset_table_lookup(NULL, LANG_JAPANESE, "こんにちは") == NULL);
+    
+    misaki_preset_table_free(table);
+    
+    // 空文本不能编译
+    const char *empty[] = { "" };
+    unsigned char *bad = NULL;
+    assert(misaki_preset_table_build(langs, empty, phonemes, 1, &bad, &size) == -1);
+    assert(bad == NULL);
+    
+    free(data);
+    printf("✓ Build / lookup passed\n");
+}
+
+void test_preset_large() {
+    printf("Testing large table...\n");
+    
+    const int count = 20000;
+    MisakiLanguage *langs = malloc(count * sizeof(MisakiLanguage));
+    char **texts = malloc(count * sizeof(char *));
+    char **phonemes = malloc(count * sizeof(char *));
+    char buffer[64];
+    for (int i = 0; i < count; i++) {
+        langs[i] = i % 2 ? LANG_JAPANESE : LANG_UNKNOWN;
+        snprintf(buffer, sizeof(buffer), "phrase-%d", i);
+        texts[i] = strdup(buffer);
+        snprintf(buffer, sizeof(buffer), "ipa-%d", i);
+        phonemes[i] = strdup(buffer);
+    }
+    
+    unsigned char *data = NULL;
+    size_t size = 0;
+    assert(misaki_preset_table_build(langs, (const char *const *)texts,
+                                     (const char *const *)phonemes, count, &data, &size) == 0);
+    MisakiPresetTable *table = misaki_preset_table_from_memory(data, size);
+    assert(misaki_preset_table_count(table) == count);
+    
+    for (int i = 0; i < count; i++) {
+        const char *found = misaki_preset_table_lookup(table, langs[i], texts[i]);
+        assert(found && strcmp(found, phonemes[i]) == 0);
+        assert(misaki_preset_table_lookup(table, i % 2 ? LANG_UNKNOWN : LANG_JAPANESE, texts[i]) == NULL);
+    }
+    printf("  %d entries, %zu bytes\n", count, size);
+    
+    misaki_preset_table_free(table);
+    free(data);
+    for (int i = 0; i < count; i++) {
+        free(texts[i]);
+        free(phonemes[i]);
+    }
+    free(langs);
+    free(texts);
+    free(phonemes);
+    printf("✓ Large table passed\n");
+}
+
+void test_preset_file() {
+    printf("Testing file round trip / validation...\n");
+    
+    const MisakiLanguage langs[] = { LANG_JAPANESE, LANG_ENGLISH };
+    const char *texts[] = { "はい", "hello" };
+    const char *phonemes[] = { "hai", "həlˈO" };
+    unsigned char *data = NULL;
+    size_t size = 0;
+    assert(misaki_preset_table_build(langs, texts, phonemes, 2, &data, &size) == 0);
+    
+    const char *path = "test_preset.bin";
+    FILE *file = fopen(path, "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+    
+    MisakiPresetTable *table = misaki_preset_table_load(path);
+    assert(table != NULL);
+    assert(strcmp(misaki_preset_table_lookup(table, LANG_ENGLISH, "hello"), "həlˈO") == 0);
+    misaki_preset_table_free(table);
+    remove(path);
+    assert(misaki_preset_table_load(path) == NULL);
+    
+    // 截断、偏移越界的数据都被拒绝
+    assert(misaki_preset_table_from_memory(data, size - 1) == NULL);
+    unsigned char *corrupt = malloc(size);
+    memcpy(corrupt, data, size);
+    corrupt[0] = 'X';
+    assert(misaki_preset_table_from_memory(corrupt, size) == NULL);
+    
+    memcpy(corrupt, data, size);
+    uint32_t bucket_count, slot_count;
+    memcpy(&bucket_count, corrupt + 16, 4);
+    memcpy(&slot_count, corrupt + 20, 4);
+    for (uint32_t i = 0; i < slot_count; i++) {
+        unsigned char *slot = corrupt + 32 + bucket_count * 4 + i * 16;
+        uint32_t key_len;
+        memcpy(&key_len, slot + 8, 4);
+        if (key_len != 0) {
+            uint32_t bad_offset = 0xffff;
+            memcpy(slot + 12, &bad_offset, 4);
+            break;
+        }
+    }
+    assert(misaki_preset_table_from_memory(corrupt, size) == NULL);
+    
+    free(corrupt);
+    free(data);
+    printf("✓ File round trip / validation passed\n");
+}
+
+int main() {
+    printf("==============================================\n");
+    printf("Misaki Preset Table Test\n");
+    printf("==============================================\n\n");
+    
+    test_preset_basic();
+    test_preset_large();
+    test_preset_file();
+    
+    printf("\n==============================================\n");
+    printf("All preset tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
@@ -0,0 +1,298 @@
+/**
+ * test_store.c
+ * 
+ * 持久化结果存储测试（重启、残缺记录、多进程、压缩、G2P 缓存后备）
+ */
+
+#include "misaki_store.h"
+#include "misaki_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static char g_path[64];
+
+static void assert_value(MisakiStore *store, const char *key, const char *expect) {
+    char *value = misaki_store_get(store, key);
+    if (expect) {
+        assert(value && strcmp(value, expect) == 0);
+    } else {
+        assert(value == NULL);
+    }
+    free(value);
+}
+
+void test_store_basic() {
+    printf("Testing put / get / warm restart...\n");
+    
+    unlink(g_path);
+    assert(misaki_store_open(g_path, true) == NULL);
+    
+    MisakiStore *store = misaki_store_open(g_path, false);
+    assert(store != NULL);
+    assert_value(store, "ja\x1f" "0\x1f" "日本", NULL);
+    assert(misaki_store_put(store, "ja\x1f" "0\x1f" "日本", "nihoɴ"));
+    assert(misaki_store_put(store, "en\x1f" "0\x1f" "hello", "həlˈO"));
+    assert(misaki_store_put(store, "en\x1f" "0\x1f" "hello", "həlˈO"));   // 相同的值不重复写入
+    assert(misaki_store_put(store, "empty", ""));
+    assert(!misaki_store_put(store, "", "x"));
+    assert_value(store, "ja\x1f" "0\x1f" "日本", "nihoɴ");
+    assert_value(store, "empty", "");
+    
+    MisakiStoreStats stats;
+    misaki_store_get_stats(store, &stats);
+    assert(stats.count == 3 && stats.append_count == 3 && stats.dead_bytes == 0);
+    misaki_store_close(store);
+    
+    // 重启后直接从文件读取
+    store = misaki_store_open(g_path, true);
+    assert(store != NULL);
+    assert_value(store, "ja\x1f" "0\x1f" "日本", "nihoɴ");
+    assert_value(store, "en\x1f" "0\x1f" "hello", "həlˈO");
+    assert(!misaki_store_put(store, "k", "v"));
+    misaki_store_get_stats(store, &stats);
+    assert(stats.count == 3 && stats.hit_count == 2);
+    misaki_store_close(store);
+    
+    // 不是存储格式的文件
+    FILE *file = fopen(g_path, "wb");
+    fputs("this is not a misaki store, just some text long enough for a header ....", file);
+    fclose(file);
+    assert(misaki_store_open(g_path, false) == NULL);
+    
+    printf("✓ Put / get / warm restart passed\n");
+}
+
+void test_store_torn_write() {
+    printf("Testing torn writes...\n");
+    
+    unlink(g_path);
+    MisakiStore *store = misaki_store_open(g_path, false);
+    assert(misaki_store_put(store, "a", "1"));
+    assert(misaki_store_put(store, "b", "2"));
+    misaki_store_close(store);
+    
+    // 模拟写到一半崩溃：一条记录只写了一部分
+    FILE *file = fopen(g_path, "ab");
+    const unsigned char torn[] = { 5, 0, 0, 0, 9, 0, 0, 0, 0x12, 0x34, 0x56, 0x78, 0, 0, 0, 0, 'k', 'e' };
+    fwrite(torn, 1, sizeof(torn), file);
+    fclose(file);
+    
+    store = misaki_store_open(g_path, true);
+    assert_value(store, "a", "1");
+    assert_value(store, "b", "2");
+    misaki_store_close(store);
+    
+    // 下一次写入截掉残缺的尾部
+    store = misaki_store_open(g_path, false);
+    assert(misaki_store_put(store, "c", "3"));
+    misaki_store_close(store);
+    
+    store = misaki_store_open(g_path, true);
+    assert_value(store, "a", "1");
+    assert_value(store, "c", "3");
+    MisakiStoreStats stats;
+    misaki_store_get_stats(store, &stats);
+    assert(stats.count == 3);
+    misaki_store_close(store);
+    
+    printf("✓ Torn writes passed\n");
+}
+
+/* ============================================================================
+ * 多进程
+ * ========================================================================== */
+
+#define STORE_PROCESSES 3
+#define STORE_KEYS 300
+
+static void store_child(int id) {
+    MisakiStore *store = misaki_store_open(g_path, false);
+    if (!store) {
+        _exit(1);
+    }
+    
+    char key[32];
+    char value[32];
+    for (int i = 0; i < STORE_KEYS; i++) {
+        // 各进程独有的键，加上所有进程都写的键
+        snprintf(key, sizeof(key), "p%d-%d", id, i);
+        snprintf(value, sizeof(value), "v%d-%d", id, i);
+        if (!misaki_store_put(store, key, value)) {
+            _exit(2);
+        }
+        snprintf(key, sizeof(key), "shared-%d", i);
+        snprintf(value, sizeof(value), "s%d", i);
+        if (!misaki_store_put(store, key, value)) {
+            _exit(3);
+        }
+    }
+    misaki_store_close(store);
+    _exit(0);
+}
+
+void test_store_processes() {
+    printf("Testing multiple processes...\n");
+    
+    unlink(g_path);
+    MisakiStore *reader = misaki_store_open(g_path, false);
+    assert(reader != NULL);
+    
+    pid_t children[STORE_PROCESSES];
+    for (int p = 0; p < STORE_PROCESSES; p++) {
+        children[p] = fork();
+        assert(children[p] >= 0);
+        if (children[p] == 0) {
+            store_child(p);
+        }
+    }
+    for (int p = 0; p < STORE_PROCESSES; p++) {
+        int status = 0;
+        waitpid(children[p], &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    
+    // 打开在前的句柄追读其他进程追加的记录
+    char key[32];
+    char value[32];
+    for (int p = 0; p < STORE_PROCESSES; p++) {
+        for (int i = 0; i < STORE_KEYS; i++) {
+            snprintf(key, sizeof(key), "p%d-%d", p, i);
+            snprintf(value, sizeof(value), "v%d-%d", p, i);
+            assert_value(reader, key, value);
+        }
+    }
+    for (int i = 0; i < STORE_KEYS; i++) {
+        snprintf(key, sizeof(key), "shared-%d", i);
+        snprintf(value, sizeof(value), "s%d", i);
+        assert_value(reader, key, value);
+    }
+    
+    MisakiStoreStats stats;
+    misaki_store_get_stats(reader, &stats);
+    assert(stats.count == (STORE_PROCESSES + 1) * STORE_KEYS);
+    misaki_store_close(reader);
+    
+    printf("✓ Multiple processes passed\n");
+}
+
+void test_store_compact() {
+    printf("Testing compaction...\n");
+    
+    unlink(g_path);
+    MisakiStore *writer = misaki_store_open(g_path, false);
+    MisakiStore *other = misaki_store_open(g_path, false);
+    
+    char value[32];
+    for (int i = 0; i < 50; i++) {
+        snprintf(value, sizeof(value), "version-%d", i);
+        assert(misaki_store_put(writer, "key", value));
+    }
+    assert(misaki_store_put(writer, "keep", "kept"));
+    
+    MisakiStoreStats before;
+    misaki_store_get_stats(writer, &before);
+    assert(before.count == 2 && before.dead_bytes > 0);
+    
+    assert(misaki_store_compact(writer) == 0);
+    MisakiStoreStats after;
+    misaki_store_get_stats(writer, &after);
+    assert(after.count == 2 && after.dead_bytes == 0);
+    assert(after.file_size < before.file_size);
+    assert_value(writer, "key", "version-49");
+    
+    // 另一个句柄发现文件被替换，换到新文件上继续读写
+    assert(misaki_store_put(writer, "after", "compaction"));
+    assert_value(other, "after", "compaction");
+    assert_value(other, "keep", "kept");
+    assert(misaki_store_put(other, "from-other", "ok"));
+    assert_value(writer, "from-other", "ok");
+    
+    misaki_store_close(other);
+    misaki_store_close(writer);
+    
+    MisakiStore *store = misaki_store_open(g_path, true);
+    misaki_store_get_stats(store, &after);
+    assert(after.count == 4 && after.dead_bytes == 0);
+    misaki_store_close(store);
+    
+    printf("✓ Compaction passed\n");
+}
+
+/* ============================================================================
+ * G2P 缓存后备
+ * ========================================================================== */
+
+static int g_compute_calls;
+
+static char* count_compute(void *ctx) {
+    g_compute_calls++;
+    return strdup((const char *)ctx);
+}
+
+void test_store_g2p_cache() {
+    printf("Testing G2P cache backed by store...\n");
+    
+    unlink(g_path);
+    g_compute_calls = 0;
+    
+    MisakiStore *store = misaki_store_open(g_path, false);
+    G2PCache *cache = misaki_g2p_cache_create(16);
+    misaki_g2p_cache_set_store(cache, store);
+    char *phonemes = misaki_g2p_cache_get_or_compute(cache, "こんにちは", "ja", NULL,
+                                                     count_compute, "koɴnitɕiwa");
+    assert(phonemes && strcmp(phonemes, "koɴnitɕiwa") == 0 && g_compute_calls == 1);
+    free(phonemes);
+    misaki_g2p_cache_free(cache);
+    misaki_store_close(store);
+    
+    // 重启：内存缓存是空的，结果来自存储
+    store = misaki_store_open(g_path, false);
+    cache = misaki_g2p_cache_create(16);
+    misaki_g2p_cache_set_store(cache, store);
+    phonemes = misaki_g2p_cache_get_or_compute(cache, "こんにちは", "ja", NULL,
+                                               count_compute, "koɴnitɕiwa");
+    assert(phonemes && strcmp(phonemes, "koɴnitɕiwa") == 0 && g_compute_calls == 1);
+    free(phonemes);
+    phonemes = misaki_g2p_cache_get_or_compute(cache, "こんにちは", "zh", NULL,
+                                               count_compute, "x");
+    assert(phonemes && g_compute_calls == 2);
+    free(phonemes);
+    misaki_g2p_cache_free(cache);
+    
+    // 只查询（不计算）的接口同样先查存储
+    cache = misaki_g2p_cache_create(16);
+    misaki_g2p_cache_set_store(cache, store);
+    phonemes = misaki_g2p_cache_get(cache, "こんにちは", "ja", NULL);
+    assert(phonemes && strcmp(phonemes, "koɴnitɕiwa") == 0);
+    free(phonemes);
+    misaki_g2p_cache_free(cache);
+    misaki_store_close(store);
+    
+    printf("✓ G2P cache backed by store passed\n");
+}
+
+int main() {
+    printf("==============================================\n");
+    printf("Misaki Store Test\n");
+    printf("==============================================\n\n");
+    
+    snprintf(g_path, sizeof(g_path), "test_store_%ld.db", (long)getpid());
+    
+    test_store_basic();
+    test_store_torn_write();
+    test_store_processes();
+    test_store_compact();
+    test_store_g2p_cache();
+    
+    unlink(g_path);
+    
+    printf("\n==============================================\n");
+    printf("All store tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
@@ -5,6 +5,7 @@
  */
 
 #include "misaki_string.h"
+#include "misaki_arena.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -140,6 +141,40 @@ void test_utils() {
     printf("✓ Utility functions passed\n");
 }
 
+// 测试字符串池
+void test_string_pool() {
+    printf("Testing string pool...\n");
+    
+    MisakiStringPool *pool = misaki_string_pool_create();
+    assert(pool != NULL);
+    
+    char buffer[32];
+    strcpy(buffer, "koɴɲit͡ɕiwa");
+    const char *a = misaki_string_pool_intern(pool, buffer);
+    strcpy(buffer, "other");
+    const char *b = misaki_string_pool_intern(pool, "koɴɲit͡ɕiwa");
+    
+    // 相同内容只存一份，且不引用调用方的缓冲区
+    assert(a == b);
+    assert(strcmp(a, "koɴɲit͡ɕiwa") == 0);
+    assert(misaki_string_pool_intern(pool, "other") != a);
+    assert(misaki_string_pool_intern(pool, NULL) == NULL);
+    
+    // 扩容后已有的字符串仍然有效、仍然去重
+    for (int i = 0; i < 1000; i++) {
+        snprintf(buffer, sizeof(buffer), "s%d", i);
+        assert(misaki_string_pool_intern(pool, buffer) != NULL);
+    }
+    assert(pool->count == 1002);
+    assert(misaki_string_pool_intern(pool, "koɴɲit͡ɕiwa") == a);
+    assert(strcmp(misaki_string_pool_intern(pool, "s500"), "s500") == 0);
+    assert(pool->count == 1002);
+    
+    misaki_string_pool_free(pool);
+    
+    printf("✓ String pool passed\n");
+}
+
 int main() {
     printf("==============================================\n");
     printf("Misaki String Module Test\n");
@@ -151,6 +186,7 @@ int main() {
     test_string_view();
     test_dynamic_string();
     test_utils();
+    test_string_pool();
     
     printf("\n==============================================\n");
     printf("All tests passed! ✓\n");
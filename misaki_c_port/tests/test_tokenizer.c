@@ -184,6 +184,71 @@ void test_token_list_clear(void) {
     printf("  ✅ TokenList clear 成功\n");
 }
 
+void test_token_inline_phonemes(void) {
+    MisakiTokenList *list = misaki_token_list_create();
+    
+    // 超过初始容量，触发数组搬家
+    for (int i = 0; i < 40; i++) {
+        MisakiToken token = {0};
+        token.text = misaki_strdup("a");
+        misaki_token_list_push_owned(list, &token);
+        misaki_token_set_phonemes(&list->tokens[i], i % 2 ? "ə" : "a long phoneme string over the inline size");
+    }
+    
+    MisakiToken *t1 = misaki_token_list_get(list, 1);
+    MisakiToken *t38 = misaki_token_list_get(list, 38);
+    TEST_ASSERT(t1->phonemes == t1->phonemes_inline, "短音素应内联存储");
+    TEST_ASSERT(strcmp(t1->phonemes, "ə") == 0, "搬家后内联音素仍然正确");
+    TEST_ASSERT(t38->phonemes != t38->phonemes_inline, "长音素应堆分配");
+    
+    misaki_token_set_phonemes(t1, t1->phonemes);
+    TEST_ASSERT(strcmp(t1->phonemes, "ə") == 0, "设置为自身应保持不变");
+    
+    misaki_token_list_free(list);
+    printf("  ✅ 内联音素存储成功\n");
+}
+
+void test_token_list_move_ops(void) {
+    MisakiTokenList *list = misaki_token_list_create();
+    MisakiTokenList *other = misaki_token_list_create();
+    const char *words[] = {"a", "b", "c", "d"};
+    
+    for (int i = 0; i < 4; i++) {
+        MisakiToken token = {0};
+        token.text = misaki_strdup(words[i]);
+        misaki_token_set_phonemes(&token, words[i]);
+        char *text = token.text;
+        TEST_ASSERT(misaki_token_list_push_owned(i < 2 ? list : other, &token), "push_owned 应该成功");
+        TEST_ASSERT(token.text == NULL, "push_owned 后源 Token 应被清零");
+        TEST_ASSERT((i < 2 ? list : other)->tokens[i % 2].text == text, "push_owned 不应复制 text");
+    }
+    
+    // append: [a b] + [c d]
+    TEST_ASSERT(misaki_token_list_append_list(list, other), "append_list 应该成功");
+    TEST_ASSERT(list->count == 4 && other->count == 0, "append 后数量应该正确");
+    TEST_ASSERT(strcmp(list->tokens[3].phonemes, "d") == 0, "append 后内联音素应该正确");
+    
+    // splice: [a b c d] -> [a X Y d]
+    MisakiToken x = {0}, y = {0};
+    x.text = misaki_strdup("X");
+    y.text = misaki_strdup("Y");
+    misaki_token_list_push_owned(other, &x);
+    misaki_token_list_push_owned(other, &y);
+    TEST_ASSERT(misaki_token_list_splice(list, 1, 2, other), "splice 应该成功");
+    TEST_ASSERT(list->count == 4, "splice 后数量应该为 4");
+    TEST_ASSERT(strcmp(list->tokens[1].text, "X") == 0 && strcmp(list->tokens[2].text, "Y") == 0,
+                "splice 插入的 Token 应该正确");
+    TEST_ASSERT(strcmp(list->tokens[3].phonemes, "d") == 0, "splice 后尾部音素应该正确");
+    
+    // splice 纯删除: [a X Y d] -> [a d]
+    TEST_ASSERT(misaki_token_list_splice(list, 1, 2, NULL), "splice 删除应该成功");
+    TEST_ASSERT(list->count == 2 && strcmp(list->tokens[1].text, "d") == 0, "删除后应为 [a d]");
+    
+    misaki_token_list_free(other);
+    misaki_token_list_free(list);
+    printf("  ✅ TokenList 移动操作成功\n");
+}
+
 /* ============================================================================
  * DAG 操作测试
  * ========================================================================== */
@@ -411,6 +476,36 @@ void test_ja_tokenize_simple(void) {
     printf("  ✅ 简单日文分词成功\n");
 }
 
+void test_ja_tokenize_view(void) {
+    Trie *trie = misaki_trie_create();
+    misaki_trie_insert(trie, "こんにちは", 1.0, "感動詞");
+    misaki_trie_insert(trie, "世界", 1.0, "名詞");
+    
+    JaTokenizerConfig config = {
+        .dict_trie = trie,
+        .use_simple_model = true,
+        .unidic_path = NULL
+    };
+    void *tokenizer = misaki_ja_tokenizer_create(&config);
+    TEST_ASSERT(tokenizer != NULL, "日文分词器应该创建成功");
+    
+    const char *text = "こんにちは世界";
+    MisakiTokenList *tokens = misaki_ja_tokenize_view(tokenizer, text);
+    TEST_ASSERT(tokens != NULL && tokens->view_mode, "应该返回视图模式列表");
+    TEST_ASSERT(misaki_token_list_size(tokens) == 2, "应该分出 2 个词");
+    
+    MisakiToken *token1 = misaki_token_list_get(tokens, 1);
+    TEST_ASSERT(token1->text == NULL, "视图模式不分配 text");
+    TEST_ASSERT(token1->surface.data == text + strlen("こんにちは"), "表层文本应指向输入");
+    TEST_ASSERT(misaki_sv_equals_cstr(token1->surface, "世界"), "表层文本应该是 '世界'");
+    TEST_ASSERT(strcmp(misaki_token_tag(token1), "名詞") == 0, "词性应该是 '名詞'");
+    
+    misaki_token_list_free(tokens);
+    misaki_ja_tokenizer_free(tokenizer);
+    misaki_trie_free(trie);
+    printf("  ✅ 日文视图模式分词成功\n");
+}
+
 /* ============================================================================
  * 中文分词器测试
  * ========================================================================== */
@@ -483,6 +578,59 @@ void test_zh_tokenize_simple(void) {
     printf("  ✅ 简单中文分词成功\n");
 }
 
+void test_zh_tokenize_view(void) {
+    Trie *trie = misaki_trie_create();
+    misaki_trie_insert(trie, "我", 1.0, NULL);
+    misaki_trie_insert(trie, "爱", 1.0, NULL);
+    misaki_trie_insert(trie, "中国", 3.0, NULL);
+    
+    ZhTokenizerConfig config = {
+        .dict_trie = trie,
+        .enable_hmm = false,
+        .enable_userdict = false,
+        .user_trie = NULL
+    };
+    void *tokenizer = misaki_zh_tokenizer_create(&config);
+    TEST_ASSERT(tokenizer != NULL, "分词器创建成功");
+    
+    const char *text = "我爱中国";
+    MisakiTokenList *view = misaki_zh_tokenize_view(tokenizer, text);
+    MisakiTokenList *owned = misaki_zh_tokenize(tokenizer, text);
+    TEST_ASSERT(view != NULL && owned != NULL, "分词结果不应为 NULL");
+    TEST_ASSERT(view->count == owned->count, "两种模式词数应该一致");
+    
+    for (int i = 0; i < view->count; i++) {
+        MisakiToken *v = &view->tokens[i];
+        MisakiToken *o = &owned->tokens[i];
+        TEST_ASSERT(v->text == NULL && v->surface.data == text + v->start, "视图应指向输入");
+        TEST_ASSERT(misaki_sv_equals(v->surface, misaki_token_surface(o)), "两种模式文本应该一致");
+    }
+    
+    // 视图 Token 加入普通列表时复制出 text
+    MisakiTokenList *copy = misaki_token_list_create();
+    misaki_token_list_add(copy, &view->tokens[2]);
+    TEST_ASSERT(strcmp(copy->tokens[0].text, "中国") == 0, "复制后应有 text");
+    
+    misaki_token_list_free(copy);
+    misaki_token_list_free(owned);
+    misaki_token_list_free(view);
+    misaki_zh_tokenizer_free(tokenizer);
+    misaki_trie_free(trie);
+    printf("  ✅ 中文视图模式分词成功\n");
+}
+
+void test_tag_intern(void) {
+    MisakiTagId noun = misaki_tag_intern("名詞");
+    TEST_ASSERT(noun != MISAKI_TAG_NONE, "预置标签应该有 ID");
+    TEST_ASSERT(misaki_tag_intern("名詞") == noun, "同一标签 ID 应该相同");
+    
+    MisakiTagId custom = misaki_tag_intern("custom_tag");
+    TEST_ASSERT(custom != MISAKI_TAG_NONE && custom != noun, "新标签应该分配新 ID");
+    TEST_ASSERT(strcmp(misaki_tag_name(custom), "custom_tag") == 0, "ID 应能取回名称");
+    TEST_ASSERT(misaki_tag_intern(NULL) == MISAKI_TAG_NONE, "NULL 标签为 NONE");
+    printf("  ✅ 词性标签驻留成功\n");
+}
+
 void test_zh_tokenize_complex(void) {
     // 构建更复杂的词典
     Trie *trie = misaki_trie_create();
@@ -543,6 +691,8 @@ int main(void) {
     RUN_TEST(test_token_list_add_get);
     RUN_TEST(test_token_list_size);
     RUN_TEST(test_token_list_clear);
+    RUN_TEST(test_token_inline_phonemes);
+    RUN_TEST(test_token_list_move_ops);
     
     // DAG 操作测试
     RUN_TEST(test_dag_create_free);
@@ -555,6 +705,8 @@ int main(void) {
     RUN_TEST(test_zh_tokenizer_create_free);
     RUN_TEST(test_zh_tokenize_simple);
     RUN_TEST(test_zh_tokenize_complex);
+    RUN_TEST(test_zh_tokenize_view);
+    RUN_TEST(test_tag_intern);
     
     // 英文分词器测试
     RUN_TEST(test_en_tokenize_simple);
@@ -562,6 +714,7 @@ int main(void) {
     
     // 日文分词器测试
     RUN_TEST(test_ja_tokenize_simple);
+    RUN_TEST(test_ja_tokenize_view);
     
     // 总结
     printf("\n════════════════════════════════════════════════════════════\n");
@@ -7,6 +7,7 @@
  */
 
 #include "misaki_tokenizer.h"
+#include "misaki_viterbi.h"
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -179,6 +180,15 @@ void test_ja_tokenize_mixed() {
         if (token->tag && strcmp(token->tag, "kanji") == 0) has_kanji = true;
     }
     
+    // 剪枝计数复制到调用者的结构体
+    ViterbiPruneStats stats = { 1, 1, 1, 1 };
+    misaki_ja_tokenizer_get_prune_stats(NULL, &stats);
+    TEST_ASSERT(stats.beam_hits == 0 && stats.exact_fallbacks == 0, "NULL 分词器的计数应为 0");
+    misaki_ja_tokenizer_get_prune_stats(tokenizer, &stats);
+    ViterbiPruneStats again;
+    misaki_ja_tokenizer_get_prune_stats(tokenizer, &again);
+    TEST_ASSERT(memcmp(&stats, &again, sizeof(stats)) == 0, "没有分词时两次读到的计数应相同");
+    
     misaki_token_list_free(tokens);
     misaki_ja_tokenizer_free(tokenizer);
     misaki_trie_free(trie);
@@ -118,6 +118,13 @@ void test_prefix_matching() {
     assert(count == 2);  // "国", "国人"
     assert(strcmp(matches[0].word, "国") == 0);
     assert(strcmp(matches[1].word, "国人") == 0);
+    assert(matches[1].pron == NULL);
+    
+    // 带读音的词：匹配结果直接带出读音
+    misaki_trie_insert_with_pron(trie, "人", "ヒト", 30.0, NULL);
+    count = misaki_trie_match_all(trie, "中国人很好", 6, matches, 10);
+    assert(count == 1);
+    assert(strcmp(matches[0].pron, "ヒト") == 0);
     
     misaki_trie_free(trie);
     
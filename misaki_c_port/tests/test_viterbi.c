@@ -7,6 +7,8 @@
 
 #include "misaki_viterbi.h"
 #include "misaki_string.h"
+#include "misaki_tokenizer.h"
+#include "misaki_transition_rules.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -95,7 +97,7 @@ void test_lattice_add_edge() {
     
     // 检查边是否添加成功
     assert(node1->next_count > 0);
-    assert(node2->edge_cost == 1.5);
+    assert(node1->next_costs[0] == 1.5);
     
     misaki_lattice_free(lattice);
     
@@ -206,35 +208,187 @@ void test_viterbi_extract_tokens() {
     printf("✓ Viterbi extract tokens passed\n");
 }
 
+// 测试视图模式 Token 列表（多字节文本，普通节点和偏移节点）
+void test_viterbi_append_view() {
+    printf("Testing view-mode token append...\n");
+    
+    const char *text = "東京都";
+    
+    // 没有原文的 Lattice：普通节点按字符位置在 source 中定位
+    Lattice *lattice = misaki_lattice_create(3);
+    LatticeNode *tokyo = misaki_lattice_add_node(lattice, 0, "東京", "noun", NULL, 1.0);
+    LatticeNode *to = misaki_lattice_add_node(lattice, 2, "都", "suffix", NULL, 1.0);
+    assert(tokyo->start == -1 && to->start == -1);
+    misaki_lattice_add_edge(lattice->bos, tokyo, 0.0);
+    misaki_lattice_add_edge(tokyo, to, 0.0);
+    misaki_lattice_add_edge(to, lattice->eos, 0.0);
+    assert(misaki_viterbi_search(lattice));
+    
+    MisakiTokenList *tokens = misaki_token_list_create_view(text);
+    assert(misaki_viterbi_append_tokens(lattice, tokens) == 2);
+    assert(tokens->tokens[0].surface.data == text);
+    assert(misaki_sv_equals(tokens->tokens[0].surface, misaki_sv_from_cstr("東京")));
+    assert(tokens->tokens[1].surface.data == text + 6);
+    assert(misaki_sv_equals(tokens->tokens[1].surface, misaki_sv_from_cstr("都")));
+    misaki_token_list_free(tokens);
+    misaki_lattice_free(lattice);
+    
+    // 有原文的 Lattice：普通节点保存字节偏移，可以和偏移节点混用
+    lattice = misaki_lattice_create_for_text(text);
+    tokyo = misaki_lattice_add_span(lattice, 0, 0, 6, 2, MISAKI_TAG_NONE, 1.0);
+    to = misaki_lattice_add_node(lattice, 2, "都", "suffix", NULL, 1.0);
+    assert(to->start == 6);
+    misaki_lattice_add_edge(lattice->bos, tokyo, 0.0);
+    misaki_lattice_add_edge(tokyo, to, 0.0);
+    misaki_lattice_add_edge(to, lattice->eos, 0.0);
+    assert(misaki_viterbi_search(lattice));
+    
+    tokens = misaki_token_list_create_view(text);
+    assert(misaki_viterbi_append_tokens(lattice, tokens) == 2);
+    assert(misaki_sv_equals(tokens->tokens[0].surface, misaki_sv_from_cstr("東京")));
+    assert(tokens->tokens[1].surface.data == text + 6);
+    assert(misaki_sv_equals(tokens->tokens[1].surface, misaki_sv_from_cstr("都")));
+    misaki_token_list_free(tokens);
+    misaki_lattice_free(lattice);
+    
+    // 长路径（超过 1000 个节点）不会被截断
+    const int long_count = 1500;
+    char *long_text = (char *)malloc(long_count + 1);
+    memset(long_text, 'a', long_count);
+    long_text[long_count] = '\0';
+    lattice = misaki_lattice_create_for_text(long_text);
+    LatticeNode *prev = lattice->bos;
+    for (int i = 0; i < long_count; i++) {
+        LatticeNode *node = misaki_lattice_add_span(lattice, i, i, 1, 1, MISAKI_TAG_NONE, 0.0);
+        misaki_lattice_add_edge(prev, node, 0.0);
+        prev = node;
+    }
+    misaki_lattice_add_edge(prev, lattice->eos, 0.0);
+    assert(misaki_viterbi_search(lattice));
+    
+    tokens = misaki_token_list_create_view(long_text);
+    assert(misaki_viterbi_append_tokens(lattice, tokens) == long_count);
+    assert(tokens->tokens[long_count - 1].surface.data == long_text + long_count - 1);
+    misaki_token_list_free(tokens);
+    misaki_lattice_free(lattice);
+    free(long_text);
+    
+    printf("✓ View-mode token append passed\n");
+}
+
 // 测试成本矩阵
 void test_cost_matrix() {
     printf("Testing cost matrix...\n");
     
     // 创建成本矩阵（简化版）
-    CostMatrix *matrix = (CostMatrix *)calloc(1, sizeof(CostMatrix));
+    CostMatrix *matrix = misaki_cost_matrix_create(3, 3);
     assert(matrix != NULL);
     
-    matrix->pos_count = 3;
-    matrix->trans_cost = (double **)calloc(3, sizeof(double *));
     for (int i = 0; i < 3; i++) {
-        matrix->trans_cost[i] = (double *)calloc(3, sizeof(double));
         for (int j = 0; j < 3; j++) {
-            matrix->trans_cost[i][j] = i + j * 0.5;
+            assert(misaki_cost_matrix_set(matrix, i, j, (int16_t)(i * 2 + j)));
         }
     }
+    assert(!misaki_cost_matrix_set(matrix, 3, 0, 1));
     
     // 测试获取成本
     double cost = misaki_cost_matrix_get(matrix, 0, 1);
-    assert(cost == 0.5);
+    assert(cost == 1.0);
     
     cost = misaki_cost_matrix_get(matrix, 1, 2);
-    assert(cost == 2.0);
+    assert(cost == 4.0);
+    
+    // 越界返回 0
+    assert(misaki_cost_matrix_get(matrix, 5, 0) == 0.0);
+    
+    // 保存后重新加载
+    const char *path = "test_cost_matrix.def";
+    assert(misaki_cost_matrix_save(matrix, path));
+    CostMatrix *loaded = misaki_cost_matrix_load(path);
+    assert(loaded != NULL);
+    assert(loaded->left_size == 3 && loaded->right_size == 3);
+    assert(memcmp(loaded->costs, matrix->costs, sizeof(int16_t) * 9) == 0);
+    misaki_cost_matrix_free(loaded);
+    remove(path);
+    
+    assert(misaki_cost_matrix_load("nonexistent.def") == NULL);
     
     misaki_cost_matrix_free(matrix);
     
     printf("✓ Cost matrix passed\n");
 }
 
+// 测试预计算的词性转移矩阵与字符串规则一致
+void test_transition_matrix() {
+    printf("Testing transition matrix...\n");
+    
+    CostMatrix *matrix = misaki_transition_matrix_build();
+    assert(matrix != NULL);
+    assert(matrix->left_size == misaki_tag_count());
+    
+    for (int i = 0; i < matrix->left_size; i++) {
+        for (int j = 0; j < matrix->right_size; j++) {
+            double expected = misaki_get_transition_cost(misaki_tag_name((MisakiTagId)i),
+                                                         misaki_tag_name((MisakiTagId)j));
+            assert(misaki_cost_matrix_get(matrix, i, j) == expected);
+        }
+    }
+    
+    MisakiTagId verb = misaki_tag_intern("動詞");
+    MisakiTagId aux = misaki_tag_intern("助動詞");
+    assert(misaki_cost_matrix_get(matrix, verb, aux) == -10.0);
+    assert(misaki_cost_matrix_get(matrix, 0, aux) == 0.0);
+    
+    // 保存的文件带词性表，重新加载后按名字对应
+    const char *path = "test_transition_matrix.def";
+    assert(misaki_cost_matrix_save(matrix, path));
+    CostMatrix *loaded = misaki_cost_matrix_load(path);
+    assert(loaded != NULL && loaded->defined != NULL);
+    assert(misaki_cost_matrix_get(loaded, verb, aux) == -10.0);
+    misaki_cost_matrix_free(loaded);
+    misaki_cost_matrix_free(matrix);
+    
+    // 其他进程保存的文件：ID 按那边的驻留顺序，这里按名字换成本进程的 ID
+    FILE *file = fopen(path, "w");
+    fputs("4 4\n@ 1 形容詞\n@ 3 名詞 固有名詞\n1 3 -4\n3 1 9\n0 3 2\n", file);
+    fclose(file);
+    loaded = misaki_cost_matrix_load(path);
+    assert(loaded != NULL);
+    MisakiTagId adj = misaki_tag_intern("形容詞");
+    MisakiTagId noun = misaki_tag_intern("名詞 固有名詞");
+    assert(misaki_cost_matrix_get(loaded, adj, noun) == -4.0);
+    assert(misaki_cost_matrix_get(loaded, noun, adj) == 9.0);
+    assert(misaki_cost_matrix_get(loaded, 0, noun) == 2.0);
+    
+    // 文件中没有的词性取内置规则
+    assert(misaki_cost_matrix_covers(loaded, verb, aux));
+    matrix = misaki_transition_matrix_build_with(loaded);
+    assert(misaki_cost_matrix_get(matrix, adj, noun) == -4.0);
+    assert(misaki_cost_matrix_get(matrix, verb, aux) == -10.0);
+    misaki_cost_matrix_free(matrix);
+    misaki_cost_matrix_free(loaded);
+    
+    // 词性表在成本之后、未列出的 ID 都被拒绝
+    file = fopen(path, "w");
+    fputs("4 4\n1 3 -4\n@ 1 形容詞\n", file);
+    fclose(file);
+    assert(misaki_cost_matrix_load(path) == NULL);
+    file = fopen(path, "w");
+    fputs("4 4\n@ 1 形容詞\n1 2 -4\n", file);
+    fclose(file);
+    assert(misaki_cost_matrix_load(path) == NULL);
+    remove(path);
+    
+    printf("✓ Transition matrix passed\n");
+}
+
+// user_data 为 {left, right}：这对节点之间的连接成本为 10
+static double test_pair_cost(const LatticeNode *left, const LatticeNode *right,
+                             void *user_data) {
+    LatticeNode **pair = (LatticeNode **)user_data;
+    return (left == pair[0] && right == pair[1]) ? 10.0 : 0.0;
+}
+
 // 测试 N-Best 路径
 void test_nbest_search() {
     printf("Testing N-Best search...\n");
@@ -250,12 +404,14 @@ void test_nbest_search() {
     
     misaki_viterbi_search(lattice);
     
-    // 获取 N-Best 路径
+    // 获取 N-Best 路径（只有一条路径）
     NBestResult results[5];
     int count = misaki_viterbi_nbest(lattice, 5, results);
     
-    assert(count >= 1);  // 至少有 1 条最优路径
+    assert(count == 1);
     assert(results[0].path_length == 2);
+    assert(results[0].path[0] == node1 && results[0].path[1] == node2);
+    assert(fabs(results[0].total_cost - 7.0) < 1e-9);
     
     printf("  Found %d best paths\n", count);
     printf("  Best path length: %d, cost: %.2f\n",
@@ -264,6 +420,70 @@ void test_nbest_search() {
     misaki_nbest_free(results, count);
     misaki_lattice_free(lattice);
     
+    // 三条路径：a+b (2)、ab (3)、a+b2 (3.5)
+    lattice = misaki_lattice_create(2);
+    LatticeNode *a = misaki_lattice_add_node(lattice, 0, "a", NULL, NULL, 1.0);
+    LatticeNode *ab = misaki_lattice_add_node(lattice, 0, "ab", NULL, NULL, 3.0);
+    LatticeNode *b = misaki_lattice_add_node(lattice, 1, "b", NULL, NULL, 1.0);
+    LatticeNode *b2 = misaki_lattice_add_node(lattice, 1, "b", NULL, NULL, 2.5);
+    
+    misaki_lattice_add_edge(lattice->bos, a, 0.0);
+    misaki_lattice_add_edge(lattice->bos, ab, 0.0);
+    misaki_lattice_add_edge(a, b, 0.0);
+    misaki_lattice_add_edge(a, b2, 0.0);
+    misaki_lattice_add_edge(b, lattice->eos, 0.0);
+    misaki_lattice_add_edge(b2, lattice->eos, 0.0);
+    misaki_lattice_add_edge(ab, lattice->eos, 0.0);
+    misaki_viterbi_search(lattice);
+    
+    count = misaki_viterbi_nbest(lattice, 5, results);
+    assert(count == 3);
+    assert(results[0].path_length == 2 && results[0].path[1] == b);
+    assert(results[1].path_length == 1 && results[1].path[0] == ab);
+    assert(results[2].path_length == 2 && results[2].path[1] == b2);
+    assert(fabs(results[0].total_cost - 2.0) < 1e-9);
+    assert(fabs(results[1].total_cost - 3.0) < 1e-9);
+    assert(fabs(results[2].total_cost - 3.5) < 1e-9);
+    misaki_nbest_free(results, count);
+    
+    // n 小于路径数时只取前 n 条
+    assert(misaki_viterbi_nbest(lattice, 1, results) == 1);
+    misaki_nbest_free(results, 1);
+    
+    // 无边版本：a → b 很贵，顺序变为 ab、a+b2、a+b
+    LatticeNode *pair[2] = { a, b };
+    assert(misaki_viterbi_search_connect(lattice, test_pair_cost, pair));
+    count = misaki_viterbi_nbest_connect(lattice, test_pair_cost, pair, 5, results);
+    assert(count == 3);
+    assert(results[0].path[0] == ab);
+    assert(results[1].path[1] == b2);
+    assert(results[2].path[1] == b);
+    assert(fabs(results[2].total_cost - 12.0) < 1e-9);
+    misaki_nbest_free(results, count);
+    
+    misaki_lattice_free(lattice);
+    
+    // 同一节点的两条入边成本不同：ab1 节点便宜但边贵，最优为 ab2 + c
+    lattice = misaki_lattice_create(3);
+    LatticeNode *ab1 = misaki_lattice_add_node(lattice, 0, "ab", NULL, NULL, 1.0);
+    LatticeNode *ab2 = misaki_lattice_add_node(lattice, 0, "ab", NULL, NULL, 3.0);
+    LatticeNode *c = misaki_lattice_add_node(lattice, 2, "c", NULL, NULL, 1.0);
+    misaki_lattice_add_edge(lattice->bos, ab1, 0.0);
+    misaki_lattice_add_edge(lattice->bos, ab2, 0.0);
+    misaki_lattice_add_edge(ab1, c, 10.0);
+    misaki_lattice_add_edge(ab2, c, 0.0);
+    misaki_lattice_add_edge(c, lattice->eos, 0.0);
+    misaki_viterbi_search(lattice);
+    assert(c->prev == ab2 && c->edge_cost == 0.0);
+    assert(fabs(lattice->eos->total_cost - 4.0) < 1e-9);
+    
+    count = misaki_viterbi_nbest(lattice, 5, results);
+    assert(count == 2);
+    assert(results[0].path[0] == ab2 && fabs(results[0].total_cost - 4.0) < 1e-9);
+    assert(results[1].path[0] == ab1 && fabs(results[1].total_cost - 12.0) < 1e-9);
+    misaki_nbest_free(results, count);
+    misaki_lattice_free(lattice);
+    
     printf("✓ N-Best search passed\n");
 }
 
@@ -336,6 +556,263 @@ void test_lattice_stats() {
     printf("✓ Lattice stats passed\n");
 }
 
+// 测试基于原文偏移的节点与 reset 复用
+void test_lattice_span_reset() {
+    printf("Testing lattice span nodes/reset...\n");
+    
+    const char *text = "東京に行く";
+    Lattice *lattice = misaki_lattice_create_for_text(text);
+    assert(lattice != NULL);
+    assert(lattice->text_length == 5);
+    
+    // 「東京」：字符 0-2，字节 0-6
+    LatticeNode *node = misaki_lattice_add_span(lattice, 0, 0, 6, 2,
+                                                misaki_tag_intern("名詞"), 1.0);
+    assert(node != NULL);
+    assert(node->surface == NULL);
+    assert(node->length == 6 && node->char_length == 2);
+    assert(strcmp(node->feature, "名詞") == 0);
+    
+    MisakiStringView surface = misaki_lattice_node_surface(lattice, node);
+    assert(misaki_sv_equals_cstr(surface, "東京"));
+    
+    // 超过初始容量的节点数
+    for (int i = 0; i < 20; i++) {
+        assert(misaki_lattice_add_span(lattice, 2, 6, 3, 1, MISAKI_TAG_NONE, 2.0) != NULL);
+    }
+    assert(lattice->node_counts[2] == 20);
+    assert(misaki_lattice_add_edge(node, lattice->nodes[2][0], 0.5));
+    
+    // 复用同一个 Lattice 处理新文本
+    const char *text2 = "猫";
+    assert(misaki_lattice_reset(lattice, text2));
+    assert(lattice->text_length == 1);
+    assert(lattice->node_counts[0] == 0);
+    
+    node = misaki_lattice_add_span(lattice, 0, 0, 3, 1, MISAKI_TAG_NONE, 1.0);
+    assert(node != NULL);
+    assert(misaki_sv_equals_cstr(misaki_lattice_node_surface(lattice, node), "猫"));
+    assert(misaki_lattice_add_span(lattice, 1, 3, 3, 1, MISAKI_TAG_NONE, 1.0) == NULL);
+    
+    misaki_lattice_free(lattice);
+    
+    printf("✓ Lattice span nodes/reset passed\n");
+}
+
+// 连接成本：tag 1 之后接 tag 3 很贵
+static double test_connect_cost(const LatticeNode *left, const LatticeNode *right,
+                                void *user_data) {
+    int *calls = (int *)user_data;
+    (*calls)++;
+    return (left->tag_id == 1 && right->tag_id == 3) ? 100.0 : 0.0;
+}
+
+// 测试无边 Viterbi（每对相邻节点有独立的连接成本）
+void test_viterbi_search_connect() {
+    printf("Testing edge-free viterbi search...\n");
+    
+    Lattice *lattice = misaki_lattice_create_for_text("ab");
+    assert(lattice != NULL);
+    
+    // 两个在位置 1 结束的候选：left_cheap 节点成本低但连接成本高
+    LatticeNode *left_cheap = misaki_lattice_add_span(lattice, 0, 0, 1, 1, 1, 1.0);
+    LatticeNode *left_plain = misaki_lattice_add_span(lattice, 0, 0, 1, 1, 2, 5.0);
+    LatticeNode *right = misaki_lattice_add_span(lattice, 1, 1, 1, 1, 3, 1.0);
+    assert(left_cheap && left_plain && right);
+    assert(lattice->end_counts[1] == 2);
+    assert(lattice->end_counts[2] == 1);
+    
+    int calls = 0;
+    assert(misaki_viterbi_search_connect(lattice, test_connect_cost, &calls));
+    assert(calls == 2 + 2 + 1);  // BOS→左侧 ×2，左侧→右侧 ×2，右侧→EOS
+    assert(right->prev == left_plain);
+    assert(fabs(lattice->eos->total_cost - 6.0) < 1e-9);
+    
+    LatticeNode *path[4];
+    assert(misaki_viterbi_backtrack(lattice, path, 4) == 2);
+    assert(path[0] == left_plain && path[1] == right);
+    
+    // 无法到达 EOS
+    assert(misaki_lattice_reset(lattice, "ab"));
+    misaki_lattice_add_span(lattice, 0, 0, 1, 1, MISAKI_TAG_NONE, 1.0);
+    assert(!misaki_viterbi_search_connect(lattice, NULL, NULL));
+    
+    misaki_lattice_free(lattice);
+    
+    printf("✓ Edge-free viterbi search passed\n");
+}
+
+// 测试紧凑（SoA）Lattice
+void test_compact_lattice() {
+    printf("Testing compact lattice...\n");
+    
+    // tag 1 之后接 tag 3 很贵
+    CostMatrix *matrix = misaki_cost_matrix_create(4, 4);
+    assert(matrix != NULL);
+    misaki_cost_matrix_set(matrix, 1, 3, 100);
+    
+    const char *text = "東京";
+    CompactLattice *lattice = misaki_compact_lattice_create(text);
+    assert(lattice != NULL);
+    assert(lattice->text_length == 2);
+    
+    int left_cheap = misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 1, 1.0f);
+    int left_plain = misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 2, 5.0f);
+    int whole = misaki_compact_lattice_add(lattice, 0, 2, 0, 6, 2, 20.0f);
+    int right = misaki_compact_lattice_add(lattice, 1, 1, 3, 3, 3, 1.0f);
+    assert(left_cheap == 0 && left_plain == 1 && whole == 2 && right == 3);
+    
+    // 起始位置不能回退
+    assert(misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 1, 1.0f) == -1);
+    
+    assert(misaki_compact_viterbi_search(lattice, matrix));
+    assert(lattice->back[right] == left_plain);
+    assert(lattice->eos_back == right);
+    assert(fabsf(lattice->eos_cost - 6.0f) < 1e-6f);
+    
+    int path[4];
+    assert(misaki_compact_viterbi_backtrack(lattice, path, 4) == 2);
+    assert(path[0] == left_plain && path[1] == right);
+    assert(misaki_compact_viterbi_backtrack(lattice, path, 1) == -1);
+    
+    // 读音随节点带到 Token
+    assert(misaki_compact_lattice_set_reading(lattice, left_plain, "ヒガシ", "çiɡaɕi"));
+    assert(!misaki_compact_lattice_set_reading(lattice, 4, "キョウ", NULL));
+    
+    MisakiTokenList *tokens = misaki_token_list_create();
+    assert(misaki_compact_viterbi_append_tokens(lattice, tokens) == 2);
+    assert(strcmp(tokens->tokens[0].text, "東") == 0);
+    assert(strcmp(tokens->tokens[0].reading, "ヒガシ") == 0);
+    assert(strcmp(tokens->tokens[0].ipa, "çiɡaɕi") == 0);
+    assert(tokens->tokens[1].reading == NULL);
+    assert(strcmp(tokens->tokens[1].text, "京") == 0);
+    assert(tokens->tokens[1].start == 1 && tokens->tokens[1].length == 1);
+    misaki_token_list_free(tokens);
+    
+    // 没有矩阵时连接成本为 0：「東京」整词 (20) 比 1 + 1 贵
+    assert(misaki_compact_viterbi_search(lattice, NULL));
+    assert(lattice->back[right] == left_cheap);
+    
+    // reset 复用数组；无法到达 EOS
+    assert(misaki_compact_lattice_reset(lattice, text));
+    assert(lattice->count == 0);
+    misaki_compact_lattice_add(lattice, 0, 1, 0, 3, MISAKI_TAG_NONE, 1.0f);
+    assert(!misaki_compact_viterbi_search(lattice, matrix));
+    assert(misaki_compact_viterbi_backtrack(lattice, path, 4) == 0);
+    
+    misaki_compact_lattice_free(lattice);
+    misaki_cost_matrix_free(matrix);
+    
+    printf("✓ Compact lattice passed\n");
+}
+
+// 测试束剪枝
+void test_compact_beam() {
+    printf("Testing compact beam pruning...\n");
+    
+    CostMatrix *matrix = misaki_cost_matrix_create(4, 4);
+    assert(matrix != NULL);
+    misaki_cost_matrix_set(matrix, 1, 3, 100);
+    
+    CompactLattice *lattice = misaki_compact_lattice_create("東京");
+    assert(lattice != NULL);
+    int left_cheap = misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 1, 1.0f);
+    int left_plain = misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 2, 5.0f);
+    int whole = misaki_compact_lattice_add(lattice, 0, 2, 0, 6, 2, 20.0f);
+    int right = misaki_compact_lattice_add(lattice, 1, 1, 3, 3, 3, 1.0f);
+    
+    // 全为 0 等同精确搜索
+    ViterbiBeam beam = { 0, 0.0f };
+    ViterbiPruneStats stats = { 0 };
+    assert(misaki_compact_viterbi_search_beam(lattice, matrix, &beam, &stats));
+    assert(lattice->back[right] == left_plain);
+    assert(stats.beam_hits == 0 && stats.pruned_paths == 0);
+    
+    // 阈值足够宽时不剪枝
+    beam.cost_threshold = 10.0f;
+    assert(misaki_compact_viterbi_search_beam(lattice, matrix, &beam, &stats));
+    assert(lattice->back[right] == left_plain);
+    assert(stats.pruned_paths == 0);
+    
+    // 束宽 1：位置 1 只保留 left_cheap，之后的连接很贵，最终选整词（非全局最优）
+    beam.beam_width = 1;
+    beam.cost_threshold = 0.0f;
+    assert(misaki_compact_viterbi_search_beam(lattice, matrix, &beam, &stats));
+    assert(lattice->back[right] == left_cheap);
+    assert(lattice->eos_back == whole);
+    assert(stats.beam_hits == 1 && stats.pruned_paths == 1);
+    
+    // 阈值 3：left_plain 比最优贵 4，被剪掉
+    beam.beam_width = 0;
+    beam.cost_threshold = 3.0f;
+    assert(misaki_compact_viterbi_search_beam(lattice, matrix, &beam, &stats));
+    assert(lattice->back[right] == left_cheap);
+    assert(stats.beam_hits == 2 && stats.pruned_paths == 2);
+    
+    // 剪枝后精确搜索仍然能看到整个桶
+    assert(misaki_compact_viterbi_search(lattice, matrix));
+    assert(lattice->back[right] == left_plain);
+    assert(lattice->eos_back == right);
+    
+    misaki_compact_lattice_free(lattice);
+    misaki_cost_matrix_free(matrix);
+    
+    printf("✓ Compact beam pruning passed\n");
+}
+
+// 测试紧凑 Lattice 的 N-Best
+void test_compact_nbest() {
+    printf("Testing compact N-Best...\n");
+    
+    CostMatrix *matrix = misaki_cost_matrix_create(4, 4);
+    assert(matrix != NULL);
+    misaki_cost_matrix_set(matrix, 1, 3, 100);
+    
+    CompactLattice *lattice = misaki_compact_lattice_create("東京");
+    assert(lattice != NULL);
+    int left_cheap = misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 1, 1.0f);
+    int left_plain = misaki_compact_lattice_add(lattice, 0, 1, 0, 3, 2, 5.0f);
+    int whole = misaki_compact_lattice_add(lattice, 0, 2, 0, 6, 2, 20.0f);
+    int right = misaki_compact_lattice_add(lattice, 1, 1, 3, 3, 3, 1.0f);
+    assert(misaki_compact_viterbi_search(lattice, matrix));
+    
+    // 三条路径：left_plain+right (6)、whole (20)、left_cheap+right (102)
+    NBestResult results[5];
+    int count = misaki_compact_viterbi_nbest(lattice, matrix, 5, results);
+    assert(count == 3);
+    assert(results[0].path_length == 2);
+    assert(results[0].nodes[0] == left_plain && results[0].nodes[1] == right);
+    assert(results[1].path_length == 1 && results[1].nodes[0] == whole);
+    assert(results[2].nodes[0] == left_cheap);
+    assert(fabs(results[0].total_cost - 6.0) < 1e-6);
+    assert(fabs(results[1].total_cost - 20.0) < 1e-6);
+    assert(fabs(results[2].total_cost - 102.0) < 1e-6);
+    
+    // 最优结果与 Viterbi 路径一致
+    int path[4];
+    assert(misaki_compact_viterbi_backtrack(lattice, path, 4) == 2);
+    assert(path[0] == results[0].nodes[0] && path[1] == results[0].nodes[1]);
+    
+    MisakiTokenList *tokens = misaki_token_list_create();
+    assert(misaki_compact_nbest_append_tokens(lattice, matrix, &results[2], tokens) == 2);
+    assert(strcmp(tokens->tokens[1].text, "京") == 0);
+    assert(fabs(tokens->tokens[1].score - 102.0) < 1e-6);
+    misaki_token_list_free(tokens);
+    
+    misaki_nbest_free(results, count);
+    
+    // 没有搜索结果时为空
+    assert(misaki_compact_lattice_reset(lattice, "東京"));
+    misaki_compact_lattice_add(lattice, 0, 1, 0, 3, MISAKI_TAG_NONE, 1.0f);
+    assert(!misaki_compact_viterbi_search(lattice, matrix));
+    assert(misaki_compact_viterbi_nbest(lattice, matrix, 5, results) == 0);
+    
+    misaki_compact_lattice_free(lattice);
+    misaki_cost_matrix_free(matrix);
+    
+    printf("✓ Compact N-Best passed\n");
+}
+
 // 测试边界情况
 void test_edge_cases() {
     printf("Testing edge cases...\n");
@@ -365,9 +842,17 @@ int main() {
     test_lattice_add_node();
     test_lattice_get_nodes_at();
     test_lattice_add_edge();
+    test_lattice_span_reset();
+    test_viterbi_search_connect();
+    test_viterbi_append_view();
+    test_compact_lattice();
+    test_compact_beam();
+    test_compact_nbest();
+    test_nbest_search();
     
     // 成本矩阵测试
     test_cost_matrix();
+    test_transition_matrix();
     
     // 边界情况
     test_edge_cases();
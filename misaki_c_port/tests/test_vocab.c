@@ -0,0 +1,179 @@
+/**
+ * test_vocab.c
+ * 
+ * Kokoro 词表编码测试（内置词表、vocab.json、分段）
+ */
+
+#include "misaki_vocab.h"
+#include "misaki_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/**
+ * 检查一段的内容：[0, 字符串中每个字符的 ID..., 0]
+ */
+static void assert_chunk(const MisakiVocab *vocab, const int64_t *ids, int length,
+                         const char *expected) {
+    int pos = 0;
+    assert(ids[pos++] == 0);
+    for (const char *p = expected; *p;) {
+        uint32_t cp;
+        p += misaki_utf8_decode(p, &cp);
+        assert(pos < length - 1 && ids[pos++] == misaki_vocab_lookup(vocab, cp));
+    }
+    assert(pos == length - 1 && ids[pos] == 0);
+}
+
+void test_vocab_default() {
+    printf("Testing built-in vocab / encode...\n");
+    
+    MisakiVocab *vocab = misaki_vocab_create_default();
+    assert(vocab != NULL);
+    assert(misaki_vocab_lookup(vocab, ';') == 1);
+    assert(misaki_vocab_lookup(vocab, ' ') == 16);
+    assert(misaki_vocab_lookup(vocab, 0x0274) == 115);     // ɴ
+    assert(misaki_vocab_lookup(vocab, 0x1D7B) == 177);     // ᵻ
+    assert(misaki_vocab_lookup(vocab, 'g') == -1);
+    assert(misaki_vocab_lookup(vocab, 0x1F600) == -1);
+    
+    // 与应用里的 phonemesToIds 相同：逐字符查表，词表外的字符跳过
+    int64_t ids[64];
+    int lengths[4];
+    assert(misaki_vocab_encode(vocab, "koɴnitɕiwa", 0, ids, 64, lengths, 4) == 1);
+    assert(lengths[0] == 12);
+    assert_chunk(vocab, ids, lengths[0], "koɴnitɕiwa");
+    assert(misaki_vocab_encode(vocab, "  ni↓xau↓ ", 0, ids, 64, lengths, 4) == 1);
+    assert_chunk(vocab, ids, lengths[0], "ni↓xau↓");
+    
+    // 没有词表内的字符
+    assert(misaki_vocab_encode(vocab, "", 0, ids, 64, lengths, 4) == 0);
+    assert(misaki_vocab_encode(vocab, "   ", 0, ids, 64, lengths, 4) == 0);
+    assert(misaki_vocab_encode(vocab, "ggg", 0, ids, 64, lengths, 4) == 0);
+    
+    // 输出数组不够
+    assert(misaki_vocab_encode(vocab, "koɴnitɕiwa", 0, ids, 11, lengths, 4) == -1);
+    assert(misaki_vocab_encode(vocab, "koɴnitɕiwa", 0, ids, 64, lengths, 0) == -1);
+    assert(misaki_vocab_encode(NULL, "a", 0, ids, 64, lengths, 4) == -1);
+    
+    misaki_vocab_free(vocab);
+    printf("✓ Built-in vocab / encode passed\n");
+}
+
+void test_vocab_chunks() {
+    printf("Testing chunking...\n");
+    
+    MisakiVocab *vocab = misaki_vocab_create_default();
+    int64_t ids[256];
+    int lengths[16];
+    
+    // 优先在标点处切开，其次空格；段首尾的空格去掉
+    assert(misaki_vocab_encode(vocab, "ab cd, ef hi", 5, ids, 256, lengths, 16) == 3);
+    assert_chunk(vocab, ids, lengths[0], "ab");
+    assert_chunk(vocab, ids + lengths[0], lengths[1], "cd,");
+    assert_chunk(vocab, ids + lengths[0] + lengths[1], lengths[2], "ef hi");
+    
+    // 正好在上限处的空格
+    assert(misaki_vocab_encode(vocab, "abcde fh", 5, ids, 256, lengths, 16) == 2);
+    assert_chunk(vocab, ids, lengths[0], "abcde");
+    assert_chunk(vocab, ids + lengths[0], lengths[1], "fh");
+    
+    // 没有标点和空格时硬切
+    assert(misaki_vocab_encode(vocab, "abcdefh", 3, ids, 256, lengths, 16) == 3);
+    assert_chunk(vocab, ids, lengths[0], "abc");
+    assert_chunk(vocab, ids + 5, lengths[1], "def");
+    assert_chunk(vocab, ids + 10, lengths[2], "h");
+    assert(misaki_vocab_encode(vocab, "abcdefh", 3, ids, 256, lengths, 2) == -1);
+    
+    // 长文本：每段不超过 510 个且在句号处切开，总数只少了切点和末尾的空格
+    char *text = (char *)malloc(4096);
+    text[0] = '\0';
+    for (int i = 0; i < 200; i++) {
+        strcat(text, i % 7 == 6 ? "koɴnitɕiwa. " : "koɴnitɕiwa ");
+    }
+    int64_t *long_ids = (int64_t *)malloc(8192 * sizeof(int64_t));
+    int count = misaki_vocab_encode(vocab, text, 0, long_ids, 8192, lengths, 16);
+    assert(count == 5);
+    int offset = 0;
+    int content = 0;
+    for (int i = 0; i < count; i++) {
+        assert(lengths[i] - 2 <= MISAKI_VOCAB_MAX_TOKENS);
+        assert(long_ids[offset] == 0 && long_ids[offset + lengths[i] - 1] == 0);
+        if (i < count - 1) {
+            assert(long_ids[offset + lengths[i] - 2] == misaki_vocab_lookup(vocab, '.'));
+        }
+        content += lengths[i] - 2;
+        offset += lengths[i];
+    }
+    assert(content == 200 * 11 + 28 - (count - 1) - 1);
+    printf("  %d chunks: %d", count, lengths[0]);
+    for (int i = 1; i < count; i++) {
+        printf(" / %d", lengths[i]);
+    }
+    printf("\n");
+    
+    free(long_ids);
+    free(text);
+    misaki_vocab_free(vocab);
+    printf("✓ Chunking passed\n");
+}
+
+void test_vocab_json() {
+    printf("Testing vocab.json...\n");
+    
+    const char *path = "test_vocab.json";
+    FILE *file = fopen(path, "w");
+    fputs("{\n  \"a\": 1,\n  \"\\u0283\": 2,\n  \"\\\"\": 3, \"ab\": 9,\n  \"ː\": 158\n}\n", file);
+    fclose(file);
+    
+    MisakiVocab *vocab = misaki_vocab_load(path);
+    assert(vocab != NULL);
+    assert(misaki_vocab_lookup(vocab, 'a') == 1);
+    assert(misaki_vocab_lookup(vocab, 0x0283) == 2);
+    assert(misaki_vocab_lookup(vocab, '"') == 3);
+    assert(misaki_vocab_lookup(vocab, 0x02D0) == 158);
+    assert(misaki_vocab_lookup(vocab, 'b') == -1);     // 多个字符的键跳过
+    misaki_vocab_free(vocab);
+    
+    file = fopen(path, "w");
+    fputs("{\"a\": 1, \"b\" 2}", file);
+    fclose(file);
+    assert(misaki_vocab_load(path) == NULL);
+    remove(path);
+    assert(misaki_vocab_load(path) == NULL);
+    
+    const uint32_t codepoints[] = { 'a' };
+    const int bad_ids[] = { 0 };
+    assert(misaki_vocab_create(codepoints, bad_ids, 1) == NULL);
+    
+    // 仓库里的 vocab.json 与内置词表一致
+    vocab = misaki_vocab_load("../../models/vocab.json");
+    if (vocab) {
+        MisakiVocab *builtin = misaki_vocab_create_default();
+        for (uint32_t cp = 0; cp <= 0xFFFF; cp++) {
+            assert(misaki_vocab_lookup(vocab, cp) == misaki_vocab_lookup(builtin, cp));
+        }
+        misaki_vocab_free(builtin);
+        misaki_vocab_free(vocab);
+        printf("  models/vocab.json matches the built-in vocab\n");
+    }
+    
+    printf("✓ vocab.json passed\n");
+}
+
+int main() {
+    printf("==============================================\n");
+    printf("Misaki Vocab Test\n");
+    printf("==============================================\n\n");
+    
+    test_vocab_default();
+    test_vocab_chunks();
+    test_vocab_json();
+    
+    printf("\n==============================================\n");
+    printf("All vocab tests passed! ✓\n");
+    printf("==============================================\n");
+    
+    return 0;
+}
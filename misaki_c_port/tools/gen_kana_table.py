@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+"""
+gen_kana_table.py
+
+生成假名→IPA 的码点索引表（src/core/misaki_kana_table.inc）
+
+表分两级：第一级按码点高 8 位选页，第二级是页内 256 个码点的表项。
+片假名直接展开成与平假名相同的表项，运行时不再做片假名→平假名转换；
+拗音按「第一字的行号 × 第二字（小写假名）的列号」查第二张表（只对平假名）。
+拗音表的第 0 行、第 0 列为空，未收录码点的表项（全 0）因此不会组成拗音。
+
+用法：python3 tools/gen_kana_table.py（在 misaki_c_port 目录下运行）
+"""
+
+from pathlib import Path
+
+OUTPUT_FILE = Path(__file__).resolve().parent.parent / "src" / "core" / "misaki_kana_table.inc"
+
+# ============================================================================
+# HEPBURN 映射表（从 Python misaki 移植）
+# ============================================================================
+
+# 单字符平假名映射
+HEPBURN_SINGLE = [
+    # あ行
+    ("ぁ", "a"), ("あ", "a"), ("ぃ", "i"), ("い", "i"),
+    ("ぅ", "ɯ"), ("う", "ɯ"), ("ぇ", "e"), ("え", "e"),
+    ("ぉ", "o"), ("お", "o"),
+
+    # か行（简化 IPA，不带腭音化标记）
+    ("か", "ka"), ("が", "ɡa"), ("き", "ki"), ("ぎ", "ɡi"),
+    ("く", "kɯ"), ("ぐ", "ɡɯ"), ("け", "ke"), ("げ", "ɡe"),
+    ("こ", "ko"), ("ご", "ɡo"),
+
+    # さ行
+    ("さ", "sa"), ("ざ", "dza"), ("し", "ɕi"), ("じ", "dʑi"),
+    ("す", "sɨ"), ("ず", "dzɨ"), ("せ", "se"), ("ぜ", "dze"),
+    ("そ", "so"), ("ぞ", "dzo"),
+
+    # た行（っ 是特殊字符）
+    ("た", "ta"), ("だ", "da"), ("ち", "tɕi"), ("ぢ", "dʑi"),
+    ("つ", "ʦɨ"), ("づ", "zɨ"), ("て", "te"), ("で", "de"),
+    ("と", "to"), ("ど", "do"),
+
+    # な行
+    ("な", "na"), ("に", "ni"), ("ぬ", "nɯ"), ("ね", "ne"),
+    ("の", "no"),
+
+    # は行
+    ("は", "ha"), ("ば", "ba"), ("ぱ", "pa"), ("ひ", "çi"),
+    ("び", "bi"), ("ぴ", "pi"), ("ふ", "ɸɯ"), ("ぶ", "bɯ"),
+    ("ぷ", "pɯ"), ("へ", "he"), ("べ", "be"), ("ぺ", "pe"),
+    ("ほ", "ho"), ("ぼ", "bo"), ("ぽ", "po"),
+
+    # ま行
+    ("ま", "ma"), ("み", "mi"), ("む", "mɯ"), ("め", "me"),
+    ("も", "mo"),
+
+    # や行
+    ("ゃ", "ja"), ("や", "ja"), ("ゅ", "jɯ"), ("ゆ", "jɯ"),
+    ("ょ", "jo"), ("よ", "jo"),
+
+    # ら行
+    ("ら", "ɾa"), ("り", "ɾi"), ("る", "ɾɯ"), ("れ", "ɾe"),
+    ("ろ", "ɾo"),
+
+    # わ行
+    ("ゎ", "wa"), ("わ", "wa"), ("ゐ", "i"), ("ゑ", "e"),
+    ("を", "o"),
+
+    # その他（ん 是特殊字符）
+    ("ゔ", "vɯ"), ("ゕ", "ka"), ("ゖ", "ke"),
+]
+
+# 片假名独有的字符（没有对应的平假名）
+KATAKANA_ONLY = [
+    ("ヷ", "va"), ("ヸ", "vʲi"), ("ヹ", "ve"), ("ヺ", "vo"),
+]
+
+# 双字符组合（拗音、外来音）
+HEPBURN_DIGRAPH = [
+    ("いぇ", "je"),
+    ("うぃ", "wi"), ("うぇ", "we"), ("うぉ", "wo"),
+    ("きぇ", "ke"), ("きゃ", "ka"), ("きゅ", "kɨ"), ("きょ", "ko"),
+    ("ぎゃ", "ɡa"), ("ぎゅ", "ɡɨ"), ("ぎょ", "ɡo"),
+    ("くぁ", "kᵝa"), ("くぃ", "kᵝi"), ("くぇ", "kᵝe"), ("くぉ", "kᵝo"),
+    ("ぐぁ", "ɡᵝa"), ("ぐぃ", "ɡᵝi"), ("ぐぇ", "ɡᵝe"), ("ぐぉ", "ɡᵝo"),
+    ("しぇ", "ɕe"), ("しゃ", "ɕa"), ("しゅ", "ɕɨ"), ("しょ", "ɕo"),
+    ("じぇ", "ʥe"), ("じゃ", "ʥa"), ("じゅ", "ʥɨ"), ("じょ", "ʥo"),
+    ("ちぇ", "tɕe"), ("ちゃ", "tɕa"), ("ちゅ", "tɕɨ"), ("ちょ", "tɕo"),
+    ("ぢゃ", "ʥa"), ("ぢゅ", "ʥɨ"), ("ぢょ", "ʥo"),
+    ("つぁ", "tsa"), ("つぃ", "tsi"), ("つぇ", "tse"), ("つぉ", "tso"),
+    ("てぃ", "tʲi"), ("てゅ", "tʲɨ"),
+    ("でぃ", "dʲi"), ("でゅ", "dʲɨ"),
+    ("とぅ", "tɯ"),
+    ("どぅ", "dɯ"),
+    ("にぇ", "ne"), ("にゃ", "na"), ("にゅ", "nɨ"), ("にょ", "no"),
+    ("ひぇ", "çe"), ("ひゃ", "ça"), ("ひゅ", "çɨ"), ("ひょ", "ço"),
+    ("びゃ", "ba"), ("びゅ", "bɨ"), ("びょ", "bo"),
+    ("ぴゃ", "pa"), ("ぴゅ", "pɨ"), ("ぴょ", "po"),
+    ("ふぁ", "ɸa"), ("ふぃ", "ɸi"), ("ふぇ", "ɸe"), ("ふぉ", "ɸo"),
+    ("ふゅ", "ɸɨ"), ("ふょ", "ɸo"),
+    ("みゃ", "ma"), ("みゅ", "mɨ"), ("みょ", "mo"),
+    ("りゃ", "ɾa"), ("りゅ", "ɾɨ"), ("りょ", "ɾo"),
+    ("ゔぁ", "va"), ("ゔぃ", "vi"), ("ゔぇ", "ve"), ("ゔぉ", "vo"),
+    ("ゔゅ", "bɨ"), ("ゔょ", "bo"),
+]
+
+# 拗音第二字（列顺序）
+SMALL_KANA = "ぁぃぅぇぉゃゅょ"
+
+# 特殊字符（IPA 由转换时的上下文决定）
+SPECIAL = [
+    ("っ", "KANA_SOKUON"),
+    ("ん", "KANA_HATSUON"),
+    ("ー", "KANA_CHOUON"),
+]
+
+# 长音检测：「う」在 o 段后、「い」在 e 段后读作 ː
+LONG_VOWEL = [
+    ("う", "KANA_LONG_O"),
+    ("い", "KANA_LONG_E"),
+]
+
+# 标点符号映射
+PUNCT_MAPPING = [
+    ("。", "."), ("、", ","), ("？", "?"), ("！", "!"),
+    ("「", "\""), ("」", "\""), ("『", "\""), ("』", "\""),
+    ("：", ":"), ("；", ";"), ("（", "("), ("）", ")"),
+    ("《", "("), ("》", ")"), ("【", "["), ("】", "]"),
+    ("・", " "), ("，", ","), ("～", "-"), ("〜", "-"),
+    ("—", "-"), ("«", "\""), ("»", "\""),
+]
+
+# 片假名 → 平假名（ァ..ヶ）
+KATAKANA_FIRST = 0x30A1
+KATAKANA_LAST = 0x30F6
+KATAKANA_OFFSET = 0x60
+
+
+def nasal_before(ipa):
+    """「ん」在以 ipa 开头的音之前的发音（None 表示默认的 ɴ）"""
+    if not ipa:
+        return None
+    if ipa[0] in "mpb":
+        return "m"
+    if ipa[0] in "kg":
+        return "ŋ"
+    if ipa[0] in "ntdrz":
+        return "n"
+    return None
+
+
+def c_string(text):
+    if text is None:
+        return "NULL"
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def build_entries():
+    entries = {}
+
+    def entry(cp):
+        return entries.setdefault(cp, {
+            "ipa": None, "digraph": 0, "small": 0, "kind": "KANA_PLAIN",
+        })
+
+    for kana, ipa in HEPBURN_SINGLE + KATAKANA_ONLY + PUNCT_MAPPING:
+        entry(ord(kana))["ipa"] = ipa
+    for kana, kind in SPECIAL + LONG_VOWEL:
+        entry(ord(kana))["kind"] = kind
+    for column, kana in enumerate(SMALL_KANA, 1):
+        entry(ord(kana))["small"] = column
+
+    columns = len(SMALL_KANA) + 1
+    rows = [("", [None] * columns)]
+    for pair, ipa in HEPBURN_DIGRAPH:
+        first = entry(ord(pair[0]))
+        if first["digraph"] == 0:
+            first["digraph"] = len(rows)
+            rows.append((pair[0], [None] * columns))
+        rows[first["digraph"]][1][SMALL_KANA.index(pair[1]) + 1] = ipa
+
+    # 片假名展开成对应平假名的表项，但不组成拗音：词典读音是片假名，
+    # 而拗音表的 IPA 是简化过的（きょ → ko），逐字转换（キョ → kijo）反而保留了腭音
+    for cp in range(KATAKANA_FIRST, KATAKANA_LAST + 1):
+        hira = cp - KATAKANA_OFFSET
+        if hira in entries:
+            entries[cp] = dict(entries[hira], digraph=0, small=0)
+
+    for value in entries.values():
+        value["nasal"] = nasal_before(value["ipa"])
+
+    return entries, rows
+
+
+def generate():
+    entries, rows = build_entries()
+    out = []
+    out.append("/**")
+    out.append(" * misaki_kana_table.inc")
+    out.append(" * ")
+    out.append(" * 假名→IPA 码点索引表（由 tools/gen_kana_table.py 生成，请勿手工修改）")
+    out.append(" * ")
+    out.append(" * License: MIT")
+    out.append(" */")
+    out.append("")
+    out.append("#define KANA_DIGRAPH_COLUMNS %d" % (len(SMALL_KANA) + 1))
+    out.append("")
+    out.append("// 拗音表：行号见 KanaEntry.digraph，列号见 KanaEntry.small（1..%d 依次为 %s）"
+               % (len(SMALL_KANA), "、".join(SMALL_KANA)))
+    out.append("static const char *const KANA_DIGRAPH[][KANA_DIGRAPH_COLUMNS] = {")
+    for kana, cells in rows:
+        out.append("    /* %s */ { %s }," % (kana or "　", ", ".join(c_string(c) for c in cells)))
+    out.append("};")
+
+    pages = sorted({cp >> 8 for cp in entries})
+    for page in pages:
+        out.append("")
+        out.append("static const KanaEntry KANA_PAGE_%02X[256] = {" % page)
+        for cp in sorted(cp for cp in entries if cp >> 8 == page):
+            value = entries[cp]
+            out.append("    [0x%02X] = { %s, %s, %d, %d, %s },  // %s" % (
+                cp & 0xFF, c_string(value["ipa"]), c_string(value["nasal"]),
+                value["digraph"], value["small"], value["kind"], chr(cp)))
+        out.append("};")
+
+    out.append("")
+    out.append("// 第一级：码点高 8 位 → 页（BMP 以外的码点不在表中）")
+    out.append("static const KanaEntry *const KANA_PAGES[256] = {")
+    for page in pages:
+        out.append("    [0x%02X] = KANA_PAGE_%02X," % (page, page))
+    out.append("};")
+
+    OUTPUT_FILE.write_text("\n".join(out) + "\n", encoding="utf-8")
+    print("生成 %s（%d 个码点，%d 行拗音）" % (OUTPUT_FILE, len(entries), len(rows) - 1))
+
+
+if __name__ == "__main__":
+    generate()
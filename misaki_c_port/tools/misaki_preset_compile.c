@@ -0,0 +1,238 @@
+/**
+ * misaki_preset_compile.c
+ * 
+ * 预设表编译工具：把固定文本的列表转换成音素，编译成预设表
+ * 
+ * 输入（UTF-8，每行一条；空行和 # 开头的行忽略）：
+ *   文本              自动检测语言的请求（misaki_engine_text_to_phonemes）
+ *   语言<TAB>文本     指定语言的请求（ja / zh / en / qya）
+ * 
+ * 输出：预设表文件（misaki_engine_load_presets 加载），
+ * 或加 -c <名字> 生成 C 源文件（数组 <名字> 和大小 <名字>_size，
+ * 用 misaki_engine_set_presets 使用）
+ * 
+ * 用法：misaki_preset_compile [-d 数据目录] [-c 名字] 输入.txt 输出
+ * 
+ * License: MIT
+ */
+
+#include "misaki_api.h"
+#include "misaki_preset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_BYTES 4096
+#define PHONEMES_MAX_BYTES 16384
+
+typedef struct {
+    MisakiLanguage *langs;
+    char **texts;
+    char **phonemes;
+    int count;
+    int capacity;
+} PresetList;
+
+static void print_usage(const char *prog_name) {
+    printf("用法: %s [选项] <输入.txt> <输出>\n\n", prog_name);
+    printf("选项:\n");
+    printf("  -d, --data <目录>    指定数据目录（默认: ../extracted_data）\n");
+    printf("  -c, --c-array <名字> 输出 C 源文件（编进程序），而不是预设表文件\n");
+    printf("  -h, --help           显示帮助信息\n\n");
+    printf("输入每行一条：\"文本\" 或 \"语言<TAB>文本\"（ja / zh / en / qya）\n");
+}
+
+static MisakiLanguage parse_lang(const char *lang) {
+    if (strcmp(lang, "ja") == 0 || strcmp(lang, "jp") == 0) {
+        return LANG_JAPANESE;
+    } else if (strcmp(lang, "zh") == 0 || strcmp(lang, "cn") == 0) {
+        return LANG_CHINESE;
+    } else if (strcmp(lang, "en") == 0) {
+        return LANG_ENGLISH;
+    } else if (strcmp(lang, "qya") == 0 || strcmp(lang, "quenya") == 0) {
+        return LANG_QUENYA;
+    }
+    return LANG_UNKNOWN;
+}
+
+static bool list_add(PresetList *list, MisakiLanguage lang, const char *text, const char *phonemes) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        MisakiLanguage *langs = realloc(list->langs, capacity * sizeof(MisakiLanguage));
+        char **texts = realloc(list->texts, capacity * sizeof(char *));
+        char **values = realloc(list->phonemes, capacity * sizeof(char *));
+        if (langs) {
+            list->langs = langs;
+        }
+        if (texts) {
+            list->texts = texts;
+        }
+        if (values) {
+            list->phonemes = values;
+        }
+        if (!langs || !texts || !values) {
+            return false;
+        }
+        list->capacity = capacity;
+    }
+    
+    list->langs[list->count] = lang;
+    list->texts[list->count] = strdup(text);
+    list->phonemes[list->count] = strdup(phonemes);
+    list->count++;
+    return true;
+}
+
+static void list_free(PresetList *list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->texts[i]);
+        free(list->phonemes[i]);
+    }
+    free(list->langs);
+    free(list->texts);
+    free(list->phonemes);
+}
+
+/**
+ * 读取输入并逐条转换
+ * 
+ * @return 成功返回 true（转换失败的行报错并跳过）
+ */
+static bool compile_input(MisakiEngine *engine, FILE *input, PresetList *list) {
+    char line[LINE_MAX_BYTES];
+    char *phonemes = (char *)malloc(PHONEMES_MAX_BYTES);
+    if (!phonemes) {
+        return false;
+    }
+    
+    int line_no = 0;
+    while (fgets(line, sizeof(line), input)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        
+        MisakiLanguage lang = LANG_UNKNOWN;
+        const char *text = line;
+        char *tab = strchr(line, '\t');
+        if (tab) {
+            *tab = '\0';
+            lang = parse_lang(line);
+            text = tab + 1;
+            if (lang == LANG_UNKNOWN || text[0] == '\0') {
+                fprintf(stderr, "第 %d 行: 无法识别的语言或空文本，跳过\n", line_no);
+                continue;
+            }
+        }
+        
+        int result = lang == LANG_UNKNOWN
+            ? misaki_engine_text_to_phonemes(engine, text, phonemes, PHONEMES_MAX_BYTES)
+            : misaki_engine_text_to_phonemes_lang(engine, text, line, phonemes, PHONEMES_MAX_BYTES);
+        if (result != 0) {
+            fprintf(stderr, "第 %d 行: 转换失败，跳过: %s\n", line_no, text);
+            continue;
+        }
+        if (!list_add(list, lang, text, phonemes)) {
+            free(phonemes);
+            return false;
+        }
+    }
+    
+    free(phonemes);
+    return true;
+}
+
+static bool write_binary(const char *path, const unsigned char *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+static bool write_c_array(const char *path, const char *name,
+                          const unsigned char *data, size_t size) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    
+    fprintf(file, "/* 由 misaki_preset_compile 生成，请勿手动修改 */\n\n");
+    fprintf(file, "#include <stddef.h>\n\n");
+    fprintf(file, "const unsigned char %s[%zu] = {", name, size);
+    for (size_t i = 0; i < size; i++) {
+        fprintf(file, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", data[i]);
+    }
+    fprintf(file, "\n};\n\n");
+    fprintf(file, "const size_t %s_size = %zu;\n", name, size);
+    return fclose(file) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *data_dir = "../extracted_data";
+    const char *array_name = NULL;
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if ((strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--data") == 0) && i + 1 < argc) {
+            data_dir = argv[++i];
+        } else if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--c-array") == 0) && i + 1 < argc) {
+            array_name = argv[++i];
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else if (!output_path) {
+            output_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!input_path || !output_path) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    FILE *input = fopen(input_path, "r");
+    if (!input) {
+        fprintf(stderr, "错误: 无法打开输入文件 %s\n", input_path);
+        return 1;
+    }
+    
+    MisakiEngine *engine = misaki_engine_create(data_dir);
+    if (!engine) {
+        fprintf(stderr, "错误: 初始化失败\n");
+        fclose(input);
+        return 1;
+    }
+    
+    PresetList list = { 0 };
+    bool ok = compile_input(engine, input, &list);
+    fclose(input);
+    misaki_engine_free(engine);
+    
+    unsigned char *data = NULL;
+    size_t size = 0;
+    ok = ok && misaki_preset_table_build(list.langs, (const char *const *)list.texts,
+                                         (const char *const *)list.phonemes, list.count,
+                                         &data, &size) == 0;
+    if (ok) {
+        ok = array_name ? write_c_array(output_path, array_name, data, size)
+                        : write_binary(output_path, data, size);
+    }
+    
+    if (ok) {
+        printf("✅ %d 条预设 → %s (%zu 字节)\n", list.count, output_path, size);
+    } else {
+        fprintf(stderr, "错误: 编译预设表失败\n");
+    }
+    
+    free(data);
+    list_free(&list);
+    return ok ? 0 : 1;
+}